@@ -16,6 +16,11 @@ int main() {
 #include <cinttypes>
 #include <limits>
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
+#include "cache/lru_cache.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
@@ -55,8 +60,23 @@ DEFINE_uint32(lookup_percent, 10,
               "Ratio of lookup to total workload (expressed as a percentage)");
 DEFINE_uint32(erase_percent, 1,
               "Ratio of erase to total workload (expressed as a percentage)");
-
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_uint32(scan_percent, 0,
+              "Ratio of scan to total workload (expressed as a percentage). "
+              "A scan does lookup (+ insert on not found) of scan_length "
+              "consecutive keys that the other operations never use, like a "
+              "long iteration with fill_cache=true.");
+DEFINE_uint32(scan_length, 1000, "Number of keys visited by each scan.");
+
+DEFINE_bool(use_clock_cache, false,
+            "Use NewClockCache() instead of NewLRUCache().");
+DEFINE_bool(use_admission_filter, false,
+            "Set LRUCacheOptions::use_admission_filter.");
+DEFINE_bool(use_deferred_promotion, false,
+            "Set LRUCacheOptions::use_deferred_promotion.");
+DEFINE_bool(numa_aware, false, "Set LRUCacheOptions::numa_aware.");
+DEFINE_bool(bind_threads_to_numa_nodes, false,
+            "Run the threads round-robin on the NUMA nodes, so that all the "
+            "sockets use the cache. Requires NUMA support.");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -122,6 +142,9 @@ struct ThreadState {
   uint32_t tid;
   Random64 rnd;
   SharedState* shared;
+  // Lookups outside of scans, and how many of them hit
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
 
   ThreadState(uint32_t index, SharedState* _shared)
       : tid(index), rnd(1000 + index), shared(_shared) {}
@@ -136,7 +159,10 @@ struct KeyGen {
     for (uint32_t i = 0; i < FLAGS_skew; ++i) {
       raw = std::min(raw, rnd.Next());
     }
-    uint64_t key = FastRange64(raw, max_key);
+    return Get(FastRange64(raw, max_key));
+  }
+
+  Slice Get(uint64_t key) {
     // Variable size and alignment
     size_t off = key % 8;
     key_data[0] = char{42};
@@ -178,8 +204,10 @@ class CacheBench {
         lookup_threshold_(insert_threshold_ +
                           kHundredthUint64 * FLAGS_lookup_percent),
         erase_threshold_(lookup_threshold_ +
-                         kHundredthUint64 * FLAGS_erase_percent) {
-    if (erase_threshold_ != 100U * kHundredthUint64) {
+                         kHundredthUint64 * FLAGS_erase_percent),
+        scan_threshold_(erase_threshold_ +
+                        kHundredthUint64 * FLAGS_scan_percent) {
+    if (scan_threshold_ != 100U * kHundredthUint64) {
       fprintf(stderr, "Percentages must add to 100.\n");
       exit(1);
     }
@@ -190,7 +218,13 @@ class CacheBench {
         exit(1);
       }
     } else {
-      cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
+                           false /* strict_capacity_limit */,
+                           0.5 /* high_pri_pool_ratio */);
+      opts.use_admission_filter = FLAGS_use_admission_filter;
+      opts.use_deferred_promotion = FLAGS_use_deferred_promotion;
+      opts.numa_aware = FLAGS_numa_aware;
+      cache_ = NewLRUCache(opts);
     }
     if (FLAGS_ops_per_thread == 0) {
       FLAGS_ops_per_thread = 5 * max_key_;
@@ -242,6 +276,23 @@ class CacheBench {
           static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
     }
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    for (const auto& thread : threads) {
+      lookups += thread->lookups;
+      hits += thread->hits;
+    }
+    if (lookups > 0) {
+      fprintf(stdout, "Lookup hit ratio (excluding scans): %.2f%%\n",
+              100.0 * static_cast<double>(hits) / lookups);
+    }
+    if (!FLAGS_use_clock_cache && FLAGS_use_admission_filter) {
+      LRUCache* lru_cache = static_cast<LRUCache*>(cache_.get());
+      fprintf(stdout,
+              "Admission filter: %" PRIu64 " admitted, %" PRIu64
+              " rejected\n",
+              lru_cache->GetAdmittedInserts(), lru_cache->GetRejectedInserts());
+    }
     return true;
   }
 
@@ -253,11 +304,19 @@ class CacheBench {
   const uint64_t insert_threshold_;
   const uint64_t lookup_threshold_;
   const uint64_t erase_threshold_;
+  const uint64_t scan_threshold_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = static_cast<ThreadState*>(v);
     SharedState* shared = thread->shared;
 
+#ifdef NUMA
+    if (FLAGS_bind_threads_to_numa_nodes && numa_available() >= 0) {
+      numa_run_on_node(
+          static_cast<int>(thread->tid % numa_num_configured_nodes()));
+    }
+#endif
+
     {
       MutexLock l(shared->GetMutex());
       shared->IncInitialized();
@@ -295,7 +354,9 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
                              FLAGS_value_bytes);
@@ -319,7 +380,9 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
                              FLAGS_value_bytes);
@@ -327,6 +390,28 @@ class CacheBench {
       } else if (random_op < erase_threshold_) {
         // do erase
         cache_->Erase(key);
+      } else if (random_op < scan_threshold_) {
+        if (handle) {
+          cache_->Release(handle);
+          handle = nullptr;
+        }
+        // do scan, starting anywhere in a keyspace much larger than the one
+        // of the other operations
+        uint64_t start =
+            max_key_ + FastRange64(thread->rnd.Next(), 100 * max_key_);
+        for (uint32_t j = 0; j < FLAGS_scan_length; j++) {
+          Slice scan_key = gen.Get(start + j);
+          Cache::Handle* scan_handle = cache_->Lookup(scan_key);
+          if (scan_handle == nullptr) {
+            cache_->Insert(scan_key, createValue(thread->rnd),
+                           FLAGS_value_bytes, &deleter, &scan_handle);
+          }
+          if (scan_handle) {
+            result += NPHash64(static_cast<char*>(cache_->Value(scan_handle)),
+                               FLAGS_value_bytes);
+            cache_->Release(scan_handle);
+          }
+        }
       } else {
         // Should be extremely unlikely (noop)
         assert(random_op >= kHundredthUint64 * 100U);
@@ -352,6 +437,12 @@ class CacheBench {
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %u%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %u%%\n", FLAGS_erase_percent);
+    printf("Scan percentage     : %u%%\n", FLAGS_scan_percent);
+    printf("Scan length         : %u\n", FLAGS_scan_length);
+    printf("Admission filter    : %d\n", int{FLAGS_use_admission_filter});
+    printf("Deferred promotion  : %d\n", int{FLAGS_use_deferred_promotion});
+    printf("NUMA aware          : %d\n", int{FLAGS_numa_aware});
+    printf("Threads on all nodes: %d\n", int{FLAGS_bind_threads_to_numa_nodes});
     printf("----------------------------\n");
   }
 };
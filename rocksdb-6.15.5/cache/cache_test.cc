@@ -9,15 +9,18 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -38,6 +41,7 @@ static int DecodeValue(void* v) {
 }
 
 const std::string kLRU = "lru";
+const std::string kLRUDeferredPromotion = "lru_deferred_promotion";
 const std::string kClock = "clock";
 
 void dumbDeleter(const Slice& /*key*/, void* /*value*/) {}
@@ -80,6 +84,12 @@ class CacheTest : public testing::TestWithParam<std::string> {
     if (type == kLRU) {
       return NewLRUCache(capacity);
     }
+    if (type == kLRUDeferredPromotion) {
+      LRUCacheOptions co;
+      co.capacity = capacity;
+      co.use_deferred_promotion = true;
+      return NewLRUCache(co);
+    }
     if (type == kClock) {
       return NewClockCache(capacity);
     }
@@ -90,13 +100,14 @@ class CacheTest : public testing::TestWithParam<std::string> {
       size_t capacity, int num_shard_bits, bool strict_capacity_limit,
       CacheMetadataChargePolicy charge_policy = kDontChargeCacheMetadata) {
     auto type = GetParam();
-    if (type == kLRU) {
+    if (type == kLRU || type == kLRUDeferredPromotion) {
       LRUCacheOptions co;
       co.capacity = capacity;
       co.num_shard_bits = num_shard_bits;
       co.strict_capacity_limit = strict_capacity_limit;
       co.high_pri_pool_ratio = 0;
       co.metadata_charge_policy = charge_policy;
+      co.use_deferred_promotion = type == kLRUDeferredPromotion;
       return NewLRUCache(co);
     }
     if (type == kClock) {
@@ -733,6 +744,24 @@ TEST_P(CacheTest, ApplyToAllCacheEntiresTest) {
   ASSERT_TRUE(inserted == callback_state);
 }
 
+TEST_P(CacheTest, ApplyToAllCacheKeysReportsHelper) {
+  const Cache::CacheItemHelper helper{nullptr, nullptr, &dumbDeleter,
+                                      42 /* tag */};
+  ASSERT_OK(cache_->Insert("plain", EncodeValue(1), 1, &dumbDeleter));
+  ASSERT_OK(cache_->InsertWithHelper("helped", EncodeValue(2), &helper, 1));
+
+  std::map<std::string, const Cache::CacheItemHelper*> helpers;
+  cache_->ApplyToAllCacheKeys(
+      [&](const Slice& key, size_t /*charge*/, Cache::Priority /*priority*/,
+          const Cache::CacheItemHelper* entry_helper) {
+        helpers[key.ToString()] = entry_helper;
+      });
+  ASSERT_EQ(2, helpers.size());
+  ASSERT_EQ(nullptr, helpers["plain"]);
+  ASSERT_EQ(&helper, helpers["helped"]);
+  ASSERT_EQ(42, helpers["helped"]->tag);
+}
+
 TEST_P(CacheTest, DefaultShardBits) {
   // test1: set the flag to false. Insert more keys than capacity. See if they
   // all go through.
@@ -749,6 +778,68 @@ TEST_P(CacheTest, DefaultShardBits) {
   ASSERT_EQ(6, sc->GetNumShardBits());
 }
 
+TEST_P(CacheTest, ManyKeys) {
+  // A single shard, so that its hash table has to grow and to shift keys back
+  // on erase.
+  auto cache = NewCache(100000, 0, false);
+  const int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(cache, i, i + 1000);
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    Erase(cache, i);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? -1 : i + 1000, Lookup(cache, i));
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    Insert(cache, i, i + 2000);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i + (i % 2 == 0 ? 2000 : 1000), Lookup(cache, i));
+  }
+  cache->EraseUnRefEntries();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(-1, Lookup(cache, i));
+  }
+}
+
+TEST_P(CacheTest, ConcurrentLookupInsertErase) {
+  auto cache = NewCache(200, 0, false);
+  const int kNumKeys = 300;
+  const int kNumThreads = 4;
+  std::atomic<bool> stop(false);
+  std::vector<port::Thread> readers;
+  for (int t = 0; t < kNumThreads; t++) {
+    readers.emplace_back([&, t]() {
+      Random rnd(t);
+      while (!stop.load(std::memory_order_relaxed)) {
+        int key = static_cast<int>(rnd.Uniform(kNumKeys));
+        int value = Lookup(cache, key);
+        // Values are only ever inserted for their own key.
+        ASSERT_TRUE(value == -1 || value % kNumKeys == key);
+      }
+    });
+  }
+  Random rnd(301);
+  for (int i = 0; i < 20000; i++) {
+    int key = static_cast<int>(rnd.Uniform(kNumKeys));
+    if (rnd.OneIn(4)) {
+      Erase(cache, key);
+    } else {
+      // Readers may free entries too, so don't use the recording Deleter.
+      int value = key + kNumKeys * static_cast<int>(rnd.Uniform(10));
+      ASSERT_OK(cache->Insert(EncodeKey(key), EncodeValue(value), 1,
+                              &dumbDeleter));
+    }
+  }
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  ASSERT_LE(cache->GetUsage(), 200);
+}
+
 TEST_P(CacheTest, GetCharge) {
   Insert(1, 2);
   Cache::Handle* h1 = cache_->Lookup(EncodeKey(1));
@@ -761,11 +852,13 @@ TEST_P(CacheTest, GetCharge) {
 std::shared_ptr<Cache> (*new_clock_cache_func)(
     size_t, int, bool, CacheMetadataChargePolicy) = NewClockCache;
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
-                        testing::Values(kLRU, kClock));
+                        testing::Values(kLRU, kLRUDeferredPromotion, kClock));
 #else
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
+                        testing::Values(kLRU, kLRUDeferredPromotion));
 #endif  // SUPPORT_CLOCK_CACHE
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest, testing::Values(kLRU));
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest,
+                        testing::Values(kLRU, kLRUDeferredPromotion));
 
 }  // namespace ROCKSDB_NAMESPACE
 
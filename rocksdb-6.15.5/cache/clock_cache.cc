@@ -27,13 +27,8 @@ std::shared_ptr<Cache> NewClockCache(
 #include <assert.h>
 #include <atomic>
 #include <deque>
-
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+#include <memory>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 #include "port/malloc.h"
@@ -61,9 +56,9 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup. It is an open addressing
+// table (HandleTable below) that is only modified under the shard mutex and
+// read without any locking, so a cache hit takes no lock at all.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -180,6 +175,8 @@ struct CacheHandle {
   void* value;
   size_t charge;
   void (*deleter)(const Slice&, void* value);
+  // The helper the entry was inserted with, if any.
+  const Cache::CacheItemHelper* helper;
 
   // Flags and counters associated with the cache handle:
   //   lowest bit: in-cache bit
@@ -227,25 +224,154 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
+// Hash table from keys to the handles in cache, with linear probing. Lookups
+// are lock-free and may run concurrently with one writer; Insert(), Remove()
+// and Clear() have to be serialized by the caller.
+//
+// Each slot keeps the hash value next to the handle, so that probing does not
+// touch handles of other keys. A reader may see a stale handle or miss a
+// handle that is being moved by Remove(); the former is caught by checking the
+// handle once it is referenced, and the latter is as harmless as a cache miss.
+//
+// Arrays are never freed while the table is alive, since a reader may still
+// probe an array that has been replaced by a larger one. The table never
+// shrinks, so the retired arrays are smaller than the current one in total.
+class HandleTable {
+ public:
+  HandleTable() : length_bits_(kInitialLengthBits), elems_(0) {
+    arrays_.emplace_back(new Slot[size_t{1} << length_bits_]);
+    slots_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  // Calls found(handle) for handles in the table with the given hash value,
+  // until it returns true. Can be called without synchronization.
+  template <typename Found>
+  void Lookup(uint32_t hash, Found found) const {
+    // Read the length before the slots: the array is at least that long.
+    size_t mask = (size_t{1} << length_bits_.load(std::memory_order_acquire)) -
+                  1;
+    const Slot* slots = slots_.load(std::memory_order_acquire);
+    for (size_t i = hash & mask, n = 0; n <= mask; i = (i + 1) & mask, ++n) {
+      CacheHandle* handle = slots[i].handle.load(std::memory_order_acquire);
+      if (handle == nullptr) {
+        return;
+      }
+      if (slots[i].hash.load(std::memory_order_relaxed) == hash &&
+          found(handle)) {
+        return;
+      }
+    }
+  }
 
-  CacheKey() = default;
+  // Returns the handle of key in the table, or nullptr.
+  CacheHandle* Find(const Slice& key, uint32_t hash) const {
+    CacheHandle* result = nullptr;
+    Lookup(hash, [&](CacheHandle* handle) {
+      if (handle->key == key) {
+        result = handle;
+        return true;
+      }
+      return false;
+    });
+    return result;
+  }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  // REQUIRES: no handle with the same key is in the table.
+  void Insert(CacheHandle* handle) {
+    if ((elems_ + 1) * 4 > (size_t{1} << length_bits_) * 3) {
+      Grow();
+    }
+    Slot* slots = slots_.load(std::memory_order_relaxed);
+    PutInto(slots, (size_t{1} << length_bits_) - 1, handle->hash, handle);
+    ++elems_;
+  }
+
+  // Removes the handle from the table. Returns false if it wasn't there.
+  bool Remove(CacheHandle* handle) {
+    Slot* slots = slots_.load(std::memory_order_relaxed);
+    const size_t mask = (size_t{1} << length_bits_) - 1;
+    size_t i = handle->hash & mask;
+    while (true) {
+      CacheHandle* h = slots[i].handle.load(std::memory_order_relaxed);
+      if (h == nullptr) {
+        return false;
+      }
+      if (h == handle) {
+        break;
+      }
+      i = (i + 1) & mask;
+    }
+    // Shift the following handles of the probe sequence back, so that no
+    // probe sequence has a hole.
+    size_t j = i;
+    while (true) {
+      j = (j + 1) & mask;
+      CacheHandle* h = slots[j].handle.load(std::memory_order_relaxed);
+      if (h == nullptr) {
+        break;
+      }
+      uint32_t hash = slots[j].hash.load(std::memory_order_relaxed);
+      size_t home = hash & mask;
+      // Keep the handle at j if its home slot is cyclically in (i, j].
+      bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+      if (!stays) {
+        slots[i].hash.store(hash, std::memory_order_relaxed);
+        slots[i].handle.store(h, std::memory_order_release);
+        i = j;
+      }
+    }
+    slots[i].handle.store(nullptr, std::memory_order_release);
+    --elems_;
+    return true;
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+  void Clear() {
+    Slot* slots = slots_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < (size_t{1} << length_bits_); ++i) {
+      slots[i].handle.store(nullptr, std::memory_order_release);
+    }
+    elems_ = 0;
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+ private:
+  struct Slot {
+    std::atomic<uint32_t> hash{0};
+    std::atomic<CacheHandle*> handle{nullptr};
+  };
+
+  static const int kInitialLengthBits = 4;
+
+  static void PutInto(Slot* slots, size_t mask, uint32_t hash,
+                      CacheHandle* handle) {
+    size_t i = hash & mask;
+    while (slots[i].handle.load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & mask;
+    }
+    slots[i].hash.store(hash, std::memory_order_relaxed);
+    slots[i].handle.store(handle, std::memory_order_release);
+  }
+
+  void Grow() {
+    const int new_length_bits = length_bits_ + 1;
+    const size_t new_mask = (size_t{1} << new_length_bits) - 1;
+    std::unique_ptr<Slot[]> new_slots(new Slot[new_mask + 1]);
+    Slot* slots = slots_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < (size_t{1} << length_bits_); ++i) {
+      CacheHandle* h = slots[i].handle.load(std::memory_order_relaxed);
+      if (h != nullptr) {
+        PutInto(new_slots.get(), new_mask, slots[i].hash, h);
+      }
+    }
+    // Publish the slots before the length, see Lookup().
+    slots_.store(new_slots.get(), std::memory_order_release);
+    length_bits_.store(new_length_bits, std::memory_order_release);
+    arrays_.push_back(std::move(new_slots));
   }
+
+  std::atomic<Slot*> slots_;
+  std::atomic<int> length_bits_;
+  size_t elems_;
+  std::vector<std::unique_ptr<Slot[]>> arrays_;
 };
 
 struct CleanupContext {
@@ -259,9 +385,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard final : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard() override;
 
@@ -271,6 +394,10 @@ class ClockCacheShard final : public CacheShard {
   Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
                 void (*deleter)(const Slice& key, void* value),
                 Cache::Handle** handle, Cache::Priority priority) override;
+  Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                          const Cache::CacheItemHelper* helper, size_t charge,
+                          Cache::Handle** handle,
+                          Cache::Priority priority) override;
   Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
   // If the entry in in cache, increase reference count and return true.
   // Return false otherwise.
@@ -286,6 +413,11 @@ class ClockCacheShard final : public CacheShard {
   void EraseUnRefEntries() override;
   void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                               bool thread_safe) override;
+  void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Cache::Priority priority,
+                               const Cache::CacheItemHelper* helper)>&
+          callback) override;
 
  private:
   static const uint32_t kInCacheBit = 1;
@@ -341,9 +473,17 @@ class ClockCacheShard final : public CacheShard {
   CacheHandle* Insert(const Slice& key, uint32_t hash, void* value,
                       size_t change,
                       void (*deleter)(const Slice& key, void* value),
+                      const Cache::CacheItemHelper* helper,
                       bool hold_reference, CleanupContext* context,
                       bool* overwritten);
 
+  // Inserts a copy of key. helper may be nullptr.
+  Status InsertKeyCopy(const Slice& key, uint32_t hash, void* value,
+                       size_t charge,
+                       void (*deleter)(const Slice& key, void* value),
+                       const Cache::CacheItemHelper* helper,
+                       Cache::Handle** out_handle);
+
   // Guards list_, head_, and recycle_. In addition, updating table_ also has
   // to hold the mutex, to avoid the cache being in inconsistent state.
   mutable port::Mutex mutex_;
@@ -377,8 +517,8 @@ class ClockCacheShard final : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  HandleTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -422,6 +562,22 @@ void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void ClockCacheShard::ApplyToAllCacheKeys(
+    const std::function<void(const Slice& key, size_t charge,
+                             Cache::Priority priority,
+                             const Cache::CacheItemHelper* helper)>&
+        callback) {
+  MutexLock l(&mutex_);
+  for (auto& handle : list_) {
+    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
+    if (InCache(flags)) {
+      // The clock cache doesn't keep the priority of its entries.
+      callback(handle.key, handle.charge, Cache::Priority::LOW,
+               handle.helper);
+    }
+  }
+}
+
 void ClockCacheShard::RecycleHandle(CacheHandle* handle,
                                     CleanupContext* context) {
   mutex_.AssertHeld();
@@ -432,6 +588,7 @@ void ClockCacheShard::RecycleHandle(CacheHandle* handle,
   handle->key.clear();
   handle->value = nullptr;
   handle->deleter = nullptr;
+  handle->helper = nullptr;
   recycle_.push_back(handle);
   usage_.fetch_sub(total_charge, std::memory_order_relaxed);
 }
@@ -473,6 +630,9 @@ bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
   if (set_usage) {
     handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
   }
+  // Once the reference is dropped, the handle may be evicted and reused by
+  // another thread, so read its charge before.
+  size_t total_charge = handle->CalcTotalCharge(metadata_charge_policy_);
   // Use acquire-release semantics as previous operations on the cache entry
   // has to be order before reference count is decreased, and potential cleanup
   // of the entry has to be order after.
@@ -480,7 +640,6 @@ bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
   assert(CountRefs(flags) > 0);
   if (CountRefs(flags) == 1) {
     // this is the last reference.
-    size_t total_charge = handle->CalcTotalCharge(metadata_charge_policy_);
     pinned_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
     // Cleanup if it is the last reference.
     if (!InCache(flags)) {
@@ -511,8 +670,7 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
+    bool erased __attribute__((__unused__)) = table_.Remove(handle);
     assert(erased);
     RecycleHandle(handle, context);
     return true;
@@ -564,7 +722,8 @@ void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 
 CacheHandle* ClockCacheShard::Insert(
     const Slice& key, uint32_t hash, void* value, size_t charge,
-    void (*deleter)(const Slice& key, void* value), bool hold_reference,
+    void (*deleter)(const Slice& key, void* value),
+    const Cache::CacheItemHelper* helper, bool hold_reference,
     CleanupContext* context, bool* overwritten) {
   assert(overwritten != nullptr && *overwritten == false);
   size_t total_charge =
@@ -595,16 +754,18 @@ CacheHandle* ClockCacheShard::Insert(
   handle->value = value;
   handle->charge = charge;
   handle->deleter = deleter;
+  handle->helper = helper;
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
+  // Use release semantics, so that a lookup referencing the handle sees the
+  // fields above.
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = table_.Find(key, hash);
+  if (existing_handle != nullptr) {
     *overwritten = true;
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
+    table_.Remove(existing_handle);
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
+  table_.Insert(handle);
   if (hold_reference) {
     pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
   }
@@ -617,14 +778,31 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                void (*deleter)(const Slice& key, void* value),
                                Cache::Handle** out_handle,
                                Cache::Priority /*priority*/) {
+  return InsertKeyCopy(key, hash, value, charge, deleter, nullptr, out_handle);
+}
+
+Status ClockCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                         void* value,
+                                         const Cache::CacheItemHelper* helper,
+                                         size_t charge,
+                                         Cache::Handle** out_handle,
+                                         Cache::Priority /*priority*/) {
+  return InsertKeyCopy(key, hash, value, charge, helper->del_cb, helper,
+                       out_handle);
+}
+
+Status ClockCacheShard::InsertKeyCopy(
+    const Slice& key, uint32_t hash, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value),
+    const Cache::CacheItemHelper* helper, Cache::Handle** out_handle) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
   bool overwritten = false;
-  CacheHandle* handle = Insert(key_copy, hash, value, charge, deleter,
-                               out_handle != nullptr, &context, &overwritten);
+  CacheHandle* handle =
+      Insert(key_copy, hash, value, charge, deleter, helper,
+             out_handle != nullptr, &context, &overwritten);
   Status s;
   if (out_handle != nullptr) {
     if (handle == nullptr) {
@@ -642,28 +820,28 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
-  }
-  return reinterpret_cast<Cache::Handle*>(handle);
+  CacheHandle* result = nullptr;
+  table_.Lookup(hash, [&](CacheHandle* handle) {
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
+      return false;
+    }
+    // The key of a handle can only be read once it is referenced. Check the
+    // hash again since the handle may now representing another key if other
+    // threads sneak in, evict/erase the entry and re-used the handle for
+    // another cache entry.
+    if (hash != handle->hash || key != handle->key) {
+      CleanupContext context;
+      Unref(handle, false, &context);
+      // It is possible Unref() delete the entry, so we need to cleanup.
+      Cleanup(context);
+      return false;
+    }
+    result = handle;
+    return true;
+  });
+  return reinterpret_cast<Cache::Handle*>(result);
 }
 
 bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
@@ -686,11 +864,10 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = table_.Find(key, hash);
+  if (handle != nullptr) {
+    table_.Remove(handle);
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -700,7 +877,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
@@ -0,0 +1,151 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/secondary_cache.h"
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// A value as stored in the cache.
+struct CompressedValue {
+  // kNoCompression if the value didn't compress.
+  CompressionType compression_type;
+  std::string data;
+};
+
+void DeleteCompressedValue(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<CompressedValue*>(value);
+}
+
+// Values are compressed with format version 2, which stores the
+// uncompressed size along with the compressed data.
+const uint32_t kCompressFormatVersion = 2;
+
+class CompressedSecondaryCache : public SecondaryCache {
+ public:
+  CompressedSecondaryCache(std::shared_ptr<Cache> cache,
+                           CompressionType compression_type)
+      : cache_(std::move(cache)), compression_type_(compression_type) {}
+
+  const char* Name() const override { return "CompressedSecondaryCache"; }
+
+  Status Insert(const Slice& key, const Slice& value) override {
+    std::unique_ptr<CompressedValue> compressed(new CompressedValue());
+    compressed->compression_type = kNoCompression;
+    if (compression_type_ != kNoCompression) {
+      CompressionOptions opts;
+      CompressionContext context(compression_type_);
+      CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
+                           compression_type_,
+                           0 /* sample_for_compression */);
+      if (CompressData(value, info, kCompressFormatVersion,
+                       &compressed->data) &&
+          compressed->data.size() < value.size()) {
+        compressed->compression_type = compression_type_;
+      }
+    }
+    if (compressed->compression_type == kNoCompression) {
+      compressed->data.assign(value.data(), value.size());
+    }
+    size_t charge = compressed->data.size();
+    Status s = cache_->Insert(key, compressed.get(), charge,
+                              &DeleteCompressedValue);
+    if (s.ok()) {
+      compressed.release();
+    }
+    return s;
+  }
+
+  bool Lookup(const Slice& key, std::string* value) override {
+    Cache::Handle* handle = cache_->Lookup(key);
+    if (handle == nullptr) {
+      return false;
+    }
+    const CompressedValue* compressed =
+        reinterpret_cast<const CompressedValue*>(cache_->Value(handle));
+    bool found = true;
+    if (compressed->compression_type == kNoCompression) {
+      value->assign(compressed->data);
+    } else {
+      UncompressionContext context(compressed->compression_type);
+      UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                             compressed->compression_type);
+      size_t uncompressed_size = 0;
+      CacheAllocationPtr uncompressed = UncompressData(
+          info, compressed->data.data(), compressed->data.size(),
+          &uncompressed_size, kCompressFormatVersion);
+      if (uncompressed) {
+        value->assign(uncompressed.get(), uncompressed_size);
+      } else {
+        found = false;
+      }
+    }
+    cache_->Release(handle);
+    return found;
+  }
+
+  void Erase(const Slice& key) override { cache_->Erase(key); }
+
+  std::string GetPrintableOptions() const override {
+    std::string ret;
+    ret.append("    compressed_secondary_cache_options:\n");
+    ret.append("      compression_type : ");
+    ret.append(CompressionTypeToString(compression_type_));
+    ret.append("\n");
+    ret.append(cache_->GetPrintableOptions());
+    return ret;
+  }
+
+ private:
+  std::shared_ptr<Cache> cache_;
+  const CompressionType compression_type_;
+};
+
+}  // namespace
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  if (opts.compression_type != kNoCompression &&
+      !CompressionTypeSupported(opts.compression_type)) {
+    return nullptr;
+  }
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(opts.capacity, opts.num_shard_bits,
+                  false /* strict_capacity_limit */,
+                  0.0 /* high_pri_pool_ratio */);
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<CompressedSecondaryCache>(std::move(cache),
+                                                    opts.compression_type);
+}
+
+std::shared_ptr<Cache> NewTieredCache(const LRUCacheOptions& cache_opts,
+                                      double compressed_secondary_ratio,
+                                      CompressionType compression_type) {
+  if (compressed_secondary_ratio < 0.0 || compressed_secondary_ratio > 1.0) {
+    return nullptr;
+  }
+  size_t secondary_capacity =
+      static_cast<size_t>(cache_opts.capacity * compressed_secondary_ratio);
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
+          secondary_capacity, cache_opts.num_shard_bits, compression_type));
+  if (secondary_cache == nullptr) {
+    return nullptr;
+  }
+  LRUCacheOptions primary_opts = cache_opts;
+  primary_opts.capacity = cache_opts.capacity - secondary_capacity;
+  primary_opts.secondary_cache = std::move(secondary_cache);
+  return NewLRUCache(primary_opts);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
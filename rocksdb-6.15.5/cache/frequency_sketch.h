@@ -0,0 +1,99 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// FrequencySketch estimates how often a hash has been seen recently. It is a
+// count-min sketch of 4-bit counters, four counters (one per row) for each
+// hash, packed into 64-bit words. To let the estimates follow a changing
+// workload, all counters are halved once the number of increments reaches
+// ten times the number of words ("aging").
+//
+// This class is not thread-safe.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t expected_entries = 0) {
+    Reset(expected_entries);
+  }
+
+  // Drops all counts, and sizes the sketch for about `expected_entries`
+  // distinct hashes.
+  void Reset(size_t expected_entries) {
+    size_t num_words = 16;
+    while (num_words < expected_entries) {
+      num_words *= 2;
+    }
+    table_.assign(num_words, 0);
+    mask_ = num_words - 1;
+    sample_size_ = 10 * num_words;
+    additions_ = 0;
+  }
+
+  size_t NumWords() const { return table_.size(); }
+
+  void Increment(uint32_t hash) {
+    bool added = false;
+    for (int i = 0; i < 4; i++) {
+      int shift;
+      uint64_t& word = table_[IndexOf(hash, i, &shift)];
+      if (((word >> shift) & 0xf) != 0xf) {
+        word += uint64_t{1} << shift;
+        added = true;
+      }
+    }
+    if (added && ++additions_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  // Returns the estimated number of recent occurrences of `hash`, between 0
+  // and 15.
+  uint32_t Estimate(uint32_t hash) const {
+    uint32_t result = 0xf;
+    for (int i = 0; i < 4; i++) {
+      int shift;
+      uint64_t word = table_[IndexOf(hash, i, &shift)];
+      uint32_t count = static_cast<uint32_t>((word >> shift) & 0xf);
+      if (count < result) {
+        result = count;
+      }
+    }
+    return result;
+  }
+
+ private:
+  // Returns the word holding the counter of `hash` in row `i`, and stores the
+  // bit offset of the counter in the word in *shift.
+  size_t IndexOf(uint32_t hash, int i, int* shift) const {
+    static const uint64_t kSeeds[4] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+        0xcbf29ce484222325ULL};
+    uint64_t h = (static_cast<uint64_t>(hash) + kSeeds[i]) * kSeeds[i];
+    h ^= h >> 32;
+    *shift = static_cast<int>(h & 0xf) << 2;
+    return static_cast<size_t>(h >> 4) & mask_;
+  }
+
+  void Age() {
+    for (auto& word : table_) {
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    additions_ /= 2;
+  }
+
+  std::vector<uint64_t> table_;
+  size_t mask_;
+  size_t sample_size_;
+  size_t additions_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -9,14 +9,49 @@
 
 #include "cache/lru_cache.h"
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
 #include <assert.h>
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 
+#include "monitoring/statistics.h"
+#include "rocksdb/env.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// The frequency sketch of a shard is sized for capacity / this many entries,
+// the default block size of block based tables.
+const size_t kAdmissionSketchEntryCharge = 4096;
+
+// Holds `mu` exclusively, unless it is nullptr.
+class OptionalWriteLock {
+ public:
+  explicit OptionalWriteLock(port::RWMutex* mu) : mu_(mu) {
+    if (mu_ != nullptr) {
+      mu_->WriteLock();
+    }
+  }
+  // No copying allowed
+  OptionalWriteLock(const OptionalWriteLock&) = delete;
+  void operator=(const OptionalWriteLock&) = delete;
+
+  ~OptionalWriteLock() {
+    if (mu_ != nullptr) {
+      mu_->WriteUnlock();
+    }
+  }
+
+ private:
+  port::RWMutex* const mu_;
+};
+}  // namespace
+
 LRUHandleTable::LRUHandleTable() : list_(nullptr), length_(0), elems_(0) {
   Resize();
 }
@@ -97,14 +132,25 @@ void LRUHandleTable::Resize() {
 LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              double high_pri_pool_ratio,
                              bool use_adaptive_mutex,
-                             CacheMetadataChargePolicy metadata_charge_policy)
+                             CacheMetadataChargePolicy metadata_charge_policy,
+                             bool use_admission_filter,
+                             bool use_deferred_promotion,
+                             std::shared_ptr<SecondaryCache> secondary_cache,
+                             bool collect_stats)
     : capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      use_admission_filter_(use_admission_filter),
+      use_deferred_promotion_(use_deferred_promotion),
+      secondary_cache_(std::move(secondary_cache)),
+      counters_(collect_stats ? new CoreLocalArray<LRUCacheShardCounters>()
+                              : nullptr),
       usage_(0),
       lru_usage_(0),
+      admitted_inserts_(0),
+      rejected_inserts_(0),
       mutex_(use_adaptive_mutex) {
   set_metadata_charge_policy(metadata_charge_policy);
   // Make empty circular linked list
@@ -118,10 +164,17 @@ void LRUCacheShard::EraseUnRefEntries() {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
-    while (lru_.next != &lru_) {
-      LRUHandle* old = lru_.next;
-      // LRU list contains only elements which can be evicted
-      assert(old->InCache() && !old->HasRefs());
+    OptionalWriteLock tl(use_deferred_promotion_ ? &table_mutex_ : nullptr);
+    LRUHandle* next = lru_.next;
+    while (next != &lru_) {
+      LRUHandle* old = next;
+      next = old->next;
+      if (old->HasRefs()) {
+        // Only with deferred promotion, LRU list contains referenced elements
+        assert(use_deferred_promotion_);
+        continue;
+      }
+      assert(old->InCache());
       LRU_Remove(old);
       table_.Remove(old->key(), old->hash);
       old->SetInCache(false);
@@ -152,6 +205,19 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void LRUCacheShard::ApplyToAllCacheKeys(
+    const std::function<void(const Slice& key, size_t charge,
+                             Cache::Priority priority,
+                             const Cache::CacheItemHelper* helper)>&
+        callback) {
+  MutexLock l(&mutex_);
+  table_.ApplyToAllCacheEntries([&callback](LRUHandle* h) {
+    callback(h->key(), h->charge,
+             h->IsHighPri() ? Cache::Priority::HIGH : Cache::Priority::LOW,
+             h->IsSecondaryCacheCompatible() ? h->helper : nullptr);
+  });
+}
+
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri) {
   MutexLock l(&mutex_);
   *lru = &lru_;
@@ -233,8 +299,25 @@ void LRUCacheShard::MaintainPoolSize() {
 
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
+  size_t max_moves =
+      use_deferred_promotion_ ? 2 * size_t{table_.GetOccupancyCount()} : 0;
   while ((usage_ + charge) > capacity_ && lru_.next != &lru_) {
     LRUHandle* old = lru_.next;
+    if (use_deferred_promotion_ &&
+        (old->HasRefs() || old->touched.load(std::memory_order_relaxed))) {
+      if (max_moves == 0) {
+        break;
+      }
+      max_moves--;
+      // Apply the deferred promotion of a touched entry, and skip referenced
+      // ones.
+      LRU_Remove(old);
+      if (old->touched.exchange(false, std::memory_order_relaxed)) {
+        old->SetHit();
+      }
+      LRU_Insert(old);
+      continue;
+    }
     // LRU list contains only elements which can be evicted
     assert(old->InCache() && !old->HasRefs());
     LRU_Remove(old);
@@ -244,31 +327,103 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
     assert(usage_ >= old_total_charge);
     usage_ -= old_total_charge;
     deleted->push_back(old);
+    Count(&LRUCacheShardCounters::evictions);
   }
 }
 
+bool LRUCacheShard::Admit(const Slice& key, uint32_t hash, size_t charge) {
+  if (!use_admission_filter_ || (usage_ + charge) <= capacity_ ||
+      lru_.next == &lru_) {
+    return true;
+  }
+  if (table_.Lookup(key, hash) != nullptr) {
+    // Overwriting an entry is always admitted.
+    return true;
+  }
+  // Compare with the entry EvictFromLRU() would evict first. Ties are
+  // rejected, so that entries seen once, e.g. by a scan, don't replace each
+  // other.
+  if (sketch_.Estimate(hash) > sketch_.Estimate(lru_.next->hash)) {
+    admitted_inserts_++;
+    return true;
+  }
+  rejected_inserts_++;
+  return false;
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
+    OptionalWriteLock tl(use_deferred_promotion_ ? &table_mutex_ : nullptr);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    if (use_admission_filter_) {
+      size_t expected_entries = capacity_ / kAdmissionSketchEntryCharge;
+      if (sketch_.NumWords() < expected_entries ||
+          sketch_.NumWords() / 2 >= expected_entries) {
+        sketch_.Reset(expected_entries);
+      }
+    }
     EvictFromLRU(0, &last_reference_list);
   }
 
   // Free the entries outside of mutex for performance reasons
   for (auto entry : last_reference_list) {
-    entry->Free();
+    DemoteAndFree(entry);
   }
 }
 
+void LRUCacheShard::DemoteAndFree(LRUHandle* e) {
+  if (secondary_cache_ != nullptr && e->IsSecondaryCacheCompatible() &&
+      e->helper->size_cb != nullptr) {
+    std::string buf;
+    buf.resize((*e->helper->size_cb)(e->value));
+    Status s = (*e->helper->saveto_cb)(e->value, buf.size(), &buf[0]);
+    if (s.ok()) {
+      s = secondary_cache_->Insert(e->key(), buf);
+    }
+    // The entry is dropped if it can't be saved, like without a secondary
+    // cache.
+    s.PermitUncheckedError();
+  }
+  e->Free();
+}
+
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
   MutexLock l(&mutex_);
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  MutexLock l(&mutex_);
+  if (use_deferred_promotion_) {
+    LRUHandle* e;
+    {
+      ReadLock rl(&table_mutex_);
+      e = table_.Lookup(key, hash);
+      if (e != nullptr) {
+        assert(e->InCache());
+        if (e->refs.fetch_add(1, std::memory_order_relaxed) == 0) {
+          pinned_usage_.fetch_add(e->CalcTotalCharge(metadata_charge_policy_),
+                                  std::memory_order_relaxed);
+        }
+        if (!e->touched.load(std::memory_order_relaxed)) {
+          e->touched.store(true, std::memory_order_relaxed);
+        }
+      }
+    }
+    if (use_admission_filter_) {
+      StatsMutexLock l(this);
+      sketch_.Increment(hash);
+    }
+    CountLookup(e != nullptr);
+    return reinterpret_cast<Cache::Handle*>(e);
+  }
+
+  StatsMutexLock l(this);
+  if (use_admission_filter_) {
+    sketch_.Increment(hash);
+  }
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -279,11 +434,50 @@ Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
     e->Ref();
     e->SetHit();
   }
+  CountLookup(e != nullptr);
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+Cache::Handle* LRUCacheShard::LookupWithHelper(
+    const Slice& key, uint32_t hash, const Cache::CacheItemHelper* helper,
+    const Cache::CreateCallback& create_cb, Cache::Priority priority,
+    Statistics* stats) {
+  Cache::Handle* handle = Lookup(key, hash);
+  if (handle != nullptr || secondary_cache_ == nullptr ||
+      helper->size_cb == nullptr || !create_cb) {
+    return handle;
+  }
+
+  std::string buf;
+  if (!secondary_cache_->Lookup(key, &buf)) {
+    RecordTick(stats, SECONDARY_CACHE_MISSES);
+    return nullptr;
+  }
+  RecordTick(stats, SECONDARY_CACHE_HITS);
+  void* value = nullptr;
+  size_t charge = 0;
+  Status s = create_cb(buf.data(), buf.size(), &value, &charge);
+  if (s.ok()) {
+    s = InsertWithHelper(key, hash, value, helper, charge, &handle, priority);
+    if (!s.ok()) {
+      (*helper->del_cb)(key, value);
+    }
+  }
+  if (!s.ok()) {
+    return nullptr;
+  }
+  // The entry moved back to this cache
+  secondary_cache_->Erase(key);
+  return handle;
+}
+
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* e = reinterpret_cast<LRUHandle*>(h);
+  if (use_deferred_promotion_) {
+    assert(e->HasRefs());
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
   MutexLock l(&mutex_);
   // To create another reference - entry must be already externally referenced
   assert(e->HasRefs());
@@ -304,9 +498,43 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
+  if (use_deferred_promotion_ && !force_erase) {
+    // The entry stays on the LRU list while referenced, so only an entry
+    // removed from the cache needs the mutex, to be freed.
+    uint32_t old_refs = e->refs.fetch_sub(1, std::memory_order_acq_rel);
+    assert((old_refs & ~LRUHandle::kDetachedRef) > 0);
+    size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
+    if ((old_refs & ~LRUHandle::kDetachedRef) == 1) {
+      pinned_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+    }
+    if (old_refs != (LRUHandle::kDetachedRef | 1)) {
+      return false;
+    }
+    {
+      StatsMutexLock l(this);
+      assert(usage_ >= total_charge);
+      usage_ -= total_charge;
+    }
+    e->Free();
+    return true;
+  }
   {
-    MutexLock l(&mutex_);
-    last_reference = e->Unref();
+    StatsMutexLock l(this);
+    OptionalWriteLock tl(use_deferred_promotion_ ? &table_mutex_ : nullptr);
+    if (use_deferred_promotion_) {
+      uint32_t old_refs = e->refs.fetch_sub(1, std::memory_order_acq_rel);
+      last_reference = (old_refs & ~LRUHandle::kDetachedRef) == 1;
+      if (last_reference) {
+        pinned_usage_.fetch_sub(e->CalcTotalCharge(metadata_charge_policy_),
+                                std::memory_order_relaxed);
+        if (e->InCache()) {
+          LRU_Remove(e);
+        }
+      }
+    } else {
+      last_reference = e->Unref();
+    }
     if (last_reference && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it
       if (usage_ > capacity_ || force_erase) {
@@ -315,6 +543,10 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
         // Take this opportunity and remove the item
         table_.Remove(e->key(), e->hash);
         e->SetInCache(false);
+        evicted = !force_erase;
+        if (evicted) {
+          Count(&LRUCacheShardCounters::evictions);
+        }
       } else {
         // Put the item back on the LRU list, and don't free it
         LRU_Insert(e);
@@ -329,7 +561,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
 
   // Free the entry here outside of mutex for performance reasons
-  if (last_reference) {
+  if (evicted) {
+    DemoteAndFree(e);
+  } else if (last_reference) {
     e->Free();
   }
   return last_reference;
@@ -339,6 +573,22 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return Insert(key, hash, value, charge, deleter, nullptr, handle, priority);
+}
+
+Status LRUCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                       void* value,
+                                       const Cache::CacheItemHelper* helper,
+                                       size_t charge, Cache::Handle** handle,
+                                       Cache::Priority priority) {
+  return Insert(key, hash, value, charge, nullptr, helper, handle, priority);
+}
+
+Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                             size_t charge,
+                             void (*deleter)(const Slice& key, void* value),
+                             const Cache::CacheItemHelper* helper,
+                             Cache::Handle** handle, Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -346,14 +596,21 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s = Status::OK();
   autovector<LRUHandle*> last_reference_list;
+  autovector<LRUHandle*> evicted_list;
 
   e->value = value;
-  e->deleter = deleter;
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
+  if (helper != nullptr) {
+    e->helper = helper;
+    e->SetSecondaryCacheCompatible(true);
+  } else {
+    e->deleter = deleter;
+  }
   e->hash = hash;
-  e->refs = 0;
+  e->refs.store(0, std::memory_order_relaxed);
+  e->touched.store(false, std::memory_order_relaxed);
   e->next = e->prev = nullptr;
   e->SetInCache(true);
   e->SetPriority(priority);
@@ -361,14 +618,35 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
 
   {
-    MutexLock l(&mutex_);
+    StatsMutexLock l(this);
+    OptionalWriteLock tl(use_deferred_promotion_ ? &table_mutex_ : nullptr);
+
+    bool admitted = Admit(key, hash, total_charge);
 
     // Free the space following strict LRU policy until enough space
     // is freed or the lru list is empty
-    EvictFromLRU(total_charge, &last_reference_list);
+    if (admitted) {
+      EvictFromLRU(total_charge, &evicted_list);
+    }
 
-    if ((usage_ + total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted) {
+      // Behave as if the entry was inserted and evicted right away. A caller
+      // asking for a handle gets one to an entry that is not in the cache,
+      // and is freed on release.
+      e->SetInCache(false);
+      if (handle == nullptr) {
+        last_reference_list.push_back(e);
+      } else {
+        usage_ += total_charge;
+        e->Ref();
+        if (use_deferred_promotion_) {
+          e->refs.fetch_or(LRUHandle::kDetachedRef, std::memory_order_relaxed);
+          pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
+        }
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+    } else if ((usage_ + total_charge) > capacity_ &&
+               (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
@@ -384,13 +662,24 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       // capacity if not enough space was freed up.
       LRUHandle* old = table_.Insert(e);
       usage_ += total_charge;
+      Count(&LRUCacheShardCounters::inserts);
       if (old != nullptr) {
         s = Status::OkOverwritten();
         assert(old->InCache());
         old->SetInCache(false);
-        if (!old->HasRefs()) {
-          // old is on LRU because it's in cache and its reference count is 0
+        bool old_last_reference;
+        if (use_deferred_promotion_) {
+          // old is on LRU because it's in cache
           LRU_Remove(old);
+          old_last_reference = old->Detach();
+        } else {
+          old_last_reference = !old->HasRefs();
+          if (old_last_reference) {
+            // old is on LRU because it's in cache and its reference count is 0
+            LRU_Remove(old);
+          }
+        }
+        if (old_last_reference) {
           size_t old_total_charge =
               old->CalcTotalCharge(metadata_charge_policy_);
           assert(usage_ >= old_total_charge);
@@ -401,6 +690,10 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       if (handle == nullptr) {
         LRU_Insert(e);
       } else {
+        if (use_deferred_promotion_) {
+          LRU_Insert(e);
+          pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
+        }
         e->Ref();
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
@@ -411,6 +704,9 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   for (auto entry : last_reference_list) {
     entry->Free();
   }
+  for (auto entry : evicted_list) {
+    DemoteAndFree(entry);
+  }
 
   return s;
 }
@@ -419,18 +715,25 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   LRUHandle* e;
   bool last_reference = false;
   {
-    MutexLock l(&mutex_);
+    StatsMutexLock l(this);
+    OptionalWriteLock tl(use_deferred_promotion_ ? &table_mutex_ : nullptr);
     e = table_.Remove(key, hash);
     if (e != nullptr) {
       assert(e->InCache());
       e->SetInCache(false);
-      if (!e->HasRefs()) {
+      if (use_deferred_promotion_) {
+        // The entry is in LRU since it's in hash
+        LRU_Remove(e);
+        last_reference = e->Detach();
+      } else if (!e->HasRefs()) {
         // The entry is in LRU since it's in hash and has no external references
         LRU_Remove(e);
+        last_reference = true;
+      }
+      if (last_reference) {
         size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
         assert(usage_ >= total_charge);
         usage_ -= total_charge;
-        last_reference = true;
       }
     }
   }
@@ -440,6 +743,41 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   if (last_reference) {
     e->Free();
   }
+
+  if (secondary_cache_ != nullptr) {
+    secondary_cache_->Erase(key);
+  }
+}
+
+LRUCacheShard::StatsMutexLock::StatsMutexLock(LRUCacheShard* shard)
+    : shard_(shard) {
+  if (shard_->counters_ == nullptr) {
+    shard_->mutex_.Lock();
+  } else if (!shard_->mutex_.TryLock()) {
+    Env* env = Env::Default();
+    uint64_t start = env->NowNanos();
+    shard_->mutex_.Lock();
+    shard_->Count(&LRUCacheShardCounters::mutex_wait_nanos,
+                  env->NowNanos() - start);
+  }
+}
+
+bool LRUCacheShard::GetStats(Cache::ShardStats* stats) const {
+  if (counters_ == nullptr) {
+    return false;
+  }
+  for (size_t core = 0; core < counters_->Size(); core++) {
+    const LRUCacheShardCounters* counters = counters_->AccessAtCore(core);
+    stats->lookups += counters->lookups.load(std::memory_order_relaxed);
+    stats->hits += counters->hits.load(std::memory_order_relaxed);
+    stats->inserts += counters->inserts.load(std::memory_order_relaxed);
+    stats->evictions += counters->evictions.load(std::memory_order_relaxed);
+    stats->mutex_wait_nanos +=
+        counters->mutex_wait_nanos.load(std::memory_order_relaxed);
+  }
+  stats->usage = GetUsage();
+  stats->pinned_usage = GetPinnedUsage();
+  return true;
 }
 
 size_t LRUCacheShard::GetUsage() const {
@@ -448,37 +786,99 @@ size_t LRUCacheShard::GetUsage() const {
 }
 
 size_t LRUCacheShard::GetPinnedUsage() const {
+  if (use_deferred_promotion_) {
+    return pinned_usage_.load(std::memory_order_relaxed);
+  }
   MutexLock l(&mutex_);
   assert(usage_ >= lru_usage_);
   return usage_ - lru_usage_;
 }
 
+uint64_t LRUCacheShard::GetAdmittedInserts() const {
+  MutexLock l(&mutex_);
+  return admitted_inserts_;
+}
+
+uint64_t LRUCacheShard::GetRejectedInserts() const {
+  MutexLock l(&mutex_);
+  return rejected_inserts_;
+}
+
 std::string LRUCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    use_admission_filter: %d\n"
+             "    use_deferred_promotion: %d\n",
+             high_pri_pool_ratio_, use_admission_filter_,
+             use_deferred_promotion_);
   }
-  return std::string(buffer);
+  std::string ret(buffer);
+  snprintf(buffer, kBufferSize, "    secondary_cache : %s\n",
+           secondary_cache_ ? secondary_cache_->Name() : "None");
+  ret.append(buffer);
+  if (secondary_cache_) {
+    ret.append(secondary_cache_->GetPrintableOptions());
+  }
+  return ret;
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit, double high_pri_pool_ratio,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
-                   CacheMetadataChargePolicy metadata_charge_policy)
+                   CacheMetadataChargePolicy metadata_charge_policy,
+                   bool use_admission_filter, bool use_deferred_promotion,
+                   std::shared_ptr<SecondaryCache> secondary_cache,
+                   std::vector<int> cpu_shard_sets,
+                   bool replicate_high_pri_entries, bool collect_shard_stats)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
-                   std::move(allocator)) {
-  num_shards_ = 1 << num_shard_bits;
-  shards_ = reinterpret_cast<LRUCacheShard*>(
-      port::cacheline_aligned_alloc(sizeof(LRUCacheShard) * num_shards_));
+                   std::move(allocator), std::move(cpu_shard_sets),
+                   replicate_high_pri_entries) {
+  num_shards_ = GetNumShards();
+  const size_t shards_size = sizeof(LRUCacheShard) * num_shards_;
+#ifdef NUMA
+  const int num_shard_sets = GetNumShardSets();
+  if (num_shard_sets > 1 && numa_available() >= 0 &&
+      num_shard_sets <= numa_max_node() + 1) {
+    // Shard set i serves the CPUs of node i. Bind the pages holding the
+    // shards of each set to its node before the shards are constructed, so
+    // that their mutexes and LRU lists are local to the threads using them.
+    // Each page goes to the set owning its first byte. Entries and grown
+    // hash tables are allocated by the inserting threads, which run on the
+    // node of the set.
+    char* mem = static_cast<char*>(numa_alloc(shards_size));
+    if (mem != nullptr) {
+      const size_t page_size = static_cast<size_t>(numa_pagesize());
+      const size_t set_size = shards_size / num_shard_sets;
+      for (int set = 0; set < num_shard_sets; set++) {
+        size_t begin = (set * set_size + page_size - 1) / page_size * page_size;
+        size_t end = std::min(
+            shards_size,
+            ((set + 1) * set_size + page_size - 1) / page_size * page_size);
+        if (begin < end) {
+          numa_tonode_memory(mem + begin, end - begin, set);
+        }
+      }
+      shards_ = reinterpret_cast<LRUCacheShard*>(mem);
+      numa_alloc_size_ = shards_size;
+    }
+  }
+#endif
+  if (shards_ == nullptr) {
+    shards_ = reinterpret_cast<LRUCacheShard*>(
+        port::cacheline_aligned_alloc(shards_size));
+  }
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
         LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio,
-                      use_adaptive_mutex, metadata_charge_policy);
+                      use_adaptive_mutex, metadata_charge_policy,
+                      use_admission_filter, use_deferred_promotion,
+                      secondary_cache, collect_shard_stats);
   }
 }
 
@@ -488,7 +888,13 @@ LRUCache::~LRUCache() {
     for (int i = 0; i < num_shards_; i++) {
       shards_[i].~LRUCacheShard();
     }
-    port::cacheline_aligned_free(shards_);
+    if (numa_alloc_size_ > 0) {
+#ifdef NUMA
+      numa_free(shards_, numa_alloc_size_);
+#endif
+    } else {
+      port::cacheline_aligned_free(shards_);
+    }
   }
 }
 
@@ -543,32 +949,55 @@ double LRUCache::GetHighPriPoolRatio() {
   return result;
 }
 
-std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio,
-                     cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
-                     cache_opts.metadata_charge_policy);
+uint64_t LRUCache::GetAdmittedInserts() const {
+  uint64_t admitted_inserts = 0;
+  for (int i = 0; i < num_shards_; i++) {
+    admitted_inserts += shards_[i].GetAdmittedInserts();
+  }
+  return admitted_inserts;
 }
 
-std::shared_ptr<Cache> NewLRUCache(
-    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    double high_pri_pool_ratio,
-    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
-    CacheMetadataChargePolicy metadata_charge_policy) {
-  if (num_shard_bits >= 20) {
+uint64_t LRUCache::GetRejectedInserts() const {
+  uint64_t rejected_inserts = 0;
+  for (int i = 0; i < num_shards_; i++) {
+    rejected_inserts += shards_[i].GetRejectedInserts();
+  }
+  return rejected_inserts;
+}
+
+std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
+  if (cache_opts.num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
+  int num_shard_bits = cache_opts.num_shard_bits;
   if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+    num_shard_bits = GetDefaultCacheShardBits(cache_opts.capacity);
   }
   return std::make_shared<LRUCache>(
+      cache_opts.capacity, num_shard_bits, cache_opts.strict_capacity_limit,
+      cache_opts.high_pri_pool_ratio, cache_opts.memory_allocator,
+      cache_opts.use_adaptive_mutex, cache_opts.metadata_charge_policy,
+      cache_opts.use_admission_filter, cache_opts.use_deferred_promotion,
+      cache_opts.secondary_cache,
+      cache_opts.numa_aware ? GetCpuNumaNodes() : std::vector<int>(),
+      cache_opts.numa_replicate_high_pri_entries,
+      cache_opts.collect_shard_stats);
+}
+
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  return NewLRUCache(LRUCacheOptions(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
-      std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy);
+      std::move(memory_allocator), use_adaptive_mutex,
+      metadata_charge_policy));
 }
 
 }  // namespace ROCKSDB_NAMESPACE
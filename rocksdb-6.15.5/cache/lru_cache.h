@@ -8,13 +8,17 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <atomic>
 #include <string>
 
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 
 #include "port/malloc.h"
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
+#include "util/core_local.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -46,10 +50,24 @@ namespace ROCKSDB_NAMESPACE {
 // that any successful LRUCacheShard::Lookup/LRUCacheShard::Insert have a
 // matching LRUCache::Release (to move into state 2) or LRUCacheShard::Erase
 // (to move into state 3).
+//
+// With deferred promotion, entries in states 1 and 2 are both in the LRU
+// list, lookups only add a reference and mark the entry as touched, and a
+// touched entry is moved to the head of the LRU list when it reaches the
+// tail. An entry moving to state 3 while referenced gets kDetachedRef set in
+// refs, so that the Release that drops its last reference frees it.
+//
+// With a secondary cache, entries inserted with a CacheItemHelper that can
+// save them are copied to the secondary cache when they are evicted, and
+// a lookup that misses the cache looks for them there.
 
 struct LRUHandle {
   void* value;
-  void (*deleter)(const Slice&, void* value);
+  union {
+    void (*deleter)(const Slice&, void* value);
+    // Only if IsSecondaryCacheCompatible()
+    const Cache::CacheItemHelper* helper;
+  };
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -58,7 +76,12 @@ struct LRUHandle {
   // The hash of key(). Used for fast sharding and comparisons.
   uint32_t hash;
   // The number of external refs to this entry. The cache itself is not counted.
-  uint32_t refs;
+  std::atomic<uint32_t> refs;
+  // Whether the entry was looked up since it was last moved in the LRU list.
+  // Only used with deferred promotion.
+  std::atomic<bool> touched;
+
+  static constexpr uint32_t kDetachedRef = uint32_t{1} << 31;
 
   enum Flags : uint8_t {
     // Whether this entry is referenced by the hash table.
@@ -69,6 +92,8 @@ struct LRUHandle {
     IN_HIGH_PRI_POOL = (1 << 2),
     // Wwhether this entry has had any lookups (hits).
     HAS_HIT = (1 << 3),
+    // Whether helper, rather than deleter, is set.
+    IS_SECONDARY_CACHE_COMPATIBLE = (1 << 4),
   };
 
   uint8_t flags;
@@ -78,23 +103,41 @@ struct LRUHandle {
 
   Slice key() const { return Slice(key_data, key_length); }
 
-  // Increase the reference count by 1.
-  void Ref() { refs++; }
+  // Increase the reference count by 1. Without deferred promotion, refs is
+  // only changed with the shard mutex held.
+  void Ref() {
+    refs.store(refs.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  }
 
   // Just reduce the reference count by 1. Return true if it was last reference.
   bool Unref() {
-    assert(refs > 0);
-    refs--;
-    return refs == 0;
+    uint32_t old_refs = refs.load(std::memory_order_relaxed);
+    assert(old_refs > 0);
+    refs.store(old_refs - 1, std::memory_order_relaxed);
+    return old_refs == 1;
   }
 
   // Return true if there are external refs, false otherwise.
-  bool HasRefs() const { return refs > 0; }
+  bool HasRefs() const {
+    return (refs.load(std::memory_order_relaxed) & ~kDetachedRef) > 0;
+  }
+
+  // With deferred promotion, marks an entry that was just removed from the
+  // cache. Returns true if it has no refs left and must be freed by the
+  // caller.
+  bool Detach() {
+    return (refs.fetch_or(kDetachedRef, std::memory_order_acq_rel) &
+            ~kDetachedRef) == 0;
+  }
 
   bool InCache() const { return flags & IN_CACHE; }
   bool IsHighPri() const { return flags & IS_HIGH_PRI; }
   bool InHighPriPool() const { return flags & IN_HIGH_PRI_POOL; }
   bool HasHit() const { return flags & HAS_HIT; }
+  bool IsSecondaryCacheCompatible() const {
+    return flags & IS_SECONDARY_CACHE_COMPATIBLE;
+  }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -122,9 +165,19 @@ struct LRUHandle {
 
   void SetHit() { flags |= HAS_HIT; }
 
+  void SetSecondaryCacheCompatible(bool compat) {
+    if (compat) {
+      flags |= IS_SECONDARY_CACHE_COMPATIBLE;
+    } else {
+      flags &= ~IS_SECONDARY_CACHE_COMPATIBLE;
+    }
+  }
+
   void Free() {
-    assert(refs == 0);
-    if (deleter) {
+    assert(!HasRefs());
+    if (IsSecondaryCacheCompatible()) {
+      (*helper->del_cb)(key(), value);
+    } else if (deleter) {
       (*deleter)(key(), value);
     }
     delete[] reinterpret_cast<char*>(this);
@@ -160,6 +213,8 @@ class LRUHandleTable {
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  uint32_t GetOccupancyCount() const { return elems_; }
+
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
     for (uint32_t i = 0; i < length_; i++) {
@@ -188,12 +243,29 @@ class LRUHandleTable {
   uint32_t elems_;
 };
 
+// Counters of an LRUCacheShard, see LRUCacheOptions::collect_shard_stats.
+// A shard has one per core, each in its own cache line.
+struct ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShardCounters {
+  std::atomic<uint64_t> lookups{0};
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> inserts{0};
+  std::atomic<uint64_t> evictions{0};
+  std::atomic<uint64_t> mutex_wait_nanos{0};
+
+  void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+  void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+};
+
 // A single shard of sharded cache.
 class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                 double high_pri_pool_ratio, bool use_adaptive_mutex,
-                CacheMetadataChargePolicy metadata_charge_policy);
+                CacheMetadataChargePolicy metadata_charge_policy,
+                bool use_admission_filter = false,
+                bool use_deferred_promotion = false,
+                std::shared_ptr<SecondaryCache> secondary_cache = nullptr,
+                bool collect_stats = false);
   virtual ~LRUCacheShard() override = default;
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -214,6 +286,14 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                                  const Cache::CacheItemHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) override;
+  virtual Cache::Handle* LookupWithHelper(
+      const Slice& key, uint32_t hash, const Cache::CacheItemHelper* helper,
+      const Cache::CreateCallback& create_cb, Cache::Priority priority,
+      Statistics* stats) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
                        bool force_erase = false) override;
@@ -229,8 +309,16 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
 
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Cache::Priority priority,
+                               const Cache::CacheItemHelper* helper)>&
+          callback) override;
+
   virtual void EraseUnRefEntries() override;
 
+  virtual bool GetStats(Cache::ShardStats* stats) const override;
+
   virtual std::string GetPrintableOptions() const override;
 
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
@@ -242,20 +330,80 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Number of inserts that needed an eviction and were admitted, or rejected,
+  // by the admission filter.
+  uint64_t GetAdmittedInserts() const;
+  uint64_t GetRejectedInserts() const;
+
  private:
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
+  // Inserts with either deleter or helper set.
+  Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                const Cache::CacheItemHelper* helper, Cache::Handle** handle,
+                Cache::Priority priority);
+
+  // Frees an entry evicted for lack of space, after saving a copy of it in
+  // the secondary cache if it can.
+  // Must be called without holding the mutex_.
+  void DemoteAndFree(LRUHandle* e);
+
   // Overflow the last entry in high-pri pool to low-pri pool until size of
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
   // Free some space following strict LRU policy until enough space
   // to hold (usage_ + charge) is freed or the lru list is empty
+  // With deferred promotion, referenced and touched entries at the tail of
+  // the LRU list are moved to its head instead, until each entry was
+  // visited twice.
   // This function is not thread safe - it needs to be executed while
-  // holding the mutex_
+  // holding the mutex_ (and table_mutex_ with deferred promotion)
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // Returns true if an entry with `key`, `hash` and `charge` may be
+  // inserted. With the admission filter, an insert that would evict entries
+  // is only admitted if the entry is estimated to be used more often than the
+  // next entry to be evicted.
+  // This function is not thread safe - it needs to be executed while
+  // holding the mutex_
+  bool Admit(const Slice& key, uint32_t hash, size_t charge);
+
+  // Locks mutex_, like MutexLock. When collecting stats, counts the time
+  // spent waiting for it if it is already locked.
+  class StatsMutexLock {
+   public:
+    explicit StatsMutexLock(LRUCacheShard* shard);
+    ~StatsMutexLock() { shard_->mutex_.Unlock(); }
+    // No copying allowed
+    StatsMutexLock(const StatsMutexLock&) = delete;
+    StatsMutexLock& operator=(const StatsMutexLock&) = delete;
+
+   private:
+    LRUCacheShard* const shard_;
+  };
+
+  // Adds n to `counter` of the calling thread's core, when collecting stats.
+  void Count(std::atomic<uint64_t> LRUCacheShardCounters::*counter,
+             uint64_t n = 1) {
+    if (counters_ != nullptr) {
+      (counters_->Access()->*counter).fetch_add(n, std::memory_order_relaxed);
+    }
+  }
+
+  // Counts a lookup, and a hit if `hit`, when collecting stats.
+  void CountLookup(bool hit) {
+    if (counters_ != nullptr) {
+      LRUCacheShardCounters* counters = counters_->Access();
+      counters->lookups.fetch_add(1, std::memory_order_relaxed);
+      if (hit) {
+        counters->hits.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
   // Initialized before use.
   size_t capacity_;
 
@@ -280,6 +428,18 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Whether inserts into a full shard go through the admission filter.
+  const bool use_admission_filter_;
+
+  // Whether lookups leave the LRU list alone, see LRUHandle.
+  const bool use_deferred_promotion_;
+
+  // Receives the entries evicted from this shard, if not nullptr.
+  const std::shared_ptr<SecondaryCache> secondary_cache_;
+
+  // Per-core counters, nullptr if not collecting stats.
+  const std::unique_ptr<CoreLocalArray<LRUCacheShardCounters>> counters_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -299,10 +459,27 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // With deferred promotion, referenced entries stay on the LRU list, so
+  // the memory size of referenced entries is counted here instead, as their
+  // reference count goes from 0 to 1 and back. Not protected by mutex_.
+  std::atomic<size_t> pinned_usage_{0};
+
+  // Access frequencies of recently looked up keys, used by the admission
+  // filter.
+  FrequencySketch sketch_;
+
+  uint64_t admitted_inserts_;
+  uint64_t rejected_inserts_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
   mutable port::Mutex mutex_;
+
+  // With deferred promotion, lookups hold table_mutex_ shared instead of
+  // holding mutex_. Changes to table_, and removing entries from the cache,
+  // then hold it exclusively in addition to mutex_.
+  port::RWMutex table_mutex_;
 };
 
 class LRUCache
@@ -316,7 +493,13 @@ class LRUCache
            std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
-               kDontChargeCacheMetadata);
+               kDontChargeCacheMetadata,
+           bool use_admission_filter = false,
+           bool use_deferred_promotion = false,
+           std::shared_ptr<SecondaryCache> secondary_cache = nullptr,
+           std::vector<int> cpu_shard_sets = {},
+           bool replicate_high_pri_entries = false,
+           bool collect_shard_stats = false);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -330,10 +513,16 @@ class LRUCache
   size_t TEST_GetLRUSize();
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
+  // Sums of LRUCacheShard::GetAdmittedInserts/GetRejectedInserts
+  uint64_t GetAdmittedInserts() const;
+  uint64_t GetRejectedInserts() const;
 
  private:
   LRUCacheShard* shards_ = nullptr;
   int num_shards_ = 0;
+  // Size of shards_ if allocated with numa_alloc(), with the shards of each
+  // set on its node, or 0 if allocated with cacheline_aligned_alloc().
+  size_t numa_alloc_size_ = 0;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
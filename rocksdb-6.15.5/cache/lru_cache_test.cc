@@ -8,7 +8,12 @@
 #include <string>
 #include <vector>
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
+#include "test_util/sync_point.h"
 #include "test_util/testharness.h"
+#include "util/compression.h"
+#include "util/hash.h"
+#include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -26,13 +31,16 @@ class LRUCacheTest : public testing::Test {
   }
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                bool use_admission_filter = false,
+                bool use_deferred_promotion = false) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
     new (cache_) LRUCacheShard(capacity, false /*strict_capcity_limit*/,
                                high_pri_pool_ratio, use_adaptive_mutex,
-                               kDontChargeCacheMetadata);
+                               kDontChargeCacheMetadata, use_admission_filter,
+                               use_deferred_promotion);
   }
 
   void Insert(const std::string& key,
@@ -88,7 +96,7 @@ class LRUCacheTest : public testing::Test {
     ASSERT_EQ(num_high_pri_pool_keys, high_pri_pool_keys);
   }
 
- private:
+ protected:
   LRUCacheShard* cache_ = nullptr;
 };
 
@@ -191,6 +199,375 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+TEST_F(LRUCacheTest, AdmissionFilter) {
+  NewCache(4, 0.0, kDefaultToAdaptiveMutex, true /*use_admission_filter*/);
+  auto hashed_lookup = [&](const std::string& key) {
+    auto handle = cache_->Lookup(key, GetSliceHash(key));
+    if (handle) {
+      cache_->Release(handle);
+      return true;
+    }
+    return false;
+  };
+  auto hashed_insert = [&](const std::string& key, Cache::Handle** handle) {
+    return cache_->Insert(key, GetSliceHash(key), nullptr /*value*/,
+                          1 /*charge*/, nullptr /*deleter*/, handle,
+                          Cache::Priority::LOW);
+  };
+
+  // Fill the cache with a working set that is looked up repeatedly.
+  for (const std::string key : {"a", "b", "c", "d"}) {
+    ASSERT_FALSE(hashed_lookup(key));
+    ASSERT_OK(hashed_insert(key, nullptr));
+    ASSERT_TRUE(hashed_lookup(key));
+    ASSERT_TRUE(hashed_lookup(key));
+  }
+  ASSERT_EQ(0, cache_->GetAdmittedInserts());
+  ASSERT_EQ(0, cache_->GetRejectedInserts());
+
+  // Keys read once, like by a scan, don't replace the working set.
+  for (int i = 0; i < 20; i++) {
+    std::string key = "scan" + ToString(i);
+    ASSERT_FALSE(hashed_lookup(key));
+    ASSERT_OK(hashed_insert(key, nullptr));
+    ASSERT_FALSE(hashed_lookup(key));
+  }
+  ASSERT_EQ(0, cache_->GetAdmittedInserts());
+  ASSERT_EQ(20, cache_->GetRejectedInserts());
+  ValidateLRUList({"a", "b", "c", "d"});
+
+  // A rejected insert asking for a handle still gets one, to an entry that
+  // is not in the cache.
+  uint64_t rejected = cache_->GetRejectedInserts();
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(hashed_insert("x", &handle));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(rejected + 1, cache_->GetRejectedInserts());
+  ASSERT_EQ(5, cache_->GetUsage());
+  ASSERT_EQ(nullptr, cache_->Lookup("x", GetSliceHash("x")));
+  ASSERT_TRUE(cache_->Release(handle));
+  ASSERT_EQ(4, cache_->GetUsage());
+  ValidateLRUList({"a", "b", "c", "d"});
+
+  // A key looked up more often than the eviction victim is admitted.
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(hashed_lookup("e"));
+  }
+  ASSERT_OK(hashed_insert("e", nullptr));
+  ASSERT_EQ(1, cache_->GetAdmittedInserts());
+  ValidateLRUList({"b", "c", "d", "e"});
+}
+
+TEST_F(LRUCacheTest, DeferredPromotion) {
+  NewCache(4, 0.0, kDefaultToAdaptiveMutex, false /*use_admission_filter*/,
+           true /*use_deferred_promotion*/);
+  Insert("a");
+  Insert("b");
+  Insert("c");
+  Insert("d");
+  ValidateLRUList({"a", "b", "c", "d"});
+
+  // A hit doesn't move the entry right away.
+  ASSERT_TRUE(Lookup("a"));
+  ValidateLRUList({"a", "b", "c", "d"});
+
+  // The touched entry is moved to the head when it would be evicted.
+  Insert("e");
+  ValidateLRUList({"c", "d", "a", "e"});
+
+  // Referenced entries stay on the LRU list but are not evicted.
+  Cache::Handle* handle = cache_->Lookup("c", 0 /*hash*/);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(1, cache_->GetPinnedUsage());
+  Insert("f");
+  ValidateLRUList({"a", "e", "c", "f"});
+  ASSERT_FALSE(cache_->Release(handle));
+  ASSERT_TRUE(Lookup("c"));
+  ASSERT_FALSE(Lookup("d"));
+  ASSERT_EQ(0, cache_->GetPinnedUsage());
+
+  // An entry erased while referenced is freed by its last release.
+  handle = cache_->Lookup("a", 0 /*hash*/);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_TRUE(cache_->Ref(handle));
+  Erase("a");
+  ASSERT_FALSE(Lookup("a"));
+  ValidateLRUList({"e", "c", "f"});
+  ASSERT_EQ(4, cache_->GetUsage());
+  ASSERT_FALSE(cache_->Release(handle));
+  ASSERT_TRUE(cache_->Release(handle));
+  ASSERT_EQ(3, cache_->GetUsage());
+
+  // So is an entry overwritten while referenced.
+  handle = cache_->Lookup("e", 0 /*hash*/);
+  ASSERT_NE(nullptr, handle);
+  Insert("e");
+  ASSERT_EQ(4, cache_->GetUsage());
+  ASSERT_TRUE(cache_->Release(handle));
+  ASSERT_EQ(3, cache_->GetUsage());
+  ASSERT_TRUE(Lookup("e"));
+
+  // Releasing with force_erase removes the entry from the cache.
+  handle = cache_->Lookup("f", 0 /*hash*/);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_TRUE(cache_->Release(handle, true /*force_erase*/));
+  ASSERT_FALSE(Lookup("f"));
+  ASSERT_EQ(2, cache_->GetUsage());
+}
+
+TEST(LRUCacheShardStatsTest, CountOperations) {
+  LRUCacheOptions opts(2 /* capacity */, 1 /* num_shard_bits */,
+                       false /* strict_capacity_limit */,
+                       0.0 /* high_pri_pool_ratio */, nullptr,
+                       kDefaultToAdaptiveMutex, kDontChargeCacheMetadata);
+  std::vector<Cache::ShardStats> shard_stats;
+  ASSERT_FALSE(NewLRUCache(opts)->GetShardStats(&shard_stats));
+
+  opts.num_shard_bits = 0;
+  opts.collect_shard_stats = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  ASSERT_OK(cache->Insert("a", nullptr, 1, nullptr));
+  ASSERT_OK(cache->Insert("b", nullptr, 1, nullptr));
+  Cache::Handle* handle = cache->Lookup("a");
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(nullptr, cache->Lookup("c"));
+  // Evicts "b", as "a" is referenced.
+  ASSERT_OK(cache->Insert("c", nullptr, 1, nullptr));
+
+  ASSERT_TRUE(cache->GetShardStats(&shard_stats));
+  ASSERT_EQ(1, shard_stats.size());
+  ASSERT_EQ(2, shard_stats[0].lookups);
+  ASSERT_EQ(1, shard_stats[0].hits);
+  ASSERT_EQ(3, shard_stats[0].inserts);
+  ASSERT_EQ(1, shard_stats[0].evictions);
+  ASSERT_EQ(2, shard_stats[0].usage);
+  ASSERT_EQ(1, shard_stats[0].pinned_usage);
+  cache->Release(handle);
+}
+
+TEST(FrequencySketchTest, EstimateAndAge) {
+  FrequencySketch sketch(16);
+  ASSERT_EQ(16, sketch.NumWords());
+  for (int i = 0; i < 5; i++) {
+    sketch.Increment(1);
+  }
+  ASSERT_GE(sketch.Estimate(1), 5);
+  // Counters saturate.
+  for (int i = 0; i < 20; i++) {
+    sketch.Increment(2);
+  }
+  ASSERT_EQ(15, sketch.Estimate(2));
+
+  // Counters are halved after 10 increments per word.
+  uint32_t before_aging = sketch.Estimate(1);
+  for (uint32_t hash = 1000; hash < 1000 + 10 * 16; hash++) {
+    sketch.Increment(hash);
+  }
+  ASSERT_LT(sketch.Estimate(1), before_aging);
+  ASSERT_LE(sketch.Estimate(2), 8);
+}
+
+namespace {
+// Values of the secondary cache tests are strings, saved as their bytes.
+size_t StringSize(void* obj) {
+  return reinterpret_cast<std::string*>(obj)->size();
+}
+
+Status SaveString(void* obj, size_t size, char* out) {
+  memcpy(out, reinterpret_cast<std::string*>(obj)->data(), size);
+  return Status::OK();
+}
+
+void DeleteString(const Slice& /*key*/, void* obj) {
+  delete reinterpret_cast<std::string*>(obj);
+}
+
+const Cache::CacheItemHelper kStringHelper{&StringSize, &SaveString,
+                                           &DeleteString, 0 /* tag */};
+
+Status CreateString(const char* buf, size_t size, void** out_obj,
+                    size_t* charge) {
+  *out_obj = new std::string(buf, size);
+  *charge = size;
+  return Status::OK();
+}
+
+CompressionType GetSupportedCompression() {
+  for (CompressionType type :
+       {kLZ4Compression, kZSTD, kSnappyCompression, kZlibCompression}) {
+    if (CompressionTypeSupported(type)) {
+      return type;
+    }
+  }
+  return kNoCompression;
+}
+}  // namespace
+
+TEST(CompressedSecondaryCacheTest, InsertAndLookup) {
+  std::string value;
+  for (int i = 0; i < 100; i++) {
+    value.append("0123456789");
+  }
+  for (CompressionType type : {kNoCompression, GetSupportedCompression()}) {
+    std::shared_ptr<SecondaryCache> secondary_cache =
+        NewCompressedSecondaryCache(
+            CompressedSecondaryCacheOptions(2000, 0 /*num_shard_bits*/, type));
+    ASSERT_NE(nullptr, secondary_cache);
+
+    std::string result;
+    ASSERT_FALSE(secondary_cache->Lookup("k1", &result));
+    ASSERT_OK(secondary_cache->Insert("k1", value));
+    ASSERT_TRUE(secondary_cache->Lookup("k1", &result));
+    ASSERT_EQ(value, result);
+    secondary_cache->Erase("k1");
+    ASSERT_FALSE(secondary_cache->Lookup("k1", &result));
+
+    // Compressed values take less of the capacity.
+    ASSERT_OK(secondary_cache->Insert("k1", value));
+    ASSERT_OK(secondary_cache->Insert("k2", value));
+    ASSERT_OK(secondary_cache->Insert("k3", value));
+    ASSERT_EQ(type != kNoCompression,
+              secondary_cache->Lookup("k1", &result));
+    ASSERT_TRUE(secondary_cache->Lookup("k3", &result));
+    ASSERT_EQ(value, result);
+  }
+}
+
+TEST(CompressedSecondaryCacheTest, DemoteAndPromote) {
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
+          1 << 20, 0 /*num_shard_bits*/, GetSupportedCompression()));
+  ASSERT_NE(nullptr, secondary_cache);
+  LRUCacheOptions opts(2000, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+
+  for (std::string key : {"k1", "k2", "k3"}) {
+    std::string* value = new std::string(1000, key[1]);
+    ASSERT_OK(cache->InsertWithHelper(key, value, &kStringHelper,
+                                      value->size()));
+  }
+  // k1 was evicted to the secondary cache. Lookup() doesn't look there.
+  std::string result;
+  ASSERT_TRUE(secondary_cache->Lookup("k1", &result));
+  ASSERT_EQ(nullptr, cache->Lookup("k1"));
+
+  Cache::Handle* handle = cache->LookupWithHelper(
+      "k1", &kStringHelper, &CreateString, Cache::Priority::LOW, stats.get());
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(std::string(1000, '1'),
+            *reinterpret_cast<std::string*>(cache->Value(handle)));
+  cache->Release(handle);
+  ASSERT_EQ(1, stats->getTickerCount(SECONDARY_CACHE_HITS));
+  ASSERT_EQ(0, stats->getTickerCount(SECONDARY_CACHE_MISSES));
+
+  // k1 moved back, and k2 was evicted in its place.
+  ASSERT_FALSE(secondary_cache->Lookup("k1", &result));
+  ASSERT_TRUE(secondary_cache->Lookup("k2", &result));
+
+  ASSERT_EQ(nullptr,
+            cache->LookupWithHelper("k4", &kStringHelper, &CreateString,
+                                    Cache::Priority::LOW, stats.get()));
+  ASSERT_EQ(1, stats->getTickerCount(SECONDARY_CACHE_MISSES));
+
+  // Erasing a key erases it from the secondary cache too.
+  cache->Erase("k2");
+  ASSERT_FALSE(secondary_cache->Lookup("k2", &result));
+
+  // Entries inserted without a helper are not moved.
+  for (std::string key : {"k5", "k6", "k7"}) {
+    ASSERT_OK(cache->Insert(key, new std::string(1000, key[1]), 1000,
+                            &DeleteString));
+  }
+  ASSERT_EQ(nullptr, cache->Lookup("k5"));
+  ASSERT_FALSE(secondary_cache->Lookup("k5", &result));
+}
+
+TEST(CompressedSecondaryCacheTest, TieredCache) {
+  LRUCacheOptions opts(4000, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  std::shared_ptr<Cache> cache =
+      NewTieredCache(opts, 0.25, GetSupportedCompression());
+  ASSERT_NE(nullptr, cache);
+  ASSERT_EQ(3000, cache->GetCapacity());
+  ASSERT_EQ(nullptr, NewTieredCache(opts, 1.5, GetSupportedCompression()));
+}
+
+#ifndef NDEBUG
+TEST(NumaLRUCacheTest, ShardSets) {
+  // Two shard sets of one shard each. The test picks the set local to the
+  // calling thread.
+  LRUCache lru_cache(
+      4000, 0 /*num_shard_bits*/, false /*strict_capacity_limit*/,
+      0.0 /*high_pri_pool_ratio*/, nullptr /*memory_allocator*/,
+      kDefaultToAdaptiveMutex, kDontChargeCacheMetadata,
+      false /*use_admission_filter*/, false /*use_deferred_promotion*/,
+      nullptr /*secondary_cache*/, {0, 1} /*cpu_shard_sets*/,
+      true /*replicate_high_pri_entries*/);
+  ASSERT_EQ(2, lru_cache.GetNumShardSets());
+  ASSERT_EQ(2, lru_cache.GetNumShards());
+  Cache& cache = lru_cache;
+  int local = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "ShardedCache::GetLocalShardSet",
+      [&](void* arg) { *reinterpret_cast<int*>(arg) = local; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Lookup() and low priority lookups only look in the local set, and an
+  // insert leaves the copy of the other set alone.
+  ASSERT_OK(cache.InsertWithHelper("k1", new std::string(100, 'a'),
+                                   &kStringHelper, 100));
+  local = 1;
+  ASSERT_EQ(nullptr, cache.Lookup("k1"));
+  ASSERT_EQ(nullptr, cache.LookupWithHelper("k1", &kStringHelper,
+                                            &CreateString,
+                                            Cache::Priority::LOW));
+  ASSERT_OK(cache.InsertWithHelper("k1", new std::string(100, 'a'),
+                                   &kStringHelper, 100));
+  ASSERT_EQ(200, cache.GetUsage());
+  Cache::Handle* handle = cache.Lookup("k1");
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(std::string(100, 'a'),
+            *reinterpret_cast<std::string*>(cache.Value(handle)));
+  cache.Release(handle);
+
+  // A high priority entry missing from the local set is looked up in the
+  // other set, and copied to the local set.
+  ASSERT_OK(cache.InsertWithHelper("k2", new std::string(200, 'c'),
+                                   &kStringHelper, 200,
+                                   nullptr /*handle*/, Cache::Priority::HIGH));
+  ASSERT_EQ(400, cache.GetUsage());
+  local = 0;
+  handle = cache.LookupWithHelper("k2", &kStringHelper, &CreateString,
+                                  Cache::Priority::HIGH);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(std::string(200, 'c'),
+            *reinterpret_cast<std::string*>(cache.Value(handle)));
+  cache.Release(handle);
+  ASSERT_EQ(600, cache.GetUsage());
+  handle = cache.Lookup("k2");
+  ASSERT_NE(nullptr, handle);
+  cache.Release(handle);
+
+  // Erase() erases all the copies.
+  cache.Erase("k2");
+  ASSERT_EQ(200, cache.GetUsage());
+  ASSERT_EQ(nullptr, cache.LookupWithHelper("k2", &kStringHelper,
+                                            &CreateString,
+                                            Cache::Priority::HIGH));
+  cache.Erase("k1");
+  ASSERT_EQ(0, cache.GetUsage());
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+#endif  // NDEBUG
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
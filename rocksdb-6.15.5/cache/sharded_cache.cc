@@ -9,23 +9,45 @@
 
 #include "cache/sharded_cache.h"
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
+#include <algorithm>
 #include <string>
 
+#include "test_util/sync_point.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
                            bool strict_capacity_limit,
-                           std::shared_ptr<MemoryAllocator> allocator)
+                           std::shared_ptr<MemoryAllocator> allocator,
+                           std::vector<int> cpu_shard_sets,
+                           bool replicate_high_pri_entries)
     : Cache(std::move(allocator)),
       num_shard_bits_(num_shard_bits),
+      num_shard_sets_(1),
+      num_shard_set_bits_(0),
+      cpu_shard_sets_(std::move(cpu_shard_sets)),
+      replicate_high_pri_entries_(replicate_high_pri_entries),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
-      last_id_(1) {}
+      last_id_(1) {
+  for (int set : cpu_shard_sets_) {
+    assert(set >= 0);
+    num_shard_sets_ = std::max(num_shard_sets_, set + 1);
+  }
+  while ((1 << num_shard_set_bits_) < num_shard_sets_) {
+    num_shard_set_bits_++;
+  }
+  shard_index_bits_ = num_shard_set_bits_ + num_shard_bits_;
+  assert(shard_index_bits_ < 32);
+}
 
 void ShardedCache::SetCapacity(size_t capacity) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
@@ -35,7 +57,7 @@ void ShardedCache::SetCapacity(size_t capacity) {
 }
 
 void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->SetStrictCapacityLimit(strict_capacity_limit);
@@ -47,13 +69,68 @@ Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
                             void (*deleter)(const Slice& key, void* value),
                             Handle** handle, Priority priority) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))
-      ->Insert(key, hash, value, charge, deleter, handle, priority);
+  if (num_shard_sets_ == 1) {
+    return GetShard(Shard(hash))
+        ->Insert(key, hash, value, charge, deleter, handle, priority);
+  }
+  int local = GetLocalShardSet();
+  uint32_t local_hash = ShardSetHash(hash, local);
+  return GetShard(Shard(local_hash))
+      ->Insert(key, local_hash, value, charge, deleter, handle, priority);
 }
 
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* /*stats*/) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))->Lookup(key, hash);
+  if (num_shard_sets_ == 1) {
+    return GetShard(Shard(hash))->Lookup(key, hash);
+  }
+  uint32_t local_hash = ShardSetHash(hash, GetLocalShardSet());
+  return GetShard(Shard(local_hash))->Lookup(key, local_hash);
+}
+
+Status ShardedCache::InsertWithHelper(const Slice& key, void* value,
+                                      const CacheItemHelper* helper,
+                                      size_t charge, Handle** handle,
+                                      Priority priority) {
+  uint32_t hash = HashSlice(key);
+  if (num_shard_sets_ == 1) {
+    return GetShard(Shard(hash))
+        ->InsertWithHelper(key, hash, value, helper, charge, handle, priority);
+  }
+  int local = GetLocalShardSet();
+  uint32_t local_hash = ShardSetHash(hash, local);
+  return GetShard(Shard(local_hash))
+      ->InsertWithHelper(key, local_hash, value, helper, charge, handle,
+                         priority);
+}
+
+Cache::Handle* ShardedCache::LookupWithHelper(const Slice& key,
+                                              const CacheItemHelper* helper,
+                                              const CreateCallback& create_cb,
+                                              Priority priority,
+                                              Statistics* stats) {
+  uint32_t hash = HashSlice(key);
+  if (num_shard_sets_ == 1) {
+    return GetShard(Shard(hash))
+        ->LookupWithHelper(key, hash, helper, create_cb, priority, stats);
+  }
+  int local = GetLocalShardSet();
+  uint32_t local_hash = ShardSetHash(hash, local);
+  Handle* handle =
+      GetShard(Shard(local_hash))
+          ->LookupWithHelper(key, local_hash, helper, create_cb, priority,
+                             stats);
+  if (handle != nullptr || priority != Priority::HIGH) {
+    return handle;
+  }
+  // Only high priority entries, such as index and filter blocks, are worth
+  // locking the shards of the other nodes on a local miss.
+  handle = LookupInOtherShardSets(key, hash, local);
+  if (handle != nullptr && replicate_high_pri_entries_) {
+    handle =
+        ReplicateEntry(key, local_hash, handle, helper, create_cb, priority);
+  }
+  return handle;
 }
 
 bool ShardedCache::Ref(Handle* handle) {
@@ -68,7 +145,70 @@ bool ShardedCache::Release(Handle* handle, bool force_erase) {
 
 void ShardedCache::Erase(const Slice& key) {
   uint32_t hash = HashSlice(key);
-  GetShard(Shard(hash))->Erase(key, hash);
+  if (num_shard_sets_ == 1) {
+    GetShard(Shard(hash))->Erase(key, hash);
+    return;
+  }
+  for (int set = 0; set < num_shard_sets_; set++) {
+    uint32_t set_hash = ShardSetHash(hash, set);
+    GetShard(Shard(set_hash))->Erase(key, set_hash);
+  }
+}
+
+int ShardedCache::GetLocalShardSet() const {
+  int set = 0;
+  int cpu = port::PhysicalCoreID();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_shard_sets_.size()) {
+    set = cpu_shard_sets_[cpu];
+  }
+  TEST_SYNC_POINT_CALLBACK("ShardedCache::GetLocalShardSet", &set);
+  return set;
+}
+
+Cache::Handle* ShardedCache::LookupInOtherShardSets(const Slice& key,
+                                                    uint32_t hash,
+                                                    int local) {
+  for (int i = 1; i < num_shard_sets_; i++) {
+    uint32_t set_hash = ShardSetHash(hash, (local + i) % num_shard_sets_);
+    Handle* handle = GetShard(Shard(set_hash))->Lookup(key, set_hash);
+    if (handle != nullptr) {
+      return handle;
+    }
+  }
+  return nullptr;
+}
+
+Cache::Handle* ShardedCache::ReplicateEntry(const Slice& key, uint32_t hash,
+                                            Handle* handle,
+                                            const CacheItemHelper* helper,
+                                            const CreateCallback& create_cb,
+                                            Priority priority) {
+  if (helper == nullptr || helper->size_cb == nullptr || !create_cb) {
+    return handle;
+  }
+  std::string buf;
+  buf.resize((*helper->size_cb)(Value(handle)));
+  Status s = (*helper->saveto_cb)(Value(handle), buf.size(), &buf[0]);
+  void* value = nullptr;
+  size_t charge = 0;
+  if (s.ok()) {
+    s = create_cb(buf.data(), buf.size(), &value, &charge);
+  }
+  Handle* copy = nullptr;
+  if (s.ok()) {
+    s = GetShard(Shard(hash))
+            ->InsertWithHelper(key, hash, value, helper, charge, &copy,
+                               priority);
+    if (!s.ok()) {
+      (*helper->del_cb)(key, value);
+    }
+  }
+  if (!s.ok()) {
+    // Keep using the entry of the other set
+    return handle;
+  }
+  Release(handle);
+  return copy;
 }
 
 uint64_t ShardedCache::NewId() {
@@ -87,7 +227,7 @@ bool ShardedCache::HasStrictCapacityLimit() const {
 
 size_t ShardedCache::GetUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetUsage();
@@ -101,7 +241,7 @@ size_t ShardedCache::GetUsage(Handle* handle) const {
 
 size_t ShardedCache::GetPinnedUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetPinnedUsage();
@@ -111,19 +251,41 @@ size_t ShardedCache::GetPinnedUsage() const {
 
 void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                           bool thread_safe) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->ApplyToAllCacheEntries(callback, thread_safe);
   }
 }
 
+void ShardedCache::ApplyToAllCacheKeys(
+    const std::function<void(const Slice& key, size_t charge,
+                             Priority priority,
+                             const CacheItemHelper* helper)>& callback) {
+  int num_shards = GetNumShards();
+  for (int s = 0; s < num_shards; s++) {
+    GetShard(s)->ApplyToAllCacheKeys(callback);
+  }
+}
+
 void ShardedCache::EraseUnRefEntries() {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->EraseUnRefEntries();
   }
 }
 
+bool ShardedCache::GetShardStats(std::vector<ShardStats>* stats) const {
+  int num_shards = GetNumShards();
+  for (int s = 0; s < num_shards; s++) {
+    ShardStats shard_stats;
+    if (!GetShard(s)->GetStats(&shard_stats)) {
+      return false;
+    }
+    stats->push_back(shard_stats);
+  }
+  return true;
+}
+
 std::string ShardedCache::GetPrintableOptions() const {
   std::string ret;
   ret.reserve(20000);
@@ -136,6 +298,8 @@ std::string ShardedCache::GetPrintableOptions() const {
     ret.append(buffer);
     snprintf(buffer, kBufferSize, "    num_shard_bits : %d\n", num_shard_bits_);
     ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    num_shard_sets : %d\n", num_shard_sets_);
+    ret.append(buffer);
     snprintf(buffer, kBufferSize, "    strict_capacity_limit : %d\n",
              strict_capacity_limit_);
     ret.append(buffer);
@@ -159,4 +323,17 @@ int GetDefaultCacheShardBits(size_t capacity) {
   return num_shard_bits;
 }
 
+std::vector<int> GetCpuNumaNodes() {
+  std::vector<int> nodes;
+#ifdef NUMA
+  if (numa_available() >= 0 && numa_num_configured_nodes() > 1) {
+    int num_cpus = numa_num_configured_cpus();
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+      nodes.push_back(std::max(numa_node_of_cpu(cpu), 0));
+    }
+  }
+#endif
+  return nodes;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
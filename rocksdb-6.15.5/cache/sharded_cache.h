@@ -11,6 +11,7 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
@@ -29,6 +30,19 @@ class CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle, Cache::Priority priority) = 0;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) = 0;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                                  const Cache::CacheItemHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) {
+    return Insert(key, hash, value, charge, helper->del_cb, handle, priority);
+  }
+  virtual Cache::Handle* LookupWithHelper(
+      const Slice& key, uint32_t hash,
+      const Cache::CacheItemHelper* /*helper*/,
+      const Cache::CreateCallback& /*create_cb*/, Cache::Priority /*priority*/,
+      Statistics* /*stats*/) {
+    return Lookup(key, hash);
+  }
   virtual bool Ref(Cache::Handle* handle) = 0;
   virtual bool Release(Cache::Handle* handle, bool force_erase = false) = 0;
   virtual void Erase(const Slice& key, uint32_t hash) = 0;
@@ -38,7 +52,13 @@ class CacheShard {
   virtual size_t GetPinnedUsage() const = 0;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Cache::Priority priority,
+                               const Cache::CacheItemHelper* /*helper*/)>&
+          /*callback*/) {}
   virtual void EraseUnRefEntries() = 0;
+  virtual bool GetStats(Cache::ShardStats* /*stats*/) const { return false; }
   virtual std::string GetPrintableOptions() const { return ""; }
   void set_metadata_charge_policy(
       CacheMetadataChargePolicy metadata_charge_policy) {
@@ -52,10 +72,25 @@ class CacheShard {
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
 // shards will be created, with capacity split evenly to each of the shards.
 // Keys are sharded by the highest num_shard_bits bits of hash value.
+//
+// The cache can also have several sets of 2^num_shard_bits shards, one per
+// NUMA node, with the capacity split evenly to all of them.
+// cpu_shard_sets[i] is the set local to CPU i. A key is inserted in and
+// looked up in the set local to the calling thread, so other nodes' shards
+// are not locked. Only LookupWithHelper() with high priority looks in the
+// other sets on a local miss, and copies the entry found to the local set if
+// replicate_high_pri_entries is true. Erase() erases the key from all sets.
+// Since an insert leaves the copies in other sets alone, this is only meant
+// for caches whose keys map to immutable values, such as the block cache.
+// The set of an entry is stored in the highest bits of its hash, above the
+// shard bits, so that Ref() and Release() find the shard of a handle from
+// its hash.
 class ShardedCache : public Cache {
  public:
   ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+               std::vector<int> cpu_shard_sets = {},
+               bool replicate_high_pri_entries = false);
   virtual ~ShardedCache() = default;
   virtual const char* Name() const override = 0;
   virtual CacheShard* GetShard(int shard) = 0;
@@ -73,6 +108,15 @@ class ShardedCache : public Cache {
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override;
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override;
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) override;
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   const CreateCallback& create_cb,
+                                   Priority priority = Priority::LOW,
+                                   Statistics* stats = nullptr) override;
   virtual bool Ref(Handle* handle) override;
   virtual bool Release(Handle* handle, bool force_erase = false) override;
   virtual void Erase(const Slice& key) override;
@@ -84,10 +128,19 @@ class ShardedCache : public Cache {
   virtual size_t GetPinnedUsage() const override;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Priority priority,
+                               const CacheItemHelper* helper)>&
+          callback) override;
   virtual void EraseUnRefEntries() override;
+  virtual bool GetShardStats(std::vector<ShardStats>* stats) const override;
   virtual std::string GetPrintableOptions() const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
+  int GetNumShardSets() const { return num_shard_sets_; }
+  // The number of shards of all the sets
+  int GetNumShards() const { return num_shard_sets_ << num_shard_bits_; }
 
  private:
   static inline uint32_t HashSlice(const Slice& s) {
@@ -96,10 +149,39 @@ class ShardedCache : public Cache {
 
   uint32_t Shard(uint32_t hash) {
     // Note, hash >> 32 yields hash in gcc, not the zero we expect!
-    return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
+    return (shard_index_bits_ > 0) ? (hash >> (32 - shard_index_bits_)) : 0;
+  }
+
+  // Returns hash with its shard set bits set to `set`.
+  uint32_t ShardSetHash(uint32_t hash, int set) const {
+    if (num_shard_set_bits_ == 0) {
+      return hash;
+    }
+    const int shift = 32 - num_shard_set_bits_;
+    return (hash & ((uint32_t{1} << shift) - 1)) |
+           (static_cast<uint32_t>(set) << shift);
   }
 
+  // Returns the shard set local to the calling thread.
+  int GetLocalShardSet() const;
+
+  // Looks up key in the shard sets other than `local`.
+  Handle* LookupInOtherShardSets(const Slice& key, uint32_t hash, int local);
+
+  // Copies the entry of `handle` to the shard of `hash` with helper and
+  // create_cb, and returns a handle to the copy, releasing `handle`. Returns
+  // `handle` if the entry can't be copied.
+  Handle* ReplicateEntry(const Slice& key, uint32_t hash, Handle* handle,
+                         const CacheItemHelper* helper,
+                         const CreateCallback& create_cb, Priority priority);
+
   int num_shard_bits_;
+  int num_shard_sets_;
+  int num_shard_set_bits_;
+  // num_shard_set_bits_ + num_shard_bits_
+  int shard_index_bits_;
+  const std::vector<int> cpu_shard_sets_;
+  const bool replicate_high_pri_entries_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
   bool strict_capacity_limit_;
@@ -108,4 +190,9 @@ class ShardedCache : public Cache {
 
 extern int GetDefaultCacheShardBits(size_t capacity);
 
+// Returns the NUMA node of each CPU, indexed by CPU number, or an empty
+// vector if RocksDB is built without NUMA support or the machine has a
+// single node.
+extern std::vector<int> GetCpuNumaNodes();
+
 }  // namespace ROCKSDB_NAMESPACE
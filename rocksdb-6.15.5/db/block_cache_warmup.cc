@@ -0,0 +1,241 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/block_cache_warmup.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rocksdb/options.h"
+#include "table/table_reader.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+const uint32_t kBlockCacheWarmupFormatVersion = 1;
+
+}  // namespace
+
+BlockCacheKeyTableIndex::BlockCacheKeyTableIndex(
+    const std::vector<BlockCacheWarmupTable>& tables) {
+  // The cache key prefixes of the tables are unique, but not necessarily of
+  // the same size.
+  prefixes_.reserve(tables.size());
+  for (size_t i = 0; i < tables.size(); ++i) {
+    prefixes_.push_back(tables[i].reader->GetBlockCacheKeyPrefix());
+    const std::string& prefix = prefixes_.back();
+    if (prefix.empty()) {
+      continue;
+    }
+    prefix_sizes_.push_back(prefix.size());
+    table_by_prefix_.emplace(Slice(prefix), i);
+  }
+  std::sort(prefix_sizes_.begin(), prefix_sizes_.end());
+  prefix_sizes_.erase(std::unique(prefix_sizes_.begin(), prefix_sizes_.end()),
+                      prefix_sizes_.end());
+}
+
+bool BlockCacheKeyTableIndex::Find(const Slice& key, size_t* table,
+                                   uint64_t* offset) const {
+  // The offset after the prefix is a varint64.
+  auto prefix_size_it = prefix_sizes_.begin();
+  if (key.size() > kMaxVarint64Length) {
+    prefix_size_it =
+        std::lower_bound(prefix_sizes_.begin(), prefix_sizes_.end(),
+                         key.size() - kMaxVarint64Length);
+  }
+  for (; prefix_size_it != prefix_sizes_.end(); ++prefix_size_it) {
+    const size_t prefix_size = *prefix_size_it;
+    if (key.size() <= prefix_size) {
+      break;
+    }
+    auto it = table_by_prefix_.find(Slice(key.data(), prefix_size));
+    if (it == table_by_prefix_.end()) {
+      continue;
+    }
+    Slice rest(key.data() + prefix_size, key.size() - prefix_size);
+    if (GetVarint64(&rest, offset) && rest.empty()) {
+      *table = it->second;
+      return true;
+    }
+  }
+  return false;
+}
+
+Status CollectBlockCacheWarmupFiles(
+    Cache* block_cache, const std::vector<BlockCacheWarmupTable>& tables,
+    std::vector<BlockCacheWarmupFile>* files) {
+  BlockCacheKeyTableIndex index(tables);
+  if (index.empty()) {
+    return Status::OK();
+  }
+
+  // The offsets and priorities of the cached blocks of each table.
+  std::vector<std::vector<std::pair<uint64_t, Cache::Priority>>> cached(
+      tables.size());
+  block_cache->ApplyToAllCacheKeys(
+      [&](const Slice& key, size_t /*charge*/, Cache::Priority priority,
+          const Cache::CacheItemHelper* /*helper*/) {
+        size_t table;
+        uint64_t offset;
+        if (index.Find(key, &table, &offset)) {
+          cached[table].emplace_back(offset, priority);
+        }
+      });
+
+  // Don't read index blocks that were evicted: the table is left out of the
+  // list instead, as its blocks are likely to be evicted soon too.
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  read_options.read_tier = kBlockCacheTier;
+  for (size_t i = 0; i < tables.size(); ++i) {
+    auto& blocks = cached[i];
+    if (blocks.empty()) {
+      continue;
+    }
+    std::sort(blocks.begin(), blocks.end());
+    std::vector<uint64_t> offsets;
+    offsets.reserve(blocks.size());
+    for (const auto& block : blocks) {
+      offsets.push_back(block.first);
+    }
+    // Index and filter blocks have the same key prefix; only keep the
+    // data blocks.
+    std::vector<BlockHandle> handles;
+    Status s =
+        tables[i].reader->GetDataBlockHandles(read_options, offsets, &handles);
+    if (s.IsIncomplete()) {
+      continue;
+    }
+    if (!s.ok()) {
+      return s;
+    }
+    if (handles.empty()) {
+      continue;
+    }
+
+    BlockCacheWarmupFile file;
+    file.column_family_id = tables[i].column_family_id;
+    file.file_number = tables[i].file_number;
+    file.blocks.reserve(handles.size());
+    auto block = blocks.begin();
+    for (const BlockHandle& handle : handles) {
+      while (block->first < handle.offset()) {
+        ++block;
+      }
+      assert(block->first == handle.offset());
+      file.blocks.push_back({handle, block->second});
+    }
+    std::stable_partition(file.blocks.begin(), file.blocks.end(),
+                          [](const BlockCacheWarmupBlock& b) {
+                            return b.priority == Cache::Priority::HIGH;
+                          });
+    files->push_back(std::move(file));
+  }
+  return Status::OK();
+}
+
+Status GetBlockCacheWarmupBlocks(TableReader* reader,
+                                 const BlockCacheWarmupFile& file,
+                                 std::vector<BlockCacheWarmupBlock>* blocks) {
+  std::vector<uint64_t> offsets;
+  offsets.reserve(file.blocks.size());
+  for (const auto& block : file.blocks) {
+    offsets.push_back(block.handle.offset());
+  }
+  std::sort(offsets.begin(), offsets.end());
+  offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+  std::vector<BlockHandle> data_blocks;
+  Status s = reader->GetDataBlockHandles(ReadOptions(), offsets, &data_blocks);
+  if (!s.ok()) {
+    return s;
+  }
+
+  for (const auto& block : file.blocks) {
+    auto it = std::lower_bound(data_blocks.begin(), data_blocks.end(),
+                               block.handle.offset(),
+                               [](const BlockHandle& h, uint64_t offset) {
+                                 return h.offset() < offset;
+                               });
+    if (it != data_blocks.end() && it->offset() == block.handle.offset() &&
+        it->size() == block.handle.size()) {
+      blocks->push_back({*it, block.priority});
+    }
+  }
+  return Status::OK();
+}
+
+void EncodeBlockCacheWarmupFiles(const std::vector<BlockCacheWarmupFile>& files,
+                                 std::string* dst) {
+  size_t start = dst->size();
+  PutVarint32(dst, kBlockCacheWarmupFormatVersion);
+  PutVarint64(dst, files.size());
+  for (const auto& file : files) {
+    PutVarint32(dst, file.column_family_id);
+    PutVarint64(dst, file.file_number);
+    PutVarint64(dst, file.blocks.size());
+    for (const auto& block : file.blocks) {
+      PutVarint64(dst, block.handle.offset());
+      PutVarint64(dst, block.handle.size());
+      dst->push_back(static_cast<char>(block.priority));
+    }
+  }
+  PutFixed32(dst, crc32c::Mask(crc32c::Value(dst->data() + start,
+                                             dst->size() - start)));
+}
+
+Status DecodeBlockCacheWarmupFiles(const Slice& src,
+                                   std::vector<BlockCacheWarmupFile>* files) {
+  const char* kFileName = "block cache warm-up file";
+  if (src.size() < sizeof(uint32_t)) {
+    return Status::Corruption(kFileName, "too short");
+  }
+  Slice input(src.data(), src.size() - sizeof(uint32_t));
+  uint32_t crc = crc32c::Unmask(DecodeFixed32(input.data() + input.size()));
+  if (crc != crc32c::Value(input.data(), input.size())) {
+    return Status::Corruption(kFileName, "checksum mismatch");
+  }
+
+  uint32_t version;
+  uint64_t num_files;
+  if (!GetVarint32(&input, &version) || !GetVarint64(&input, &num_files)) {
+    return Status::Corruption(kFileName, "bad header");
+  }
+  if (version != kBlockCacheWarmupFormatVersion) {
+    return Status::NotSupported(kFileName, "unknown format version");
+  }
+  for (uint64_t i = 0; i < num_files; ++i) {
+    BlockCacheWarmupFile file;
+    uint64_t num_blocks;
+    if (!GetVarint32(&input, &file.column_family_id) ||
+        !GetVarint64(&input, &file.file_number) ||
+        !GetVarint64(&input, &num_blocks)) {
+      return Status::Corruption(kFileName, "bad file entry");
+    }
+    for (uint64_t j = 0; j < num_blocks; ++j) {
+      uint64_t offset;
+      uint64_t size;
+      if (!GetVarint64(&input, &offset) || !GetVarint64(&input, &size) ||
+          input.empty() ||
+          static_cast<unsigned char>(input[0]) >
+              static_cast<unsigned char>(Cache::Priority::LOW)) {
+        return Status::Corruption(kFileName, "bad block entry");
+      }
+      Cache::Priority priority = static_cast<Cache::Priority>(input[0]);
+      input.remove_prefix(1);
+      file.blocks.push_back({BlockHandle(offset, size), priority});
+    }
+    files->push_back(std::move(file));
+  }
+  if (!input.empty()) {
+    return Status::Corruption(kFileName, "trailing bytes");
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,93 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TableReader;
+
+// A data block to load into the block cache when the DB is opened, see
+// DBOptions::block_cache_warmup_period_sec.
+struct BlockCacheWarmupBlock {
+  BlockHandle handle;
+  // The priority of the block in the block cache it was found in.
+  Cache::Priority priority;
+};
+
+// The blocks of an SST file to load into the block cache, high priority
+// blocks first.
+struct BlockCacheWarmupFile {
+  uint32_t column_family_id = 0;
+  uint64_t file_number = 0;
+  std::vector<BlockCacheWarmupBlock> blocks;
+};
+
+// An open SST file whose blocks may be in the block cache.
+struct BlockCacheWarmupTable {
+  uint32_t column_family_id;
+  uint64_t file_number;
+  TableReader* reader;
+};
+
+// Finds the table a block cache key belongs to, by the cache key prefixes of
+// the tables, see TableReader::GetBlockCacheKeyPrefix().
+class BlockCacheKeyTableIndex {
+ public:
+  explicit BlockCacheKeyTableIndex(
+      const std::vector<BlockCacheWarmupTable>& tables);
+
+  bool empty() const { return table_by_prefix_.empty(); }
+
+  // If key is the cache key of a block of one of the tables, returns true,
+  // the index of the table in `tables` in *table, and the offset of the block
+  // in *offset. Doesn't allocate, so that it can run under a cache shard's
+  // mutex.
+  bool Find(const Slice& key, size_t* table, uint64_t* offset) const;
+
+ private:
+  // The prefixes the keys of table_by_prefix_ point to
+  std::vector<std::string> prefixes_;
+  std::unordered_map<Slice, size_t, SliceHasher> table_by_prefix_;
+  // The distinct sizes of the prefixes, in increasing order
+  std::vector<size_t> prefix_sizes_;
+};
+
+// Appends to *files the data blocks of `tables` that are in block_cache, one
+// BlockCacheWarmupFile per table that has any. Cache keys are matched to
+// tables by TableReader::GetBlockCacheKeyPrefix().
+extern Status CollectBlockCacheWarmupFiles(
+    Cache* block_cache, const std::vector<BlockCacheWarmupTable>& tables,
+    std::vector<BlockCacheWarmupFile>* files);
+
+// Stores in *blocks the blocks of `file` that are data blocks of reader, in
+// the order of file.blocks. A block whose offset or size doesn't match a data
+// block of the table is skipped, so that a stale list can't load anything but
+// whole data blocks into the cache.
+extern Status GetBlockCacheWarmupBlocks(
+    TableReader* reader, const BlockCacheWarmupFile& file,
+    std::vector<BlockCacheWarmupBlock>* blocks);
+
+// The contents of BlockCacheWarmupFileName() are a format version, the number
+// of files and, for each file, its column family id, file number and number
+// of blocks followed by the offset, size and priority of each block, followed
+// by the masked crc32c of everything before it.
+extern void EncodeBlockCacheWarmupFiles(
+    const std::vector<BlockCacheWarmupFile>& files, std::string* dst);
+
+extern Status DecodeBlockCacheWarmupFiles(
+    const Slice& src, std::vector<BlockCacheWarmupFile>* files);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -259,6 +259,9 @@ ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
   } else if (result.memtable_prefix_bloom_size_ratio < 0) {
     result.memtable_prefix_bloom_size_ratio = 0;
   }
+  if (!(result.write_buffer_weight > 0)) {
+    result.write_buffer_weight = 1.0;
+  }
 
   if (!result.prefix_extractor) {
     assert(result.memtable_factory);
@@ -531,6 +534,9 @@ ColumnFamilyData::ColumnFamilyData(
       queued_for_flush_(false),
       queued_for_compaction_(false),
       prev_compaction_needed_bytes_(0),
+      write_rate_sampled_(false),
+      prev_bytes_flushed_(0),
+      prev_compaction_bytes_written_(0),
       allow_2pc_(db_options.allow_2pc),
       last_memtable_id_(0),
       db_paths_registered_(false) {
@@ -563,6 +569,17 @@ ColumnFamilyData::ColumnFamilyData(
     blob_file_cache_.reset(
         new BlobFileCache(_table_cache, ioptions(), soptions(), id_,
                           internal_stats_->GetBlobFileReadHist()));
+    // A compaction filter or FIFO compaction may change values without a
+    // write, and reads with timestamps are not served from the cache. With
+    // unordered_write, a read may not see a write of a sequence number below
+    // its own, so the invalidation of the key can't tell its value is stale.
+    if (db_options.hot_key_cache_size > 0 && !db_options.unordered_write &&
+        ioptions_.compaction_style != kCompactionStyleFIFO &&
+        ioptions_.compaction_filter == nullptr &&
+        ioptions_.compaction_filter_factory == nullptr &&
+        ioptions_.user_comparator->timestamp_size() == 0) {
+      hot_key_cache_.reset(new HotKeyCache(db_options.hot_key_cache_size));
+    }
 
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
@@ -795,6 +812,38 @@ std::unique_ptr<WriteControllerToken> SetupDelay(
   return write_controller->GetDelayToken(write_rate);
 }
 
+// Returns how far the column family has moved from its slowdown triggers
+// towards its stop triggers, from 0 to 1, for smooth write throttling.
+double GetWriteStallPressure(int num_l0_files,
+                             uint64_t num_compaction_needed_bytes,
+                             const MutableCFOptions& mutable_cf_options) {
+  if (mutable_cf_options.disable_auto_compactions) {
+    return 0;
+  }
+  double pressure = 0;
+  const int l0_slowdown = mutable_cf_options.level0_slowdown_writes_trigger;
+  const int l0_stop = mutable_cf_options.level0_stop_writes_trigger;
+  if (l0_slowdown >= 0 && num_l0_files >= l0_slowdown) {
+    pressure = l0_stop > l0_slowdown
+                   ? static_cast<double>(num_l0_files - l0_slowdown) /
+                         (l0_stop - l0_slowdown)
+                   : 1.0;
+  }
+  const uint64_t soft_limit =
+      mutable_cf_options.soft_pending_compaction_bytes_limit;
+  const uint64_t hard_limit =
+      mutable_cf_options.hard_pending_compaction_bytes_limit;
+  if (soft_limit > 0 && num_compaction_needed_bytes >= soft_limit) {
+    pressure = std::max(
+        pressure, hard_limit > soft_limit
+                      ? static_cast<double>(num_compaction_needed_bytes -
+                                            soft_limit) /
+                            static_cast<double>(hard_limit - soft_limit)
+                      : 1.0);
+  }
+  return std::min(pressure, 1.0);
+}
+
 int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
                                     int level0_slowdown_writes_trigger) {
   // SanitizeOptions() ensures it.
@@ -881,8 +930,57 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
 
-    if (write_stall_condition == WriteStallCondition::kStopped &&
-        write_stall_cause == WriteStallCause::kMemtableLimit) {
+    if (write_controller->smooth_throttling()) {
+      uint64_t bytes_flushed = internal_stats_->GetBytesFlushed();
+      uint64_t compaction_bytes_written =
+          internal_stats_->GetCompactionBytesWritten();
+      if (write_rate_sampled_) {
+        write_controller->UpdateSustainableWriteRate(
+            ioptions_.env, bytes_flushed - prev_bytes_flushed_,
+            compaction_bytes_written - prev_compaction_bytes_written_,
+            static_cast<int64_t>(compaction_needed_bytes) -
+                static_cast<int64_t>(prev_compaction_needed_bytes_));
+      }
+      write_rate_sampled_ = true;
+      prev_bytes_flushed_ = bytes_flushed;
+      prev_compaction_bytes_written_ = compaction_bytes_written;
+    }
+
+    if (write_controller->smooth_throttling() &&
+        (write_stall_condition == WriteStallCondition::kDelayed ||
+         (write_stall_condition == WriteStallCondition::kStopped &&
+          write_stall_cause != WriteStallCause::kMemtableLimit))) {
+      // Pace writes instead of stopping them at the L0 file count and
+      // pending compaction bytes stop triggers.
+      double pressure = GetWriteStallPressure(
+          vstorage->l0_delay_trigger_count(), compaction_needed_bytes,
+          mutable_cf_options);
+      write_controller_token_ = write_controller->GetSmoothDelayToken(pressure);
+      switch (write_stall_cause) {
+        case WriteStallCause::kMemtableLimit:
+          internal_stats_->AddCFStats(InternalStats::MEMTABLE_LIMIT_SLOWDOWNS,
+                                      1);
+          break;
+        case WriteStallCause::kL0FileCountLimit:
+          internal_stats_->AddCFStats(
+              InternalStats::L0_FILE_COUNT_LIMIT_SLOWDOWNS, 1);
+          break;
+        default:
+          internal_stats_->AddCFStats(
+              InternalStats::PENDING_COMPACTION_BYTES_LIMIT_SLOWDOWNS, 1);
+          break;
+      }
+      write_stall_condition = WriteStallCondition::kDelayed;
+      ROCKS_LOG_WARN(
+          ioptions_.info_log,
+          "[%s] Pacing writes at rate %" PRIu64
+          " because we have %d level-0 files, %d immutable memtables and "
+          "estimated pending compaction bytes %" PRIu64 ", pressure %.2f",
+          name_.c_str(), write_controller->delayed_write_rate(),
+          vstorage->l0_delay_trigger_count(), imm()->NumNotFlushed(),
+          compaction_needed_bytes, pressure);
+    } else if (write_stall_condition == WriteStallCondition::kStopped &&
+               write_stall_cause == WriteStallCause::kMemtableLimit) {
       write_controller_token_ = write_controller->GetStopToken();
       internal_stats_->AddCFStats(InternalStats::MEMTABLE_LIMIT_STOPS, 1);
       ROCKS_LOG_WARN(
@@ -1007,10 +1105,14 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       // If the DB recovers from delay conditions, we reward with reducing
       // double the slowdown ratio. This is to balance the long term slowdown
       // increase signal.
+      // With smooth throttling, the pressure of the column families that
+      // still need a delay sets the rate instead.
       if (needed_delay) {
         uint64_t write_rate = write_controller->delayed_write_rate();
-        write_controller->set_delayed_write_rate(static_cast<uint64_t>(
-            static_cast<double>(write_rate) * kDelayRecoverSlowdownRatio));
+        if (!write_controller->smooth_throttling()) {
+          write_controller->set_delayed_write_rate(static_cast<uint64_t>(
+              static_cast<double>(write_rate) * kDelayRecoverSlowdownRatio));
+        }
         // Set the low pri limit to be 1/4 the delayed write rate.
         // Note we don't reset this value even after delay condition is relased.
         // Low-pri rate will continue to apply if there is a compaction
@@ -14,6 +14,7 @@
 #include <vector>
 #include <atomic>
 
+#include "db/hot_key_cache.h"
 #include "db/memtable_list.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
@@ -383,6 +384,8 @@ class ColumnFamilyData {
 
   TableCache* table_cache() const { return table_cache_.get(); }
   BlobFileCache* blob_file_cache() const { return blob_file_cache_.get(); }
+  // nullptr unless DBOptions::hot_key_cache_size is set
+  HotKeyCache* hot_key_cache() const { return hot_key_cache_.get(); }
 
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
@@ -547,6 +550,7 @@ class ColumnFamilyData {
 
   std::unique_ptr<TableCache> table_cache_;
   std::unique_ptr<BlobFileCache> blob_file_cache_;
+  std::unique_ptr<HotKeyCache> hot_key_cache_;
 
   std::unique_ptr<InternalStats> internal_stats_;
 
@@ -595,6 +599,12 @@ class ColumnFamilyData {
 
   uint64_t prev_compaction_needed_bytes_;
 
+  // The background work of the column family that was last fed to the
+  // sustainable write rate estimate of smooth write throttling.
+  bool write_rate_sampled_;
+  uint64_t prev_bytes_flushed_;
+  uint64_t prev_compaction_bytes_written_;
+
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
 
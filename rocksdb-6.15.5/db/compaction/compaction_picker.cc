@@ -80,6 +80,25 @@ bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
     }
     compact_bytes_per_del_file = new_compact_bytes_per_del_file;
   }
+  // The sequence number ranges of the files of a partitioned flush overlap,
+  // since their keys were written interleaved. Only stop
+  // in front of a file that is older than every picked file; otherwise the
+  // output could overlap it in both key and sequence number range. Ingested
+  // files have a single sequence number and are already ordered against
+  // their neighbors.
+  while (limit > start + 1 && limit < level_files.size()) {
+    const FileMetaData* next = level_files[limit];
+    SequenceNumber smallest_picked_seqno = kMaxSequenceNumber;
+    for (size_t i = start; i < limit; ++i) {
+      smallest_picked_seqno =
+          std::min(smallest_picked_seqno, level_files[i]->fd.smallest_seqno);
+    }
+    if (next->fd.smallest_seqno == next->fd.largest_seqno ||
+        next->fd.largest_seqno <= smallest_picked_seqno) {
+      break;
+    }
+    --limit;
+  }
 
   if ((limit - start) >= min_files_to_compact &&
       compact_bytes_per_del_file < max_compact_bytes_per_del_file) {
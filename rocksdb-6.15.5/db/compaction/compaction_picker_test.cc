@@ -1852,6 +1852,40 @@ TEST_F(CompactionPickerTest, IntraL0ForEarliestSeqno) {
   ASSERT_EQ(0, compaction->output_level());
 }
 
+TEST_F(CompactionPickerTest, IntraL0KeepsFlushPartitionsTogether) {
+  // Intra L0 compaction triggers only if there are at least
+  // level0_file_num_compaction_trigger + 2 L0 files.
+  mutable_cf_options_.level0_file_num_compaction_trigger = 3;
+  mutable_cf_options_.max_compaction_bytes = 1199999u;
+  NewVersionStorage(6, kCompactionStyleLevel);
+
+  // max_compaction_bytes would allow 5 files, but the 5th one is one of the
+  // two partitions of a flush, whose sequence number ranges overlap. Picking
+  // only one of them is not allowed, so 4 files are picked. The one L1 file
+  // spans entire L0 key range and is marked as being compacted to avoid
+  // L0->L1 compaction.
+  Add(0, 1U, "100", "150", 200000U, 0, 130, 131);
+  Add(0, 2U, "151", "200", 200000U, 0, 126, 127);
+  Add(0, 3U, "201", "250", 200000U, 0, 122, 123);
+  Add(0, 4U, "251", "300", 200000U, 0, 118, 119);
+  Add(0, 5U, "100", "200", 200000U, 0, 100, 110);
+  Add(0, 6U, "201", "350", 200000U, 0, 101, 109);
+  Add(1, 7U, "100", "350", 200000U, 0, 50, 60);
+  vstorage_->LevelFiles(1)[0]->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_levels());
+  ASSERT_EQ(4U, compaction->num_input_files(0));
+  ASSERT_EQ(4U, compaction->input(0, 3)->fd.GetNumber());
+  ASSERT_EQ(CompactionReason::kLevelL0FilesNum,
+            compaction->compaction_reason());
+  ASSERT_EQ(0, compaction->output_level());
+}
+
 #ifndef ROCKSDB_LITE
 TEST_F(CompactionPickerTest, UniversalMarkedCompactionFullOverlap) {
   const uint64_t kFileSize = 100000;
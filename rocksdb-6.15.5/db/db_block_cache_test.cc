@@ -9,8 +9,11 @@
 #include <cstdlib>
 
 #include "cache/lru_cache.h"
+#include "db/block_cache_warmup.h"
 #include "db/db_test_util.h"
+#include "file/filename.h"
 #include "port/stack_trace.h"
+#include "table/block_based/block_based_table_reader.h"
 #include "util/compression.h"
 #include "util/random.h"
 
@@ -226,6 +229,51 @@ TEST_F(DBBlockCacheTest, TestWithoutCompressedBlockCache) {
   }
 }
 
+TEST_F(DBBlockCacheTest, TestWithCompressedSecondaryCache) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+
+  CompressionType compression_type = kNoCompression;
+  for (CompressionType type : GetSupportedCompressions()) {
+    if (type != kNoCompression) {
+      compression_type = type;
+      break;
+    }
+  }
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
+          1 << 20, 0 /*num_shard_bits*/, compression_type));
+  ASSERT_NE(nullptr, secondary_cache);
+  // With no capacity, every block is evicted once its last reader releases
+  // it.
+  LRUCacheOptions cache_opts(0, 0 /*num_shard_bits*/,
+                             false /*strict_capacity_limit*/,
+                             0.0 /*high_pri_pool_ratio*/);
+  cache_opts.secondary_cache = secondary_cache;
+  table_options.block_cache = NewLRUCache(cache_opts);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(kValueSize, 'a');
+  uint64_t misses = TestGetTickerCount(options, SECONDARY_CACHE_MISSES);
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(misses + kNumBlocks,
+            TestGetTickerCount(options, SECONDARY_CACHE_MISSES));
+  ASSERT_EQ(0, TestGetTickerCount(options, SECONDARY_CACHE_HITS));
+
+  // The blocks are read back from the secondary cache, which counts as block
+  // cache hits.
+  RecordCacheCounters(options);
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(kNumBlocks, TestGetTickerCount(options, SECONDARY_CACHE_HITS));
+  CheckCacheCounters(options, 0, kNumBlocks, 0, 0);
+}
+
 #ifdef SNAPPY
 TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
   ReadOptions read_options;
@@ -456,6 +504,18 @@ class MockCache : public LRUCache {
     }
     return LRUCache::Insert(key, value, charge, deleter, handle, priority);
   }
+
+  Status InsertWithHelper(const Slice& key, void* value,
+                          const CacheItemHelper* helper, size_t charge,
+                          Handle** handle, Priority priority) override {
+    if (priority == Priority::LOW) {
+      low_pri_insert_count++;
+    } else {
+      high_pri_insert_count++;
+    }
+    return LRUCache::InsertWithHelper(key, value, helper, charge, handle,
+                                      priority);
+  }
 };
 
 uint32_t MockCache::high_pri_insert_count = 0;
@@ -697,6 +757,248 @@ TEST_F(DBBlockCacheTest, ParanoidFileChecks) {
             TestGetTickerCount(options, BLOCK_CACHE_ADD));
 }
 
+TEST_F(DBBlockCacheTest, IteratorReadaheadIntoBlockCache) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  Options options = GetOptions(table_options);
+  DestroyAndReopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  // Start with an empty block cache.
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  uint64_t hits = TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT);
+
+  ReadOptions read_options;
+  read_options.block_cache_readahead_blocks = 4;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  size_t num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    num_keys++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumBlocks, num_keys);
+  // The first two blocks are read on their own, the others are read ahead
+  // into the block cache and found there.
+  ASSERT_EQ(misses + kNumBlocks,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(hits + kNumBlocks - 2,
+            TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  iter.reset();
+
+  // The blocks read ahead serve point lookups.
+  misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+}
+
+TEST_F(DBBlockCacheTest, IteratorReadaheadIntoBlockCacheTier) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  Options options = GetOptions(table_options);
+  DestroyAndReopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  // Start with an empty block cache.
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  env_->count_random_reads_ = true;
+  Reopen(options);
+  // Cache the first blocks, so that the iterator gets far enough to read
+  // ahead.
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  env_->random_read_counter_.Reset();
+
+  // A block cache tier read doesn't read ahead, as that would be IO.
+  ReadOptions read_options;
+  read_options.block_cache_readahead_blocks = 4;
+  read_options.read_tier = kBlockCacheTier;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  size_t num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    num_keys++;
+  }
+  ASSERT_TRUE(iter->status().IsIncomplete());
+  ASSERT_EQ(3, num_keys);
+  ASSERT_EQ(0, env_->random_read_counter_.Read());
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBBlockCacheTest, WarmUpBlockCacheOnOpen) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  Options options = GetOptions(table_options);
+  options.block_cache_warmup_period_sec = 3600;
+  DestroyAndReopen(options);
+
+  std::string value(kValueSize, 'a');
+  InitTable(options);
+  ASSERT_OK(Flush());
+  // Cache the data blocks of the first half of the keys.
+  const size_t kNumHot = kNumBlocks / 2;
+  for (size_t i = 0; i < kNumHot; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  // Closing the DB saves the cached blocks.
+  Close();
+  ASSERT_OK(env_->FileExists(BlockCacheWarmupFileName(dbname_)));
+
+  // Reopen with an empty block cache, as after a restart.
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  options = GetOptions(table_options);
+  options.block_cache_warmup_period_sec = 3600;
+  std::shared_ptr<RateLimiter> rate_limiter(NewGenericRateLimiter(
+      1 << 30 /* rate_bytes_per_sec */, 100 * 1000 /* refill_period_us */,
+      10 /* fairness */, RateLimiter::Mode::kReadsOnly));
+  options.block_cache_warmup_rate_limiter = rate_limiter;
+  Reopen(options);
+  dbfull()->TEST_WaitForBlockCacheWarmup();
+  ASSERT_EQ(kNumHot, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+  ASSERT_GT(rate_limiter->GetTotalBytesThrough(), 0);
+
+  // The blocks of the hot keys are already cached.
+  uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  for (size_t i = 0; i < kNumHot; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(kNumHot, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  ASSERT_EQ(value, Get(ToString(kNumBlocks - 1)));
+  ASSERT_EQ(misses + 1, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+
+  // A list that doesn't match the file is ignored.
+  Close();
+  ASSERT_OK(WriteStringToFile(env_, "garbage",
+                              BlockCacheWarmupFileName(dbname_)));
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  options = GetOptions(table_options);
+  options.block_cache_warmup_period_sec = 3600;
+  Reopen(options);
+  dbfull()->TEST_WaitForBlockCacheWarmup();
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+  ASSERT_EQ(value, Get(ToString(0)));
+}
+
+TEST_F(DBBlockCacheTest, WarmUpBlockCacheKeepsPriority) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  Options options = GetOptions(table_options);
+  options.block_cache_warmup_period_sec = 3600;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // Two files, so that the warm-up job reschedules itself once the first
+  // one is loaded.
+  std::string value(kValueSize, 'a');
+  InitTable(options);
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("x", value));
+  ASSERT_OK(Flush());
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(value, Get("x"));
+  Close();
+
+  // Make every other saved block a high priority one.
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  std::string data;
+  ASSERT_OK(ReadFileToString(env_, fname, &data));
+  std::vector<BlockCacheWarmupFile> files;
+  ASSERT_OK(DecodeBlockCacheWarmupFiles(data, &files));
+  ASSERT_EQ(2, files.size());
+  size_t num_blocks = 0;
+  size_t num_high = 0;
+  for (auto& file : files) {
+    for (auto& block : file.blocks) {
+      if (num_blocks++ % 2 == 0) {
+        block.priority = Cache::Priority::HIGH;
+        num_high++;
+      }
+    }
+  }
+  ASSERT_EQ(kNumBlocks + 1, num_blocks);
+  data.clear();
+  EncodeBlockCacheWarmupFiles(files, &data);
+  ASSERT_OK(WriteStringToFile(env_, data, fname));
+
+  table_options.block_cache =
+      NewLRUCache(1 << 20, 0 /* num_shard_bits */,
+                  false /* strict_capacity_limit */, 0.5 /* high_pri_ratio */);
+  options = GetOptions(table_options);
+  options.block_cache_warmup_period_sec = 3600;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  dbfull()->TEST_WaitForBlockCacheWarmup();
+  ASSERT_EQ(kNumBlocks + 1, TestGetTickerCount(options, BLOCK_CACHE_DATA_ADD));
+
+  size_t high = 0;
+  table_options.block_cache->ApplyToAllCacheKeys(
+      [&](const Slice& /*key*/, size_t /*charge*/, Cache::Priority priority,
+          const Cache::CacheItemHelper* helper) {
+        if (BlockBasedTable::GetCachedBlockType(helper) == BlockType::kData &&
+            priority == Cache::Priority::HIGH) {
+          high++;
+        }
+      });
+  ASSERT_EQ(num_high, high);
+}
+
+TEST_F(DBBlockCacheTest, BlockCacheStatsProperty) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.cache_index_and_filter_blocks = true;
+  LRUCacheOptions cache_opts(1 << 20, 1 /* num_shard_bits */,
+                             false /* strict_capacity_limit */,
+                             0.0 /* high_pri_pool_ratio */);
+  cache_opts.collect_shard_stats = true;
+  table_options.block_cache = NewLRUCache(cache_opts);
+  Options options = GetOptions(table_options);
+  DestroyAndReopen(options);
+
+  std::string value(kValueSize, 'a');
+  InitTable(options);
+  ASSERT_OK(Flush());
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  // An entry that isn't a block of this DB.
+  ASSERT_OK(table_options.block_cache->Insert("foo", nullptr, 10, nullptr));
+
+  std::map<std::string, std::string> stats;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kBlockCacheStats, &stats));
+  ASSERT_EQ(ToString(1 << 20), stats["capacity"]);
+  ASSERT_EQ(ToString(table_options.block_cache->GetUsage()), stats["usage"]);
+  ASSERT_EQ("3", stats["cf.default.data.count"]);
+  ASSERT_EQ("1", stats["cf.default.index.count"]);
+  ASSERT_EQ("1", stats["other.other.count"]);
+  ASSERT_EQ("10", stats["other.other.usage"]);
+  uint64_t lookups = 0;
+  for (int i = 0; i < 2; i++) {
+    const std::string prefix = "shard." + ToString(i) + ".";
+    ASSERT_EQ(1, stats.count(prefix + "mutex-wait-nanos"));
+    lookups += ParseUint64(stats[prefix + "lookups"]);
+  }
+  ASSERT_GE(lookups, 3);
+  ASSERT_EQ(0, stats.count("shard.2.lookups"));
+
+  // The string form of the property has a line per entry of the map
+  std::string str;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kBlockCacheStats, &str));
+  ASSERT_NE(std::string::npos, str.find("cf.default.data.count=3\n"));
+  ASSERT_NE(std::string::npos, str.find("other.other.usage=10\n"));
+}
+#endif  // ROCKSDB_LITE
+
 TEST_F(DBBlockCacheTest, CompressedCache) {
   if (!Snappy_Supported()) {
     return;
@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <algorithm>
 #include <atomic>
 
 #include "db/db_impl/db_impl.h"
@@ -524,6 +525,206 @@ TEST_F(DBFlushTest, FlushWithBlob) {
 #endif  // ROCKSDB_LITE
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBFlushTest, PartitionedFlush) {
+  Options options = CurrentOptions();
+  options.max_flush_partitions = 4;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  // Two versions of each key, kept apart by a snapshot.
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v1_" + Key(i)));
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v2_" + Key(i)));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(4, files.size());
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  ASSERT_EQ(Key(0), files[0].smallestkey);
+  ASSERT_EQ(Key(99), files[3].largestkey);
+  for (size_t i = 0; i < files.size(); i++) {
+    ASSERT_EQ(0, files[i].level);
+    ASSERT_EQ(50, files[i].num_entries);
+    if (i > 0) {
+      ASSERT_LT(files[i - 1].largestkey, files[i].smallestkey);
+    }
+  }
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ("v2_" + Key(i), Get(Key(i)));
+    ASSERT_EQ("v1_" + Key(i), Get(Key(i), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // A memtable with a range deletion is flushed to a single file.
+  ASSERT_OK(Put(Key(0), "v3"));
+  ASSERT_OK(Put(Key(99), "v3"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(10), Key(20)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("5", FilesPerLevel());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  for (int i = 0; i < 100; i++) {
+    if (i == 0 || i == 99) {
+      ASSERT_EQ("v3", Get(Key(i)));
+    } else if (i >= 10 && i < 20) {
+      ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+    } else {
+      ASSERT_EQ("v2_" + Key(i), Get(Key(i)));
+    }
+  }
+}
+
+// Flush partitions with a single entry each, i.e. a single sequence number,
+// and the listeners hearing about every file.
+TEST_F(DBFlushTest, PartitionedFlushSingleEntryPartitions) {
+  class TestListener : public EventListener {
+   public:
+    void OnFlushCompleted(DB* /*db*/, const FlushJobInfo& info) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      file_numbers.push_back(info.file_number);
+      num_entries += info.table_properties.num_entries;
+    }
+
+    std::mutex mutex_;
+    std::vector<uint64_t> file_numbers;
+    uint64_t num_entries = 0;
+  };
+  auto listener = std::make_shared<TestListener>();
+
+  Options options = CurrentOptions();
+  options.max_flush_partitions = 4;
+  options.disable_auto_compactions = true;
+  options.listeners.push_back(listener);
+  Reopen(options);
+
+  const int kNumFlushes = 3;
+  for (int f = 0; f < kNumFlushes; f++) {
+    for (int i = 0; i < 4; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(f)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(ToString(4 * kNumFlushes), FilesPerLevel());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  std::sort(listener->file_numbers.begin(), listener->file_numbers.end());
+  ASSERT_EQ(files.size(), listener->file_numbers.size());
+  for (const auto& file : files) {
+    ASSERT_EQ(1, file.num_entries);
+    ASSERT_EQ(file.smallest_seqno, file.largest_seqno);
+    ASSERT_TRUE(std::binary_search(listener->file_numbers.begin(),
+                                   listener->file_numbers.end(),
+                                   file.file_number));
+  }
+  ASSERT_EQ(4 * kNumFlushes, listener->num_entries);
+
+  // The L0 files pass the consistency checks of recovery and compaction.
+  Reopen(options);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ("v" + ToString(kNumFlushes - 1), Get(Key(i)));
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ("v" + ToString(kNumFlushes - 1), Get(Key(i)));
+  }
+}
+
+// The files of a partitioned flush keep the sequence number ranges of their
+// own entries, which overlap, and are compacted together with other L0
+// files whose key ranges overlap theirs.
+TEST_F(DBFlushTest, PartitionedFlushOverlappingSeqnos) {
+  Options options = CurrentOptions();
+  options.max_flush_partitions = 2;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  // Alternate between the two halves of the keys, so that the sequence
+  // number ranges of the two partitions overlap.
+  for (int i = 0; i < 50; i++) {
+    ASSERT_OK(Put(Key(i), "v1"));
+    ASSERT_OK(Put(Key(99 - i), "v1"));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2, files.size());
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  ASSERT_EQ(Key(49), files[0].largestkey);
+  ASSERT_EQ(Key(50), files[1].smallestkey);
+  ASSERT_EQ(1, files[0].smallest_seqno);
+  ASSERT_EQ(99, files[0].largest_seqno);
+  ASSERT_EQ(2, files[1].smallest_seqno);
+  ASSERT_EQ(100, files[1].largest_seqno);
+
+  // Newer partitioned flushes that overlap the first one, and a snapshot
+  // that keeps the old values.
+  const Snapshot* snapshot = db_->GetSnapshot();
+  for (int i = 40; i < 60; i++) {
+    ASSERT_OK(Put(Key(i), "v2"));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "v3"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(6, NumTableFilesAtLevel(0));
+
+  auto check = [&]() {
+    for (int i = 0; i < 100; i++) {
+      std::string expected = "v1";
+      if (i < 10) {
+        expected = "v3";
+      } else if (i >= 40 && i < 60) {
+        expected = "v2";
+      }
+      ASSERT_EQ(expected, Get(Key(i)));
+      ASSERT_EQ("v1", Get(Key(i), snapshot));
+    }
+  };
+  check();
+
+  // Compact the L0 files that overlap the first keys, then reopen to run the
+  // consistency checks on what is left in L0.
+  std::string begin = Key(0);
+  std::string end = Key(5);
+  Slice begin_slice(begin);
+  Slice end_slice(end);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), &begin_slice, &end_slice));
+  ASSERT_LT(NumTableFilesAtLevel(0), 6);
+  check();
+  db_->ReleaseSnapshot(snapshot);
+  snapshot = nullptr;
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i < 10 ? "v3" : (i >= 40 && i < 60 ? "v2" : "v1"), Get(Key(i)));
+  }
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i < 10 ? "v3" : (i >= 40 && i < 60 ? "v2" : "v1"), Get(Key(i)));
+  }
+}
+#endif  // ROCKSDB_LITE
+
 class DBFlushTestBlobError : public DBFlushTest,
                              public testing::WithParamInterface<std::string> {
  public:
@@ -86,6 +86,7 @@
 #include "rocksdb/write_buffer_manager.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
+#include "table/block_based/block_based_table_reader.h"
 #include "table/get_context.h"
 #include "table/merging_iterator.h"
 #include "table/multiget_context.h"
@@ -175,6 +176,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       log_empty_(true),
       persist_stats_cf_handle_(nullptr),
       log_sync_cv_(&mutex_),
+      wal_synced_seq_(0),
       total_log_size_(0),
       is_snapshot_supported_(true),
       write_buffer_manager_(immutable_db_options_.write_buffer_manager.get()),
@@ -190,6 +192,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_block_cache_warmup_scheduled_(0),
       disable_delete_obsolete_files_(0),
       pending_purge_obsolete_files_(0),
       delete_obsolete_files_last_run_(env_->NowMicros()),
@@ -250,6 +253,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   co.metadata_charge_policy = kDontChargeCacheMetadata;
   table_cache_ = NewLRUCache(co);
 
+  write_controller_.set_smooth_throttling(
+      immutable_db_options_.smooth_write_throttling);
   versions_.reset(new VersionSet(dbname_, &immutable_db_options_, file_options_,
                                  table_cache_.get(), write_buffer_manager_,
                                  &write_controller_, &block_cache_tracer_,
@@ -502,6 +507,12 @@ Status DBImpl::CloseHelper() {
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
+#ifndef ROCKSDB_LITE
+  if (opened_successfully_ &&
+      immutable_db_options_.block_cache_warmup_period_sec > 0) {
+    SaveBlockCacheWarmupFile();
+  }
+#endif  // !ROCKSDB_LITE
   int bottom_compactions_unscheduled =
       env_->UnSchedule(this, Env::Priority::BOTTOM);
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
@@ -515,7 +526,7 @@ Status DBImpl::CloseHelper() {
   // Wait for background work to finish
   while (bg_bottom_compaction_scheduled_ || bg_compaction_scheduled_ ||
          bg_flush_scheduled_ || bg_purge_scheduled_ ||
-         pending_purge_obsolete_files_ ||
+         bg_block_cache_warmup_scheduled_ || pending_purge_obsolete_files_ ||
          error_handler_.IsRecoveryInProgress()) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
@@ -699,7 +710,8 @@ void DBImpl::StartPeriodicWorkScheduler() {
 
   periodic_work_scheduler_->Register(
       this, mutable_db_options_.stats_dump_period_sec,
-      mutable_db_options_.stats_persist_period_sec);
+      mutable_db_options_.stats_persist_period_sec,
+      immutable_db_options_.block_cache_warmup_period_sec);
 #endif  // !ROCKSDB_LITE
 }
 
@@ -923,6 +935,263 @@ void DBImpl::FlushInfoLog() {
   LogFlush(immutable_db_options_.info_log);
 }
 
+void DBImpl::RefOpenTablesByBlockCache(OpenTablesByBlockCache* tables) {
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->IsDropped() && cfd->initialized()) {
+        cfd->Ref();
+        tables->cfds.push_back(cfd);
+      }
+    }
+  }
+
+  for (auto cfd : tables->cfds) {
+    const auto* table_options =
+        cfd->ioptions()->table_factory->GetOptions<BlockBasedTableOptions>();
+    if (table_options == nullptr || table_options->block_cache == nullptr) {
+      continue;
+    }
+    SuperVersion* sv = GetAndRefSuperVersion(cfd);
+    tables->super_versions.emplace_back(cfd, sv);
+    auto& cache_tables = tables->tables[table_options->block_cache.get()];
+    const VersionStorageInfo* vstorage = sv->current->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); ++level) {
+      for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+        // A table that isn't open has no blocks in the cache under its
+        // current key prefix.
+        Cache::Handle* handle = nullptr;
+        Status s = cfd->table_cache()->FindTable(
+            ReadOptions(), file_options_, cfd->internal_comparator(), f->fd,
+            &handle, sv->mutable_cf_options.prefix_extractor.get(),
+            true /* no_io */);
+        if (!s.ok()) {
+          continue;
+        }
+        tables->table_handles.emplace_back(cfd->table_cache(), handle);
+        cache_tables.push_back(
+            {cfd->GetID(), f->fd.GetNumber(),
+             cfd->table_cache()->GetTableReaderFromHandle(handle)});
+      }
+    }
+  }
+}
+
+void DBImpl::UnrefOpenTablesByBlockCache(OpenTablesByBlockCache* tables) {
+  for (const auto& table_handle : tables->table_handles) {
+    table_handle.first->ReleaseHandle(table_handle.second);
+  }
+  for (const auto& cfd_and_sv : tables->super_versions) {
+    ReturnAndCleanupSuperVersion(cfd_and_sv.first, cfd_and_sv.second);
+  }
+  InstrumentedMutexLock l(&mutex_);
+  for (auto cfd : tables->cfds) {
+    cfd->UnrefAndTryDelete();
+  }
+}
+
+void DBImpl::SaveBlockCacheWarmupFile() {
+  {
+    InstrumentedMutexLock l(&mutex_);
+    // Don't replace the list with a partial one while the block cache is
+    // still being warmed up from it.
+    if (bg_block_cache_warmup_scheduled_ > 0) {
+      return;
+    }
+  }
+
+  // Column families may share a block cache, so collect the open tables of
+  // each block cache and go through its keys once.
+  OpenTablesByBlockCache tables;
+  RefOpenTablesByBlockCache(&tables);
+  std::vector<BlockCacheWarmupFile> files;
+  Status s;
+  for (const auto& cache_and_tables : tables.tables) {
+    s = CollectBlockCacheWarmupFiles(cache_and_tables.first,
+                                     cache_and_tables.second, &files);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  UnrefOpenTablesByBlockCache(&tables);
+
+  size_t num_blocks = 0;
+  if (s.ok()) {
+    // Warm up the files with the most cached blocks first.
+    std::stable_sort(files.begin(), files.end(),
+                     [](const BlockCacheWarmupFile& a,
+                        const BlockCacheWarmupFile& b) {
+                       return a.blocks.size() > b.blocks.size();
+                     });
+    for (const auto& file : files) {
+      num_blocks += file.blocks.size();
+    }
+    std::string data;
+    EncodeBlockCacheWarmupFiles(files, &data);
+    const std::string fname = BlockCacheWarmupFileName(dbname_);
+    const std::string tmp = fname + "." + kTempFileNameSuffix;
+    s = WriteStringToFile(env_, data, tmp, true /* should_sync */);
+    if (s.ok()) {
+      s = env_->RenameFile(tmp, fname);
+    }
+    if (!s.ok()) {
+      env_->DeleteFile(tmp).PermitUncheckedError();
+    }
+  }
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Saved %" ROCKSDB_PRIszt " blocks of %" ROCKSDB_PRIszt
+                   " files for block cache warm-up",
+                   num_blocks, files.size());
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Failed to save blocks for block cache warm-up: %s",
+                   s.ToString().c_str());
+  }
+  TEST_SYNC_POINT("DBImpl::SaveBlockCacheWarmupFile:Done");
+}
+
+void DBImpl::ScheduleBlockCacheWarmup() {
+  if (immutable_db_options_.block_cache_warmup_period_sec == 0) {
+    return;
+  }
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  Status s = env_->FileExists(fname);
+  if (s.IsNotFound()) {
+    return;
+  }
+  std::string data;
+  std::vector<BlockCacheWarmupFile> files;
+  if (s.ok()) {
+    s = ReadFileToString(env_, fname, &data);
+  }
+  if (s.ok()) {
+    s = DecodeBlockCacheWarmupFiles(data, &files);
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Skipping block cache warm-up: %s", s.ToString().c_str());
+    return;
+  }
+
+  InstrumentedMutexLock l(&mutex_);
+  for (auto& file : files) {
+    block_cache_warmup_queue_.push_back(std::move(file));
+  }
+  // The jobs share the LOW pool with compactions. Warm up at most as many
+  // files at a time as compactions may run, and leave at least one thread of
+  // the pool to them.
+  const int low_threads = env_->GetBackgroundThreads(Env::Priority::LOW);
+  size_t num_jobs = std::min(
+      {static_cast<size_t>(GetBGJobLimits().max_compactions),
+       static_cast<size_t>(std::max(low_threads - 1, 1)),
+       block_cache_warmup_queue_.size()});
+  for (size_t i = 0; i < num_jobs; ++i) {
+    bg_block_cache_warmup_scheduled_++;
+    env_->Schedule(&DBImpl::BGWorkBlockCacheWarmup, this, Env::Priority::LOW,
+                   nullptr);
+  }
+}
+
+void DBImpl::BGWorkBlockCacheWarmup(void* db) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  reinterpret_cast<DBImpl*>(db)->BackgroundCallBlockCacheWarmup();
+}
+
+void DBImpl::BackgroundCallBlockCacheWarmup() {
+  InstrumentedMutexLock l(&mutex_);
+  // Warm up a single file, then go to the back of the LOW pool queue, so
+  // that compactions scheduled meanwhile don't wait for the whole warm-up.
+  while (!block_cache_warmup_queue_.empty() &&
+         !shutting_down_.load(std::memory_order_acquire)) {
+    BlockCacheWarmupFile file = std::move(block_cache_warmup_queue_.front());
+    block_cache_warmup_queue_.pop_front();
+    ColumnFamilyData* cfd = versions_->GetColumnFamilySet()->GetColumnFamily(
+        file.column_family_id);
+    if (cfd == nullptr || cfd->IsDropped() || !cfd->initialized()) {
+      continue;
+    }
+    cfd->Ref();
+    mutex_.Unlock();
+    Status s = WarmUpBlockCacheFile(cfd, file);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Block cache warm-up of file %" PRIu64 " failed: %s",
+                     file.file_number, s.ToString().c_str());
+    }
+    mutex_.Lock();
+    cfd->UnrefAndTryDelete();
+    break;
+  }
+  if (shutting_down_.load(std::memory_order_acquire)) {
+    block_cache_warmup_queue_.clear();
+  }
+  if (!block_cache_warmup_queue_.empty()) {
+    // Still counted in bg_block_cache_warmup_scheduled_
+    env_->Schedule(&DBImpl::BGWorkBlockCacheWarmup, this, Env::Priority::LOW,
+                   nullptr);
+    return;
+  }
+  bg_block_cache_warmup_scheduled_--;
+  bg_cv_.SignalAll();
+}
+
+Status DBImpl::WarmUpBlockCacheFile(ColumnFamilyData* cfd,
+                                    const BlockCacheWarmupFile& file) {
+  // Blocks are loaded a few at a time so that shutdown doesn't wait for a
+  // whole file.
+  const size_t kBlocksPerBatch = 16;
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  const VersionStorageInfo* vstorage = sv->current->storage_info();
+  const FileMetaData* meta = nullptr;
+  int file_level = -1;
+  for (int level = 0; meta == nullptr && level < vstorage->num_levels();
+       ++level) {
+    for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+      if (f->fd.GetNumber() == file.file_number) {
+        meta = f;
+        file_level = level;
+        break;
+      }
+    }
+  }
+
+  // The file may have been compacted away since the list was saved.
+  Status s;
+  if (meta != nullptr) {
+    Cache::Handle* handle = nullptr;
+    s = cfd->table_cache()->FindTable(
+        ReadOptions(), file_options_, cfd->internal_comparator(), meta->fd,
+        &handle, sv->mutable_cf_options.prefix_extractor.get(),
+        false /* no_io */, true /* record_read_stats */,
+        nullptr /* file_read_hist */, false /* skip_filters */, file_level);
+    if (s.ok()) {
+      TableReader* reader =
+          cfd->table_cache()->GetTableReaderFromHandle(handle);
+      std::vector<BlockCacheWarmupBlock> blocks;
+      s = GetBlockCacheWarmupBlocks(reader, file, &blocks);
+      RateLimiter* rate_limiter =
+          immutable_db_options_.block_cache_warmup_rate_limiter.get();
+      std::vector<BlockHandle> batch;
+      for (size_t i = 0; s.ok() && i < blocks.size() &&
+                         !shutting_down_.load(std::memory_order_acquire);) {
+        // A batch of blocks of the same priority
+        const Cache::Priority priority = blocks[i].priority;
+        batch.clear();
+        for (; i < blocks.size() && batch.size() < kBlocksPerBatch &&
+               blocks[i].priority == priority;
+             ++i) {
+          batch.push_back(blocks[i].handle);
+        }
+        s = reader->WarmUpBlockCache(batch, priority, rate_limiter);
+      }
+      cfd->table_cache()->ReleaseHandle(handle);
+    }
+  }
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  return s;
+}
+
 Status DBImpl::TablesRangeTombstoneSummary(ColumnFamilyHandle* column_family,
                                            int max_entries_to_print,
                                            std::string* out_str) {
@@ -1103,7 +1372,8 @@ Status DBImpl::SetDBOptions(
         periodic_work_scheduler_->Unregister(this);
         periodic_work_scheduler_->Register(
             this, new_options.stats_dump_period_sec,
-            new_options.stats_persist_period_sec);
+            new_options.stats_persist_period_sec,
+            immutable_db_options_.block_cache_warmup_period_sec);
         mutex_.Lock();
       }
       write_controller_.set_max_delayed_write_rate(
@@ -1219,10 +1489,16 @@ Status DBImpl::FlushWAL(bool sync) {
   return SyncWAL();
 }
 
-Status DBImpl::SyncWAL() {
+Status DBImpl::SyncWAL() { return SyncWALImpl(kMaxSequenceNumber); }
+
+Status DBImpl::SyncWALImpl(SequenceNumber wait_for_seq) {
+  if (immutable_db_options_.wal_streams > 1) {
+    return SyncWALStreams(wait_for_seq);
+  }
   autovector<log::Writer*, 1> logs_to_sync;
   bool need_log_dir_sync;
   uint64_t current_log_number;
+  SequenceNumber synced_seq;
 
   {
     InstrumentedMutexLock l(&mutex_);
@@ -1233,8 +1509,18 @@ Status DBImpl::SyncWAL() {
 
     while (logs_.front().number <= current_log_number &&
            logs_.front().getting_synced) {
+      if (wait_for_seq <= wal_synced_seq_) {
+        break;
+      }
       log_sync_cv_.Wait();
     }
+    if (wait_for_seq != kMaxSequenceNumber && wait_for_seq <= wal_synced_seq_) {
+      RecordTick(stats_, WAL_FILE_SYNC_SHARED);
+      return Status::OK();
+    }
+    // Records up to the last sequence number have been handed to the WAL
+    // files, so the sync below covers them.
+    synced_seq = versions_->LastSequence();
     // First check that logs are safe to sync in background.
     for (auto it = logs_.begin();
          it != logs_.end() && it->number <= current_log_number; ++it) {
@@ -1285,6 +1571,11 @@ Status DBImpl::SyncWAL() {
     InstrumentedMutexLock l(&mutex_);
     if (status.ok()) {
       status = MarkLogsSynced(current_log_number, need_log_dir_sync);
+      if (status.ok()) {
+        // Threads woken up by MarkLogsSynced() can only observe this after
+        // the mutex is released.
+        wal_synced_seq_ = std::max(wal_synced_seq_, synced_seq);
+      }
     } else {
       MarkLogsNotSynced(current_log_number);
     }
@@ -1294,6 +1585,80 @@ Status DBImpl::SyncWAL() {
   return status;
 }
 
+// A record is durable once every log that may hold a record up to its
+// sequence number was synced past it. Each pass picks one such log that no
+// other thread is syncing, so that concurrent callers sync different logs,
+// and waits for the other threads if there is none.
+Status DBImpl::SyncWALStreams(SequenceNumber wait_for_seq) {
+  InstrumentedMutexLock l(&mutex_);
+  if (wait_for_seq == kMaxSequenceNumber) {
+    wait_for_seq = versions_->LastSequence();
+  }
+  bool shared = true;
+  while (true) {
+    LogWriterNumber* log_to_sync = nullptr;
+    bool others_syncing = false;
+    for (auto& log : logs_) {
+      if (log.synced_seq >= std::min(wait_for_seq, log.closed_seq)) {
+        continue;
+      }
+      if (log.getting_synced) {
+        others_syncing = true;
+      } else {
+        log_to_sync = &log;
+        break;
+      }
+    }
+    if (log_to_sync == nullptr) {
+      if (!others_syncing) {
+        break;
+      }
+      log_sync_cv_.Wait();
+      continue;
+    }
+    log::Writer* writer = log_to_sync->writer;
+    if (!writer->file()->writable_file()->IsSyncThreadSafe()) {
+      return Status::NotSupported(
+          "SyncWAL() is not supported for this implementation of WAL file");
+    }
+    // The records up to the last sequence number have been handed to the
+    // log, so the sync covers them.
+    const SequenceNumber synced_seq = versions_->LastSequence();
+    const bool need_log_dir_sync = !log_dir_synced_;
+    const uint64_t current_log_number = logfile_number_;
+    // log_to_sync is not popped from logs_ while it is getting synced.
+    log_to_sync->getting_synced = true;
+    shared = false;
+
+    mutex_.Unlock();
+    RecordTick(stats_, WAL_FILE_SYNCED);
+    IOStatus io_s =
+        writer->file()->SyncWithoutFlush(immutable_db_options_.use_fsync);
+    if (!io_s.ok()) {
+      ROCKS_LOG_ERROR(immutable_db_options_.info_log, "WAL Sync error %s",
+                      io_s.ToString().c_str());
+      IOStatusCheck(io_s);
+    } else if (need_log_dir_sync) {
+      io_s = directories_.GetWalDir()->Fsync(IOOptions(), nullptr);
+    }
+    mutex_.Lock();
+
+    log_to_sync->getting_synced = false;
+    log_sync_cv_.SignalAll();
+    if (!io_s.ok()) {
+      return std::move(io_s);
+    }
+    log_to_sync->synced_seq = std::max(log_to_sync->synced_seq, synced_seq);
+    if (need_log_dir_sync && current_log_number == logfile_number_) {
+      log_dir_synced_ = true;
+    }
+  }
+  if (shared) {
+    RecordTick(stats_, WAL_FILE_SYNC_SHARED);
+  }
+  return Status::OK();
+}
+
 Status DBImpl::LockWAL() {
   log_write_mutex_.Lock();
   auto cur_log_writer = logs_.back().writer;
@@ -1645,6 +2010,37 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     }
   }
 
+  // Only plain reads of the latest value, or of a snapshot, use the hot key
+  // cache. A read that ignores range deletions may see values other reads
+  // don't.
+  HotKeyCache* hot_key_cache = nullptr;
+  uint64_t hot_key_cache_epoch = 0;
+  if (cfd->hot_key_cache() != nullptr && get_impl_options.get_value &&
+      get_impl_options.callback == nullptr &&
+      get_impl_options.is_blob_index == nullptr &&
+      read_options.read_tier == kReadAllTier &&
+      !read_options.ignore_range_deletions) {
+    hot_key_cache = cfd->hot_key_cache();
+    SequenceNumber visible_seq =
+        read_options.snapshot != nullptr
+            ? reinterpret_cast<const SnapshotImpl*>(read_options.snapshot)
+                  ->number_
+            : kMaxSequenceNumber;
+    if (hot_key_cache->Lookup(key, visible_seq, get_impl_options.value)) {
+      RecordTick(stats_, HOT_KEY_CACHE_HIT);
+      RecordTick(stats_, NUMBER_KEYS_READ);
+      size_t size = get_impl_options.value->size();
+      RecordTick(stats_, BYTES_READ, size);
+      PERF_COUNTER_ADD(get_read_bytes, size);
+      RecordInHistogram(stats_, BYTES_PER_READ, size);
+      return Status::OK();
+    }
+    RecordTick(stats_, HOT_KEY_CACHE_MISS);
+    // Taken before the SuperVersion, so that a change the cache is
+    // invalidated for after the read started keeps the value out of it.
+    hot_key_cache_epoch = hot_key_cache->GetEpoch();
+  }
+
   // Acquire SuperVersion
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
 
@@ -1784,6 +2180,10 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     if (s.ok()) {
       if (get_impl_options.get_value) {
         size = get_impl_options.value->size();
+        if (hot_key_cache != nullptr && read_options.snapshot == nullptr) {
+          hot_key_cache->MaybeInsert(key, *get_impl_options.value, snapshot,
+                                     hot_key_cache_epoch);
+        }
       } else {
         // Return all merge operands for get_impl_options.key
         *get_impl_options.number_of_operands =
@@ -3169,9 +3569,22 @@ bool DBImpl::GetProperty(ColumnFamilyHandle* column_family,
       *value = tmp_value;
     }
     return ret_value;
+  } else if (property_info->handle_map_dbimpl) {
+    // A map property reads as one "name=value" line per entry
+    std::map<std::string, std::string> map_value;
+    bool ret_value =
+        (this->*(property_info->handle_map_dbimpl))(cfd, &map_value);
+    if (ret_value) {
+      value->clear();
+      for (const auto& entry : map_value) {
+        value->append(entry.first).append("=").append(entry.second);
+        value->append("\n");
+      }
+    }
+    return ret_value;
   }
-  // Shouldn't reach here since exactly one of handle_string and handle_int
-  // should be non-nullptr.
+  // Shouldn't reach here since exactly one of the handlers should be
+  // non-nullptr.
   assert(false);
   return false;
 }
@@ -3189,6 +3602,8 @@ bool DBImpl::GetMapProperty(ColumnFamilyHandle* column_family,
     InstrumentedMutexLock l(&mutex_);
     return cfd->internal_stats()->GetMapProperty(*property_info, property,
                                                  value);
+  } else if (property_info->handle_map_dbimpl) {
+    return (this->*(property_info->handle_map_dbimpl))(cfd, value);
   }
   // If we reach this point it means that handle_map is not provided for the
   // requested property
@@ -3247,6 +3662,109 @@ bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   return true;
 }
 
+#ifndef ROCKSDB_LITE
+namespace {
+const char* BlockTypeToPropertyName(BlockType block_type) {
+  switch (block_type) {
+    case BlockType::kData:
+      return "data";
+    case BlockType::kFilter:
+      return "filter";
+    case BlockType::kProperties:
+      return "properties";
+    case BlockType::kCompressionDictionary:
+      return "compression-dict";
+    case BlockType::kRangeDeletion:
+      return "range-deletion";
+    case BlockType::kHashIndexPrefixes:
+      return "hash-index-prefixes";
+    case BlockType::kHashIndexMetadata:
+      return "hash-index-metadata";
+    case BlockType::kMetaIndex:
+      return "meta-index";
+    case BlockType::kIndex:
+      return "index";
+    case BlockType::kInvalid:
+      break;
+  }
+  return "other";
+}
+}  // namespace
+
+bool DBImpl::GetPropertyHandleBlockCacheStats(
+    ColumnFamilyData* cfd, std::map<std::string, std::string>* value) {
+  assert(value != nullptr);
+  Cache* block_cache = cfd->ioptions()->table_factory->GetOptions<Cache>(
+      TableFactory::kBlockCacheOpts());
+  if (block_cache == nullptr) {
+    return false;
+  }
+  (*value)["capacity"] = ToString(block_cache->GetCapacity());
+  (*value)["usage"] = ToString(block_cache->GetUsage());
+  (*value)["pinned-usage"] = ToString(block_cache->GetPinnedUsage());
+
+  std::vector<Cache::ShardStats> shard_stats;
+  if (block_cache->GetShardStats(&shard_stats)) {
+    for (size_t i = 0; i < shard_stats.size(); ++i) {
+      const Cache::ShardStats& stats = shard_stats[i];
+      const std::string prefix = "shard." + ToString(i) + ".";
+      (*value)[prefix + "lookups"] = ToString(stats.lookups);
+      (*value)[prefix + "hits"] = ToString(stats.hits);
+      (*value)[prefix + "inserts"] = ToString(stats.inserts);
+      (*value)[prefix + "evictions"] = ToString(stats.evictions);
+      (*value)[prefix + "mutex-wait-nanos"] = ToString(stats.mutex_wait_nanos);
+      (*value)[prefix + "usage"] = ToString(stats.usage);
+      (*value)[prefix + "pinned-usage"] = ToString(stats.pinned_usage);
+    }
+  }
+
+  // Attribute the cached blocks to the column families of the open tables
+  // they belong to, and to their block types.
+  OpenTablesByBlockCache open_tables;
+  RefOpenTablesByBlockCache(&open_tables);
+  std::unordered_map<uint32_t, std::string> cf_names;
+  for (auto open_cfd : open_tables.cfds) {
+    cf_names[open_cfd->GetID()] = open_cfd->GetName();
+  }
+  const std::vector<BlockCacheWarmupTable>& tables =
+      open_tables.tables[block_cache];
+  BlockCacheKeyTableIndex index(tables);
+  // Count and usage of the entries by (column family name or "", type)
+  std::map<std::pair<std::string, BlockType>, std::pair<uint64_t, uint64_t>>
+      entries;
+  block_cache->ApplyToAllCacheKeys(
+      [&](const Slice& key, size_t charge, Cache::Priority /*priority*/,
+          const Cache::CacheItemHelper* helper) {
+        size_t table;
+        uint64_t offset;
+        std::string cf_name;
+        if (index.Find(key, &table, &offset)) {
+          cf_name = cf_names[tables[table].column_family_id];
+        }
+        auto& entry = entries[std::make_pair(
+            std::move(cf_name), BlockBasedTable::GetCachedBlockType(helper))];
+        entry.first++;
+        entry.second += charge;
+      });
+  UnrefOpenTablesByBlockCache(&open_tables);
+
+  for (const auto& entry : entries) {
+    const std::string prefix =
+        (entry.first.first.empty() ? std::string("other.")
+                                   : "cf." + entry.first.first + ".") +
+        BlockTypeToPropertyName(entry.first.second) + ".";
+    (*value)[prefix + "count"] = ToString(entry.second.first);
+    (*value)[prefix + "usage"] = ToString(entry.second.second);
+  }
+  return true;
+}
+#else
+bool DBImpl::GetPropertyHandleBlockCacheStats(
+    ColumnFamilyData* /*cfd*/, std::map<std::string, std::string>* /*value*/) {
+  return false;
+}
+#endif  // ROCKSDB_LITE
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::ResetStats() {
   InstrumentedMutexLock l(&mutex_);
@@ -3455,6 +3973,10 @@ Status DBImpl::GetUpdatesSince(
     SequenceNumber seq, std::unique_ptr<TransactionLogIterator>* iter,
     const TransactionLogIterator::ReadOptions& read_options) {
   RecordTick(stats_, GET_UPDATES_SINCE_CALLS);
+  if (immutable_db_options_.wal_streams > 1) {
+    return Status::NotSupported(
+        "GetUpdatesSince() is not supported with wal_streams > 1");
+  }
   if (seq > versions_->LastSequence()) {
     return Status::NotFound("Requested sequence not yet written in the db");
   }
@@ -3546,6 +4068,10 @@ Status DBImpl::DeleteFile(std::string name) {
       InstallSuperVersionAndScheduleWork(cfd,
                                          &job_context.superversion_contexts[0],
                                          *cfd->GetLatestMutableCFOptions());
+      // The keys of the deleted files may now have older values or none.
+      if (cfd->hot_key_cache() != nullptr) {
+        cfd->hot_key_cache()->InvalidateAll(versions_->LastSequence());
+      }
     }
     FindObsoleteFiles(&job_context, false);
   }  // lock released here
@@ -3631,6 +4157,10 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
       InstallSuperVersionAndScheduleWork(cfd,
                                          &job_context.superversion_contexts[0],
                                          *cfd->GetLatestMutableCFOptions());
+      // The keys of the deleted files may now have older values or none.
+      if (cfd->hot_key_cache() != nullptr) {
+        cfd->hot_key_cache()->InvalidateAll(versions_->LastSequence());
+      }
     }
     for (auto* deleted_file : deleted_files) {
       deleted_file->being_compacted = false;
@@ -3909,6 +4439,9 @@ Status DestroyDB(const std::string& dbname, const Options& options,
         }
       }
     }
+    // The block cache warm-up file doesn't have a file type, as it is not
+    // tracked by the DB.
+    env->DeleteFile(BlockCacheWarmupFileName(dbname)).PermitUncheckedError();
 
     std::set<std::string> paths;
     for (const DbPath& db_path : options.db_paths) {
@@ -4575,6 +5108,9 @@ Status DBImpl::IngestExternalFiles(
         if (!cfd->IsDropped()) {
           InstallSuperVersionAndScheduleWork(cfd, &sv_ctxs[i],
                                              *cfd->GetLatestMutableCFOptions());
+          if (cfd->hot_key_cache() != nullptr) {
+            cfd->hot_key_cache()->InvalidateAll(versions_->LastSequence());
+          }
 #ifndef NDEBUG
           if (0 == i && num_cfs > 1) {
             TEST_SYNC_POINT(
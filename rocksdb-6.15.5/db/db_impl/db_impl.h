@@ -19,6 +19,7 @@
 #include <utility>
 #include <vector>
 
+#include "db/block_cache_warmup.h"
 #include "db/column_family.h"
 #include "db/compaction/compaction_job.h"
 #include "db/dbformat.h"
@@ -1013,6 +1014,8 @@ class DBImpl : public DB {
   int TEST_BGFlushesAllowed() const;
   size_t TEST_GetWalPreallocateBlockSize(uint64_t write_buffer_size) const;
   void TEST_WaitForStatsDumpRun(std::function<void()> callback) const;
+  // Wait for the block cache warm-up started by DB::Open to finish.
+  void TEST_WaitForBlockCacheWarmup();
   size_t TEST_EstimateInMemoryStatsHistorySize() const;
 
   VersionSet* TEST_GetVersionSet() const { return versions_.get(); }
@@ -1036,6 +1039,9 @@ class DBImpl : public DB {
   // flush LOG out of application buffer
   void FlushInfoLog();
 
+  // save the data blocks in the block cache to BlockCacheWarmupFileName()
+  void SaveBlockCacheWarmupFile();
+
  protected:
   const std::string dbname_;
   std::string db_id_;
@@ -1315,8 +1321,14 @@ class DBImpl : public DB {
     // Visual Studio doesn't support deque's member to be noncopyable because
     // of a std::unique_ptr as a member.
     log::Writer* writer;  // own
-    // true for some prefix of logs_
+    // true for some prefix of logs_, except with wal_streams > 1, where any
+    // log may be synced on its own by SyncWALStreams()
     bool getting_synced = false;
+    // Only maintained with wal_streams > 1: the records of the log with
+    // sequence numbers up to synced_seq are synced, and once the log is no
+    // longer written, it has no record past closed_seq.
+    SequenceNumber synced_seq = 0;
+    SequenceNumber closed_seq = kMaxSequenceNumber;
   };
 
   // PurgeFileInfo is a structure to hold information of files to be deleted in
@@ -1582,18 +1594,33 @@ class DBImpl : public DB {
   Status PreprocessWrite(const WriteOptions& write_options, bool* need_log_sync,
                          WriteContext* write_context);
 
+  // If merged_records is not nullptr and the batches of write_group have to
+  // be merged, their records are not copied into *tmp_batch: the merged batch
+  // is then the contents of *tmp_batch followed by (*merged_records)[1..],
+  // and (*merged_records)[0] is left for the caller to fill in.
   WriteBatch* MergeBatch(const WriteThread::WriteGroup& write_group,
                          WriteBatch* tmp_batch, size_t* write_with_wal,
-                         WriteBatch** to_be_cached_state);
+                         WriteBatch** to_be_cached_state,
+                         std::vector<Slice>* merged_records = nullptr);
 
   IOStatus WriteToWAL(const WriteBatch& merged_batch, log::Writer* log_writer,
                       uint64_t* log_used, uint64_t* log_size);
 
+  IOStatus WriteToWAL(const SliceParts& log_entry, log::Writer* log_writer,
+                      uint64_t* log_used, uint64_t* log_size);
+
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
                       bool need_log_sync, bool need_log_dir_sync,
                       SequenceNumber sequence);
 
+  // With wal_streams > 1, writes the header-only record that marks the
+  // sequence numbers skipped before a write group's record, if any, and sets
+  // *skip_record if the group's record is empty.
+  IOStatus WriteWALStreamsGapMarker(const WriteBatch* merged_batch,
+                                    log::Writer* log_writer,
+                                    SequenceNumber sequence, bool* skip_record);
+
   IOStatus ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
@@ -1658,12 +1685,31 @@ class DBImpl : public DB {
   static void BGWorkBottomCompaction(void* arg);
   static void BGWorkFlush(void* arg);
   static void BGWorkPurge(void* arg);
+  static void BGWorkBlockCacheWarmup(void* arg);
   static void UnscheduleCompactionCallback(void* arg);
   static void UnscheduleFlushCallback(void* arg);
   void BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
                                 Env::Priority thread_pri);
   void BackgroundCallFlush(Env::Priority thread_pri);
   void BackgroundCallPurge();
+  void BackgroundCallBlockCacheWarmup();
+  // Load the blocks of `file` into the block cache of cfd.
+  Status WarmUpBlockCacheFile(ColumnFamilyData* cfd,
+                              const BlockCacheWarmupFile& file);
+
+  // The open tables of the live files of all column families, by block
+  // cache, and the references that keep them open.
+  struct OpenTablesByBlockCache {
+    autovector<ColumnFamilyData*> cfds;
+    std::vector<std::pair<ColumnFamilyData*, SuperVersion*>> super_versions;
+    std::vector<std::pair<TableCache*, Cache::Handle*>> table_handles;
+    std::unordered_map<Cache*, std::vector<BlockCacheWarmupTable>> tables;
+  };
+  // Fills *tables without IO, so tables not in the table cache are left
+  // out. Must be followed by UnrefOpenTablesByBlockCache(tables).
+  // REQUIRES: mutex_ not held
+  void RefOpenTablesByBlockCache(OpenTablesByBlockCache* tables);
+  void UnrefOpenTablesByBlockCache(OpenTablesByBlockCache* tables);
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer,
                               PrepickedCompaction* prepicked_compaction,
@@ -1685,6 +1731,10 @@ class DBImpl : public DB {
   // Schedule background tasks
   void StartPeriodicWorkScheduler();
 
+  // Schedule background jobs to load the blocks of BlockCacheWarmupFileName()
+  // into the block cache.
+  void ScheduleBlockCacheWarmup();
+
   void PrintStatistics();
 
   size_t EstimateInMemoryStatsHistorySize() const;
@@ -1709,6 +1759,17 @@ class DBImpl : public DB {
   ColumnFamilyData* PickCompactionFromQueue(
       std::unique_ptr<TaskLimiterToken>* token, LogBuffer* log_buffer);
 
+  // Syncs all WAL files up to the current one. If wait_for_seq is not
+  // kMaxSequenceNumber, returns as soon as a sync covering all records with
+  // sequence numbers up to wait_for_seq has completed, which may be a sync
+  // started by another thread.
+  Status SyncWALImpl(SequenceNumber wait_for_seq);
+
+  // SyncWALImpl() with wal_streams > 1. Each log is synced on its own, so that
+  // threads waiting for different records sync different logs at the same
+  // time.
+  Status SyncWALStreams(SequenceNumber wait_for_seq);
+
   // helper function to call after some of the logs_ were synced
   Status MarkLogsSynced(uint64_t up_to, bool synced_dir);
   // WALs with log number up to up_to are not synced successfully.
@@ -1740,6 +1801,8 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleBlockCacheStats(
+      ColumnFamilyData* cfd, std::map<std::string, std::string>* value);
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
@@ -1772,6 +1835,16 @@ class DBImpl : public DB {
   IOStatus CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
                      size_t preallocate_block_size, log::Writer** new_log);
 
+  // With wal_streams > 1, creates the logs numbered after log_file_num that
+  // make up the rest of a new WAL. On failure, none of them is returned.
+  IOStatus CreateWALStreams(uint64_t log_file_num,
+                            size_t preallocate_block_size,
+                            autovector<log::Writer*>* stream_logs);
+
+  // Returns the log the next write group appends to. With wal_streams > 1,
+  // the logs of the current WAL take turns. REQUIRES: mutex_ held.
+  log::Writer* SelectWALStream();
+
   // Validate self-consistency of DB options
   static Status ValidateOptions(const DBOptions& db_options);
   // Validate self-consistency of DB options and its consistency with cf options
@@ -1938,6 +2011,20 @@ class DBImpl : public DB {
   std::deque<LogWriterNumber> logs_;
   // Signaled when getting_synced becomes false for some of the logs_.
   InstrumentedCondVar log_sync_cv_;
+  // All WAL records with sequence numbers up to this one are known to be
+  // synced. Only maintained by SyncWALImpl(). Protected by mutex_.
+  SequenceNumber wal_synced_seq_;
+  // With wal_streams > 1, the logs_ of the current WAL are its last
+  // wal_streams entries, with consecutive numbers starting at
+  // logfile_number_, and next_wal_stream_ counts the write groups that picked
+  // one of them. Protected by mutex_.
+  size_t next_wal_stream_ = 0;
+  // With wal_streams > 1, the sequence number that follows the last record
+  // written to the WAL, or 0 if not known. When a write group starts past it,
+  // e.g. after writes with disableWAL, a header-only record with this
+  // sequence number is written before the group's record, so that recovery
+  // can tell the gap from lost records. Only accessed by the write thread.
+  SequenceNumber wal_streams_next_seq_ = 0;
   // This is the app-level state that is written to the WAL but will be used
   // only during recovery. Using this feature enables not writing the state to
   // memtable on normal writes and hence improving the throughput. Each new
@@ -1967,6 +2054,8 @@ class DBImpl : public DB {
 
   WriteThread write_thread_;
   WriteBatch tmp_batch_;
+  // The WAL record of a write group, see MergeBatch().
+  std::vector<Slice> tmp_wal_records_;
   // The write thread when the writers have no memtable write. This will be used
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
@@ -2053,6 +2142,12 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of background block cache warm-up jobs, submitted to the LOW pool
+  int bg_block_cache_warmup_scheduled_;
+
+  // the files whose blocks remain to be loaded by the block cache warm-up
+  std::deque<BlockCacheWarmupFile> block_cache_warmup_queue_;
+
   std::deque<ManualCompactionState*> manual_compaction_dequeue_;
 
   // shall we disable deletion of obsolete files
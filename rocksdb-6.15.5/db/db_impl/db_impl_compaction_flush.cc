@@ -83,8 +83,17 @@ IOStatus DBImpl::SyncClosedLogs(JobContext* job_context) {
   mutex_.AssertHeld();
   autovector<log::Writer*, 1> logs_to_sync;
   uint64_t current_log_number = logfile_number_;
-  while (logs_.front().number < current_log_number &&
-         logs_.front().getting_synced) {
+  // With wal_streams > 1, any of the closed logs may be getting synced.
+  auto closed_log_getting_synced = [&]() {
+    for (auto it = logs_.begin();
+         it != logs_.end() && it->number < current_log_number; ++it) {
+      if (it->getting_synced) {
+        return true;
+      }
+    }
+    return false;
+  };
+  while (closed_log_getting_synced()) {
     log_sync_cv_.Wait();
   }
   for (auto it = logs_.begin();
@@ -289,6 +298,12 @@ Status DBImpl::FlushMemTableToOutputFile(
       std::string file_path = MakeTableFileName(
           cfd->ioptions()->cf_paths[0].path, file_meta.fd.GetNumber());
       sfm->OnAddFile(file_path);
+      for (const auto& meta : flush_job.GetPartitionOutputs()) {
+        if (meta.fd.GetFileSize() > 0) {
+          sfm->OnAddFile(MakeTableFileName(cfd->ioptions()->cf_paths[0].path,
+                                           meta.fd.GetNumber()));
+        }
+      }
       if (sfm->IsMaxAllowedSpaceReached()) {
         Status new_bg_error =
             Status::SpaceLimit("Max allowed space was reached");
@@ -641,6 +656,12 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         std::string file_path = MakeTableFileName(
             cfds[i]->ioptions()->cf_paths[0].path, file_meta[i].fd.GetNumber());
         sfm->OnAddFile(file_path);
+        for (const auto& meta : jobs[i]->GetPartitionOutputs()) {
+          if (meta.fd.GetFileSize() > 0) {
+            sfm->OnAddFile(MakeTableFileName(
+                cfds[i]->ioptions()->cf_paths[0].path, meta.fd.GetNumber()));
+          }
+        }
         if (sfm->IsMaxAllowedSpaceReached() &&
             error_handler_.GetBGError().ok()) {
           Status new_bg_error =
@@ -280,6 +280,13 @@ void DBImpl::TEST_WaitForStatsDumpRun(std::function<void()> callback) const {
   }
 }
 
+void DBImpl::TEST_WaitForBlockCacheWarmup() {
+  InstrumentedMutexLock l(&mutex_);
+  while (bg_block_cache_warmup_scheduled_ > 0) {
+    bg_cv_.Wait();
+  }
+}
+
 PeriodicWorkTestScheduler* DBImpl::TEST_GetPeriodicWorkScheduler() const {
   return static_cast<PeriodicWorkTestScheduler*>(periodic_work_scheduler_);
 }
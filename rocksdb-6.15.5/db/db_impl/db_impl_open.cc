@@ -21,6 +21,7 @@
 #include "rocksdb/table.h"
 #include "rocksdb/wal_filter.h"
 #include "test_util/sync_point.h"
+#include "util/coding.h"
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -249,6 +250,29 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "unordered_write is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.pipelined_wal_sync &&
+      (db_options.two_write_queues || db_options.manual_wal_flush ||
+       db_options.allow_mmap_writes)) {
+    return Status::InvalidArgument(
+        "pipelined_wal_sync is incompatible with two_write_queues, "
+        "manual_wal_flush and allow_mmap_writes");
+  }
+
+  if (db_options.wal_streams == 0) {
+    return Status::InvalidArgument("wal_streams must be greater than 0");
+  }
+
+  if (db_options.wal_streams > 1 &&
+      (db_options.two_write_queues || db_options.unordered_write ||
+       db_options.enable_pipelined_write || db_options.manual_wal_flush ||
+       db_options.allow_mmap_writes || db_options.allow_2pc ||
+       db_options.recycle_log_file_num > 0)) {
+    return Status::InvalidArgument(
+        "wal_streams > 1 is incompatible with two_write_queues, "
+        "unordered_write, enable_pipelined_write, manual_wal_flush, "
+        "allow_mmap_writes, allow_2pc and recycle_log_file_num");
+  }
+
   if (db_options.atomic_flush && db_options.enable_pipelined_write) {
     return Status::InvalidArgument(
         "atomic_flush is incompatible with enable_pipelined_write");
@@ -624,6 +648,16 @@ Status DBImpl::Recover(
         }
       }
     }
+
+    if (s.ok() && !read_only &&
+        versions_->GetWalStreams() != immutable_db_options_.wal_streams) {
+      // RecoverLogFiles() flushed what it recovered from the WALs written
+      // with the previous wal_streams, see there.
+      VersionEdit edit;
+      edit.SetWalStreams(
+          static_cast<uint32_t>(immutable_db_options_.wal_streams));
+      s = versions_->LogAndApplyToDefaultColumnFamily(&edit, &mutex_);
+    }
   }
 
   if (read_only) {
@@ -766,6 +800,137 @@ Status DBImpl::InitPersistStatsColumnFamily() {
   return s;
 }
 
+namespace {
+// Reads the records of the log files that RecoverLogFiles() replays together.
+// Without merge, there is a single log file and its records are returned in
+// order. With merge, the records of all log files are returned in sequence
+// number order, the order they were written in with wal_streams > 1. Unless
+// corrupted records are skipped, reading stops at a record whose sequence
+// number doesn't follow the records before it, since the missing ones were in
+// the lost tail of another log. Header-only records mark the sequence numbers
+// that were skipped on purpose and are not returned.
+class WalRecordMerger {
+ public:
+  WalRecordMerger(WALRecoveryMode recovery_mode, bool merge)
+      : recovery_mode_(recovery_mode),
+        merge_(merge),
+        stop_at_gap_(recovery_mode !=
+                     WALRecoveryMode::kSkipAnyCorruptedRecords) {}
+
+  void AddLog(std::unique_ptr<log::Reader>&& reader) {
+    assert(merge_ || logs_.empty());
+    logs_.emplace_back();
+    logs_.back().index = logs_.size() - 1;
+    logs_.back().reader = std::move(reader);
+  }
+
+  // Returns the next record, which stays valid until the next call, and the
+  // index of its log in the order of AddLog() calls.
+  bool ReadRecord(Slice* record, size_t* log_index) {
+    if (last_ != nullptr) {
+      Advance(last_);
+      last_ = nullptr;
+    } else if (!started_) {
+      for (auto& log : logs_) {
+        Advance(&log);
+      }
+      started_ = true;
+    }
+    while (true) {
+      Log* next = nullptr;
+      for (auto& log : logs_) {
+        if (log.valid && (next == nullptr || Precedes(log, *next))) {
+          next = &log;
+        }
+      }
+      if (next == nullptr) {
+        return false;
+      }
+      if (merge_ && next->record.size() >= WriteBatchInternal::kHeader) {
+        const SequenceNumber seq = RecordSequence(next->record);
+        if (stop_at_gap_ && next_seq_ != 0 && seq > next_seq_) {
+          gap_found_ = true;
+          gap_log_index_ = next->index;
+          return false;
+        }
+        if (next->record.size() == WriteBatchInternal::kHeader) {
+          // The sequence numbers from seq up to the next record of this log
+          // were not written to the WAL.
+          Advance(next);
+          SequenceNumber skipped_to = seq;
+          if (next->valid &&
+              next->record.size() >= WriteBatchInternal::kHeader) {
+            skipped_to = RecordSequence(next->record);
+          }
+          next_seq_ = std::max(next_seq_, skipped_to);
+          continue;
+        }
+        next_seq_ = std::max(
+            next_seq_, seq + DecodeFixed32(next->record.data() + 8));
+      }
+      last_ = next;
+      *record = next->record;
+      *log_index = next->index;
+      return true;
+    }
+  }
+
+  bool gap_found() const { return gap_found_; }
+  // Index of the log of the first record past the gap.
+  size_t gap_log_index() const { return gap_log_index_; }
+  // With merge, the sequence number following the records returned, or 0.
+  SequenceNumber next_sequence() const { return next_seq_; }
+
+ private:
+  struct Log {
+    size_t index = 0;
+    std::unique_ptr<log::Reader> reader;
+    std::string scratch;
+    Slice record;
+    bool valid = true;
+  };
+
+  // The first 8 bytes of a WriteBatch are its sequence number, the next 4
+  // its count.
+  static SequenceNumber RecordSequence(const Slice& record) {
+    return DecodeFixed64(record.data());
+  }
+
+  void Advance(Log* log) {
+    log->valid = log->valid && log->reader->ReadRecord(
+                                   &log->record, &log->scratch, recovery_mode_);
+  }
+
+  // Records too small to hold a sequence number are returned first, to be
+  // reported, and header-only records before records with the same sequence
+  // number.
+  static bool Precedes(const Log& a, const Log& b) {
+    if (a.record.size() < WriteBatchInternal::kHeader ||
+        b.record.size() < WriteBatchInternal::kHeader) {
+      return a.record.size() < b.record.size();
+    }
+    const SequenceNumber a_seq = RecordSequence(a.record);
+    const SequenceNumber b_seq = RecordSequence(b.record);
+    if (a_seq != b_seq) {
+      return a_seq < b_seq;
+    }
+    return a.record.size() == WriteBatchInternal::kHeader &&
+           b.record.size() > WriteBatchInternal::kHeader;
+  }
+
+  const WALRecoveryMode recovery_mode_;
+  const bool merge_;
+  const bool stop_at_gap_;
+  // A deque, so that records keep pointing into the scratch of their log.
+  std::deque<Log> logs_;
+  Log* last_ = nullptr;
+  bool started_ = false;
+  SequenceNumber next_seq_ = 0;
+  bool gap_found_ = false;
+  size_t gap_log_index_ = 0;
+};
+}  // namespace
+
 // REQUIRES: wal_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
@@ -827,6 +992,15 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   bool flushed = false;
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
+  // With wal_streams > 1, the records of a WAL are spread over several log
+  // files, so all of them are replayed together, merged by sequence number.
+  // The WALs are read with the wal_streams recorded in the MANIFEST. If it
+  // differs from the option, what they hold is flushed below, so that the
+  // new count can be recorded once they are obsolete.
+  const bool merge_wals = versions_->GetWalStreams() > 1;
+  const bool wal_streams_changed =
+      versions_->GetWalStreams() != immutable_db_options_.wal_streams;
+  std::vector<std::vector<uint64_t>> wal_groups;
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -839,77 +1013,105 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // records after allocating this log number.  So we manually
     // update the file number allocation counter in VersionSet.
     versions_->MarkFileNumberUsed(wal_number);
-    // Open the log file
-    std::string fname = LogFileName(immutable_db_options_.wal_dir, wal_number);
-
-    ROCKS_LOG_INFO(immutable_db_options_.info_log,
-                   "Recovering log #%" PRIu64 " mode %d", wal_number,
-                   static_cast<int>(immutable_db_options_.wal_recovery_mode));
-    auto logFileDropped = [this, &fname]() {
-      uint64_t bytes;
-      if (env_->GetFileSize(fname, &bytes).ok()) {
-        auto info_log = immutable_db_options_.info_log.get();
-        ROCKS_LOG_WARN(info_log, "%s: dropping %d bytes", fname.c_str(),
-                       static_cast<int>(bytes));
-      }
-    };
+    if (merge_wals && !wal_groups.empty()) {
+      wal_groups.back().push_back(wal_number);
+    } else {
+      wal_groups.push_back({wal_number});
+    }
+  }
+  auto logFileDropped = [this](const std::string& fname) {
+    uint64_t bytes;
+    if (env_->GetFileSize(fname, &bytes).ok()) {
+      auto info_log = immutable_db_options_.info_log.get();
+      ROCKS_LOG_WARN(info_log, "%s: dropping %d bytes", fname.c_str(),
+                     static_cast<int>(bytes));
+    }
+  };
+  for (const auto& wal_group : wal_groups) {
     if (stop_replay_by_wal_filter) {
-      logFileDropped();
+      for (auto wal_number : wal_group) {
+        logFileDropped(
+            LogFileName(immutable_db_options_.wal_dir, wal_number));
+      }
       continue;
     }
 
-    std::unique_ptr<SequentialFileReader> file_reader;
-    {
-      std::unique_ptr<FSSequentialFile> file;
-      status = fs_->NewSequentialFile(fname,
-                                      fs_->OptimizeForLogRead(file_options_),
-                                      &file, nullptr);
-      if (!status.ok()) {
-        MaybeIgnoreError(&status);
+    // The log files of the group that could be opened, and their readers.
+    std::vector<uint64_t> log_numbers;
+    std::vector<std::string> log_fnames;
+    std::vector<LogReporter> reporters;
+    log_numbers.reserve(wal_group.size());
+    log_fnames.reserve(wal_group.size());
+    reporters.reserve(wal_group.size());
+    WalRecordMerger merger(immutable_db_options_.wal_recovery_mode,
+                           merge_wals);
+    for (auto wal_number : wal_group) {
+      // Open the log file
+      std::string fname =
+          LogFileName(immutable_db_options_.wal_dir, wal_number);
+
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Recovering log #%" PRIu64 " mode %d", wal_number,
+                     static_cast<int>(immutable_db_options_.wal_recovery_mode));
+
+      std::unique_ptr<SequentialFileReader> file_reader;
+      {
+        std::unique_ptr<FSSequentialFile> file;
+        status = fs_->NewSequentialFile(fname,
+                                        fs_->OptimizeForLogRead(file_options_),
+                                        &file, nullptr);
         if (!status.ok()) {
-          return status;
-        } else {
-          // Fail with one log file, but that's ok.
-          // Try next one.
-          continue;
+          MaybeIgnoreError(&status);
+          if (!status.ok()) {
+            return status;
+          } else {
+            // Fail with one log file, but that's ok.
+            // Try next one.
+            continue;
+          }
         }
+        file_reader.reset(new SequentialFileReader(
+            std::move(file), fname, immutable_db_options_.log_readahead_size,
+            io_tracer_));
       }
-      file_reader.reset(new SequentialFileReader(
-          std::move(file), fname, immutable_db_options_.log_readahead_size,
-          io_tracer_));
-    }
-
-    // Create the log reader.
-    LogReporter reporter;
-    reporter.env = env_;
-    reporter.info_log = immutable_db_options_.info_log.get();
-    reporter.fname = fname.c_str();
-    if (!immutable_db_options_.paranoid_checks ||
-        immutable_db_options_.wal_recovery_mode ==
-            WALRecoveryMode::kSkipAnyCorruptedRecords) {
-      reporter.status = nullptr;
-    } else {
-      reporter.status = &status;
+      log_numbers.push_back(wal_number);
+      log_fnames.push_back(std::move(fname));
+
+      // Create the log reader.
+      reporters.emplace_back();
+      LogReporter& reporter = reporters.back();
+      reporter.env = env_;
+      reporter.info_log = immutable_db_options_.info_log.get();
+      reporter.fname = log_fnames.back().c_str();
+      if (!immutable_db_options_.paranoid_checks ||
+          immutable_db_options_.wal_recovery_mode ==
+              WALRecoveryMode::kSkipAnyCorruptedRecords) {
+        reporter.status = nullptr;
+      } else {
+        reporter.status = &status;
+      }
+      // We intentially make log::Reader do checksumming even if
+      // paranoid_checks==false so that corruptions cause entire commits
+      // to be skipped instead of propagating bad information (like overly
+      // large sequence numbers).
+      merger.AddLog(std::unique_ptr<log::Reader>(new log::Reader(
+          immutable_db_options_.info_log, std::move(file_reader), &reporter,
+          true /*checksum*/, wal_number)));
     }
-    // We intentially make log::Reader do checksumming even if
-    // paranoid_checks==false so that corruptions cause entire commits
-    // to be skipped instead of propagating bad information (like overly
-    // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
 
-    // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
-    std::string scratch;
+    uint64_t wal_number = wal_group.front();
+    size_t log_index;
     Slice record;
     WriteBatch batch;
 
     TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
                              /*arg=*/nullptr);
     while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
-           status.ok()) {
+           merger.ReadRecord(&record, &log_index) && status.ok()) {
+      wal_number = log_numbers[log_index];
+      const std::string& fname = log_fnames[log_index];
+      LogReporter& reporter = reporters[log_index];
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -932,7 +1134,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
           stop_replay_for_corruption = false;
         }
         if (stop_replay_for_corruption) {
-          logFileDropped();
+          logFileDropped(fname);
           break;
         }
       }
@@ -1061,6 +1263,33 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
     }
 
+    if (status.ok() && merger.gap_found()) {
+      // A log of the WAL lost its tail, and the records past the gap were
+      // written after the lost ones.
+      uint64_t gap_wal_number = log_numbers[merger.gap_log_index()];
+      if (immutable_db_options_.wal_recovery_mode ==
+          WALRecoveryMode::kAbsoluteConsistency) {
+        status = Status::Corruption(
+            "WAL record missing before log #" + ToString(gap_wal_number));
+      } else {
+        stop_replay_for_corruption = true;
+        corrupted_wal_number = gap_wal_number;
+        if (corrupted_wal_found != nullptr) {
+          *corrupted_wal_found = true;
+        }
+        for (const auto& fname : log_fnames) {
+          logFileDropped(fname);
+        }
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Recovered WAL up to a missing record, log #%" PRIu64
+                       " seq #%" PRIu64,
+                       gap_wal_number, *next_sequence);
+      }
+    }
+    if (merge_wals) {
+      wal_streams_next_seq_ = merger.next_sequence();
+    }
+
     if (!status.ok()) {
       if (status.IsNotSupported()) {
         // We should not treat NotSupported as corruption. It is rather a clear
@@ -1167,7 +1396,13 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
         // If flush happened in the middle of recovery (e.g. due to memtable
         // being full), we flush at the end. Otherwise we'll need to record
         // where we were on last flush, which make the logic complicated.
-        if (flushed || !immutable_db_options_.avoid_flush_during_recovery) {
+        // With merged WALs, records past the point where replay stopped
+        // must not be replayed on the next open, when they may no longer be
+        // preceded by a gap. WALs written with another wal_streams must not
+        // be replayed once the new count is recorded.
+        if (flushed || !immutable_db_options_.avoid_flush_during_recovery ||
+            (merge_wals && stop_replay_for_corruption) ||
+            wal_streams_changed) {
           status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
           if (!status.ok()) {
             // Recovery failed
@@ -1490,6 +1725,27 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
   return io_s;
 }
 
+IOStatus DBImpl::CreateWALStreams(uint64_t log_file_num,
+                                  size_t preallocate_block_size,
+                                  autovector<log::Writer*>* stream_logs) {
+  assert(stream_logs->empty());
+  IOStatus io_s;
+  for (size_t i = 1; i < immutable_db_options_.wal_streams; ++i) {
+    log::Writer* stream_log = nullptr;
+    io_s = CreateWAL(log_file_num + i, 0 /*recycle_log_number*/,
+                     preallocate_block_size, &stream_log);
+    if (!io_s.ok()) {
+      for (log::Writer* created : *stream_logs) {
+        delete created;
+      }
+      stream_logs->clear();
+      break;
+    }
+    stream_logs->push_back(stream_log);
+  }
+  return io_s;
+}
+
 Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
                     const std::vector<ColumnFamilyDescriptor>& column_families,
                     std::vector<ColumnFamilyHandle*>* handles, DB** dbptr,
@@ -1553,17 +1809,34 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   uint64_t recovered_seq(kMaxSequenceNumber);
   s = impl->Recover(column_families, false, false, false, &recovered_seq);
   if (s.ok()) {
-    uint64_t new_log_number = impl->versions_->NewFileNumber();
+    const size_t wal_streams = impl->immutable_db_options_.wal_streams;
+    uint64_t new_log_number = impl->versions_->FetchAddFileNumber(wal_streams);
     log::Writer* new_log = nullptr;
+    autovector<log::Writer*> stream_logs;
     const size_t preallocate_block_size =
         impl->GetWalPreallocateBlockSize(max_write_buffer_size);
     s = impl->CreateWAL(new_log_number, 0 /*recycle_log_number*/,
                         preallocate_block_size, &new_log);
+    if (s.ok() && wal_streams > 1) {
+      s = impl->CreateWALStreams(new_log_number, preallocate_block_size,
+                                 &stream_logs);
+      if (!s.ok()) {
+        delete new_log;
+        new_log = nullptr;
+      }
+    }
     if (s.ok()) {
       InstrumentedMutexLock wl(&impl->log_write_mutex_);
       impl->logfile_number_ = new_log_number;
       assert(new_log != nullptr);
       impl->logs_.emplace_back(new_log_number, new_log);
+      for (log::Writer* stream_log : stream_logs) {
+        impl->logs_.emplace_back(stream_log->get_log_number(), stream_log);
+      }
+      for (size_t i = impl->logs_.size() - wal_streams; i < impl->logs_.size();
+           ++i) {
+        impl->logs_[i].synced_seq = impl->versions_->LastSequence();
+      }
     }
 
     if (s.ok()) {
@@ -1604,8 +1877,10 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
       if (impl->two_write_queues_) {
         impl->log_write_mutex_.Lock();
       }
-      impl->alive_log_files_.push_back(
-          DBImpl::LogFileNumberSize(impl->logfile_number_));
+      for (size_t i = 0; i < impl->immutable_db_options_.wal_streams; ++i) {
+        impl->alive_log_files_.push_back(
+            DBImpl::LogFileNumberSize(impl->logfile_number_ + i));
+      }
       if (impl->two_write_queues_) {
         impl->log_write_mutex_.Unlock();
       }
@@ -1623,7 +1898,11 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
       // empty, and thus missing the consecutive seq hint to distinguish
       // middle-log corruption to corrupted-log-remained-after-recovery. This
       // case also will be addressed by a dummy write.
-      if (recovered_seq != kMaxSequenceNumber) {
+      // With wal_streams > 1, a header-only record marks a gap instead, and
+      // the logs of the corrupted WAL are no longer replayed, see
+      // RecoverLogFiles().
+      if (recovered_seq != kMaxSequenceNumber &&
+          impl->immutable_db_options_.wal_streams == 1) {
         WriteBatch empty_batch;
         WriteBatchInternal::SetSequence(&empty_batch, recovered_seq);
         WriteOptions write_options;
@@ -1788,6 +2067,9 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   }
   if (s.ok()) {
     impl->StartPeriodicWorkScheduler();
+#ifndef ROCKSDB_LITE
+    impl->ScheduleBlockCacheWarmup();
+#endif  // !ROCKSDB_LITE
   } else {
     for (auto* h : *handles) {
       delete h;
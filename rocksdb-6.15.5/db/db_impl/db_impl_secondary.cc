@@ -79,6 +79,11 @@ Status DBImplSecondary::FindAndRecoverLogFiles(
     JobContext* job_context) {
   assert(nullptr != cfds_changed);
   assert(nullptr != job_context);
+  if (versions_->GetWalStreams() > 1) {
+    // The records of its WALs would have to be merged across log files.
+    return Status::NotSupported(
+        "Secondary instance can't read WALs written with wal_streams > 1");
+  }
   Status s;
   std::vector<uint64_t> logs;
   s = FindNewLogNumbers(&logs);
@@ -605,6 +610,9 @@ Status DB::OpenAsSecondary(
     // while primary instance may delete original.
     return Status::InvalidArgument("require max_open_files to be -1");
   }
+  if (db_options.wal_streams > 1) {
+    return Status::InvalidArgument("wal_streams > 1 is not supported");
+  }
 
   DBOptions tmp_opts(db_options);
   Status s;
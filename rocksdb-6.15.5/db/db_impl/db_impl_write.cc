@@ -109,6 +109,13 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     }
   }
 
+  if (two_write_queues_ || immutable_db_options_.unordered_write) {
+    // Only WriteToWAL() of a write group writes pinned values straight from
+    // the caller's memory. Copy them into the batch while it is still private
+    // to this thread, before other writers can read it.
+    WriteBatchInternal::MaterializePinnedValues(my_batch);
+  }
+
   if (two_write_queues_ && disable_memtable) {
     AssignOrder assign_order =
         seq_per_batch_ ? kDoAssignOrder : kDontAssignOrder;
@@ -147,6 +154,30 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     return status;
   }
 
+  if (write_options.sync && (immutable_db_options_.pipelined_wal_sync ||
+                             immutable_db_options_.wal_streams > 1)) {
+    // Write the batch like a non-sync write and sync the WAL after leaving the
+    // write thread, so that the next write group can append to the WAL while
+    // the sync is in flight. A sync started after this write completed covers
+    // it, whoever started it. With wal_streams > 1, the logs of the WAL are
+    // synced on their own, see SyncWALStreams().
+    WriteOptions no_sync_options = write_options;
+    no_sync_options.sync = false;
+    uint64_t seq = 0;
+    Status status = WriteImpl(no_sync_options, my_batch, callback, log_used,
+                              log_ref, disable_memtable, &seq, batch_cnt,
+                              pre_release_callback);
+    if (status.ok()) {
+      TEST_SYNC_POINT("DBImpl::WriteImpl:BeforePipelinedWALSync");
+      PERF_TIMER_GUARD(write_wal_time);
+      status = SyncWALImpl(seq);
+    }
+    if (seq_used != nullptr) {
+      *seq_used = seq;
+    }
+    return status;
+  }
+
   if (immutable_db_options_.enable_pipelined_write) {
     return PipelinedWriteImpl(write_options, my_batch, callback, log_used,
                               log_ref, disable_memtable, seq_used);
@@ -241,7 +272,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
     PERF_TIMER_START(write_pre_and_post_process_time);
   }
-  log::Writer* log_writer = logs_.back().writer;
+  log::Writer* log_writer = SelectWALStream();
 
   mutex_.Unlock();
 
@@ -983,7 +1014,8 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
 
 WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
                                WriteBatch* tmp_batch, size_t* write_with_wal,
-                               WriteBatch** to_be_cached_state) {
+                               WriteBatch** to_be_cached_state,
+                               std::vector<Slice>* merged_records) {
   assert(write_with_wal != nullptr);
   assert(tmp_batch != nullptr);
   assert(*to_be_cached_state == nullptr);
@@ -1002,16 +1034,24 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
     }
     *write_with_wal = 1;
   } else {
-    // WAL needs all of the batches flattened into a single batch.
-    // We could avoid copying here with an iov-like AddRecord
-    // interface
+    // WAL needs all of the batches flattened into a single batch. With
+    // merged_records the flattening is left to the iov-like AddRecord
+    // interface, which saves copying the records here.
     merged_batch = tmp_batch;
+    if (merged_records != nullptr) {
+      merged_records->assign(1, Slice());
+    }
     for (auto writer : write_group) {
       if (!writer->CallbackFailed()) {
-        Status s = WriteBatchInternal::Append(merged_batch, writer->batch,
-                                              /*WAL_only*/ true);
-        // Always returns Status::OK.
-        assert(s.ok());
+        if (merged_records != nullptr) {
+          WriteBatchInternal::AppendReference(merged_batch, writer->batch,
+                                              merged_records);
+        } else {
+          Status s = WriteBatchInternal::Append(merged_batch, writer->batch,
+                                                /*WAL_only*/ true);
+          // Always returns Status::OK.
+          assert(s.ok());
+        }
         if (WriteBatchInternal::IsLatestPersistentState(writer->batch)) {
           // We only need to cache the last of such write batch
           *to_be_cached_state = writer->batch;
@@ -1023,14 +1063,34 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
   return merged_batch;
 }
 
+log::Writer* DBImpl::SelectWALStream() {
+  mutex_.AssertHeld();
+  const size_t wal_streams = immutable_db_options_.wal_streams;
+  if (wal_streams == 1) {
+    return logs_.back().writer;
+  }
+  assert(logs_.size() >= wal_streams);
+  const size_t stream = next_wal_stream_++ % wal_streams;
+  return logs_[logs_.size() - wal_streams + stream].writer;
+}
+
+IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
+                            log::Writer* log_writer, uint64_t* log_used,
+                            uint64_t* log_size) {
+  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
+  return WriteToWAL(SliceParts(&log_entry, 1), log_writer, log_used, log_size);
+}
+
 // When two_write_queues_ is disabled, this function is called from the only
 // write thread. Otherwise this must be called holding log_write_mutex_.
-IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
+IOStatus DBImpl::WriteToWAL(const SliceParts& log_entry,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size) {
   assert(log_size != nullptr);
-  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  *log_size = log_entry.size();
+  *log_size = 0;
+  for (int i = 0; i < log_entry.num_parts; ++i) {
+    *log_size += log_entry.parts[i].size();
+  }
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
   // if manual_wal_flush_ is enabled we need to protect log_writer->AddRecord
@@ -1047,17 +1107,62 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
   }
+  const uint64_t log_number = log_writer->get_log_number();
   if (log_used != nullptr) {
-    *log_used = logfile_number_;
+    *log_used = log_number;
   }
-  total_log_size_ += log_entry.size();
+  total_log_size_ += *log_size;
   // TODO(myabandeh): it might be unsafe to access alive_log_files_.back() here
   // since alive_log_files_ might be modified concurrently
-  alive_log_files_.back().AddSize(log_entry.size());
+  // The logs of the current WAL are the last entries of alive_log_files_.
+  assert(log_number >= logfile_number_ &&
+         log_number < logfile_number_ + immutable_db_options_.wal_streams);
+  alive_log_files_
+      .rbegin()[logfile_number_ + immutable_db_options_.wal_streams - 1 -
+                log_number]
+      .AddSize(*log_size);
   log_empty_ = false;
   return io_s;
 }
 
+// With wal_streams > 1, recovery merges the logs of the WAL by sequence
+// number and takes a gap in the sequence numbers for records lost with the
+// tail of a log. So when a write group starts past the end of the last record
+// written to the WAL, e.g. after writes with disableWAL, a header-only record
+// with the sequence number the gap starts at is written to the group's log
+// first. Header-only records are reserved for that, so the record of a group
+// with nothing in it is not written.
+IOStatus DBImpl::WriteWALStreamsGapMarker(const WriteBatch* merged_batch,
+                                          log::Writer* log_writer,
+                                          SequenceNumber sequence,
+                                          bool* skip_record) {
+  *skip_record = false;
+  if (WriteBatchInternal::Count(merged_batch) == 0) {
+    bool empty = true;
+    if (merged_batch == &tmp_batch_) {
+      for (size_t i = 1; i < tmp_wal_records_.size(); ++i) {
+        empty = empty && tmp_wal_records_[i].empty();
+      }
+    } else {
+      empty = WriteBatchInternal::ByteSize(merged_batch) ==
+              WriteBatchInternal::kHeader;
+    }
+    if (empty) {
+      *skip_record = true;
+      return IOStatus::OK();
+    }
+  }
+  if (wal_streams_next_seq_ == 0 || wal_streams_next_seq_ == sequence) {
+    return IOStatus::OK();
+  }
+  assert(wal_streams_next_seq_ < sequence);
+  WriteBatch gap_marker;
+  WriteBatchInternal::SetSequence(&gap_marker, wal_streams_next_seq_);
+  uint64_t marker_size;
+  return WriteToWAL(gap_marker, log_writer, nullptr /*log_used*/,
+                    &marker_size);
+}
+
 IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
                             log::Writer* log_writer, uint64_t* log_used,
                             bool need_log_sync, bool need_log_dir_sync,
@@ -1067,20 +1172,47 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   // Same holds for all in the batch group
   size_t write_with_wal = 0;
   WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch = MergeBatch(write_group, &tmp_batch_,
-                                        &write_with_wal, &to_be_cached_state);
+  WriteBatch* merged_batch =
+      MergeBatch(write_group, &tmp_batch_, &write_with_wal,
+                 &to_be_cached_state, &tmp_wal_records_);
   if (merged_batch == write_group.leader->batch) {
-    write_group.leader->log_used = logfile_number_;
+    write_group.leader->log_used = log_writer->get_log_number();
   } else if (write_with_wal > 1) {
     for (auto writer : write_group) {
-      writer->log_used = logfile_number_;
+      writer->log_used = log_writer->get_log_number();
     }
   }
 
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
-  uint64_t log_size;
-  io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+  uint64_t log_size = 0;
+  bool skip_record = false;
+  if (immutable_db_options_.wal_streams > 1) {
+    io_s = WriteWALStreamsGapMarker(merged_batch, log_writer, sequence,
+                                    &skip_record);
+  }
+  if (io_s.ok() && !skip_record) {
+    if (merged_batch == &tmp_batch_) {
+      // tmp_batch_ only holds the header of the merged batch.
+      tmp_wal_records_[0] = WriteBatchInternal::Contents(merged_batch);
+      io_s = WriteToWAL(SliceParts(tmp_wal_records_.data(),
+                                   static_cast<int>(tmp_wal_records_.size())),
+                        log_writer, log_used, &log_size);
+    } else if (WriteBatchInternal::HasPinnedValues(merged_batch)) {
+      // Write the pinned values straight from the caller's memory.
+      WriteBatchInternal::ContentsReference(merged_batch, &tmp_wal_records_);
+      io_s = WriteToWAL(SliceParts(tmp_wal_records_.data(),
+                                   static_cast<int>(tmp_wal_records_.size())),
+                        log_writer, log_used, &log_size);
+      tmp_wal_records_.clear();
+    } else {
+      io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+    }
+    if (io_s.ok() && immutable_db_options_.wal_streams > 1) {
+      wal_streams_next_seq_ =
+          sequence + WriteBatchInternal::Count(merged_batch);
+    }
+  }
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
     cached_recoverable_state_empty_ = false;
@@ -1112,6 +1244,7 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
 
   if (merged_batch == &tmp_batch_) {
     tmp_batch_.Clear();
+    tmp_wal_records_.clear();
   }
   if (io_s.ok()) {
     auto stats = default_cf_internal_stats_;
@@ -1288,7 +1421,13 @@ Status DBImpl::SwitchWAL(WriteContext* write_context) {
     // transactions then we cannot flush this log until those transactions are
     // commited.
     unable_to_release_oldest_log_ = false;
-    alive_log_files_.begin()->getting_flushed = true;
+    // With wal_streams > 1, the logs of the oldest WAL are released together.
+    for (auto it = alive_log_files_.begin();
+         it != alive_log_files_.end() &&
+         it->number < oldest_alive_log + immutable_db_options_.wal_streams;
+         ++it) {
+      it->getting_flushed = true;
+    }
   }
 
   ROCKS_LOG_INFO(
@@ -1354,10 +1493,12 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
   // thread is writing to another DB with the same write buffer, they may also
   // be flushed. We may end up with flushing much more DBs than needed. It's
   // suboptimal but still correct.
+  const bool by_weighted_size = write_buffer_manager_->flush_by_weighted_size();
   ROCKS_LOG_INFO(
       immutable_db_options_.info_log,
-      "Flushing column family with oldest memtable entry. Write buffer is "
+      "Flushing column family with %s. Write buffer is "
       "using %" ROCKSDB_PRIszt " bytes out of a total of %" ROCKSDB_PRIszt ".",
+      by_weighted_size ? "largest weighted memtable" : "oldest memtable entry",
       write_buffer_manager_->memory_usage(),
       write_buffer_manager_->buffer_size());
   // no need to refcount because drop is happening in write thread, so can't
@@ -1368,6 +1509,7 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
   } else {
     ColumnFamilyData* cfd_picked = nullptr;
     SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
+    double weighted_size_for_cf_picked = 0;
 
     for (auto cfd : *versions_->GetColumnFamilySet()) {
       if (cfd->IsDropped()) {
@@ -1376,6 +1518,20 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
       if (!cfd->mem()->IsEmpty()) {
         // We only consider active mem table, hoping immutable memtable is
         // already in the process of flushing.
+        if (by_weighted_size) {
+          // The column family most over its share of the write buffer.
+          double weight =
+              cfd->GetLatestMutableCFOptions()->write_buffer_weight;
+          double weighted_size =
+              static_cast<double>(cfd->mem()->ApproximateMemoryUsageFast()) /
+              (weight > 0 ? weight : 1.0);
+          if (cfd_picked == nullptr ||
+              weighted_size > weighted_size_for_cf_picked) {
+            cfd_picked = cfd;
+            weighted_size_for_cf_picked = weighted_size;
+          }
+          continue;
+        }
         uint64_t seq = cfd->mem()->GetCreationSeq();
         if (cfd_picked == nullptr || seq < seq_num_for_cf_picked) {
           cfd_picked = cfd;
@@ -1700,8 +1856,11 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       !log_recycle_files_.empty()) {
     recycle_log_number = log_recycle_files_.front();
   }
-  uint64_t new_log_number =
-      creating_new_log ? versions_->NewFileNumber() : logfile_number_;
+  const size_t wal_streams = immutable_db_options_.wal_streams;
+  uint64_t new_log_number = creating_new_log
+                                ? versions_->FetchAddFileNumber(wal_streams)
+                                : logfile_number_;
+  autovector<log::Writer*> new_stream_logs;
   const MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
 
   // Set memtable_info for memtable sealed callback
@@ -1724,6 +1883,10 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     // of mutable_cf_options.write_buffer_size.
     io_s = CreateWAL(new_log_number, recycle_log_number, preallocate_block_size,
                      &new_log);
+    if (io_s.ok() && wal_streams > 1) {
+      io_s = CreateWALStreams(new_log_number, preallocate_block_size,
+                              &new_stream_logs);
+    }
     if (s.ok()) {
       s = io_s;
     }
@@ -1749,9 +1912,10 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   if (s.ok() && creating_new_log) {
     log_write_mutex_.Lock();
     assert(new_log != nullptr);
-    if (!logs_.empty()) {
-      // Alway flush the buffer of the last log before switching to a new one
-      log::Writer* cur_log_writer = logs_.back().writer;
+    // Alway flush the buffer of the last logs before switching to new ones
+    for (size_t i = logs_.size() - std::min(logs_.size(), wal_streams);
+         i < logs_.size() && s.ok(); ++i) {
+      log::Writer* cur_log_writer = logs_[i].writer;
       io_s = cur_log_writer->WriteBuffer();
       if (s.ok()) {
         s = io_s;
@@ -1765,11 +1929,26 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       }
     }
     if (s.ok()) {
+      const SequenceNumber last_sequence = versions_->LastSequence();
+      if (wal_streams > 1) {
+        for (auto& log : logs_) {
+          log.closed_seq = std::min(log.closed_seq, last_sequence);
+        }
+      }
       logfile_number_ = new_log_number;
       log_empty_ = true;
       log_dir_synced_ = false;
       logs_.emplace_back(logfile_number_, new_log);
       alive_log_files_.push_back(LogFileNumberSize(logfile_number_));
+      for (log::Writer* stream_log : new_stream_logs) {
+        logs_.emplace_back(stream_log->get_log_number(), stream_log);
+        alive_log_files_.push_back(
+            LogFileNumberSize(stream_log->get_log_number()));
+      }
+      for (size_t i = logs_.size() - wal_streams; i < logs_.size(); ++i) {
+        logs_[i].synced_seq = last_sequence;
+      }
+      new_stream_logs.clear();
     }
     log_write_mutex_.Unlock();
   }
@@ -1783,6 +1962,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
     if (new_log) {
       delete new_log;
     }
+    for (log::Writer* stream_log : new_stream_logs) {
+      delete stream_log;
+    }
     SuperVersion* new_superversion =
         context->superversion_context.new_superversion.release();
     if (new_superversion != nullptr) {
@@ -1869,8 +2051,14 @@ Status DB::Put(const WriteOptions& opt, ColumnFamilyHandle* column_family,
     // Pre-allocate size of write batch conservatively.
     // 8 bytes are taken by header, 4 bytes for count, 1 byte for type,
     // and we allocate 11 extra bytes for key length, as well as value length.
-    WriteBatch batch(key.size() + value.size() + 24);
-    Status s = batch.Put(column_family, key, value);
+    // Values the caller asks to pin are only referenced by the batch, which
+    // does not outlive them, so they are copied straight into the WAL and the
+    // memtable.
+    const bool pin_value = opt.put_pinned_value_min_size > 0 &&
+                           value.size() >= opt.put_pinned_value_min_size;
+    WriteBatch batch(key.size() + (pin_value ? 0 : value.size()) + 24);
+    Status s = pin_value ? batch.PutPinnedValue(column_family, key, value)
+                         : batch.Put(column_family, key, value);
     if (!s.ok()) {
       return s;
     }
@@ -147,6 +147,23 @@ TEST_F(DBSecondaryTest, ReopenAsSecondary) {
   ASSERT_EQ(2, count);
 }
 
+TEST_F(DBSecondaryTest, OpenAsSecondaryWALStreams) {
+  Options options;
+  options.env = env_;
+  options.wal_streams = 2;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "foo_value"));
+
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  options1.wal_streams = 2;
+  ASSERT_TRUE(TryOpenSecondary(options1).IsInvalidArgument());
+  // The WALs of the primary are written with 2 streams.
+  options1.wal_streams = 1;
+  ASSERT_TRUE(TryOpenSecondary(options1).IsNotSupported());
+}
+
 TEST_F(DBSecondaryTest, OpenAsSecondary) {
   Options options;
   options.env = env_;
@@ -10,6 +10,7 @@
 #include "db/memtable.h"
 #include "db/range_del_aggregator.h"
 #include "port/stack_trace.h"
+#include "rocksdb/arena_block_pool.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
 
@@ -204,6 +205,198 @@ TEST_F(DBMemTableTest, DuplicateSeq) {
   delete mem;
 }
 
+// The bytewise fast path of MemTable::KeyComparator must order keys exactly
+// like the internal key comparator, including keys shorter than the 8-byte
+// prefix and keys that tie on it.
+TEST_F(DBMemTableTest, KeyComparatorPrefixOrder) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator key_cmp(icmp);
+  ASSERT_EQ(BytewiseComparator(), key_cmp.user_comparator());
+
+  const char kAlphabet[] = {'\0', '\x01', 'a', '\x7f', '\x80', '\xff'};
+  Random rnd(301);
+  std::vector<std::string> memtable_keys;
+  for (int i = 0; i < 500; i++) {
+    std::string user_key;
+    int len = rnd.Uniform(13);
+    for (int j = 0; j < len; j++) {
+      user_key.push_back(kAlphabet[rnd.Uniform(sizeof(kAlphabet))]);
+    }
+    std::string memtable_key;
+    EncodeKey(&memtable_key,
+              InternalKey(user_key, rnd.Uniform(4), kTypeValue).Encode());
+    memtable_keys.push_back(memtable_key);
+  }
+
+  auto sign = [](int v) { return (v > 0) - (v < 0); };
+  for (const auto& a : memtable_keys) {
+    for (const auto& b : memtable_keys) {
+      Slice ikey_a = GetLengthPrefixedSlice(a.data());
+      Slice ikey_b = GetLengthPrefixedSlice(b.data());
+      int expected = sign(icmp.CompareKeySeq(ikey_a, ikey_b));
+      ASSERT_EQ(expected, sign(key_cmp(a.data(), b.data())));
+      ASSERT_EQ(expected, sign(key_cmp(a.data(), ikey_b)));
+    }
+  }
+}
+
+#ifndef ROCKSDB_LITE
+// Verifies point lookups through the hash index of HashIndexedSkipListRep,
+// including concurrent inserts, snapshots older than the newest version, merge
+// operands and keys that no longer fit in the index.
+TEST_F(DBMemTableTest, HashIndexedSkipListGet) {
+  const int kNumKeys = 100;
+  const int kNumVersions = 10;
+  Options options;
+  options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+  // Far fewer slots than keys so that some keys overflow the index.
+  options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(16));
+  options.allow_concurrent_memtable_write = true;
+  InternalKeyComparator cmp(BytewiseComparator());
+  ImmutableCFOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+
+  // Key i gets versions with sequence numbers i * kNumVersions + v + 1,
+  // written by two threads.
+  auto writer = [&](int first_key, int last_key) {
+    MemTablePostProcessInfo post_process_info;
+    for (int v = 0; v < kNumVersions; v++) {
+      for (int i = first_key; i < last_key; i++) {
+        SequenceNumber seq = i * kNumVersions + v + 1;
+        ASSERT_TRUE(mem->Add(seq, kTypeValue, "key" + ToString(i),
+                             "v" + ToString(v), true, &post_process_info));
+      }
+    }
+  };
+  ROCKSDB_NAMESPACE::port::Thread write_thread1(writer, 0, kNumKeys / 2);
+  ROCKSDB_NAMESPACE::port::Thread write_thread2(writer, kNumKeys / 2,
+                                                kNumKeys);
+  write_thread1.join();
+  write_thread2.join();
+
+  SequenceNumber seq = kNumKeys * kNumVersions;
+  std::string value;
+  for (uint64_t i = 1; i <= 3; i++) {
+    value.clear();
+    PutFixed64(&value, i);
+    ASSERT_TRUE(mem->Add(++seq, kTypeMerge, "merge_key", value));
+  }
+
+  ReadOptions roptions;
+  auto get = [&](const std::string& key, SequenceNumber snapshot,
+                 std::string* result) {
+    Status status;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    LookupKey lkey(key, snapshot);
+    result->clear();
+    return mem->Get(lkey, result, /*timestamp=*/nullptr, &status,
+                    &merge_context, &max_covering_tombstone_seq, roptions) &&
+           status.ok();
+  };
+
+  for (int i = 0; i < kNumKeys; i++) {
+    std::string key = "key" + ToString(i);
+    ASSERT_TRUE(get(key, kMaxSequenceNumber, &value));
+    ASSERT_EQ("v" + ToString(kNumVersions - 1), value);
+    // Snapshot older than the newest version.
+    ASSERT_TRUE(get(key, i * kNumVersions + 3, &value));
+    ASSERT_EQ("v2", value);
+    // Snapshot older than the first version.
+    ASSERT_FALSE(get(key, i * kNumVersions, &value));
+  }
+  ASSERT_FALSE(get("key", kMaxSequenceNumber, &value));
+  ASSERT_FALSE(get("missing", kMaxSequenceNumber, &value));
+
+  // Without a base value the memtable only collects the merge operands.
+  auto get_operands = [&](SequenceNumber snapshot) {
+    Status status;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    LookupKey lkey("merge_key", snapshot);
+    std::string result;
+    EXPECT_FALSE(mem->Get(lkey, &result, /*timestamp=*/nullptr, &status,
+                          &merge_context, &max_covering_tombstone_seq,
+                          roptions));
+    EXPECT_TRUE(status.IsMergeInProgress());
+    return merge_context.GetNumOperands();
+  };
+  ASSERT_EQ(3U, get_operands(kMaxSequenceNumber));
+  ASSERT_EQ(2U, get_operands(seq - 1));
+
+  // Iteration still covers every entry in order.
+  Arena arena;
+  ScopedArenaIterator iter(mem->NewIterator(roptions, &arena));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_EQ(kNumKeys * kNumVersions + 3, count);
+
+  delete mem;
+}
+
+namespace {
+// Compares keys ignoring the case of ASCII letters, so that keys with
+// different bytes can be equal.
+class CaseInsensitiveComparator : public Comparator {
+ public:
+  const char* Name() const override { return "CaseInsensitiveComparator"; }
+
+  int Compare(const Slice& a, const Slice& b) const override {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; i++) {
+      int ca = tolower(static_cast<unsigned char>(a[i]));
+      int cb = tolower(static_cast<unsigned char>(b[i]));
+      if (ca != cb) {
+        return ca < cb ? -1 : 1;
+      }
+    }
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+  }
+
+  void FindShortestSeparator(std::string* /*start*/,
+                             const Slice& /*limit*/) const override {}
+
+  void FindShortSuccessor(std::string* /*key*/) const override {}
+};
+}  // namespace
+
+// The hash index can't be used with a comparator that treats keys with
+// different bytes as equal, as a lookup of one of them wouldn't find the
+// other.
+TEST_F(DBMemTableTest, HashIndexedSkipListCaseInsensitiveComparator) {
+  CaseInsensitiveComparator ucmp;
+  Options options;
+  options.comparator = &ucmp;
+  options.memtable_factory.reset(NewHashIndexedSkipListRepFactory(16));
+  InternalKeyComparator cmp(&ucmp);
+  ImmutableCFOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+  ASSERT_TRUE(mem->Add(1, kTypeValue, "Key", "value"));
+
+  ReadOptions roptions;
+  for (const char* key : {"Key", "key", "KEY"}) {
+    std::string value;
+    Status status;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    LookupKey lkey(key, kMaxSequenceNumber);
+    ASSERT_TRUE(mem->Get(lkey, &value, /*timestamp=*/nullptr, &status,
+                         &merge_context, &max_covering_tombstone_seq,
+                         roptions));
+    ASSERT_OK(status);
+    ASSERT_EQ("value", value);
+  }
+
+  delete mem;
+}
+#endif  // ROCKSDB_LITE
+
 // A simple test to verify that the concurrent merge writes is functional
 TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   int num_ops = 1000;
@@ -332,6 +525,159 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, SeqnoFilter) {
+  Options options = CurrentOptions();
+  options.memtable_seqno_filter_bucket_count = 1024;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("old", "v0"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  for (int i = 1; i <= 10; i++) {
+    ASSERT_OK(Put("old", "v" + ToString(i)));
+    ASSERT_OK(Put("new", "v" + ToString(i)));
+    ASSERT_OK(Merge("merged", "m" + ToString(i)));
+  }
+
+  get_perf_context()->Reset();
+  SetPerfLevel(kEnableCount);
+  // Every version of "new" and "merged" is newer than the snapshot.
+  ASSERT_EQ("NOT_FOUND", Get("new", snapshot));
+  ASSERT_EQ("NOT_FOUND", Get("merged", snapshot));
+  ASSERT_EQ(2, get_perf_context()->seqno_filter_memtable_miss_count);
+  ASSERT_EQ("v0", Get("old", snapshot));
+  ASSERT_EQ(2, get_perf_context()->seqno_filter_memtable_miss_count);
+
+  std::vector<std::string> values =
+      MultiGet({"merged", "new", "old"}, snapshot);
+  ASSERT_EQ(3, values.size());
+  ASSERT_EQ("NOT_FOUND", values[0]);
+  ASSERT_EQ("NOT_FOUND", values[1]);
+  ASSERT_EQ("v0", values[2]);
+  ASSERT_EQ(4, get_perf_context()->seqno_filter_memtable_miss_count);
+
+  // Reads at the latest sequence number still see everything.
+  ASSERT_EQ("v10", Get("new"));
+  ASSERT_EQ("m1,m2,m3,m4,m5,m6,m7,m8,m9,m10", Get("merged"));
+  ASSERT_EQ(4, get_perf_context()->seqno_filter_memtable_miss_count);
+
+  // Older versions in the SST file are still found once the newer ones sit
+  // in a memtable that the filter skips.
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("old", "v11"));
+  ASSERT_EQ("v0", Get("old", snapshot));
+  SetPerfLevel(kDisable);
+
+  db_->ReleaseSnapshot(snapshot);
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBMemTableTest, VersionChainSnapshotReads) {
+  Options options = CurrentOptions();
+  options.allow_concurrent_memtable_write = false;
+  options.memtable_factory.reset(NewVersionChainRepFactory());
+  DestroyAndReopen(options);
+
+  // A few hot keys with many versions each, and snapshots taken in between.
+  const int kNumKeys = 3;
+  const int kNumRounds = 200;
+  std::vector<const Snapshot*> snapshots;
+  for (int round = 0; round < kNumRounds; ++round) {
+    for (int k = 0; k < kNumKeys; ++k) {
+      ASSERT_OK(Put("key" + ToString(k), "v" + ToString(round)));
+    }
+    if (round % 50 == 0) {
+      snapshots.push_back(db_->GetSnapshot());
+    }
+  }
+  ASSERT_OK(Delete("key1"));
+
+  auto verify = [&]() {
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+      for (int k = 0; k < kNumKeys; ++k) {
+        ASSERT_EQ("v" + ToString(i * 50),
+                  Get("key" + ToString(k), snapshots[i]));
+      }
+      ASSERT_EQ("NOT_FOUND", Get("key", snapshots[i]));
+      ASSERT_EQ("NOT_FOUND", Get("key3", snapshots[i]));
+    }
+    ASSERT_EQ("v" + ToString(kNumRounds - 1), Get("key0"));
+    ASSERT_EQ("NOT_FOUND", Get("key1"));
+    ASSERT_EQ("v" + ToString(kNumRounds - 1), Get("key2"));
+
+    ReadOptions ro;
+    ro.snapshot = snapshots[1];
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ("key" + ToString(count), iter->key().ToString());
+      ASSERT_EQ("v50", iter->value().ToString());
+      ++count;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, count);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      --count;
+      ASSERT_EQ("key" + ToString(count), iter->key().ToString());
+    }
+    ASSERT_EQ(0, count);
+    iter->Seek("key1");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("key1", iter->key().ToString());
+    iter->SeekForPrev("key10");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("key1", iter->key().ToString());
+
+    iter.reset(db_->NewIterator(ReadOptions()));
+    iter->Seek("key1");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("key2", iter->key().ToString());
+    iter->Prev();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("key0", iter->key().ToString());
+  };
+
+  verify();
+  ASSERT_OK(Flush());
+  verify();
+
+  for (auto* snapshot : snapshots) {
+    db_->ReleaseSnapshot(snapshot);
+  }
+}
+#endif  // ROCKSDB_LITE
+
+TEST_F(DBMemTableTest, ArenaBlockPool) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 16 * 1024;
+  std::shared_ptr<ArenaBlockPool> pool =
+      std::make_shared<ArenaBlockPool>(1024 * 1024);
+  options.arena_block_pool = pool;
+  DestroyAndReopen(options);
+
+  // Blocks of flushed memtables are given back to the pool
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(1000)));
+  }
+  ASSERT_OK(Flush());
+  // The flushed memtable is freed after the flush result is installed.
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_GT(pool->GetPooledBytes(), 0U);
+  ASSERT_EQ(0U, pool->GetReusedBlocks());
+
+  // and reused by the next memtables.
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(1000, 'b')));
+  }
+  ASSERT_GT(pool->GetReusedBlocks(), 0U);
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(DummyString(1000, 'b'), Get(Key(i)));
+  }
+  Close();
+  ASSERT_LE(pool->GetPooledBytes(), pool->capacity());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -282,6 +282,7 @@ TEST_F(DBPropertiesTest, ValidatePropertyInfo) {
     count += (ppt_name_and_info.second.handle_string == nullptr) ? 0 : 1;
     count += (ppt_name_and_info.second.handle_int == nullptr) ? 0 : 1;
     count += (ppt_name_and_info.second.handle_string_dbimpl == nullptr) ? 0 : 1;
+    count += (ppt_name_and_info.second.handle_map_dbimpl == nullptr) ? 0 : 1;
     ASSERT_TRUE(count == 1);
   }
 }
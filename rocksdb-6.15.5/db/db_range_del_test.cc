@@ -697,6 +697,35 @@ TEST_F(DBRangeDelTest, GetCoveredKeyFromSst) {
   } while (ChangeOptions(kRangeDelSkipConfigs));
 }
 
+TEST_F(DBRangeDelTest, GetFromSstBelowAllTombstones) {
+  do {
+    DestroyAndReopen(CurrentOptions());
+    ASSERT_OK(db_->Put(WriteOptions(), "key", "val"));
+    const Snapshot* snapshot = db_->GetSnapshot();
+    ASSERT_OK(
+        db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a", "j"));
+    ASSERT_OK(
+        db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "j", "z"));
+    ASSERT_OK(db_->Flush(FlushOptions()));
+
+    // Every tombstone in the file is newer than the snapshot.
+    ReadOptions read_opts;
+    read_opts.snapshot = snapshot;
+    std::string value;
+    ASSERT_OK(db_->Get(read_opts, "key", &value));
+    ASSERT_EQ("val", value);
+    auto* iter = db_->NewIterator(read_opts);
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("key", iter->key());
+    delete iter;
+
+    read_opts.snapshot = nullptr;
+    ASSERT_TRUE(db_->Get(read_opts, "key", &value).IsNotFound());
+    db_->ReleaseSnapshot(snapshot);
+  } while (ChangeOptions(kRangeDelSkipConfigs));
+}
+
 TEST_F(DBRangeDelTest, GetCoveredMergeOperandFromMemtable) {
   const int kNumMergeOps = 10;
   Options opts = CurrentOptions();
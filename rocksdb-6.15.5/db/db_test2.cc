@@ -613,6 +613,63 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest2, SharedWriteBufferFlushByWeightedSize) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  // Avoid undeterministic value by malloc_usable_size();
+  // Force arena block size to 1
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::Arena:0", [&](void* arg) {
+        size_t* block_size = static_cast<size_t*>(arg);
+        *block_size = 1;
+      });
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::AllocateNewBlock:0", [&](void* arg) {
+        std::pair<size_t*, size_t*>* pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        *std::get<0>(*pair) = *std::get<1>(*pair);
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  options.write_buffer_size = 500000;  // this is never hit
+  // Use a write buffer total size so that the soft limit is about
+  // 105000.
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(120000, {}, true /* flush_by_weighted_size */));
+  CreateColumnFamilies({"cf1", "cf2"}, options);
+  Options cf1_options = options;
+  cf1_options.write_buffer_weight = 4;
+  ReopenWithColumnFamilies({"default", "cf1", "cf2"},
+                           {options, cf1_options, options});
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  std::function<void()> wait_flush = [&]() {
+    dbfull()->TEST_WaitForFlushMemTable(handles_[0]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[1]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[2]);
+  };
+
+  // cf1 holds the oldest and largest memtable, but it is entitled to four
+  // times the share of the others, so cf2 is the one over its share.
+  ASSERT_OK(Put(1, Key(1), DummyString(50000), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(40000), wo));
+  ASSERT_OK(Put(0, Key(1), DummyString(20000), wo));
+  wait_flush();
+  ASSERT_OK(Put(0, Key(2), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf1"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(1));
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DBTest2, TestWriteBufferNoLimitWithCache) {
   Options options = CurrentOptions();
   options.arena_block_size = 4096;
@@ -4725,8 +4782,163 @@ TEST_F(DBTest2, RowCacheSnapshot) {
   db_->ReleaseSnapshot(s2);
   db_->ReleaseSnapshot(s3);
 }
+
+TEST_F(DBTest2, RowCacheSnapshotAware) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8 * 8192);
+  options.row_cache_snapshot_aware = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar1"));
+  const Snapshot* s1 = db_->GetSnapshot();
+  ASSERT_OK(Put("foo2", "bar"));
+  const Snapshot* s2 = db_->GetSnapshot();
+  ASSERT_OK(Put("foo", "bar2"));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(Put("foo3", "bar"));
+  const Snapshot* s3 = db_->GetSnapshot();
+
+  // s1 and s2 both see bar1, so they share a single entry.
+  ASSERT_EQ(Get("foo", s1), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 0);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(Get("foo", s2), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(Get("foo", s1), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  // bar2 is outside of the cached range and replaces the entry.
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+  ASSERT_EQ(Get("foo", s3), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 3);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+  ASSERT_EQ(Get("foo", s2), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 3);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 3);
+  ASSERT_EQ(Get("foo", s1), "bar1");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 4);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 3);
+
+  // Files with range tombstones are never cached.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "b"));
+  ASSERT_OK(Put("foo4", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("foo4"), "bar");
+  ASSERT_EQ(Get("foo4"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 4);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 5);
+
+  db_->ReleaseSnapshot(s1);
+  db_->ReleaseSnapshot(s2);
+  db_->ReleaseSnapshot(s3);
+}
 #endif  // ROCKSDB_LITE
 
+TEST_F(DBTest2, HotKeyCache) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.hot_key_cache_size = 16;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  // The second read gets the key admitted.
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ(2, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // A write drops the key.
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(3, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(2, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  // The cached value was read after the snapshot.
+  ASSERT_EQ("v1", Get("foo", snapshot));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  db_->ReleaseSnapshot(snapshot);
+  snapshot = db_->GetSnapshot();
+  ASSERT_EQ("v2", Get("foo", snapshot));
+  ASSERT_EQ(3, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  db_->ReleaseSnapshot(snapshot);
+
+  ASSERT_OK(Delete("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+
+  // A range deletion drops all keys.
+  ASSERT_OK(Put("bar", "v1"));
+  ASSERT_EQ("v1", Get("bar"));
+  ASSERT_EQ("v1", Get("bar"));
+  ASSERT_EQ("v1", Get("bar"));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "c"));
+  ASSERT_EQ("NOT_FOUND", Get("bar"));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+}
+
+TEST_F(DBTest2, HotKeyCacheIgnoreRangeDeletions) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.hot_key_cache_size = 16;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  // Reads that see the deleted value neither use the cache nor fill it.
+  ReadOptions read_options;
+  read_options.ignore_range_deletions = true;
+  for (int i = 0; i < 3; i++) {
+    std::string value;
+    ASSERT_OK(db_->Get(read_options, "foo", &value));
+    ASSERT_EQ("v1", value);
+  }
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+
+  // Nor do they return what other reads cached.
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  std::string value;
+  ASSERT_OK(db_->Get(read_options, "foo", &value));
+  ASSERT_EQ("v2", value);
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+}
+
+TEST_F(DBTest2, HotKeyCacheUnorderedWrite) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.hot_key_cache_size = 16;
+  options.unordered_write = true;
+  DestroyAndReopen(options);
+
+  // A read may not see a write below its sequence number, so the DB doesn't
+  // cache any value.
+  ASSERT_OK(Put("foo", "v1"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("v1", Get("foo"));
+  }
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+}
+
 // When DB is reopened with multiple column families, the manifest file
 // is written after the first CF is flushed, and it is written again
 // after each flush. If DB crashes between the flushes, the flushed CF
@@ -1072,6 +1072,148 @@ TEST_F(DBWALTest, PartOfWritesWithWALDisabled) {
   Destroy(options);
 }
 
+TEST_F(DBWALTest, WALStreamsRecover) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = CurrentOptions();
+  options.env = fault_env.get();
+  options.wal_streams = 3;
+  DestroyAndReopen(options);
+
+  WriteOptions wal_on, wal_off;
+  wal_on.sync = true;
+  wal_off.disableWAL = true;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i), wal_on));
+  }
+  // Writes without WAL leave holes in the sequence numbers that recovery has
+  // to step over.
+  ASSERT_OK(Put("nowal", "x", wal_off));
+  for (int i = 10; i < 20; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i), wal_on));
+  }
+  ASSERT_OK(dbfull()->SyncWAL());
+
+  // Simulate a crash. Only synced data survives.
+  fault_env->SetFilesystemActive(false);
+  Close();
+  fault_env->ResetState();
+  Reopen(options);
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  ASSERT_EQ("NOT_FOUND", Get("nowal"));
+
+  // Writes after a memtable switch go to the next generation of streams.
+  ASSERT_OK(Put(Key(20), "v20", wal_on));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put(Key(21), "v21", wal_on));
+  ASSERT_OK(Put(Key(22), "v22", wal_on));
+  Reopen(options);
+  for (int i = 0; i < 23; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  // Destroy DB before destruct fault_env.
+  Destroy(options);
+}
+
+TEST_F(DBWALTest, WALStreamsStopAtLostRecord) {
+  Options options = CurrentOptions();
+  options.wal_streams = 2;
+  options.avoid_flush_during_recovery = true;
+  DestroyAndReopen(options);
+
+  // Writes alternate between the two streams, starting with the first one.
+  const uint64_t first_stream = dbfull()->TEST_LogfileNumber();
+  const std::string fname = LogFileName(dbname_, first_stream);
+  ASSERT_OK(Put("k0", "v0"));
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Put("k2", "v2"));
+  ASSERT_OK(Put("k3", "v3"));
+  uint64_t size;
+  ASSERT_OK(env_->GetFileSize(fname, &size));
+  ASSERT_OK(Put("k4", "v4"));
+  ASSERT_OK(Put("k5", "v5"));
+  Close();
+
+  // Drop k4 from the first stream. k5 is intact in the second stream, but
+  // recovering it without k4 would not be a prefix of the writes.
+  ASSERT_OK(test::TruncateFile(env_, fname, size));
+  options.wal_recovery_mode = WALRecoveryMode::kAbsoluteConsistency;
+  ASSERT_TRUE(TryReopen(options).IsCorruption());
+
+  options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+  Reopen(options);
+  ASSERT_EQ("v0", Get("k0"));
+  ASSERT_EQ("v1", Get("k1"));
+  ASSERT_EQ("v2", Get("k2"));
+  ASSERT_EQ("v3", Get("k3"));
+  ASSERT_EQ("NOT_FOUND", Get("k4"));
+  ASSERT_EQ("NOT_FOUND", Get("k5"));
+
+  // k5 must not come back after the next restart either.
+  ASSERT_OK(Put("k6", "v6"));
+  Reopen(options);
+  ASSERT_EQ("NOT_FOUND", Get("k5"));
+  ASSERT_EQ("v6", Get("k6"));
+}
+
+TEST_F(DBWALTest, WALStreamsIncompatibleOptions) {
+  Options options = CurrentOptions();
+  options.wal_streams = 0;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.wal_streams = 2;
+  options.enable_pipelined_write = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.enable_pipelined_write = false;
+  options.manual_wal_flush = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+  options.manual_wal_flush = false;
+  ASSERT_OK(TryReopen(options));
+}
+
+TEST_F(DBWALTest, WALStreamsChangeCount) {
+  Options options = CurrentOptions();
+  options.avoid_flush_during_recovery = true;
+  options.avoid_flush_during_shutdown = true;
+  options.wal_streams = 3;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("k0", "v0"));
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Put("k2", "v2"));
+  ASSERT_OK(Put("k3", "v3"));
+
+  // The WALs are replayed with the count they were written with, and flushed
+  // so that the new count applies to all live WALs.
+  options.wal_streams = 1;
+  Reopen(options);
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v0", Get("k0"));
+  ASSERT_EQ("v1", Get("k1"));
+  ASSERT_EQ("v2", Get("k2"));
+  ASSERT_EQ("v3", Get("k3"));
+
+  // A single stream WAL has no record for the writes without WAL, which
+  // must not stop its replay.
+  WriteOptions wal_off;
+  wal_off.disableWAL = true;
+  ASSERT_OK(Put("k4", "v4"));
+  ASSERT_OK(Put("nowal", "x", wal_off));
+  ASSERT_OK(Put("k5", "v5"));
+  options.wal_streams = 3;
+  Reopen(options);
+  ASSERT_EQ(2, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v4", Get("k4"));
+  ASSERT_EQ("NOT_FOUND", Get("nowal"));
+  ASSERT_EQ("v5", Get("k5"));
+
+  // With the same count, the WALs are not flushed.
+  ASSERT_OK(Put("k6", "v6"));
+  Reopen(options);
+  ASSERT_EQ(2, NumTableFilesAtLevel(0));
+  ASSERT_EQ("v6", Get("k6"));
+}
+
 //
 // Test WAL recovery for the various modes available
 //
@@ -441,6 +441,197 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, PipelinedWalSync) {
+  Options options = GetOptions();
+  if (options.two_write_queues) {
+    // Not supported.
+    return;
+  }
+  options.pipelined_wal_sync = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  Reopen(options);
+  WriteOptions sync_options;
+  sync_options.sync = true;
+
+  // A non-sync write completes while a sync write has its WAL sync in flight.
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBWriteTest::PipelinedWalSync:NoSyncWriteDone",
+        "DBWALTest::SyncWALNotWaitWrite:1"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  port::Thread sync_writer(
+      [&] { ASSERT_OK(dbfull()->Put(sync_options, "a", "1")); });
+  ASSERT_OK(Put("b", "2"));
+  TEST_SYNC_POINT("DBWriteTest::PipelinedWalSync:NoSyncWriteDone");
+  sync_writer.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  SyncPoint::GetInstance()->LoadDependency({});
+  ASSERT_EQ(1, options.statistics->getTickerCount(WAL_FILE_SYNCED));
+  ASSERT_EQ(0, options.statistics->getTickerCount(WAL_FILE_SYNC_SHARED));
+
+  // A sync write that completed before another sync write started its WAL
+  // sync shares that sync.
+  std::atomic<bool> first_waiting{false};
+  std::atomic<bool> second_done{false};
+  std::atomic<int> num_callbacks{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::WriteImpl:BeforePipelinedWALSync", [&](void*) {
+        if (num_callbacks.fetch_add(1) == 0) {
+          first_waiting.store(true);
+          while (!second_done.load()) {
+            env_->SleepForMicroseconds(100);
+          }
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  sync_writer = port::Thread(
+      [&] { ASSERT_OK(dbfull()->Put(sync_options, "c", "3")); });
+  while (!first_waiting.load()) {
+    env_->SleepForMicroseconds(100);
+  }
+  ASSERT_OK(dbfull()->Put(sync_options, "d", "4"));
+  second_done.store(true);
+  sync_writer.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(2, options.statistics->getTickerCount(WAL_FILE_SYNCED));
+  ASSERT_EQ(1, options.statistics->getTickerCount(WAL_FILE_SYNC_SHARED));
+
+  Reopen(options);
+  ASSERT_EQ("1", Get("a"));
+  ASSERT_EQ("2", Get("b"));
+  ASSERT_EQ("3", Get("c"));
+  ASSERT_EQ("4", Get("d"));
+}
+
+TEST_P(DBWriteTest, WriteThreadWaitCounters) {
+  Options options = GetOptions();
+  // Spin, then block.
+  options.enable_write_thread_adaptive_yield = false;
+  Reopen(options);
+
+  // The leader holds on until the follower has started blocking.
+  std::atomic<bool> leader_waiting{false};
+  std::atomic<bool> follower_blocking{false};
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::JoinBatchGroup:Wait", [&](void* arg) {
+        auto* w = reinterpret_cast<WriteThread::Writer*>(arg);
+        if (w->state == WriteThread::STATE_GROUP_LEADER &&
+            !leader_waiting.exchange(true)) {
+          while (!follower_blocking.load()) {
+            env_->SleepForMicroseconds(100);
+          }
+        }
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "WriteThread::AwaitState:BlockingWaiting",
+      [&](void*) { follower_blocking.store(true); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  port::Thread leader([&] { ASSERT_OK(Put("a", "1")); });
+  while (!leader_waiting.load()) {
+    env_->SleepForMicroseconds(100);
+  }
+  SetPerfLevel(kEnableTimeExceptForMutex);
+  get_perf_context()->Reset();
+  ASSERT_OK(Put("b", "2"));
+  leader.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_GE(get_perf_context()->write_thread_block_count, 1U);
+  ASSERT_EQ(0U, get_perf_context()->write_thread_yield_count);
+  ASSERT_GT(get_perf_context()->write_thread_block_nanos, 0U);
+  ASSERT_GE(get_perf_context()->write_thread_wait_nanos,
+            get_perf_context()->write_thread_block_nanos);
+  SetPerfLevel(kDisable);
+  ASSERT_EQ("1", Get("a"));
+  ASSERT_EQ("2", Get("b"));
+}
+
+TEST_P(DBWriteTest, PutPinnedValue) {
+  Options options = GetOptions();
+  Reopen(options);
+  Random rnd(301);
+  std::string large_value = rnd.RandomString(10000);
+  std::string pinned_value = rnd.RandomString(100);
+  WriteOptions write_options;
+  write_options.put_pinned_value_min_size = 4096;
+  ASSERT_OK(Put("large", large_value, write_options));
+  ASSERT_OK(Put("small", "v", write_options));
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("a", "1"));
+  ASSERT_OK(batch.PutPinnedValue("pinned", pinned_value));
+  ASSERT_OK(batch.Delete("a"));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_EQ(large_value, Get("large"));
+  ASSERT_EQ(pinned_value, Get("pinned"));
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+
+  // Recover the values from the WAL.
+  Reopen(options);
+  ASSERT_EQ(large_value, Get("large"));
+  ASSERT_EQ(pinned_value, Get("pinned"));
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("v", Get("small"));
+}
+
+TEST_P(DBWriteTest, MemtableInsertSorted) {
+  Options options = GetOptions();
+  Reopen(options);
+  const int kNumKeys = 100;
+  std::vector<int> order;
+  for (int i = 0; i < kNumKeys; i++) {
+    order.push_back(i);
+  }
+  RandomShuffle(order.begin(), order.end(), 301);
+  WriteBatch batch;
+  for (int i : order) {
+    ASSERT_OK(batch.Put(Key(i), "v" + ToString(i)));
+  }
+  // Later entries of the same key must win.
+  ASSERT_OK(batch.Put(Key(5), "new"));
+  ASSERT_OK(batch.Delete(Key(7)));
+  WriteOptions write_options;
+  write_options.memtable_insert_sorted = true;
+  ASSERT_OK(dbfull()->Write(write_options, &batch));
+  ASSERT_EQ(kNumKeys + 2, dbfull()->GetLatestSequenceNumber());
+
+  auto verify = [&]() {
+    ASSERT_EQ("new", Get(Key(5)));
+    ASSERT_EQ("NOT_FOUND", Get(Key(7)));
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (count == 7) {
+        count++;
+      }
+      ASSERT_EQ(Key(count), iter->key().ToString());
+      if (count != 5) {
+        ASSERT_EQ("v" + ToString(count), iter->value().ToString());
+      }
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, count);
+  };
+  verify();
+  {
+    // The older version is still visible to a snapshot taken in between.
+    ManagedSnapshot snapshot(db_);
+    WriteBatch batch2;
+    ASSERT_OK(batch2.Put(Key(9), "v9_2"));
+    ASSERT_OK(batch2.Put(Key(1), "v1_2"));
+    ASSERT_OK(dbfull()->Write(write_options, &batch2));
+    ASSERT_EQ("v1_2", Get(Key(1)));
+    ASSERT_EQ("v9", Get(Key(9), snapshot.snapshot()));
+  }
+
+  Reopen(options);
+  ASSERT_EQ("v9_2", Get(Key(9)));
+  ASSERT_EQ("v0", Get(Key(0)));
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
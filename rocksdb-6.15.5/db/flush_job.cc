@@ -12,6 +12,7 @@
 #include <cinttypes>
 
 #include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 #include "db/builder.h"
@@ -80,6 +81,111 @@ const char* GetFlushReasonString (FlushReason flush_reason) {
   }
 }
 
+namespace {
+// Restricts an internal iterator to the entries whose user keys are in
+// [start, end). A null bound leaves that side unbounded. Used to feed one
+// partition of a partitioned flush to BuildTable().
+class FlushPartitionIterator : public InternalIterator {
+ public:
+  FlushPartitionIterator(InternalIterator* iter, const Comparator* ucmp,
+                         const Slice* start, const Slice* end)
+      : iter_(iter), ucmp_(ucmp), start_(start), end_(end), valid_(false) {}
+
+  bool Valid() const override { return valid_; }
+
+  void SeekToFirst() override {
+    if (start_ != nullptr) {
+      iter_->Seek(InternalKey(*start_, kMaxSequenceNumber, kValueTypeForSeek)
+                      .Encode());
+    } else {
+      iter_->SeekToFirst();
+    }
+    UpdateValid();
+  }
+
+  void SeekToLast() override {
+    if (end_ != nullptr) {
+      // (end, kMaxSequenceNumber) sorts before every entry of end, so this
+      // lands on the last entry before end.
+      iter_->SeekForPrev(
+          InternalKey(*end_, kMaxSequenceNumber, kValueTypeForSeek).Encode());
+    } else {
+      iter_->SeekToLast();
+    }
+    UpdateValid();
+  }
+
+  void Seek(const Slice& target) override {
+    if (start_ != nullptr &&
+        ucmp_->Compare(ExtractUserKey(target), *start_) < 0) {
+      SeekToFirst();
+      return;
+    }
+    iter_->Seek(target);
+    UpdateValid();
+  }
+
+  void SeekForPrev(const Slice& target) override {
+    if (end_ != nullptr && ucmp_->Compare(ExtractUserKey(target), *end_) >= 0) {
+      SeekToLast();
+      return;
+    }
+    iter_->SeekForPrev(target);
+    UpdateValid();
+  }
+
+  void Next() override {
+    assert(valid_);
+    iter_->Next();
+    UpdateValid();
+  }
+
+  void Prev() override {
+    assert(valid_);
+    iter_->Prev();
+    UpdateValid();
+  }
+
+  Slice key() const override {
+    assert(valid_);
+    return iter_->key();
+  }
+
+  Slice value() const override {
+    assert(valid_);
+    return iter_->value();
+  }
+
+  Status status() const override { return iter_->status(); }
+
+  bool PrepareValue() override { return iter_->PrepareValue(); }
+
+  void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
+    iter_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
+
+  bool IsKeyPinned() const override { return iter_->IsKeyPinned(); }
+
+  bool IsValuePinned() const override { return iter_->IsValuePinned(); }
+
+ private:
+  void UpdateValid() {
+    valid_ = iter_->Valid();
+    if (valid_) {
+      const Slice user_key = ExtractUserKey(iter_->key());
+      valid_ = (start_ == nullptr || ucmp_->Compare(user_key, *start_) >= 0) &&
+               (end_ == nullptr || ucmp_->Compare(user_key, *end_) < 0);
+    }
+  }
+
+  InternalIterator* iter_;
+  const Comparator* ucmp_;
+  const Slice* start_;
+  const Slice* end_;
+  bool valid_;
+};
+}  // namespace
+
 FlushJob::FlushJob(
     const std::string& dbname, ColumnFamilyData* cfd,
     const ImmutableDBOptions& db_options,
@@ -303,6 +409,73 @@ void FlushJob::Cancel() {
   base_->Unref();
 }
 
+void FlushJob::GenFlushPartitionBoundaries(
+    uint64_t num_entries, std::vector<std::string>* boundaries) {
+  boundaries->clear();
+  const uint64_t num_partitions = mutable_cf_options_.max_flush_partitions;
+  const Comparator* ucmp = cfd_->user_comparator();
+  // The L0 files of a flush have overlapping sequence number ranges, which
+  // only the level compaction picker accounts for. They must also have
+  // disjoint key ranges, so a user key is never split across files; with
+  // user-defined timestamps the comparator does not tell where a user key
+  // ends.
+  if (num_partitions <= 1 || num_entries < num_partitions ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel ||
+      ucmp->timestamp_size() > 0) {
+    return;
+  }
+
+  // Sample the keys from the upper levels of the memtables' skip lists
+  // rather than walking every entry before the partitions can be built.
+  // Each memtable gets a share of the samples by its number of entries.
+  const uint64_t kSamplesPerPartition = 16;
+  const uint64_t num_samples = num_partitions * kSamplesPerPartition;
+  // Memtable entries stay in place while the memtables are alive, so the
+  // samples can reference them without a copy.
+  std::vector<Slice> samples;
+  for (MemTable* m : mems_) {
+    const uint64_t target =
+        std::max<uint64_t>(1, num_samples * m->num_entries() / num_entries);
+    if (!m->SampleKeys(static_cast<size_t>(target), &samples)) {
+      return;
+    }
+  }
+  if (samples.size() < num_partitions) {
+    return;
+  }
+  const InternalKeyComparator& icmp = cfd_->internal_comparator();
+  std::sort(samples.begin(), samples.end(),
+            [&icmp](const Slice& a, const Slice& b) {
+              return icmp.Compare(a, b) < 0;
+            });
+  // Files with a single sequence number look like ingested files. If the
+  // sampled entries share one, the whole flush may, and its files couldn't
+  // be ordered.
+  SequenceNumber smallest_seqno = kMaxSequenceNumber;
+  SequenceNumber largest_seqno = 0;
+  for (const Slice& sample : samples) {
+    const SequenceNumber seqno = GetInternalKeySeqno(sample);
+    smallest_seqno = std::min(smallest_seqno, seqno);
+    largest_seqno = std::max(largest_seqno, seqno);
+  }
+  if (smallest_seqno >= largest_seqno) {
+    return;
+  }
+
+  // Cut at the user keys of the samples at even intervals. Cuts are at user
+  // keys, so all entries of a user key go to the same partition.
+  for (uint64_t i = 1; i < num_partitions; i++) {
+    const Slice user_key =
+        ExtractUserKey(samples[i * samples.size() / num_partitions]);
+    if (boundaries->empty() ||
+        ucmp->Compare(user_key, boundaries->back()) > 0) {
+      boundaries->emplace_back(user_key.data(), user_key.size());
+    }
+  }
+  TEST_SYNC_POINT_CALLBACK("FlushJob::GenFlushPartitionBoundaries",
+                           boundaries);
+}
+
 Status FlushJob::WriteLevel0Table() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
@@ -402,20 +575,157 @@ Status FlushJob::WriteLevel0Table() {
       IOStatus io_s;
       const std::string* const full_history_ts_low =
           (full_history_ts_low_.empty()) ? nullptr : &full_history_ts_low_;
-      s = BuildTable(
-          dbname_, versions_, db_options_, *cfd_->ioptions(),
-          mutable_cf_options_, file_options_, cfd_->table_cache(), iter.get(),
-          std::move(range_del_iters), &meta_, &blob_file_additions,
-          cfd_->internal_comparator(), cfd_->int_tbl_prop_collector_factories(),
-          cfd_->GetID(), cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          output_compression_, mutable_cf_options_.sample_for_compression,
-          mutable_cf_options_.compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, &io_s, io_tracer_, event_logger_,
-          job_context_->job_id, Env::IO_HIGH, &table_properties_, 0 /* level */,
-          creation_time, oldest_key_time, write_hint, current_time, db_id_,
-          db_session_id_, full_history_ts_low);
+      auto build_table =
+          [&](InternalIterator* input,
+              std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
+                  range_dels,
+              FileMetaData* meta, std::vector<BlobFileAddition>* blobs,
+              TableProperties* table_properties, IOStatus* table_io_s) {
+            return BuildTable(
+                dbname_, versions_, db_options_, *cfd_->ioptions(),
+                mutable_cf_options_, file_options_, cfd_->table_cache(), input,
+                std::move(range_dels), meta, blobs,
+                cfd_->internal_comparator(),
+                cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
+                cfd_->GetName(), existing_snapshots_,
+                earliest_write_conflict_snapshot_, snapshot_checker_,
+                output_compression_, mutable_cf_options_.sample_for_compression,
+                mutable_cf_options_.compression_opts,
+                mutable_cf_options_.paranoid_file_checks,
+                cfd_->internal_stats(), TableFileCreationReason::kFlush,
+                table_io_s, io_tracer_, event_logger_, job_context_->job_id,
+                Env::IO_HIGH, table_properties, 0 /* level */, creation_time,
+                oldest_key_time, write_hint, current_time, db_id_,
+                db_session_id_, full_history_ts_low);
+          };
+
+      std::vector<std::string> boundaries;
+      if (range_del_iters.empty()) {
+        GenFlushPartitionBoundaries(total_num_entries, &boundaries);
+      }
+      if (boundaries.empty()) {
+        s = build_table(iter.get(), std::move(range_del_iters), &meta_,
+                        &blob_file_additions, &table_properties_, &io_s);
+      } else {
+        // Partition i covers the user keys in [boundaries[i - 1],
+        // boundaries[i]); the first and the last partition are unbounded
+        // on the left and on the right. The first partition is built on
+        // this thread into meta_, the others on threads of their own.
+        const size_t num_extra = boundaries.size();
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush split into %" ROCKSDB_PRIszt
+                       " partitions",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       num_extra + 1);
+        partition_metas_.resize(num_extra);
+        partition_table_properties_.resize(num_extra);
+        std::vector<std::vector<BlobFileAddition>> partition_blobs(num_extra);
+        std::vector<Status> partition_status(num_extra);
+        std::vector<IOStatus> partition_io_s(num_extra);
+        for (auto& meta : partition_metas_) {
+          meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+          meta.oldest_ancester_time = meta_.oldest_ancester_time;
+          meta.file_creation_time = meta_.file_creation_time;
+        }
+        const Comparator* ucmp = cfd_->user_comparator();
+
+        auto build_partition = [&](size_t i) {
+          // Memtable iterators are not thread-safe, so every partition
+          // reads the memtables through its own.
+          Arena partition_arena;
+          std::vector<InternalIterator*> partition_memtables;
+          for (MemTable* m : mems_) {
+            partition_memtables.push_back(m->NewIterator(ro, &partition_arena));
+          }
+          ScopedArenaIterator merged(NewMergingIterator(
+              &cfd_->internal_comparator(), &partition_memtables[0],
+              static_cast<int>(partition_memtables.size()), &partition_arena));
+          const Slice start(boundaries[i]);
+          Slice end;
+          if (i + 1 < num_extra) {
+            end = boundaries[i + 1];
+          }
+          FlushPartitionIterator input(merged.get(), ucmp, &start,
+                                       i + 1 < num_extra ? &end : nullptr);
+          IOSTATS_RESET(bytes_written);
+          partition_status[i] =
+              build_table(&input, {}, &partition_metas_[i], &partition_blobs[i],
+                          &partition_table_properties_[i],
+                          &partition_io_s[i]);
+          RecordTick(stats_, FLUSH_WRITE_BYTES, IOSTATS(bytes_written));
+          IOSTATS_RESET(bytes_written);
+        };
+
+        std::vector<port::Thread> thread_pool;
+        thread_pool.reserve(num_extra);
+        for (size_t i = 0; i < num_extra; i++) {
+          thread_pool.emplace_back(build_partition, i);
+        }
+        const Slice first_end(boundaries[0]);
+        FlushPartitionIterator first_input(iter.get(), ucmp, nullptr,
+                                           &first_end);
+        s = build_table(&first_input, {}, &meta_, &blob_file_additions,
+                        &table_properties_, &io_s);
+        for (auto& thread : thread_pool) {
+          thread.join();
+        }
+
+        for (size_t i = 0; i < num_extra; i++) {
+          if (s.ok()) {
+            s = partition_status[i];
+          } else {
+            partition_status[i].PermitUncheckedError();
+          }
+          if (io_s.ok()) {
+            io_s = partition_io_s[i];
+          } else {
+            partition_io_s[i].PermitUncheckedError();
+          }
+          blob_file_additions.insert(
+              blob_file_additions.end(),
+              std::make_move_iterator(partition_blobs[i].begin()),
+              std::make_move_iterator(partition_blobs[i].end()));
+          ROCKS_LOG_INFO(db_options_.info_log,
+                         "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                         ": %" PRIu64 " bytes (partition %" ROCKSDB_PRIszt
+                         ")",
+                         cfd_->GetName().c_str(), job_context_->job_id,
+                         partition_metas_[i].fd.GetNumber(),
+                         partition_metas_[i].fd.GetFileSize(), i + 1);
+        }
+
+        // Each file keeps the sequence number range of its own entries. The
+        // ranges overlap, which the L0 consistency check accepts as the key
+        // ranges of the files are disjoint. A file with a single sequence
+        // number looks like an ingested file though, and those need
+        // distinct sequence numbers. If two files share one, e.g. with
+        // seq_per_batch, they all get the range of the whole flush instead.
+        std::vector<FileMetaData*> files{&meta_};
+        for (auto& meta : partition_metas_) {
+          files.push_back(&meta);
+        }
+        SequenceNumber smallest_seqno = kMaxSequenceNumber;
+        SequenceNumber largest_seqno = 0;
+        std::unordered_set<SequenceNumber> single_seqnos;
+        bool share_single_seqno = false;
+        for (const FileMetaData* meta : files) {
+          if (meta->fd.GetFileSize() == 0) {
+            continue;
+          }
+          smallest_seqno = std::min(smallest_seqno, meta->fd.smallest_seqno);
+          largest_seqno = std::max(largest_seqno, meta->fd.largest_seqno);
+          if (meta->fd.smallest_seqno == meta->fd.largest_seqno &&
+              !single_seqnos.insert(meta->fd.smallest_seqno).second) {
+            share_single_seqno = true;
+          }
+        }
+        if (share_single_seqno) {
+          for (FileMetaData* meta : files) {
+            meta->fd.smallest_seqno = smallest_seqno;
+            meta->fd.largest_seqno = largest_seqno;
+          }
+        }
+      }
       if (!io_s.ok()) {
         io_status_ = io_s;
       }
@@ -440,7 +750,16 @@ Status FlushJob::WriteLevel0Table() {
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  const bool has_output = meta_.fd.GetFileSize() > 0;
+  autovector<const FileMetaData*> outputs;
+  if (meta_.fd.GetFileSize() > 0) {
+    outputs.push_back(&meta_);
+  }
+  for (const auto& meta : partition_metas_) {
+    if (meta.fd.GetFileSize() > 0) {
+      outputs.push_back(&meta);
+    }
+  }
+  const bool has_output = !outputs.empty();
 
   if (s.ok() && has_output) {
     // if we have more than 1 background thread, then we cannot
@@ -448,18 +767,29 @@ Status FlushJob::WriteLevel0Table() {
     // threads could be concurrently producing compacted files for
     // that key range.
     // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.oldest_blob_file_number,
-                   meta_.oldest_ancester_time, meta_.file_creation_time,
-                   meta_.file_checksum, meta_.file_checksum_func_name);
+    for (const FileMetaData* meta : outputs) {
+      edit_->AddFile(0 /* level */, meta->fd.GetNumber(), meta->fd.GetPathId(),
+                     meta->fd.GetFileSize(), meta->smallest, meta->largest,
+                     meta->fd.smallest_seqno, meta->fd.largest_seqno,
+                     meta->marked_for_compaction, meta->oldest_blob_file_number,
+                     meta->oldest_ancester_time, meta->file_creation_time,
+                     meta->file_checksum, meta->file_checksum_func_name);
+    }
 
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
 #ifndef ROCKSDB_LITE
-  // Piggyback FlushJobInfo on the first first flushed memtable.
-  mems_[0]->SetFlushJobInfo(GetFlushJobInfo());
+  // Piggyback FlushJobInfo on the first first flushed memtable, one for each
+  // table file.
+  std::list<std::unique_ptr<FlushJobInfo>> flush_job_info;
+  flush_job_info.push_back(GetFlushJobInfo(meta_, table_properties_));
+  for (size_t i = 0; i < partition_metas_.size(); i++) {
+    if (partition_metas_[i].fd.GetFileSize() > 0) {
+      flush_job_info.push_back(GetFlushJobInfo(
+          partition_metas_[i], partition_table_properties_[i]));
+    }
+  }
+  mems_[0]->SetFlushJobInfo(std::move(flush_job_info));
 #endif  // !ROCKSDB_LITE
 
   // Note that here we treat flush as level 0 compaction in internal stats
@@ -467,9 +797,9 @@ Status FlushJob::WriteLevel0Table() {
   stats.micros = db_options_.env->NowMicros() - start_micros;
   stats.cpu_micros = db_options_.env->NowCPUNanos() / 1000 - start_cpu_micros;
 
-  if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
+  for (const FileMetaData* meta : outputs) {
+    stats.bytes_written += meta->fd.GetFileSize();
+    stats.num_output_files++;
   }
 
   const auto& blobs = edit_->GetBlobFileAdditions();
@@ -488,22 +818,23 @@ Status FlushJob::WriteLevel0Table() {
 }
 
 #ifndef ROCKSDB_LITE
-std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo() const {
+std::unique_ptr<FlushJobInfo> FlushJob::GetFlushJobInfo(
+    const FileMetaData& meta, const TableProperties& table_properties) const {
   db_mutex_->AssertHeld();
   std::unique_ptr<FlushJobInfo> info(new FlushJobInfo{});
   info->cf_id = cfd_->GetID();
   info->cf_name = cfd_->GetName();
 
-  const uint64_t file_number = meta_.fd.GetNumber();
+  const uint64_t file_number = meta.fd.GetNumber();
   info->file_path =
       MakeTableFileName(cfd_->ioptions()->cf_paths[0].path, file_number);
   info->file_number = file_number;
-  info->oldest_blob_file_number = meta_.oldest_blob_file_number;
+  info->oldest_blob_file_number = meta.oldest_blob_file_number;
   info->thread_id = db_options_.env->GetThreadID();
   info->job_id = job_context_->job_id;
-  info->smallest_seqno = meta_.fd.smallest_seqno;
-  info->largest_seqno = meta_.fd.largest_seqno;
-  info->table_properties = table_properties_;
+  info->smallest_seqno = meta.fd.smallest_seqno;
+  info->largest_seqno = meta.fd.largest_seqno;
+  info->table_properties = table_properties;
   info->flush_reason = cfd_->GetFlushReason();
   return info;
 }
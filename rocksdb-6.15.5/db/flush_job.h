@@ -95,13 +95,26 @@ class FlushJob {
   // Return the IO status
   IOStatus io_status() const { return io_status_; }
 
+  // Returns the table files written by Run() besides the one reported through
+  // its file_meta argument, i.e. the outputs of all but the first partition
+  // of a partitioned flush. Files that turned out empty have a size of 0.
+  const std::vector<FileMetaData>& GetPartitionOutputs() const {
+    return partition_metas_;
+  }
+
  private:
   void ReportStartedFlush();
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Picks the user keys at which a partitioned flush splits its input, based
+  // on max_flush_partitions and a sample of the memtables' keys. Leaves
+  // *boundaries empty if the flush should write a single file.
+  void GenFlushPartitionBoundaries(uint64_t num_entries,
+                                   std::vector<std::string>* boundaries);
 #ifndef ROCKSDB_LITE
-  std::unique_ptr<FlushJobInfo> GetFlushJobInfo() const;
+  std::unique_ptr<FlushJobInfo> GetFlushJobInfo(
+      const FileMetaData& meta, const TableProperties& table_properties) const;
 #endif  // !ROCKSDB_LITE
 
   const std::string& dbname_;
@@ -156,6 +169,10 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // Outputs of the second and later partitions of a partitioned flush. The
+  // first partition is written to meta_.
+  std::vector<FileMetaData> partition_metas_;
+  std::vector<TableProperties> partition_table_properties_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
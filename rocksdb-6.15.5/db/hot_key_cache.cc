@@ -0,0 +1,158 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/hot_key_cache.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "rocksdb/slice.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// A key has to be read at least this often to be cached, so that a key read
+// once doesn't replace a key that is no longer hit.
+const uint32_t kMinAdmitFrequency = 2;
+
+// The number of entries from the clock hand a new key is compared with
+// when its shard is full. The least hit of them is replaced.
+const size_t kVictimCandidates = 8;
+
+// The hits of the entries of a full shard are halved after this many times
+// its capacity of admission attempts, like FrequencySketch ages its counts.
+const size_t kAgingWindow = 10;
+
+}  // namespace
+
+HotKeyCache::HotKeyCache(size_t capacity)
+    : shard_capacity_(std::max<size_t>(
+          1, (capacity + (1 << kNumShardBits) - 1) >> kNumShardBits)) {
+  for (Shard& shard : shards_) {
+    // Room to tell the hot keys apart from many more that are read less.
+    shard.sketch.Reset(16 * shard_capacity_);
+  }
+}
+
+bool HotKeyCache::Lookup(const Slice& key, SequenceNumber snapshot,
+                         PinnableSlice* value) {
+  uint64_t hash = GetSliceNPHash64(key);
+  Shard& shard = GetShard(hash);
+  ReadLock l(&shard.mutex);
+  auto it = shard.index.find(hash);
+  if (it == shard.index.end()) {
+    return false;
+  }
+  Entry* entry = shard.entries[it->second].get();
+  if (entry->seq > snapshot || key != Slice(entry->key)) {
+    return false;
+  }
+  entry->hits.fetch_add(1, std::memory_order_relaxed);
+  value->PinSelf(entry->value);
+  return true;
+}
+
+void HotKeyCache::MaybeInsert(const Slice& key, const Slice& value,
+                              SequenceNumber snapshot, uint64_t epoch) {
+  uint64_t hash = GetSliceNPHash64(key);
+  Shard& shard = GetShard(hash);
+  // Counting every miss isn't needed to find the hot keys, so skip it
+  // rather than wait for the sketch.
+  if (!shard.sketch_mutex.TryLock()) {
+    return;
+  }
+  shard.sketch.Increment(static_cast<uint32_t>(hash));
+  uint32_t frequency = shard.sketch.Estimate(static_cast<uint32_t>(hash));
+  shard.sketch_mutex.Unlock();
+  if (frequency < kMinAdmitFrequency) {
+    return;
+  }
+
+  WriteLock l(&shard.mutex);
+  // Writes to the key since the read may have been invalidated already
+  if (epoch_.load(std::memory_order_relaxed) != epoch ||
+      shard.max_invalidated_seq > snapshot) {
+    return;
+  }
+  if (shard.index.find(hash) != shard.index.end()) {
+    return;
+  }
+  const size_t size = shard.entries.size();
+  if (size >= shard_capacity_) {
+    if (++shard.attempts >= kAgingWindow * shard_capacity_) {
+      for (auto& e : shard.entries) {
+        e->hits.store(e->hits.load(std::memory_order_relaxed) / 2,
+                      std::memory_order_relaxed);
+      }
+      shard.attempts = 0;
+    }
+    // Compare with the least hit of the entries at the clock hand, rather
+    // than of the whole shard, and move the hand past them.
+    size_t victim = size;
+    uint32_t victim_hits = std::numeric_limits<uint32_t>::max();
+    const size_t candidates = std::min(kVictimCandidates, size);
+    for (size_t i = 0; i < candidates; ++i) {
+      size_t pos = (shard.clock_hand + i) % size;
+      uint32_t hits = shard.entries[pos]->hits.load(std::memory_order_relaxed);
+      if (hits < victim_hits) {
+        victim = pos;
+        victim_hits = hits;
+      }
+    }
+    shard.clock_hand = (shard.clock_hand + candidates) % size;
+    if (frequency <= victim_hits) {
+      return;
+    }
+    Erase(&shard, victim);
+  }
+  std::unique_ptr<Entry> entry(new Entry());
+  entry->key.assign(key.data(), key.size());
+  entry->value.assign(value.data(), value.size());
+  entry->seq = snapshot;
+  entry->hash = hash;
+  // Starts with the misses that got it admitted, so that it isn't replaced
+  // before it had a chance to be hit.
+  entry->hits.store(frequency, std::memory_order_relaxed);
+  shard.index.emplace(hash, shard.entries.size());
+  shard.entries.push_back(std::move(entry));
+}
+
+void HotKeyCache::Invalidate(const Slice& key, SequenceNumber seq) {
+  uint64_t hash = GetSliceNPHash64(key);
+  Shard& shard = GetShard(hash);
+  WriteLock l(&shard.mutex);
+  shard.max_invalidated_seq = std::max(shard.max_invalidated_seq, seq);
+  auto it = shard.index.find(hash);
+  if (it != shard.index.end()) {
+    Erase(&shard, it->second);
+  }
+}
+
+void HotKeyCache::InvalidateAll(SequenceNumber seq) {
+  // Reads that started before this don't insert their values.
+  epoch_.fetch_add(1, std::memory_order_acq_rel);
+  for (Shard& shard : shards_) {
+    WriteLock l(&shard.mutex);
+    shard.max_invalidated_seq = std::max(shard.max_invalidated_seq, seq);
+    shard.entries.clear();
+    shard.index.clear();
+    shard.clock_hand = 0;
+    shard.attempts = 0;
+  }
+}
+
+void HotKeyCache::Erase(Shard* shard, size_t pos) {
+  shard->index.erase(shard->entries[pos]->hash);
+  if (pos + 1 < shard->entries.size()) {
+    shard->entries[pos] = std::move(shard->entries.back());
+    shard->index[shard->entries[pos]->hash] = pos;
+  }
+  shard->entries.pop_back();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,111 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cache/frequency_sketch.h"
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class PinnableSlice;
+
+// HotKeyCache holds the values of the most read keys of a column family, see
+// DBOptions::hot_key_cache_size. A read that misses the cache is counted in
+// a frequency sketch, and its value is admitted if the key is read more
+// often than the least hit of a few cached keys its shard's clock hand
+// points to. Writes to a key drop it from the cache once they are in the
+// memtable.
+//
+// An entry keeps the sequence number its value was read at. As every write
+// to the key since then would have dropped it, the value is the one visible
+// to any snapshot at or after that sequence number.
+//
+// This class is thread-safe.
+class HotKeyCache {
+ public:
+  // `capacity` is the number of keys to cache.
+  explicit HotKeyCache(size_t capacity);
+
+  // No copying allowed
+  HotKeyCache(const HotKeyCache&) = delete;
+  void operator=(const HotKeyCache&) = delete;
+
+  // If `key` is cached with a value that is visible to `snapshot`, copies
+  // the value to *value and returns true.
+  bool Lookup(const Slice& key, SequenceNumber snapshot, PinnableSlice* value);
+
+  // Returns the token to pass to MaybeInsert() for a read. Must be called
+  // before the read gets its version and snapshot.
+  uint64_t GetEpoch() const { return epoch_.load(std::memory_order_acquire); }
+
+  // Counts a read of `key` that missed the cache and returned `value` as of
+  // the latest sequence number `snapshot`. Caches the value if the key is
+  // among the most read ones and hasn't been written since `snapshot`.
+  void MaybeInsert(const Slice& key, const Slice& value,
+                   SequenceNumber snapshot, uint64_t epoch);
+
+  // Drops `key`, which was written at sequence number `seq`. Must be called
+  // once the write is in the memtable.
+  void Invalidate(const Slice& key, SequenceNumber seq);
+
+  // Drops all keys, after a change that isn't a write of single keys, such
+  // as a range deletion or a file ingestion, is visible to reads. `seq` is
+  // the last sequence number of the change.
+  void InvalidateAll(SequenceNumber seq);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    SequenceNumber seq;
+    // The 64-bit hash of key
+    uint64_t hash;
+    // Recent hits. The hits of all entries of a shard are halved once per
+    // window of admission attempts, so that keys that are no longer read can
+    // be replaced.
+    std::atomic<uint32_t> hits{0};
+  };
+
+  struct Shard {
+    port::RWMutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+    // The index in `entries` of the entry of each key hash
+    std::unordered_map<uint64_t, size_t> index;
+    // Where the next search for an entry to replace starts in `entries`
+    size_t clock_hand = 0;
+    // Admission attempts into the full shard since the hits were last halved
+    size_t attempts = 0;
+    // The largest sequence number of a write invalidated in this shard
+    SequenceNumber max_invalidated_seq = 0;
+    // Counts the misses. Updates are skipped when the mutex is contended.
+    port::Mutex sketch_mutex;
+    FrequencySketch sketch;
+  };
+
+  static const int kNumShardBits = 4;
+
+  Shard& GetShard(uint64_t hash) {
+    return shards_[hash >> (64 - kNumShardBits)];
+  }
+
+  // Removes entries[pos] of `shard`, moving the last entry into its place.
+  // REQUIRES: shard->mutex is held for writing.
+  static void Erase(Shard* shard, size_t pos);
+
+  const size_t shard_capacity_;
+  std::atomic<uint64_t> epoch_{0};
+  Shard shards_[1 << kNumShardBits];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
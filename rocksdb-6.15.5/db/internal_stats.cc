@@ -254,11 +254,13 @@ static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
     "actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
+static const std::string sustainable_write_rate = "sustainable-write-rate";
 static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
 static const std::string options_statistics = "options-statistics";
+static const std::string block_cache_stats = "block-cache-stats";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -338,6 +340,8 @@ const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
     rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kSustainableWriteRate =
+    rocksdb_prefix + sustainable_write_rate;
 const std::string DB::Properties::kEstimateOldestKeyTime =
     rocksdb_prefix + estimate_oldest_key_time;
 const std::string DB::Properties::kBlockCacheCapacity =
@@ -348,145 +352,158 @@ const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kBlockCacheStats =
+    rocksdb_prefix + block_cache_stats;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
         {DB::Properties::kNumFilesAtLevelPrefix,
          {false, &InternalStats::HandleNumFilesAtLevel, nullptr, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCompressionRatioAtLevelPrefix,
          {false, &InternalStats::HandleCompressionRatioAtLevelPrefix, nullptr,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kLevelStats,
-         {false, &InternalStats::HandleLevelStats, nullptr, nullptr, nullptr}},
+         {false, &InternalStats::HandleLevelStats, nullptr, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kStats,
-         {false, &InternalStats::HandleStats, nullptr, nullptr, nullptr}},
+         {false, &InternalStats::HandleStats, nullptr, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kCFStats,
          {false, &InternalStats::HandleCFStats, nullptr,
-          &InternalStats::HandleCFMapStats, nullptr}},
+          &InternalStats::HandleCFMapStats, nullptr, nullptr}},
         {DB::Properties::kCFStatsNoFileHistogram,
          {false, &InternalStats::HandleCFStatsNoFileHistogram, nullptr, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCFFileHistogram,
          {false, &InternalStats::HandleCFFileHistogram, nullptr, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kDBStats,
-         {false, &InternalStats::HandleDBStats, nullptr, nullptr, nullptr}},
+         {false, &InternalStats::HandleDBStats, nullptr, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kSSTables,
-         {false, &InternalStats::HandleSsTables, nullptr, nullptr, nullptr}},
+         {false, &InternalStats::HandleSsTables, nullptr, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kAggregatedTableProperties,
          {false, &InternalStats::HandleAggregatedTableProperties, nullptr,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kAggregatedTablePropertiesAtLevel,
          {false, &InternalStats::HandleAggregatedTablePropertiesAtLevel,
-          nullptr, nullptr, nullptr}},
+          nullptr, nullptr, nullptr, nullptr}},
         {DB::Properties::kNumImmutableMemTable,
          {false, nullptr, &InternalStats::HandleNumImmutableMemTable, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumImmutableMemTableFlushed,
          {false, nullptr, &InternalStats::HandleNumImmutableMemTableFlushed,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kMemTableFlushPending,
          {false, nullptr, &InternalStats::HandleMemTableFlushPending, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCompactionPending,
          {false, nullptr, &InternalStats::HandleCompactionPending, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kBackgroundErrors,
          {false, nullptr, &InternalStats::HandleBackgroundErrors, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCurSizeActiveMemTable,
          {false, nullptr, &InternalStats::HandleCurSizeActiveMemTable, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCurSizeAllMemTables,
          {false, nullptr, &InternalStats::HandleCurSizeAllMemTables, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kSizeAllMemTables,
          {false, nullptr, &InternalStats::HandleSizeAllMemTables, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumEntriesActiveMemTable,
          {false, nullptr, &InternalStats::HandleNumEntriesActiveMemTable,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kNumEntriesImmMemTables,
          {false, nullptr, &InternalStats::HandleNumEntriesImmMemTables, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumDeletesActiveMemTable,
          {false, nullptr, &InternalStats::HandleNumDeletesActiveMemTable,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kNumDeletesImmMemTables,
          {false, nullptr, &InternalStats::HandleNumDeletesImmMemTables, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kEstimateNumKeys,
          {false, nullptr, &InternalStats::HandleEstimateNumKeys, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kEstimateTableReadersMem,
          {true, nullptr, &InternalStats::HandleEstimateTableReadersMem, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kIsFileDeletionsEnabled,
          {false, nullptr, &InternalStats::HandleIsFileDeletionsEnabled, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumSnapshots,
-         {false, nullptr, &InternalStats::HandleNumSnapshots, nullptr,
+         {false, nullptr, &InternalStats::HandleNumSnapshots, nullptr, nullptr,
           nullptr}},
         {DB::Properties::kOldestSnapshotTime,
          {false, nullptr, &InternalStats::HandleOldestSnapshotTime, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kOldestSnapshotSequence,
          {false, nullptr, &InternalStats::HandleOldestSnapshotSequence, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumLiveVersions,
          {false, nullptr, &InternalStats::HandleNumLiveVersions, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kCurrentSuperVersionNumber,
          {false, nullptr, &InternalStats::HandleCurrentSuperVersionNumber,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kEstimateLiveDataSize,
          {true, nullptr, &InternalStats::HandleEstimateLiveDataSize, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kMinLogNumberToKeep,
          {false, nullptr, &InternalStats::HandleMinLogNumberToKeep, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kMinObsoleteSstNumberToKeep,
          {false, nullptr, &InternalStats::HandleMinObsoleteSstNumberToKeep,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kBaseLevel,
-         {false, nullptr, &InternalStats::HandleBaseLevel, nullptr, nullptr}},
+         {false, nullptr, &InternalStats::HandleBaseLevel, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kTotalSstFilesSize,
          {false, nullptr, &InternalStats::HandleTotalSstFilesSize, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kLiveSstFilesSize,
          {false, nullptr, &InternalStats::HandleLiveSstFilesSize, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kEstimatePendingCompactionBytes,
          {false, nullptr, &InternalStats::HandleEstimatePendingCompactionBytes,
-          nullptr, nullptr}},
+          nullptr, nullptr, nullptr}},
         {DB::Properties::kNumRunningFlushes,
          {false, nullptr, &InternalStats::HandleNumRunningFlushes, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kNumRunningCompactions,
          {false, nullptr, &InternalStats::HandleNumRunningCompactions, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kActualDelayedWriteRate,
          {false, nullptr, &InternalStats::HandleActualDelayedWriteRate, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kIsWriteStopped,
          {false, nullptr, &InternalStats::HandleIsWriteStopped, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
+        {DB::Properties::kSustainableWriteRate,
+         {false, nullptr, &InternalStats::HandleSustainableWriteRate, nullptr,
+          nullptr, nullptr}},
         {DB::Properties::kEstimateOldestKeyTime,
          {false, nullptr, &InternalStats::HandleEstimateOldestKeyTime, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kBlockCacheCapacity,
          {false, nullptr, &InternalStats::HandleBlockCacheCapacity, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kBlockCacheUsage,
          {false, nullptr, &InternalStats::HandleBlockCacheUsage, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
-          nullptr}},
+          nullptr, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
-          &DBImpl::GetPropertyHandleOptionsStatistics}},
+          &DBImpl::GetPropertyHandleOptionsStatistics, nullptr}},
+        {DB::Properties::kBlockCacheStats,
+         {false, nullptr, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleBlockCacheStats}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -874,6 +891,12 @@ bool InternalStats::HandleIsWriteStopped(uint64_t* value, DBImpl* db,
   return true;
 }
 
+bool InternalStats::HandleSustainableWriteRate(uint64_t* value, DBImpl* db,
+                                               Version* /*version*/) {
+  *value = db->write_controller().sustainable_write_rate();
+  return true;
+}
+
 bool InternalStats::HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* /*db*/,
                                                 Version* /*version*/) {
   // TODO(yiwu): The property is currently available for fifo compaction
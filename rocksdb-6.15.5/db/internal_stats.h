@@ -49,6 +49,13 @@ struct DBPropertyInfo {
   // handle the string type properties rely on DBImpl methods
   // @param value Value-result argument for storing the property's string value
   bool (DBImpl::*handle_string_dbimpl)(std::string* value);
+
+  // handle the map type properties rely on DBImpl methods. Called without
+  // holding db mutex.
+  // @param cfd Column family the property was requested for
+  // @param value Map of properties to populate
+  bool (DBImpl::*handle_map_dbimpl)(ColumnFamilyData* cfd,
+                                    std::map<std::string, std::string>* value);
 };
 
 extern const DBPropertyInfo* GetPropertyInfo(const Slice& property);
@@ -348,6 +355,19 @@ class InternalStats {
     comp_stats_by_pri_[thread_pri].Add(stats);
   }
 
+  // Bytes written by the flushes of the column family so far.
+  uint64_t GetBytesFlushed() const { return cf_stats_value_[BYTES_FLUSHED]; }
+
+  // Bytes written by the compactions of the column family so far.
+  uint64_t GetCompactionBytesWritten() const {
+    uint64_t bytes_written = 0;
+    for (const auto& comp_stat : comp_stats_) {
+      bytes_written += comp_stat.bytes_written;
+    }
+    // Flushes are accounted as compactions into level 0.
+    return bytes_written - std::min(bytes_written, GetBytesFlushed());
+  }
+
   void IncBytesMoved(int level, uint64_t amount) {
     comp_stats_[level].bytes_moved += amount;
   }
@@ -581,6 +601,8 @@ class InternalStats {
   bool HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
                                     Version* version);
   bool HandleIsWriteStopped(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleSustainableWriteRate(uint64_t* value, DBImpl* db,
+                                  Version* version);
   bool HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleBlockCacheCapacity(uint64_t* value, DBImpl* db, Version* version);
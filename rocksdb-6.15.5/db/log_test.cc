@@ -194,6 +194,10 @@ class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
     writer_.AddRecord(Slice(msg));
   }
 
+  void Write(const SliceParts& record) {
+    ASSERT_OK(writer_.AddRecord(record));
+  }
+
   size_t WrittenBytes() const {
     return dest_contents().size();
   }
@@ -307,6 +311,23 @@ TEST_P(LogTest, Fragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, FragmentedParts) {
+  // The parts, some of them empty, straddle physical record and block
+  // boundaries.
+  std::string small = BigString("small", 10);
+  std::string medium = BigString("medium", 50000);
+  std::string large = BigString("large", 100000);
+  Slice parts[] = {small, Slice(), medium, large, Slice(), small};
+  Write(SliceParts(parts, 6));
+  Slice no_parts[] = {Slice(), Slice()};
+  Write(SliceParts(no_parts, 2));
+  Write("foo");
+  ASSERT_EQ(small + medium + large + small, Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("EOF", Read());
+}
+
 TEST_P(LogTest, MarginalTrailer) {
   // Make a trailer that is exactly the same length as an empty record.
   int header_size =
@@ -10,6 +10,9 @@
 #include "db/log_writer.h"
 
 #include <stdint.h>
+
+#include <algorithm>
+
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
@@ -49,8 +52,17 @@ IOStatus Writer::Close() {
 }
 
 IOStatus Writer::AddRecord(const Slice& slice) {
-  const char* ptr = slice.data();
-  size_t left = slice.size();
+  return AddRecord(SliceParts(&slice, 1));
+}
+
+IOStatus Writer::AddRecord(const SliceParts& record) {
+  size_t left = 0;
+  for (int i = 0; i < record.num_parts; ++i) {
+    left += record.parts[i].size();
+  }
+  // Position in record of the next byte to emit
+  int part = 0;
+  size_t offset = 0;
 
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
@@ -97,8 +109,7 @@ IOStatus Writer::AddRecord(const Slice& slice) {
       type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
     }
 
-    s = EmitPhysicalRecord(type, ptr, fragment_length);
-    ptr += fragment_length;
+    s = EmitPhysicalRecord(type, record, &part, &offset, fragment_length);
     left -= fragment_length;
     begin = false;
   } while (s.ok() && left > 0);
@@ -114,7 +125,8 @@ IOStatus Writer::AddRecord(const Slice& slice) {
 
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
-IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
+IOStatus Writer::EmitPhysicalRecord(RecordType t, const SliceParts& record,
+                                    int* part, size_t* offset, size_t n) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -145,7 +157,21 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   }
 
   // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
+  {
+    int p = *part;
+    size_t off = *offset;
+    for (size_t left = n; left > 0;) {
+      const Slice& piece = record.parts[p];
+      const size_t len = std::min(piece.size() - off, left);
+      crc = crc32c::Extend(crc, piece.data() + off, len);
+      left -= len;
+      off += len;
+      if (off == piece.size()) {
+        ++p;
+        off = 0;
+      }
+    }
+  }
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
                            &crc);
@@ -153,8 +179,18 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
 
   // Write the header and the payload
   IOStatus s = dest_->Append(Slice(buf, header_size));
-  if (s.ok()) {
-    s = dest_->Append(Slice(ptr, n));
+  for (size_t left = n; s.ok() && left > 0;) {
+    const Slice& piece = record.parts[*part];
+    const size_t len = std::min(piece.size() - *offset, left);
+    if (len > 0) {
+      s = dest_->Append(Slice(piece.data() + *offset, len));
+    }
+    left -= len;
+    *offset += len;
+    if (*offset == piece.size()) {
+      ++*part;
+      *offset = 0;
+    }
   }
   block_offset_ += header_size + n;
   return s;
@@ -82,6 +82,10 @@ class Writer {
 
   IOStatus AddRecord(const Slice& slice);
 
+  // Add a single record whose payload is the concatenation of record.parts,
+  // without first copying them into one contiguous buffer.
+  IOStatus AddRecord(const SliceParts& record);
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -104,7 +108,10 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
-  IOStatus EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+  // Emit the next length bytes of record, starting at byte *offset of
+  // record.parts[*part], and advance (*part, *offset) past them.
+  IOStatus EmitPhysicalRecord(RecordType type, const SliceParts& record,
+                              int* part, size_t* offset, size_t length);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
@@ -52,6 +52,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       memtable_huge_page_size(mutable_cf_options.memtable_huge_page_size),
       memtable_whole_key_filtering(
           mutable_cf_options.memtable_whole_key_filtering),
+      memtable_seqno_filter_bucket_count(
+          mutable_cf_options.memtable_seqno_filter_bucket_count),
       inplace_update_support(ioptions.inplace_update_support),
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
@@ -77,7 +79,8 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             ioptions.arena_block_pool),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.info_log, column_family_id)),
@@ -101,6 +104,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                  ? moptions_.inplace_update_num_locks
                  : 0),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
+      min_seqno_buckets_(nullptr),
       flush_state_(FLUSH_NOT_REQUESTED),
       env_(ioptions.env),
       insert_with_hint_prefix_extractor_(
@@ -120,6 +124,18 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                          6 /* hard coded 6 probes */,
                          moptions_.memtable_huge_page_size, ioptions.info_log));
   }
+
+  if (moptions_.memtable_seqno_filter_bucket_count > 0) {
+    const size_t num_buckets = moptions_.memtable_seqno_filter_bucket_count;
+    char* raw = arena_.AllocateAligned(
+        num_buckets * sizeof(std::atomic<SequenceNumber>),
+        moptions_.memtable_huge_page_size, ioptions.info_log);
+    min_seqno_buckets_ = new (raw) std::atomic<SequenceNumber>[num_buckets];
+    for (size_t i = 0; i < num_buckets; i++) {
+      min_seqno_buckets_[i].store(kMaxSequenceNumber,
+                                  std::memory_order_relaxed);
+    }
+  }
 }
 
 MemTable::~MemTable() {
@@ -232,11 +248,37 @@ void MemTable::UpdateOldestKeyTime() {
   }
 }
 
+namespace {
+// Returns the first 8 bytes of the user key of internal_key, zero padded, as
+// a big-endian integer. Under the bytewise comparator, a < b for these values
+// implies the user keys compare the same way; equal values are a tie that the
+// full comparison has to resolve.
+inline uint64_t NormalizedUserKeyPrefix(const Slice& internal_key) {
+  assert(internal_key.size() >= kNumInternalBytes);
+  const size_t user_key_size = internal_key.size() - kNumInternalBytes;
+  uint64_t prefix = 0;
+  memcpy(&prefix, internal_key.data(), std::min(user_key_size, sizeof(prefix)));
+  return port::kLittleEndian ? EndianSwapValue(prefix) : prefix;
+}
+}  // namespace
+
+MemTable::KeyComparator::KeyComparator(const InternalKeyComparator& c)
+    : comparator(c),
+      prefix_compare_(c.user_comparator() == BytewiseComparator()) {}
+
 int MemTable::KeyComparator::operator()(const char* prefix_len_key1,
                                         const char* prefix_len_key2) const {
   // Internal keys are encoded as length-prefixed strings.
   Slice k1 = GetLengthPrefixedSlice(prefix_len_key1);
   Slice k2 = GetLengthPrefixedSlice(prefix_len_key2);
+  if (prefix_compare_) {
+    const uint64_t p1 = NormalizedUserKeyPrefix(k1);
+    const uint64_t p2 = NormalizedUserKeyPrefix(k2);
+    if (p1 != p2) {
+      PERF_COUNTER_ADD(user_key_comparison_count, 1);
+      return static_cast<int>(p1 > p2) - static_cast<int>(p1 < p2);
+    }
+  }
   return comparator.CompareKeySeq(k1, k2);
 }
 
@@ -245,6 +287,14 @@ int MemTable::KeyComparator::operator()(const char* prefix_len_key,
     const {
   // Internal keys are encoded as length-prefixed strings.
   Slice a = GetLengthPrefixedSlice(prefix_len_key);
+  if (prefix_compare_) {
+    const uint64_t p1 = NormalizedUserKeyPrefix(a);
+    const uint64_t p2 = NormalizedUserKeyPrefix(key);
+    if (p1 != p2) {
+      PERF_COUNTER_ADD(user_key_comparison_count, 1);
+      return static_cast<int>(p1 > p2) - static_cast<int>(p1 < p2);
+    }
+  }
   return comparator.CompareKeySeq(a, key);
 }
 
@@ -480,6 +530,17 @@ MemTable::MemTableStats MemTable::ApproximateStats(const Slice& start_ikey,
   return {entry_count * (data_size / n), entry_count};
 }
 
+bool MemTable::SampleKeys(size_t target, std::vector<Slice>* keys) {
+  std::vector<const char*> entries;
+  if (!table_->SampleEntries(target, &entries)) {
+    return false;
+  }
+  for (const char* entry : entries) {
+    keys->push_back(GetLengthPrefixedSlice(entry));
+  }
+  return true;
+}
+
 bool MemTable::Add(SequenceNumber s, ValueType type,
                    const Slice& key, /* user key */
                    const Slice& value, bool allow_concurrent,
@@ -548,14 +609,14 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
       bloom_filter_->Add(StripTimestampFromUserKey(key, ts_sz));
     }
 
-    // The first sequence number inserted into the memtable
-    assert(first_seqno_ == 0 || s >= first_seqno_);
-    if (first_seqno_ == 0) {
+    // The first sequence number inserted into the memtable. The entries of a
+    // batch written with WriteOptions::memtable_insert_sorted are not added
+    // in sequence number order, so keep the smallest one.
+    if (first_seqno_ == 0 || s < first_seqno_) {
       first_seqno_.store(s, std::memory_order_relaxed);
 
-      if (earliest_seqno_ == kMaxSequenceNumber) {
-        earliest_seqno_.store(GetFirstSequenceNumber(),
-                              std::memory_order_relaxed);
+      if (earliest_seqno_ == kMaxSequenceNumber || s < earliest_seqno_) {
+        earliest_seqno_.store(s, std::memory_order_relaxed);
       }
       assert(first_seqno_.load() >= earliest_seqno_.load());
     }
@@ -598,11 +659,37 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
   }
   if (type == kTypeRangeDeletion) {
     is_range_del_table_empty_.store(false, std::memory_order_relaxed);
+  } else if (min_seqno_buckets_ != nullptr) {
+    UpdateSeqnoFilter(StripTimestampFromUserKey(key, ts_sz), s);
   }
   UpdateOldestKeyTime();
   return true;
 }
 
+void MemTable::UpdateSeqnoFilter(const Slice& user_key_without_ts,
+                                 SequenceNumber s) {
+  std::atomic<SequenceNumber>& bucket =
+      min_seqno_buckets_[GetSliceRangedNPHash(
+          user_key_without_ts, moptions_.memtable_seqno_filter_bucket_count)];
+  // Relaxed ordering is enough: readers can only use a snapshot >= s after
+  // the write that inserted s has been published.
+  SequenceNumber cur = bucket.load(std::memory_order_relaxed);
+  while (s < cur &&
+         !bucket.compare_exchange_weak(cur, s, std::memory_order_relaxed)) {
+  }
+}
+
+bool MemTable::SeqnoFilterMayMatch(const Slice& user_key_without_ts,
+                                   SequenceNumber snapshot) const {
+  if (min_seqno_buckets_ == nullptr) {
+    return true;
+  }
+  const std::atomic<SequenceNumber>& bucket =
+      min_seqno_buckets_[GetSliceRangedNPHash(
+          user_key_without_ts, moptions_.memtable_seqno_filter_bucket_count)];
+  return bucket.load(std::memory_order_relaxed) <= snapshot;
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -844,6 +931,13 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
     // iter is null if prefix bloom says the key does not exist
     PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
     *seq = kMaxSequenceNumber;
+  } else if (!SeqnoFilterMayMatch(StripTimestampFromUserKey(user_key, ts_sz),
+                                  GetInternalKeySeqno(key.internal_key()))) {
+    if (bloom_filter_) {
+      PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
+    }
+    PERF_COUNTER_ADD(seqno_filter_memtable_miss_count, 1);
+    *seq = kMaxSequenceNumber;
   } else {
     if (bloom_filter_) {
       PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
@@ -945,6 +1039,11 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
           iter->max_covering_tombstone_seq,
           range_del_iter->MaxCoveringTombstoneSeqnum(iter->lkey->user_key()));
     }
+    if (!SeqnoFilterMayMatch(iter->ukey_without_ts,
+                             GetInternalKeySeqno(iter->lkey->internal_key()))) {
+      PERF_COUNTER_ADD(seqno_filter_memtable_miss_count, 1);
+      continue;
+    }
     GetFromTable(*(iter->lkey), iter->max_covering_tombstone_seq, true,
                  callback, is_blob, iter->value->GetSelf(), iter->timestamp,
                  iter->s, &(iter->merge_context), &seq, &found_final_value,
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <deque>
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -44,6 +45,7 @@ struct ImmutableMemTableOptions {
   uint32_t memtable_prefix_bloom_bits;
   size_t memtable_huge_page_size;
   bool memtable_whole_key_filtering;
+  size_t memtable_seqno_filter_bucket_count;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
   UpdateStatus (*inplace_callback)(char* existing_value,
@@ -84,11 +86,20 @@ class MemTable {
  public:
   struct KeyComparator : public MemTableRep::KeyComparator {
     const InternalKeyComparator comparator;
-    explicit KeyComparator(const InternalKeyComparator& c) : comparator(c) { }
+    explicit KeyComparator(const InternalKeyComparator& c);
     virtual int operator()(const char* prefix_len_key1,
                            const char* prefix_len_key2) const override;
     virtual int operator()(const char* prefix_len_key,
                            const DecodedType& key) const override;
+    virtual const Comparator* user_comparator() const override {
+      return comparator.user_comparator();
+    }
+
+   private:
+    // With the bytewise comparator, keys whose first 8 user key bytes differ
+    // are ordered by comparing those bytes as one big-endian integer, without
+    // calling into the user comparator.
+    const bool prefix_compare_;
   };
 
   // MemTables are reference counted.  The initial reference count
@@ -406,6 +417,11 @@ class MemTable {
   MemTableStats ApproximateStats(const Slice& start_ikey,
                                  const Slice& end_ikey);
 
+  // Appends to *keys, in order, the internal keys of about `target` entries
+  // spread evenly over the memtable, see MemTableRep::SampleEntries().
+  // Returns false if the memtable representation can't sample its entries.
+  bool SampleKeys(size_t target, std::vector<Slice>* keys);
+
   // Get the lock associated for the key
   port::RWMutex* GetLock(const Slice& key);
 
@@ -437,11 +453,12 @@ class MemTable {
   }
 
 #ifndef ROCKSDB_LITE
-  void SetFlushJobInfo(std::unique_ptr<FlushJobInfo>&& info) {
+  // One FlushJobInfo per table file written by the flush
+  void SetFlushJobInfo(std::list<std::unique_ptr<FlushJobInfo>>&& info) {
     flush_job_info_ = std::move(info);
   }
 
-  std::unique_ptr<FlushJobInfo> ReleaseFlushJobInfo() {
+  std::list<std::unique_ptr<FlushJobInfo>> ReleaseFlushJobInfo() {
     return std::move(flush_job_info_);
   }
 #endif  // !ROCKSDB_LITE
@@ -502,6 +519,10 @@ class MemTable {
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> bloom_filter_;
 
+  // Smallest sequence number written to the keys hashing to each bucket, or
+  // nullptr if memtable_seqno_filter_bucket_count is 0.
+  std::atomic<SequenceNumber>* min_seqno_buckets_;
+
   std::atomic<FlushStateEnum> flush_state_;
 
   Env* env_;
@@ -530,7 +551,7 @@ class MemTable {
 
 #ifndef ROCKSDB_LITE
   // Flush job info of the current memtable.
-  std::unique_ptr<FlushJobInfo> flush_job_info_;
+  std::list<std::unique_ptr<FlushJobInfo>> flush_job_info_;
 #endif  // !ROCKSDB_LITE
 
   // Returns a heuristic flush decision
@@ -539,6 +560,14 @@ class MemTable {
   // Updates flush_state_ using ShouldFlushNow()
   void UpdateFlushState();
 
+  // Records that a version of key with sequence number s was inserted.
+  void UpdateSeqnoFilter(const Slice& user_key_without_ts, SequenceNumber s);
+
+  // Returns false if no version of the key in this memtable can be visible at
+  // snapshot, i.e. every version was written after it.
+  bool SeqnoFilterMayMatch(const Slice& user_key_without_ts,
+                           SequenceNumber snapshot) const;
+
   void UpdateOldestKeyTime();
 
   void GetFromTable(const LookupKey& key,
@@ -460,10 +460,8 @@ Status MemTableList::TryInstallMemtableFlushResults(
         edit_list.push_back(&m->edit_);
         memtables_to_flush.push_back(m);
 #ifndef ROCKSDB_LITE
-        std::unique_ptr<FlushJobInfo> info = m->ReleaseFlushJobInfo();
-        if (info != nullptr) {
-          committed_flush_jobs_info->push_back(std::move(info));
-        }
+        committed_flush_jobs_info->splice(committed_flush_jobs_info->end(),
+                                          m->ReleaseFlushJobInfo());
 #else
         (void)committed_flush_jobs_info;
 #endif  // !ROCKSDB_LITE
@@ -13,8 +13,9 @@
 namespace ROCKSDB_NAMESPACE {
 
 // PeriodicWorkScheduler is a singleton object, which is scheduling/running
-// DumpStats(), PersistStats(), and FlushInfoLog() for all DB instances. All DB
-// instances use the same object from `Default()`.
+// DumpStats(), PersistStats(), FlushInfoLog() and SaveBlockCacheWarmupFile()
+// for all DB instances. All DB instances use the same object from
+// `Default()`.
 //
 // Internally, it uses a single threaded timer object to run the periodic work
 // functions. Timer thread will always be started since the info log flushing
@@ -30,7 +31,8 @@ class PeriodicWorkScheduler {
   PeriodicWorkScheduler& operator=(PeriodicWorkScheduler&&) = delete;
 
   void Register(DBImpl* dbi, unsigned int stats_dump_period_sec,
-                unsigned int stats_persist_period_sec);
+                unsigned int stats_persist_period_sec,
+                unsigned int block_cache_warmup_period_sec = 0);
 
   void Unregister(DBImpl* dbi);
 
@@ -319,7 +319,10 @@ bool RangeDelAggregator::StripeRep::IsRangeOverlapped(const Slice& start,
 void ReadRangeDelAggregator::AddTombstones(
     std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter,
     const InternalKey* smallest, const InternalKey* largest) {
-  if (input_iter == nullptr || input_iter->empty()) {
+  // Tombstones that are all newer than the read snapshot can never delete a
+  // key, so drop them here instead of positioning over them on every lookup.
+  if (input_iter == nullptr || input_iter->empty() ||
+      input_iter->empty_in_snapshot()) {
     return;
   }
   rep_.AddTombstones(
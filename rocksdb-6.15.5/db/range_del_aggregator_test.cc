@@ -431,6 +431,35 @@ TEST_F(RangeDelAggregatorTest, MultipleItersInAggregatorWithUpperBound) {
                                            {"x", "y", false}});
 }
 
+TEST_F(RangeDelAggregatorTest, InvisibleItersInAggregator) {
+  auto fragment_lists = MakeFragmentedTombstoneLists(
+      {{{"a", "e", 10}, {"c", "g", 8}}, {{"a", "b", 20}, {"h", "i", 25}}});
+  ASSERT_EQ(8, fragment_lists[0]->min_seqno());
+  ASSERT_EQ(20, fragment_lists[1]->min_seqno());
+
+  ReadRangeDelAggregator range_del_agg(&bytewise_icmp, 19);
+  for (const auto& fragment_list : fragment_lists) {
+    std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter(
+        new FragmentedRangeTombstoneIterator(fragment_list.get(), bytewise_icmp,
+                                             19 /* snapshot */));
+    range_del_agg.AddTombstones(std::move(input_iter));
+  }
+  ASSERT_FALSE(range_del_agg.IsEmpty());
+
+  ReadRangeDelAggregator old_range_del_agg(&bytewise_icmp, 7);
+  for (const auto& fragment_list : fragment_lists) {
+    std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter(
+        new FragmentedRangeTombstoneIterator(fragment_list.get(), bytewise_icmp,
+                                             7 /* snapshot */));
+    ASSERT_TRUE(input_iter->empty_in_snapshot());
+    old_range_del_agg.AddTombstones(std::move(input_iter));
+  }
+  ASSERT_TRUE(old_range_del_agg.IsEmpty());
+  VerifyShouldDelete(&old_range_del_agg, {{InternalValue("a", 5), false},
+                                          {InternalValue("d", 6), false},
+                                          {InternalValue("h", 6), false}});
+}
+
 TEST_F(RangeDelAggregatorTest, MultipleTruncatedItersInAggregator) {
   auto fragment_lists = MakeFragmentedTombstoneLists(
       {{{"a", "z", 10}}, {{"a", "z", 10}}, {{"a", "z", 10}}});
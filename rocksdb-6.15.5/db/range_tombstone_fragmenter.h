@@ -68,6 +68,13 @@ struct FragmentedRangeTombstoneList {
   // number in [lower, upper].
   bool ContainsRange(SequenceNumber lower, SequenceNumber upper) const;
 
+  // Returns the smallest sequence number of the stored tombstones, or
+  // kMaxSequenceNumber if there are none. A reader whose snapshot is below
+  // it cannot see any of the tombstones.
+  SequenceNumber min_seqno() const {
+    return seq_set_.empty() ? kMaxSequenceNumber : *seq_set_.begin();
+  }
+
  private:
   // Given an ordered range tombstone iterator unfragmented_tombstones,
   // "fragment" the tombstones into non-overlapping pieces, and store them in
@@ -141,6 +148,11 @@ class FragmentedRangeTombstoneIterator : public InternalIterator {
   Status status() const override { return Status::OK(); }
 
   bool empty() const { return tombstones_->empty(); }
+  // Returns true if none of the tombstones has a sequence number in
+  // [lower_bound, upper_bound], i.e. the iterator would never be Valid().
+  bool empty_in_snapshot() const {
+    return !tombstones_->ContainsRange(lower_bound_, upper_bound_);
+  }
   void Invalidate() {
     pos_ = tombstones_->end();
     seq_pos_ = tombstones_->seq_end();
@@ -328,10 +328,11 @@ void TableCache::CreateRowCacheKeyPrefix(const ReadOptions& options,
   // all data should be exposed to the snapshot, so we treat it
   // the same as there is no snapshot. The exception is that if
   // a seq-checking callback is registered, some internal keys
-  // may still be filtered out.
+  // may still be filtered out. In snapshot aware mode the entry records
+  // the snapshots it is visible to, so the sequence number is not needed.
   uint64_t seq_no = 0;
   // Maybe we can include the whole file ifsnapshot == fd.largest_seqno.
-  if (options.snapshot != nullptr &&
+  if (!ioptions_.row_cache_snapshot_aware && options.snapshot != nullptr &&
       (get_context->has_callback() ||
        static_cast_with_check<const SnapshotImpl>(options.snapshot)
                ->GetSequenceNumber() <= fd.largest_seqno)) {
@@ -349,20 +350,38 @@ void TableCache::CreateRowCacheKeyPrefix(const ReadOptions& options,
 }
 
 bool TableCache::GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
-                                 size_t prefix_size, GetContext* get_context) {
+                                 size_t prefix_size, SequenceNumber snapshot,
+                                 GetContext* get_context) {
   bool found = false;
 
   row_cache_key.TrimAppend(prefix_size, user_key.data(), user_key.size());
-  if (auto row_handle =
-          ioptions_.row_cache->Lookup(row_cache_key.GetUserKey())) {
+  auto row_handle = ioptions_.row_cache->Lookup(row_cache_key.GetUserKey());
+  Slice found_row_cache_entry;
+  SequenceNumber version_seq = kMaxSequenceNumber;
+  if (row_handle != nullptr) {
+    found_row_cache_entry =
+        *static_cast<const std::string*>(ioptions_.row_cache->Value(row_handle));
+    if (ioptions_.row_cache_snapshot_aware) {
+      SequenceNumber next_version_seq = 0;
+      bool decoded = GetVarint64(&found_row_cache_entry, &version_seq) &&
+                     GetVarint64(&found_row_cache_entry, &next_version_seq);
+      assert(decoded);
+      // The cached version is what the snapshot sees only if the snapshot
+      // falls between it and the next newer version of the key in the file.
+      if (!decoded || snapshot < version_seq || snapshot >= next_version_seq ||
+          !get_context->CheckCallback(version_seq)) {
+        ioptions_.row_cache->Release(row_handle);
+        row_handle = nullptr;
+      }
+    }
+  }
+  if (row_handle != nullptr) {
     // Cleanable routine to release the cache entry
     Cleanable value_pinner;
     auto release_cache_entry_func = [](void* cache_to_clean,
                                        void* cache_handle) {
       ((Cache*)cache_to_clean)->Release((Cache::Handle*)cache_handle);
     };
-    auto found_row_cache_entry =
-        static_cast<const std::string*>(ioptions_.row_cache->Value(row_handle));
     // If it comes here value is located on the cache.
     // found_row_cache_entry points to the value on cache,
     // and value_pinner has cleanup procedure for the cached entry.
@@ -373,8 +392,8 @@ bool TableCache::GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
     // get_context.pinnable_slice_ is reset.
     value_pinner.RegisterCleanup(release_cache_entry_func,
                                  ioptions_.row_cache.get(), row_handle);
-    replayGetContextLog(*found_row_cache_entry, user_key, get_context,
-                        &value_pinner);
+    replayGetContextLog(found_row_cache_entry, user_key, get_context,
+                        &value_pinner, version_seq);
     RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
     found = true;
   } else {
@@ -382,6 +401,42 @@ bool TableCache::GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
   }
   return found;
 }
+
+bool TableCache::CanCacheRowSnapshotRange(
+    const InternalKeyComparator& internal_comparator, TableReader* t) const {
+  if (internal_comparator.user_comparator()->timestamp_size() > 0) {
+    return false;
+  }
+  auto props = t->GetTableProperties();
+  return props != nullptr && props->num_range_deletions == 0;
+}
+
+bool TableCache::EncodeRowCacheEntry(const FileDescriptor& fd,
+                                     SequenceNumber snapshot,
+                                     bool seeked_from_newest,
+                                     GetContext* get_context,
+                                     std::string* replay_log,
+                                     std::string* entry) const {
+  if (!ioptions_.row_cache_snapshot_aware) {
+    *entry = std::move(*replay_log);
+    return true;
+  }
+  SequenceNumber version_seq = get_context->replay_log_seq();
+  if (version_seq == kMaxSequenceNumber) {
+    return false;
+  }
+  // Versions newer than the snapshot are only seen if the lookup started
+  // from the newest version of the key. Otherwise all we know is that there
+  // is none up to the snapshot.
+  SequenceNumber next_version_seq = get_context->min_skipped_seq();
+  if (!seeked_from_newest && snapshot < fd.largest_seqno) {
+    next_version_seq = std::min(next_version_seq, snapshot + 1);
+  }
+  entry->reserve(2 * kMaxVarint64Length + replay_log->size());
+  PutVarint64Varint64(entry, version_seq, next_version_seq);
+  entry->append(*replay_log);
+  return true;
+}
 #endif  // ROCKSDB_LITE
 
 Status TableCache::Get(const ReadOptions& options,
@@ -398,17 +453,21 @@ Status TableCache::Get(const ReadOptions& options,
   IterKey row_cache_key;
   std::string row_cache_entry_buffer;
 
-  // Check row cache if enabled. Since row cache does not currently store
-  // sequence numbers, we cannot use it if we need to fetch the sequence.
-  if (ioptions_.row_cache && !get_context->NeedToReadSequence()) {
+  // Check row cache if enabled. Unless the row cache is snapshot aware it
+  // does not store sequence numbers, so we cannot use it if we need to fetch
+  // the sequence.
+  if (ioptions_.row_cache && (ioptions_.row_cache_snapshot_aware ||
+                              !get_context->NeedToReadSequence())) {
     auto user_key = ExtractUserKey(k);
     CreateRowCacheKeyPrefix(options, fd, k, get_context, row_cache_key);
     done = GetFromRowCache(user_key, row_cache_key, row_cache_key.Size(),
-                           get_context);
+                           GetInternalKeySeqno(k), get_context);
     if (!done) {
       row_cache_entry = &row_cache_entry_buffer;
     }
   }
+  InternalKey newest_version_key;
+  bool seeked_from_newest = false;
 #endif  // ROCKSDB_LITE
   Status s;
   TableReader* t = fd.table_reader;
@@ -438,10 +497,29 @@ Status TableCache::Get(const ReadOptions& options,
             range_del_iter->MaxCoveringTombstoneSeqnum(ExtractUserKey(k)));
       }
     }
+    Slice lookup_key = k;
+#ifndef ROCKSDB_LITE
+    if (s.ok() && row_cache_entry != nullptr &&
+        ioptions_.row_cache_snapshot_aware) {
+      if (!CanCacheRowSnapshotRange(internal_comparator, t)) {
+        row_cache_entry = nullptr;
+      } else if (GetInternalKeySeqno(k) < fd.largest_seqno) {
+        // Start from the newest version of the key, so that the versions
+        // hidden from the snapshot bound the range the cached entry is valid
+        // for. GetContext skips them as invisible.
+        newest_version_key.Set(ExtractUserKey(k), kMaxSequenceNumber,
+                               kValueTypeForSeek);
+        lookup_key = newest_version_key.Encode();
+        get_context->SetMaxVisibleSeq(GetInternalKeySeqno(k));
+        seeked_from_newest = true;
+      }
+    }
+#endif  // ROCKSDB_LITE
     if (s.ok()) {
       get_context->SetReplayLog(row_cache_entry);  // nullptr if no cache.
-      s = t->Get(options, k, get_context, prefix_extractor, skip_filters);
-      get_context->SetReplayLog(nullptr);
+      s = t->Get(options, lookup_key, get_context, prefix_extractor,
+                 skip_filters);
+      get_context->SetMaxVisibleSeq(kMaxSequenceNumber);
     } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
       // Couldn't find Table in cache but treat as kFound if no_io set
       get_context->MarkKeyMayExist();
@@ -453,15 +531,19 @@ Status TableCache::Get(const ReadOptions& options,
 #ifndef ROCKSDB_LITE
   // Put the replay log in row cache only if something was found.
   if (!done && s.ok() && row_cache_entry && !row_cache_entry->empty()) {
-    size_t charge =
-        row_cache_key.Size() + row_cache_entry->size() + sizeof(std::string);
-    void* row_ptr = new std::string(std::move(*row_cache_entry));
-    // If row cache is full, it's OK to continue.
-    ioptions_.row_cache
-        ->Insert(row_cache_key.GetUserKey(), row_ptr, charge,
-                 &DeleteEntry<std::string>)
-        .PermitUncheckedError();
+    std::unique_ptr<std::string> row_ptr(new std::string());
+    if (EncodeRowCacheEntry(fd, GetInternalKeySeqno(k), seeked_from_newest,
+                            get_context, row_cache_entry, row_ptr.get())) {
+      size_t charge =
+          row_cache_key.Size() + row_ptr->size() + sizeof(std::string);
+      // If row cache is full, it's OK to continue.
+      ioptions_.row_cache
+          ->Insert(row_cache_key.GetUserKey(), row_ptr.release(), charge,
+                   &DeleteEntry<std::string>)
+          .PermitUncheckedError();
+    }
   }
+  get_context->SetReplayLog(nullptr);
 #endif  // ROCKSDB_LITE
 
   if (handle != nullptr) {
@@ -490,10 +572,12 @@ Status TableCache::MultiGet(const ReadOptions& options,
   size_t row_cache_key_prefix_size = 0;
   KeyContext& first_key = *table_range.begin();
   bool lookup_row_cache =
-      ioptions_.row_cache && !first_key.get_context->NeedToReadSequence();
+      ioptions_.row_cache && (ioptions_.row_cache_snapshot_aware ||
+                              !first_key.get_context->NeedToReadSequence());
 
-  // Check row cache if enabled. Since row cache does not currently store
-  // sequence numbers, we cannot use it if we need to fetch the sequence.
+  // Check row cache if enabled. Unless the row cache is snapshot aware it
+  // does not store sequence numbers, so we cannot use it if we need to fetch
+  // the sequence.
   if (lookup_row_cache) {
     GetContext* first_context = first_key.get_context;
     CreateRowCacheKeyPrefix(options, fd, first_key.ikey, first_context,
@@ -507,7 +591,7 @@ Status TableCache::MultiGet(const ReadOptions& options,
       GetContext* get_context = miter->get_context;
 
       if (GetFromRowCache(user_key, row_cache_key, row_cache_key_prefix_size,
-                          get_context)) {
+                          GetInternalKeySeqno(miter->ikey), get_context)) {
         table_range.SkipKey(miter);
       } else {
         row_cache_entries.emplace_back();
@@ -562,6 +646,9 @@ Status TableCache::MultiGet(const ReadOptions& options,
 #ifndef ROCKSDB_LITE
   if (lookup_row_cache) {
     size_t row_idx = 0;
+    bool can_cache = s.ok() && t != nullptr &&
+                     (!ioptions_.row_cache_snapshot_aware ||
+                      CanCacheRowSnapshotRange(internal_comparator, t));
 
     for (auto miter = table_range.begin(); miter != table_range.end();
          ++miter) {
@@ -570,21 +657,24 @@ Status TableCache::MultiGet(const ReadOptions& options,
       ;
       GetContext* get_context = miter->get_context;
 
-      get_context->SetReplayLog(nullptr);
       // Compute row cache key.
       row_cache_key.TrimAppend(row_cache_key_prefix_size, user_key.data(),
                                user_key.size());
       // Put the replay log in row cache only if something was found.
-      if (s.ok() && !row_cache_entry.empty()) {
+      std::unique_ptr<std::string> row_ptr(new std::string());
+      if (can_cache && !row_cache_entry.empty() &&
+          EncodeRowCacheEntry(fd, GetInternalKeySeqno(miter->ikey),
+                              false /* seeked_from_newest */, get_context,
+                              &row_cache_entry, row_ptr.get())) {
         size_t charge =
-            row_cache_key.Size() + row_cache_entry.size() + sizeof(std::string);
-        void* row_ptr = new std::string(std::move(row_cache_entry));
+            row_cache_key.Size() + row_ptr->size() + sizeof(std::string);
         // If row cache is full, it's OK.
         ioptions_.row_cache
-            ->Insert(row_cache_key.GetUserKey(), row_ptr, charge,
+            ->Insert(row_cache_key.GetUserKey(), row_ptr.release(), charge,
                      &DeleteEntry<std::string>)
             .PermitUncheckedError();
       }
+      get_context->SetReplayLog(nullptr);
     }
   }
 #endif  // ROCKSDB_LITE
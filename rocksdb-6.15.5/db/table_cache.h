@@ -209,16 +209,34 @@ class TableCache {
 
   // Create a key prefix for looking up the row cache. The prefix is of the
   // format row_cache_id + fd_number + seq_no. Later, the user key can be
-  // appended to form the full key
+  // appended to form the full key. With row_cache_snapshot_aware, seq_no is
+  // always 0 since the entry itself records the snapshots it is valid for.
   void CreateRowCacheKeyPrefix(const ReadOptions& options,
                                const FileDescriptor& fd,
                                const Slice& internal_key,
                                GetContext* get_context, IterKey& row_cache_key);
 
   // Helper function to lookup the row cache for a key. It appends the
-  // user key to row_cache_key at offset prefix_size
+  // user key to row_cache_key at offset prefix_size. `snapshot` is the
+  // sequence number of the lookup key.
   bool GetFromRowCache(const Slice& user_key, IterKey& row_cache_key,
-                       size_t prefix_size, GetContext* get_context);
+                       size_t prefix_size, SequenceNumber snapshot,
+                       GetContext* get_context);
+
+  // Returns true if results read from table `t` can be cached together with
+  // the range of snapshots they are visible to. Not the case if the file has
+  // range tombstones, which would have to be re-evaluated per snapshot, or
+  // if user-defined timestamps are used.
+  bool CanCacheRowSnapshotRange(const InternalKeyComparator& internal_comparator,
+                                TableReader* t) const;
+
+  // Builds the row cache entry for the replay log accumulated in
+  // get_context. With row_cache_snapshot_aware, the log is prefixed with the
+  // interval [version_seq, next_version_seq) of snapshots for which it is
+  // valid. Returns false if the entry must not be cached.
+  bool EncodeRowCacheEntry(const FileDescriptor& fd, SequenceNumber snapshot,
+                           bool seeked_from_newest, GetContext* get_context,
+                           std::string* replay_log, std::string* entry) const;
 
   const ImmutableCFOptions& ioptions_;
   const FileOptions& file_options_;
@@ -270,6 +270,15 @@ class VersionBuilder::Rep {
     (*expected_linked_ssts)[blob_file_number].emplace(table_file_number);
   }
 
+  // Returns true if the user key ranges of two L0 files overlap.
+  static bool L0FilesOverlap(VersionStorageInfo* vstorage,
+                             const FileMetaData* f1, const FileMetaData* f2) {
+    const Comparator* ucmp = vstorage->InternalComparator()->user_comparator();
+    return ucmp->Compare(f1->smallest.user_key(), f2->largest.user_key()) <=
+               0 &&
+           ucmp->Compare(f2->smallest.user_key(), f1->largest.user_key()) <= 0;
+  }
+
   Status CheckConsistencyDetails(VersionStorageInfo* vstorage) {
     // Make sure the files are sorted correctly and that the links between
     // table files and blob files are consistent. The latter is checked using
@@ -319,7 +328,11 @@ class VersionBuilder::Rep {
                   NumberToString(external_file_seqno) + " with fileNumber " +
                   NumberToString(f1->fd.GetNumber()));
             }
-          } else if (f1->fd.smallest_seqno <= f2->fd.smallest_seqno) {
+          } else if (f1->fd.smallest_seqno <= f2->fd.smallest_seqno &&
+                     L0FilesOverlap(vstorage, f1, f2)) {
+            // The sequence number ranges of the files of a partitioned flush
+            // overlap, which is fine as long as their key ranges are
+            // disjoint.
             return Status::Corruption(
                 "L0 files seqno " + NumberToString(f1->fd.smallest_seqno) +
                 " " + NumberToString(f1->fd.largest_seqno) + " " +
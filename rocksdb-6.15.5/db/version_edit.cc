@@ -76,6 +76,7 @@ void VersionEdit::Clear() {
   max_column_family_ = 0;
   min_log_number_to_keep_ = 0;
   last_sequence_ = 0;
+  wal_streams_ = 1;
   has_db_id_ = false;
   has_comparator_ = false;
   has_log_number_ = false;
@@ -84,6 +85,7 @@ void VersionEdit::Clear() {
   has_max_column_family_ = false;
   has_min_log_number_to_keep_ = false;
   has_last_sequence_ = false;
+  has_wal_streams_ = false;
   deleted_files_.clear();
   new_files_.clear();
   blob_file_additions_.clear();
@@ -234,6 +236,14 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
     wal_deletion_.EncodeTo(dst);
   }
 
+  if (has_wal_streams_) {
+    // Length prefixed, so that older versions can skip it.
+    std::string varint_wal_streams;
+    PutVarint32(&varint_wal_streams, wal_streams_);
+    PutVarint32(dst, kWalStreams);
+    PutLengthPrefixedSlice(dst, Slice(varint_wal_streams));
+  }
+
   // 0 is default and does not need to be explicitly written
   if (column_family_ != 0) {
     PutVarint32Varint32(dst, kColumnFamily, column_family_);
@@ -580,6 +590,17 @@ Status VersionEdit::DecodeFrom(const Slice& src) {
         break;
       }
 
+      case kWalStreams:
+        if (GetLengthPrefixedSlice(&input, &str) &&
+            GetVarint32(&str, &wal_streams_) && wal_streams_ > 0) {
+          has_wal_streams_ = true;
+        } else {
+          if (!msg) {
+            msg = "wal streams";
+          }
+        }
+        break;
+
       case kColumnFamily:
         if (!GetVarint32(&input, &column_family_)) {
           if (!msg) {
@@ -730,6 +751,11 @@ std::string VersionEdit::DebugString(bool hex_key) const {
     r.append(wal_deletion_.DebugString());
   }
 
+  if (has_wal_streams_) {
+    r.append("\n  WalStreams: ");
+    AppendNumberTo(&r, wal_streams_);
+  }
+
   r.append("\n  ColumnFamily: ");
   AppendNumberTo(&r, column_family_);
   if (is_column_family_add_) {
@@ -861,6 +887,10 @@ std::string VersionEdit::DebugJSON(int edit_num, bool hex_key) const {
     jw.EndObject();
   }
 
+  if (has_wal_streams_) {
+    jw << "WalStreams" << wal_streams_;
+  }
+
   jw << "ColumnFamily" << column_family_;
 
   if (is_column_family_add_) {
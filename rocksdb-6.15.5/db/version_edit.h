@@ -61,6 +61,7 @@ enum Tag : uint32_t {
   kBlobFileGarbage,
   kWalAddition,
   kWalDeletion,
+  kWalStreams,
 };
 
 enum NewFileCustomTag : uint32_t {
@@ -317,6 +318,15 @@ class VersionEdit {
   bool HasDbId() const { return has_db_id_; }
   const std::string& GetDbId() const { return db_id_; }
 
+  // The number of log files each WAL is written to, see
+  // DBOptions::wal_streams. Not recorded means 1.
+  void SetWalStreams(uint32_t wal_streams) {
+    has_wal_streams_ = true;
+    wal_streams_ = wal_streams;
+  }
+  bool HasWalStreams() const { return has_wal_streams_; }
+  uint32_t GetWalStreams() const { return wal_streams_; }
+
   void SetComparatorName(const Slice& name) {
     has_comparator_ = true;
     comparator_ = name.ToString();
@@ -556,6 +566,7 @@ class VersionEdit {
   // The most recent WAL log number that is deleted
   uint64_t min_log_number_to_keep_ = 0;
   SequenceNumber last_sequence_ = 0;
+  uint32_t wal_streams_ = 1;
   bool has_db_id_ = false;
   bool has_comparator_ = false;
   bool has_log_number_ = false;
@@ -564,6 +575,7 @@ class VersionEdit {
   bool has_max_column_family_ = false;
   bool has_min_log_number_to_keep_ = false;
   bool has_last_sequence_ = false;
+  bool has_wal_streams_ = false;
 
   DeletedFiles deleted_files_;
   NewFiles new_files_;
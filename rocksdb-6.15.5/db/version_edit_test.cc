@@ -279,6 +279,19 @@ TEST_F(VersionEditTest, DbId) {
   TestEncodeDecode(edit);
 }
 
+TEST_F(VersionEditTest, WalStreams) {
+  VersionEdit edit;
+  edit.SetWalStreams(3);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  ASSERT_OK(parsed.DecodeFrom(encoded));
+  ASSERT_TRUE(parsed.HasWalStreams());
+  ASSERT_EQ(3, parsed.GetWalStreams());
+}
+
 TEST_F(VersionEditTest, BlobFileAdditionAndGarbage) {
   VersionEdit edit;
 
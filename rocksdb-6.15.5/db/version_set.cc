@@ -3786,6 +3786,7 @@ void VersionSet::Reset() {
                             wbm, wc, block_cache_tracer_, io_tracer_));
   }
   db_id_.clear();
+  wal_streams_ = 1;
   next_file_number_.store(2);
   min_log_number_to_keep_2pc_.store(0);
   manifest_file_number_ = 0;
@@ -4170,6 +4171,9 @@ Status VersionSet::ProcessManifestWrites(
   if (s.ok()) {
     // Apply WAL edits, DB mutex must be held.
     for (auto& e : batch_edits) {
+      if (e->HasWalStreams()) {
+        wal_streams_ = e->GetWalStreams();
+      }
       if (e->IsWalAddition()) {
         s = wals_.AddWals(e->GetWalAdditions());
       } else if (e->IsWalDeletion()) {
@@ -4656,6 +4660,9 @@ Status VersionSet::ReadAndRecover(
         db_id->assign(edit.GetDbId());
       }
     }
+    if (edit.has_wal_streams_) {
+      wal_streams_ = edit.wal_streams_;
+    }
     s = read_buffer->AddEdit(&edit);
     if (!s.ok()) {
       break;
@@ -5175,6 +5182,20 @@ Status VersionSet::WriteCurrentStateToManifest(
     }
   }
 
+  if (wal_streams_ > 1) {
+    VersionEdit edit_for_wal_streams;
+    edit_for_wal_streams.SetWalStreams(wal_streams_);
+    std::string wal_streams_record;
+    if (!edit_for_wal_streams.EncodeTo(&wal_streams_record)) {
+      return Status::Corruption("Unable to Encode VersionEdit:" +
+                                edit_for_wal_streams.DebugString(true));
+    }
+    io_s = log->AddRecord(wal_streams_record);
+    if (!io_s.ok()) {
+      return io_s;
+    }
+  }
+
   // Save WALs.
   if (!wal_additions.GetWalAdditions().empty()) {
     TEST_SYNC_POINT_CALLBACK("VersionSet::WriteCurrentStateToManifest:SaveWal",
@@ -6117,6 +6138,9 @@ Status ReactiveVersionSet::ReadAndApply(
 Status ReactiveVersionSet::ApplyOneVersionEditToBuilder(
     VersionEdit& edit, std::unordered_set<ColumnFamilyData*>* cfds_changed,
     VersionEdit* version_edit) {
+  if (edit.has_wal_streams_) {
+    wal_streams_ = edit.wal_streams_;
+  }
   ColumnFamilyData* cfd =
       column_family_set_->GetColumnFamily(edit.column_family_);
 
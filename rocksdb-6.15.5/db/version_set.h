@@ -1205,6 +1205,10 @@ class VersionSet {
   // The returned WalSet needs to be accessed with DB mutex held.
   const WalSet& GetWalSet() const { return wals_; }
 
+  // The number of log files the WALs are written to, as recorded in the
+  // MANIFEST, or 1 if never recorded. Needs to be accessed with DB mutex held.
+  uint32_t GetWalStreams() const { return wal_streams_; }
+
   void TEST_CreateAndAppendVersion(ColumnFamilyData* cfd) {
     assert(cfd);
 
@@ -1294,6 +1298,8 @@ class VersionSet {
 
   // Protected by DB mutex.
   WalSet wals_;
+  // Protected by DB mutex.
+  uint32_t wal_streams_ = 1;
 
   std::unique_ptr<ColumnFamilySet> column_family_set_;
   Cache* table_cache_;
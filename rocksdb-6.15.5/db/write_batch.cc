@@ -32,9 +32,15 @@
 // varstring :=
 //    len: varint32
 //    data: uint8[len]
+//
+// The data of a value added with PutPinnedValue() is not stored in rep_ but
+// referenced from WriteBatch::pinned_values_ until it is materialized. Sizes
+// and offsets handed out by WriteBatch, e.g. GetDataSize() and save points,
+// always count the pinned values as if they were stored in rep_.
 
 #include "rocksdb/write_batch.h"
 
+#include <algorithm>
 #include <map>
 #include <stack>
 #include <stdexcept>
@@ -237,6 +243,76 @@ class TimestampAssigner : public WriteBatch::Handler {
 };
 const std::vector<Slice> TimestampAssigner::kEmptyTimestampList;
 
+// Collects the puts and deletes of a batch, so that they can be inserted into
+// memtables in key order. Stops at any other kind of entry.
+class SortedInsertCollector : public WriteBatch::Handler {
+ public:
+  struct Entry {
+    uint32_t column_family_id;
+    Slice key;
+    Slice value;
+    ValueType type;
+    // Sequence number offset of the entry within the batch
+    size_t index;
+  };
+
+  Status PutCF(uint32_t column_family_id, const Slice& key,
+               const Slice& value) override {
+    return Add(column_family_id, key, value, kTypeValue);
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, key, Slice(), kTypeDeletion);
+  }
+
+  Status SingleDeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, key, Slice(), kTypeSingleDeletion);
+  }
+
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    return Unsupported();
+  }
+
+  Status MergeCF(uint32_t, const Slice&, const Slice&) override {
+    return Unsupported();
+  }
+
+  Status PutBlobIndexCF(uint32_t, const Slice&, const Slice&) override {
+    return Unsupported();
+  }
+
+  Status MarkBeginPrepare(bool) override { return Unsupported(); }
+
+  Status MarkEndPrepare(const Slice&) override { return Unsupported(); }
+
+  Status MarkNoop(bool) override { return Unsupported(); }
+
+  Status MarkCommit(const Slice&) override { return Unsupported(); }
+
+  Status MarkRollback(const Slice&) override { return Unsupported(); }
+
+  bool Continue() override { return supported_; }
+
+  bool supported() const { return supported_; }
+
+  std::vector<Entry>* entries() { return &entries_; }
+
+ private:
+  Status Add(uint32_t column_family_id, const Slice& key, const Slice& value,
+             ValueType type) {
+    entries_.push_back({column_family_id, key, value, type, entries_.size()});
+    return Status::OK();
+  }
+
+  Status Unsupported() {
+    supported_ = false;
+    return Status::OK();
+  }
+
+  std::vector<Entry> entries_;
+  bool supported_ = true;
+};
+
 }  // anon namespace
 
 struct SavePoints {
@@ -273,6 +349,8 @@ WriteBatch::WriteBatch(std::string&& rep)
 WriteBatch::WriteBatch(const WriteBatch& src)
     : wal_term_point_(src.wal_term_point_),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
+      pinned_values_(src.pinned_values_),
+      pinned_bytes_(src.pinned_bytes_),
       max_bytes_(src.max_bytes_),
       rep_(src.rep_),
       timestamp_size_(src.timestamp_size_) {
@@ -280,15 +358,22 @@ WriteBatch::WriteBatch(const WriteBatch& src)
     save_points_.reset(new SavePoints());
     save_points_->stack = src.save_points_->stack;
   }
+  // The copy may outlive the pinned values of src.
+  MaterializePinnedValues();
 }
 
 WriteBatch::WriteBatch(WriteBatch&& src) noexcept
     : save_points_(std::move(src.save_points_)),
       wal_term_point_(std::move(src.wal_term_point_)),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
+      pinned_values_(std::move(src.pinned_values_)),
+      pinned_bytes_(src.pinned_bytes_),
       max_bytes_(src.max_bytes_),
       rep_(std::move(src.rep_)),
-      timestamp_size_(src.timestamp_size_) {}
+      timestamp_size_(src.timestamp_size_) {
+  src.pinned_values_.clear();
+  src.pinned_bytes_ = 0;
+}
 
 WriteBatch& WriteBatch::operator=(const WriteBatch& src) {
   if (&src != this) {
@@ -322,6 +407,8 @@ bool WriteBatch::Handler::Continue() {
 void WriteBatch::Clear() {
   rep_.clear();
   rep_.resize(WriteBatchInternal::kHeader);
+  pinned_values_.clear();
+  pinned_bytes_ = 0;
 
   content_flags_.store(0, std::memory_order_relaxed);
 
@@ -336,6 +423,25 @@ void WriteBatch::Clear() {
 
 uint32_t WriteBatch::Count() const { return WriteBatchInternal::Count(this); }
 
+void WriteBatch::MaterializePinnedValues() {
+  if (pinned_values_.empty()) {
+    return;
+  }
+  std::string rep;
+  rep.reserve(GetDataSize());
+  size_t pos = 0;
+  for (const auto& pinned : pinned_values_) {
+    assert(pinned.value_offset >= pos);
+    rep.append(rep_, pos, pinned.value_offset - pos);
+    rep.append(pinned.value.data(), pinned.value.size());
+    pos = pinned.value_offset;
+  }
+  rep.append(rep_, pos, std::string::npos);
+  rep_.swap(rep);
+  pinned_values_.clear();
+  pinned_bytes_ = 0;
+}
+
 uint32_t WriteBatch::ComputeContentFlags() const {
   auto rv = content_flags_.load(std::memory_order_relaxed);
   if ((rv & ContentFlags::DEFERRED) != 0) {
@@ -512,25 +618,68 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
   return Status::OK();
 }
 
+// Reads a Put record added with PutPinnedValue(), whose value is not in
+// input but pinned_value.
+Status ReadPinnedPutRecord(Slice* input, const Slice& pinned_value, char* tag,
+                           uint32_t* column_family, Slice* key, Slice* value) {
+  *tag = (*input)[0];
+  input->remove_prefix(1);
+  *column_family = 0;  // default
+  if (*tag == kTypeColumnFamilyValue) {
+    if (!GetVarint32(input, column_family)) {
+      return Status::Corruption("bad WriteBatch Put");
+    }
+  } else if (*tag != kTypeValue) {
+    return Status::Corruption("bad WriteBatch pinned Put");
+  }
+  uint32_t value_size = 0;
+  if (!GetLengthPrefixedSlice(input, key) || !GetVarint32(input, &value_size) ||
+      value_size != pinned_value.size()) {
+    return Status::Corruption("bad WriteBatch Put");
+  }
+  *value = pinned_value;
+  return Status::OK();
+}
+
 Status WriteBatch::Iterate(Handler* handler) const {
   if (rep_.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
   }
 
   return WriteBatchInternal::Iterate(this, handler, WriteBatchInternal::kHeader,
-                                     rep_.size());
+                                     GetDataSize());
 }
 
 Status WriteBatchInternal::Iterate(const WriteBatch* wb,
                                    WriteBatch::Handler* handler, size_t begin,
                                    size_t end) {
-  if (begin > wb->rep_.size() || end > wb->rep_.size() || end < begin) {
+  const size_t data_size = wb->GetDataSize();
+  if (begin > data_size || end > data_size || end < begin) {
     return Status::Corruption("Invalid start/end bounds for Iterate");
   }
   assert(begin <= end);
-  Slice input(wb->rep_.data() + begin, static_cast<size_t>(end - begin));
   bool whole_batch =
-      (begin == WriteBatchInternal::kHeader) && (end == wb->rep_.size());
+      (begin == WriteBatchInternal::kHeader) && (end == data_size);
+  // begin and end count the pinned values, which are not in rep_. Both are
+  // record boundaries, so the record of a pinned value, which may be empty,
+  // is either entirely before them or entirely after them.
+  const auto& pinned_values = wb->pinned_values_;
+  size_t next_pinned = 0;
+  size_t rep_begin = begin;
+  size_t rep_end = end;
+  size_t pinned_before = 0;
+  for (const auto& pinned : pinned_values) {
+    if (pinned.record_offset + pinned_before >= end) {
+      break;
+    }
+    if (pinned.record_offset + pinned_before < begin) {
+      rep_begin -= pinned.value.size();
+      ++next_pinned;
+    }
+    rep_end -= pinned.value.size();
+    pinned_before += pinned.value.size();
+  }
+  Slice input(wb->rep_.data() + rep_begin, rep_end - rep_begin);
 
   Slice key, value, blob, xid;
   // Sometimes a sub-batch starts with a Noop. We want to exclude such Noops as
@@ -555,8 +704,16 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
       tag = 0;
       column_family = 0;  // default
 
-      s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key, &value,
-                                   &blob, &xid);
+      if (next_pinned < pinned_values.size() &&
+          static_cast<size_t>(input.data() - wb->rep_.data()) ==
+              pinned_values[next_pinned].record_offset) {
+        s = ReadPinnedPutRecord(&input, pinned_values[next_pinned].value, &tag,
+                                &column_family, &key, &value);
+        ++next_pinned;
+      } else {
+        s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                     &value, &blob, &xid);
+      }
       if (!s.ok()) {
         return s;
       }
@@ -798,6 +955,46 @@ Status WriteBatch::Put(ColumnFamilyHandle* column_family, const Slice& key,
                                  value);
 }
 
+Status WriteBatchInternal::PutPinnedValue(WriteBatch* b,
+                                          uint32_t column_family_id,
+                                          const Slice& key,
+                                          const Slice& value) {
+  if (b->timestamp_size_ != 0) {
+    // The key is rewritten when timestamps are assigned, keep it simple.
+    return Put(b, column_family_id, key, value);
+  }
+  if (key.size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("key is too large");
+  }
+  if (value.size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("value is too large");
+  }
+
+  LocalSavePoint save(b);
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  const size_t record_offset = b->rep_.size();
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeValue));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, key);
+  PutVarint32(&b->rep_, static_cast<uint32_t>(value.size()));
+  b->pinned_values_.push_back({record_offset, b->rep_.size(), value});
+  b->pinned_bytes_ += value.size();
+  b->content_flags_.store(
+      b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
+      std::memory_order_relaxed);
+  return save.commit();
+}
+
+Status WriteBatch::PutPinnedValue(ColumnFamilyHandle* column_family,
+                                  const Slice& key, const Slice& value) {
+  return WriteBatchInternal::PutPinnedValue(
+      this, GetColumnFamilyID(column_family), key, value);
+}
+
 Status WriteBatchInternal::CheckSlicePartsLength(const SliceParts& key,
                                                  const SliceParts& value) {
   size_t total_key_bytes = 0;
@@ -1166,6 +1363,7 @@ Status WriteBatch::RollbackToSavePoint() {
   SavePoint savepoint = save_points_->stack.top();
   save_points_->stack.pop();
 
+  MaterializePinnedValues();
   assert(savepoint.size <= rep_.size());
   assert(static_cast<uint32_t>(savepoint.count) <= Count());
 
@@ -1363,6 +1561,92 @@ class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence() const { return sequence_; }
 
+  // Inserts the entries of a batch of puts and deletes in the order of the
+  // memtables, so that each insertion continues the search from the position
+  // of the previous one: through the per-batch hints in concurrent writes, and
+  // through the sequential insert position of the memtable otherwise. Entries
+  // keep the sequence numbers of their position in the batch. Falls back to
+  // inserting in batch order for other batches.
+  Status InsertSorted(const WriteBatch* batch) {
+    if (seq_per_batch_ || rebuilding_trx_ != nullptr ||
+        recovering_log_number_ != 0) {
+      return batch->Iterate(this);
+    }
+    SortedInsertCollector collector;
+    Status s = batch->Iterate(&collector);
+    auto& entries = *collector.entries();
+    if (!s.ok() || !collector.supported() || entries.size() < 2) {
+      return batch->Iterate(this);
+    }
+
+    // Order the entries like the memtables do: by column family, then user
+    // key, then descending sequence number.
+    autovector<std::pair<uint32_t, const Comparator*>> comparators;
+    auto get_comparator = [&](uint32_t column_family_id) -> const Comparator* {
+      for (const auto& cmp : comparators) {
+        if (cmp.first == column_family_id) {
+          return cmp.second;
+        }
+      }
+      return nullptr;
+    };
+    for (const auto& entry : entries) {
+      if (get_comparator(entry.column_family_id) != nullptr) {
+        continue;
+      }
+      const Comparator* ucmp = BytewiseComparator();
+      if (cf_mems_->Seek(entry.column_family_id)) {
+        MemTable* mem = cf_mems_->GetMemTable();
+        if (mem->GetImmutableMemTableOptions()->inplace_update_support) {
+          // In-place updates depend on the order of the entries of a key.
+          return batch->Iterate(this);
+        }
+        ucmp = mem->GetInternalKeyComparator().user_comparator();
+      }
+      comparators.emplace_back(entry.column_family_id, ucmp);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [&](const SortedInsertCollector::Entry& a,
+                  const SortedInsertCollector::Entry& b) {
+                if (a.column_family_id != b.column_family_id) {
+                  return a.column_family_id < b.column_family_id;
+                }
+                int c = get_comparator(a.column_family_id)
+                            ->Compare(a.key, b.key);
+                if (c != 0) {
+                  return c < 0;
+                }
+                return a.index > b.index;
+              });
+
+    if (concurrent_memtable_writes_) {
+      hint_per_batch_ = true;
+    }
+    const SequenceNumber first_seq = sequence_;
+    for (const auto& entry : entries) {
+      sequence_ = first_seq + entry.index;
+      switch (entry.type) {
+        case kTypeValue:
+          s = PutCF(entry.column_family_id, entry.key, entry.value);
+          break;
+        case kTypeDeletion:
+          s = DeleteCF(entry.column_family_id, entry.key);
+          break;
+        case kTypeSingleDeletion:
+          s = SingleDeleteCF(entry.column_family_id, entry.key);
+          break;
+        default:
+          assert(false);
+          break;
+      }
+      if (!s.ok()) {
+        break;
+      }
+    }
+    sequence_ = first_seq + entries.size();
+    return s;
+  }
+
   void PostProcess() {
     assert(concurrent_memtable_writes_);
     // If post info was not created there is nothing
@@ -1514,6 +1798,7 @@ class MemTableInserter : public WriteBatch::Handler {
                                            key, value);
       assert(ret_status.ok());
     }
+    InvalidateHotKey(key);
     // Since all Puts are logged in transaction logs (if enabled), always bump
     // sequence number. Even if the update eventually fails and does not result
     // in memtable add/update.
@@ -1541,6 +1826,11 @@ class MemTableInserter : public WriteBatch::Handler {
       const bool BATCH_BOUNDRY = true;
       MaybeAdvanceSeq(BATCH_BOUNDRY);
     }
+    if (delete_type == kTypeRangeDeletion) {
+      InvalidateHotKeys();
+    } else {
+      InvalidateHotKey(key);
+    }
     MaybeAdvanceSeq();
     CheckMemtableFull();
     return ret_status;
@@ -1804,6 +2094,7 @@ class MemTableInserter : public WriteBatch::Handler {
                                              key, value);
       assert(ret_status.ok());
     }
+    InvalidateHotKey(key);
     MaybeAdvanceSeq();
     CheckMemtableFull();
     return ret_status;
@@ -1815,6 +2106,22 @@ class MemTableInserter : public WriteBatch::Handler {
     return PutCFImpl(column_family_id, key, value, kTypeBlobIndex);
   }
 
+  // Drops the key written from the hot key cache of the column family, once
+  // the write is in the memtable.
+  void InvalidateHotKey(const Slice& key) {
+    ColumnFamilyData* cfd = cf_mems_->current();
+    if (cfd != nullptr && cfd->hot_key_cache() != nullptr) {
+      cfd->hot_key_cache()->Invalidate(key, sequence_);
+    }
+  }
+
+  void InvalidateHotKeys() {
+    ColumnFamilyData* cfd = cf_mems_->current();
+    if (cfd != nullptr && cfd->hot_key_cache() != nullptr) {
+      cfd->hot_key_cache()->InvalidateAll(sequence_);
+    }
+  }
+
   void CheckMemtableFull() {
     if (flush_scheduler_ != nullptr) {
       auto* cfd = cf_mems_->current();
@@ -2032,7 +2339,8 @@ Status WriteBatchInternal::InsertInto(
     }
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
-    w->status = w->batch->Iterate(&inserter);
+    w->status = w->memtable_insert_sorted ? inserter.InsertSorted(w->batch)
+                                          : w->batch->Iterate(&inserter);
     if (!w->status.ok()) {
       return w->status;
     }
@@ -2060,7 +2368,9 @@ Status WriteBatchInternal::InsertInto(
       batch_per_txn, hint_per_batch);
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
-  Status s = writer->batch->Iterate(&inserter);
+  Status s = writer->memtable_insert_sorted
+                 ? inserter.InsertSorted(writer->batch)
+                 : writer->batch->Iterate(&inserter);
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -2094,6 +2404,8 @@ Status WriteBatchInternal::InsertInto(
 Status WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   assert(contents.size() >= WriteBatchInternal::kHeader);
   b->rep_.assign(contents.data(), contents.size());
+  b->pinned_values_.clear();
+  b->pinned_bytes_ = 0;
   b->content_flags_.store(ContentFlags::DEFERRED, std::memory_order_relaxed);
   return Status::OK();
 }
@@ -2111,20 +2423,92 @@ Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
     src_count = batch_end.count;
     src_flags = batch_end.content_flags;
   } else {
-    src_len = src->rep_.size() - WriteBatchInternal::kHeader;
+    src_len = src->GetDataSize() - WriteBatchInternal::kHeader;
     src_count = Count(src);
     src_flags = src->content_flags_.load(std::memory_order_relaxed);
   }
 
   SetCount(dst, Count(dst) + src_count);
   assert(src->rep_.size() >= WriteBatchInternal::kHeader);
-  dst->rep_.append(src->rep_.data() + WriteBatchInternal::kHeader, src_len);
+  if (src->pinned_values_.empty()) {
+    dst->rep_.append(src->rep_.data() + WriteBatchInternal::kHeader, src_len);
+  } else {
+    // Copy the pinned values of src straight into dst, leaving src as is.
+    std::vector<Slice> parts;
+    AppendDataReferences(src, WriteBatchInternal::kHeader, src_len, &parts);
+    dst->rep_.reserve(dst->rep_.size() + src_len);
+    for (const auto& part : parts) {
+      dst->rep_.append(part.data(), part.size());
+    }
+  }
   dst->content_flags_.store(
       dst->content_flags_.load(std::memory_order_relaxed) | src_flags,
       std::memory_order_relaxed);
   return Status::OK();
 }
 
+void WriteBatchInternal::AppendReference(WriteBatch* dst, const WriteBatch* src,
+                                         std::vector<Slice>* records) {
+  size_t src_len;
+  int src_count;
+  uint32_t src_flags;
+
+  const SavePoint& batch_end = src->GetWalTerminationPoint();
+
+  if (!batch_end.is_cleared()) {
+    src_len = batch_end.size - WriteBatchInternal::kHeader;
+    src_count = batch_end.count;
+    src_flags = batch_end.content_flags;
+  } else {
+    src_len = src->GetDataSize() - WriteBatchInternal::kHeader;
+    src_count = Count(src);
+    src_flags = src->content_flags_.load(std::memory_order_relaxed);
+  }
+
+  SetCount(dst, Count(dst) + src_count);
+  assert(src->rep_.size() >= WriteBatchInternal::kHeader);
+  AppendDataReferences(src, WriteBatchInternal::kHeader, src_len, records);
+  dst->content_flags_.store(
+      dst->content_flags_.load(std::memory_order_relaxed) | src_flags,
+      std::memory_order_relaxed);
+}
+
+void WriteBatchInternal::ContentsReference(const WriteBatch* batch,
+                                           std::vector<Slice>* parts) {
+  AppendDataReferences(batch, 0, batch->GetDataSize(), parts);
+}
+
+void WriteBatchInternal::AppendDataReferences(const WriteBatch* b,
+                                              size_t begin, size_t len,
+                                              std::vector<Slice>* parts) {
+  // Nothing is pinned before the first record.
+  assert(begin <= WriteBatchInternal::kHeader);
+  size_t pos = begin;
+  for (const auto& pinned : b->pinned_values_) {
+    if (len == 0) {
+      break;
+    }
+    size_t n = std::min(pinned.value_offset - pos, len);
+    if (n > 0) {
+      parts->emplace_back(b->rep_.data() + pos, n);
+      pos += n;
+      len -= n;
+    }
+    if (len == 0) {
+      break;
+    }
+    n = std::min(pinned.value.size(), len);
+    if (n > 0) {
+      parts->emplace_back(pinned.value.data(), n);
+      len -= n;
+    }
+  }
+  if (len > 0) {
+    assert(pos + len <= b->rep_.size());
+    parts->emplace_back(b->rep_.data() + pos, len);
+  }
+}
+
 size_t WriteBatchInternal::AppendedByteSize(size_t leftByteSize,
                                             size_t rightByteSize) {
   if (leftByteSize == 0 || rightByteSize == 0) {
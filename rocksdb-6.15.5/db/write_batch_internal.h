@@ -76,6 +76,9 @@ class WriteBatchInternal {
   static Status Put(WriteBatch* batch, uint32_t column_family_id,
                     const SliceParts& key, const SliceParts& value);
 
+  static Status PutPinnedValue(WriteBatch* batch, uint32_t column_family_id,
+                               const Slice& key, const Slice& value);
+
   static Status Delete(WriteBatch* batch, uint32_t column_family_id,
                        const SliceParts& key);
 
@@ -131,12 +134,14 @@ class WriteBatchInternal {
   // This offset is only valid if the batch is not empty.
   static size_t GetFirstOffset(WriteBatch* batch);
 
+  // REQUIRES: batch has no pinned values, see MaterializePinnedValues().
   static Slice Contents(const WriteBatch* batch) {
+    assert(!HasPinnedValues(batch));
     return Slice(batch->rep_);
   }
 
   static size_t ByteSize(const WriteBatch* batch) {
-    return batch->rep_.size();
+    return batch->GetDataSize();
   }
 
   static Status SetContents(WriteBatch* batch, const Slice& contents);
@@ -194,6 +199,29 @@ class WriteBatchInternal {
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
 
+  // Accounts for the count and content flags of src in dst like
+  // Append(dst, src, /*wal_only*/ true), but instead of copying the records of
+  // src into dst appends slices referencing them to *records. The contents of
+  // dst followed by every such slice, in order, form the appended batch.
+  // REQUIRES: src is not modified or destroyed while *records is in use.
+  static void AppendReference(WriteBatch* dst, const WriteBatch* src,
+                              std::vector<Slice>* records);
+
+  // Appends to *parts slices that, concatenated, form Contents(batch), without
+  // copying the values pinned with PutPinnedValue() into the batch.
+  // REQUIRES: batch is not modified or destroyed while *parts is in use.
+  static void ContentsReference(const WriteBatch* batch,
+                                std::vector<Slice>* parts);
+
+  static bool HasPinnedValues(const WriteBatch* batch) {
+    return !batch->pinned_values_.empty();
+  }
+
+  // Copies the values pinned with PutPinnedValue() into the batch.
+  static void MaterializePinnedValues(WriteBatch* batch) {
+    batch->MaterializePinnedValues();
+  }
+
   // Returns the byte size of appending a WriteBatch with ByteSize
   // leftByteSize and a WriteBatch with ByteSize rightByteSize
   static size_t AppendedByteSize(size_t leftByteSize, size_t rightByteSize);
@@ -206,6 +234,12 @@ class WriteBatchInternal {
   // state meant to be used only during recovery.
   static void SetAsLastestPersistentState(WriteBatch* b);
   static bool IsLatestPersistentState(const WriteBatch* b);
+
+ private:
+  // Appends to *parts slices referencing the len bytes of b starting at
+  // begin, which is at most kHeader.
+  static void AppendDataReferences(const WriteBatch* b, size_t begin,
+                                   size_t len, std::vector<Slice>* parts);
 };
 
 // LocalSavePoint is similar to a scope guard
@@ -229,7 +263,8 @@ class LocalSavePoint {
 #ifndef NDEBUG
     committed_ = true;
 #endif
-    if (batch_->max_bytes_ && batch_->rep_.size() > batch_->max_bytes_) {
+    if (batch_->max_bytes_ && batch_->GetDataSize() > batch_->max_bytes_) {
+      batch_->MaterializePinnedValues();
       batch_->rep_.resize(savepoint_.size);
       WriteBatchInternal::SetCount(batch_, savepoint_.count);
       batch_->content_flags_.store(savepoint_.content_flags,
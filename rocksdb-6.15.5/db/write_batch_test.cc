@@ -603,6 +603,138 @@ TEST_F(WriteBatchTest, PutGatherSlices) {
   ASSERT_EQ(3u, batch.Count());
 }
 
+TEST_F(WriteBatchTest, PutPinnedValue) {
+  std::string v1 = "pinned1";
+  std::string v2 = "pinned2";
+  WriteBatch batch;
+  WriteBatch expected;
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(expected.Put("foo", "bar"));
+  ASSERT_OK(batch.PutPinnedValue("k1", v1));
+  ASSERT_OK(expected.Put("k1", v1));
+  batch.SetSavePoint();
+  expected.SetSavePoint();
+  ASSERT_OK(batch.PutPinnedValue("k2", v2));
+  ASSERT_OK(expected.Put("k2", v2));
+  batch.MarkWalTerminationPoint();
+  expected.MarkWalTerminationPoint();
+  ASSERT_OK(batch.Delete("box"));
+  ASSERT_OK(expected.Delete("box"));
+  ASSERT_EQ(expected.GetDataSize(), batch.GetDataSize());
+  ASSERT_EQ(expected.GetWalTerminationPoint().size,
+            batch.GetWalTerminationPoint().size);
+  ASSERT_EQ(4u, batch.Count());
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+
+  // The WAL record is gathered from the batch and the pinned values.
+  std::vector<Slice> parts;
+  WriteBatchInternal::ContentsReference(&batch, &parts);
+  std::string gathered;
+  for (const auto& part : parts) {
+    gathered.append(part.data(), part.size());
+  }
+  ASSERT_EQ(WriteBatchInternal::Contents(&expected).ToString(), gathered);
+
+  // The records up to the WAL termination point.
+  WriteBatch wal_batch;
+  parts.clear();
+  WriteBatchInternal::AppendReference(&wal_batch, &batch, &parts);
+  gathered = WriteBatchInternal::Contents(&wal_batch).ToString();
+  for (const auto& part : parts) {
+    gathered.append(part.data(), part.size());
+  }
+  ASSERT_EQ(3u, wal_batch.Count());
+  ASSERT_OK(WriteBatchInternal::SetContents(&wal_batch, gathered));
+  ASSERT_EQ(
+      "Put(foo, bar)@0"
+      "Put(k1, pinned1)@1"
+      "Put(k2, pinned2)@2",
+      PrintContents(&wal_batch));
+
+  WriteBatchInternal::SetSequence(&batch, 100);
+  ASSERT_EQ(
+      "Delete(box)@103"
+      "Put(foo, bar)@100"
+      "Put(k1, pinned1)@101"
+      "Put(k2, pinned2)@102",
+      PrintContents(&batch));
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+
+  // Reading a const batch leaves the pinned values in place.
+  const WriteBatch& const_batch = batch;
+  const size_t wal_end = const_batch.GetWalTerminationPoint().size;
+  TestHandler handler;
+  ASSERT_OK(WriteBatchInternal::Iterate(&const_batch, &handler, wal_end,
+                                        const_batch.GetDataSize()));
+  ASSERT_EQ("Delete(box)", handler.seen);
+  handler.seen.clear();
+  ASSERT_OK(WriteBatchInternal::Iterate(
+      &const_batch, &handler, WriteBatchInternal::kHeader, wal_end));
+  ASSERT_EQ("Put(foo, bar)Put(k1, pinned1)Put(k2, pinned2)", handler.seen);
+  WriteBatch appended;
+  ASSERT_OK(WriteBatchInternal::Append(&appended, &const_batch,
+                                       /*wal_only*/ true));
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&appended));
+  ASSERT_EQ(
+      "Put(foo, bar)@0"
+      "Put(k1, pinned1)@1"
+      "Put(k2, pinned2)@2",
+      PrintContents(&appended));
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+
+  // A copy owns its values.
+  WriteBatch copy(batch);
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&copy));
+  ASSERT_OK(batch.RollbackToSavePoint());
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+  v1.assign("changed");
+  v2.assign("changed");
+  ASSERT_EQ(
+      "Put(foo, bar)@100"
+      "Put(k1, pinned1)@101",
+      PrintContents(&batch));
+  ASSERT_EQ(
+      "Delete(box)@103"
+      "Put(foo, bar)@100"
+      "Put(k1, pinned1)@101"
+      "Put(k2, pinned2)@102",
+      PrintContents(&copy));
+}
+
+TEST_F(WriteBatchTest, PutPinnedEmptyValue) {
+  std::string v = "pinned";
+  WriteBatch batch;
+  WriteBatch expected;
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(expected.Put("foo", "bar"));
+  ASSERT_OK(batch.PutPinnedValue("k1", ""));
+  ASSERT_OK(expected.Put("k1", ""));
+  batch.MarkWalTerminationPoint();
+  expected.MarkWalTerminationPoint();
+  ASSERT_OK(batch.PutPinnedValue("k2", v));
+  ASSERT_OK(expected.Put("k2", v));
+  ASSERT_OK(batch.Delete("box"));
+  ASSERT_OK(expected.Delete("box"));
+
+  // The empty pinned value ends right at the WAL termination point, and is
+  // before it.
+  const WriteBatch& const_batch = batch;
+  const size_t wal_end = const_batch.GetWalTerminationPoint().size;
+  TestHandler handler;
+  ASSERT_OK(WriteBatchInternal::Iterate(&const_batch, &handler, wal_end,
+                                        const_batch.GetDataSize()));
+  ASSERT_EQ("Put(k2, pinned)Delete(box)", handler.seen);
+  handler.seen.clear();
+  ASSERT_OK(WriteBatchInternal::Iterate(
+      &const_batch, &handler, WriteBatchInternal::kHeader, wal_end));
+  ASSERT_EQ("Put(foo, bar)Put(k1, )", handler.seen);
+
+  // Data() of a const batch copies the pinned values in.
+  ASSERT_TRUE(WriteBatchInternal::HasPinnedValues(&batch));
+  ASSERT_EQ(expected.Data(), const_batch.Data());
+  ASSERT_FALSE(WriteBatchInternal::HasPinnedValues(&batch));
+}
+
 namespace {
 class ColumnFamilyHandleImplDummy : public ColumnFamilyHandleImpl {
  public:
@@ -878,6 +1010,15 @@ TEST_F(WriteBatchTest, MemoryLimitTest) {
   ASSERT_OK(batch.Put("b", "...."));
   s = batch.Put("c", "....");
   ASSERT_TRUE(s.IsMemoryLimit());
+
+  // Pinned values count towards the limit.
+  WriteBatch pinned_batch(0, 28);
+  ASSERT_OK(pinned_batch.PutPinnedValue("a", "...."));
+  ASSERT_OK(pinned_batch.Put("b", "...."));
+  s = pinned_batch.PutPinnedValue("c", "....");
+  ASSERT_TRUE(s.IsMemoryLimit());
+  ASSERT_EQ(28u, pinned_batch.GetDataSize());
+  ASSERT_EQ(2u, pinned_batch.Count());
 }
 
 }  // namespace ROCKSDB_NAMESPACE
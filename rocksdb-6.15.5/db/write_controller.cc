@@ -5,6 +5,7 @@
 
 #include "db/write_controller.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <ratio>
@@ -27,6 +28,18 @@ std::unique_ptr<WriteControllerToken> WriteController::GetDelayToken(
   return std::unique_ptr<WriteControllerToken>(new DelayWriteToken(this));
 }
 
+std::unique_ptr<WriteControllerToken> WriteController::GetSmoothDelayToken(
+    double pressure) {
+  total_delayed_++;
+  // Reset counters.
+  last_refill_time_ = 0;
+  bytes_left_ = 0;
+  smooth_delay_pressures_.insert(pressure);
+  UpdateSmoothDelayedWriteRate();
+  return std::unique_ptr<WriteControllerToken>(
+      new SmoothDelayWriteToken(this, pressure));
+}
+
 std::unique_ptr<WriteControllerToken>
 WriteController::GetCompactionPressureToken() {
   ++total_compaction_pressure_;
@@ -106,6 +119,79 @@ uint64_t WriteController::GetDelay(Env* env, uint64_t num_bytes) {
   return sleep_amount;
 }
 
+constexpr uint64_t WriteController::kSustainableRateWindowMicros;
+constexpr uint64_t WriteController::kMinSmoothWriteRate;
+
+void WriteController::UpdateSustainableWriteRate(
+    Env* env, uint64_t flushed_bytes, uint64_t compaction_bytes,
+    int64_t compaction_debt_growth) {
+  auto time_now = NowMicrosMonotonic(env);
+  if (sample_start_time_ == 0 || sample_start_time_ > time_now) {
+    sample_start_time_ = time_now;
+    sample_flushed_bytes_ = 0;
+    sample_compaction_bytes_ = 0;
+    sample_debt_growth_ = 0;
+    return;
+  }
+  sample_flushed_bytes_ += flushed_bytes;
+  sample_compaction_bytes_ += compaction_bytes;
+  sample_debt_growth_ += compaction_debt_growth;
+  const uint64_t elapsed = time_now - sample_start_time_;
+  if (elapsed < kSustainableRateWindowMicros) {
+    return;
+  }
+
+  // Without flushes there is no ingest to measure, e.g. the DB is idle.
+  if (sample_flushed_bytes_ > 0) {
+    // Flushes drain the memtables at the rate data is ingested. The part of
+    // it that is sustainable is what compaction retires: if the compaction
+    // debt grew by as much as compaction wrote, only half of the ingest was
+    // sustainable; if it shrank, more would have been. The ratio is bounded
+    // to [1/2, 2] so a single sample can't swing the estimate too far.
+    const double flush_rate = static_cast<double>(sample_flushed_bytes_) *
+                              1000000 / static_cast<double>(elapsed);
+    const double written = static_cast<double>(sample_compaction_bytes_);
+    // The compaction work the ingest added.
+    const double debt_added =
+        written + static_cast<double>(sample_debt_growth_);
+    double ratio = 1.0;
+    if (sample_compaction_bytes_ > 0 || sample_debt_growth_ != 0) {
+      ratio = debt_added > 0 ? written / debt_added : 2.0;
+    }
+    ratio = std::max(0.5, std::min(ratio, 2.0));
+    const double sample = flush_rate * ratio;
+    if (sustainable_write_rate_ == 0) {
+      sustainable_write_rate_ = static_cast<uint64_t>(sample);
+    } else {
+      // Exponentially weighted moving average, weighting the new sample 1/4.
+      sustainable_write_rate_ = static_cast<uint64_t>(
+          (static_cast<double>(sustainable_write_rate_) * 3 + sample) / 4);
+    }
+  }
+  sample_start_time_ = time_now;
+  sample_flushed_bytes_ = 0;
+  sample_compaction_bytes_ = 0;
+  sample_debt_growth_ = 0;
+}
+
+uint64_t WriteController::GetSmoothDelayedWriteRate(double pressure) const {
+  uint64_t base_rate = sustainable_write_rate_ > 0 ? sustainable_write_rate_
+                                                   : max_delayed_write_rate_;
+  pressure = std::max(0.0, std::min(pressure, 1.0));
+  uint64_t write_rate =
+      static_cast<uint64_t>(static_cast<double>(base_rate) * (1.0 - pressure));
+  // If the user gives a rate less than the minimum, don't go above it.
+  return std::min(std::max(write_rate, kMinSmoothWriteRate),
+                  max_delayed_write_rate_);
+}
+
+void WriteController::UpdateSmoothDelayedWriteRate() {
+  if (!smooth_delay_pressures_.empty()) {
+    set_delayed_write_rate(
+        GetSmoothDelayedWriteRate(*smooth_delay_pressures_.rbegin()));
+  }
+}
+
 uint64_t WriteController::NowMicrosMonotonic(Env* env) {
   return env->NowNanos() / std::milli::den;
 }
@@ -120,6 +206,14 @@ DelayWriteToken::~DelayWriteToken() {
   assert(controller_->total_delayed_.load() >= 0);
 }
 
+SmoothDelayWriteToken::~SmoothDelayWriteToken() {
+  auto& pressures = controller_->smooth_delay_pressures_;
+  auto it = pressures.find(pressure_);
+  assert(it != pressures.end());
+  pressures.erase(it);
+  controller_->UpdateSmoothDelayedWriteRate();
+}
+
 CompactionPressureToken::~CompactionPressureToken() {
   controller_->total_compaction_pressure_--;
   assert(controller_->total_compaction_pressure_ >= 0);
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <memory>
+#include <set>
 #include "rocksdb/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -29,6 +30,12 @@ class WriteController {
         total_compaction_pressure_(0),
         bytes_left_(0),
         last_refill_time_(0),
+        smooth_throttling_(false),
+        sample_start_time_(0),
+        sample_flushed_bytes_(0),
+        sample_compaction_bytes_(0),
+        sample_debt_growth_(0),
+        sustainable_write_rate_(0),
         low_pri_rate_limiter_(
             NewGenericRateLimiter(low_pri_rate_bytes_per_sec)) {
     set_max_delayed_write_rate(_delayed_write_rate);
@@ -82,14 +89,54 @@ class WriteController {
 
   uint64_t max_delayed_write_rate() const { return max_delayed_write_rate_; }
 
+  // In smooth throttling mode, writes are paced at a rate derived from the
+  // measured background throughput instead of being stepped down and up on
+  // every change of the write stall condition. See
+  // DBOptions::smooth_write_throttling.
+  void set_smooth_throttling(bool smooth) { smooth_throttling_ = smooth; }
+  bool smooth_throttling() const { return smooth_throttling_; }
+
+  // Feeds the background work a column family did since its previous call:
+  // bytes written by flushes and by compactions, and the change of its
+  // estimated pending compaction bytes. Once the samples span
+  // kSustainableRateWindowMicros, the ingest rate that the background work
+  // sustained over them updates sustainable_write_rate().
+  void UpdateSustainableWriteRate(Env* env, uint64_t flushed_bytes,
+                                  uint64_t compaction_bytes,
+                                  int64_t compaction_debt_growth);
+
+  // The estimated ingest rate the background work can keep up with, in bytes
+  // per second. 0 until there is an estimate.
+  uint64_t sustainable_write_rate() const { return sustainable_write_rate_; }
+
+  // The rate to pace writes at for the given write pressure, which goes from
+  // 0 when a slowdown trigger is reached to 1 when a stop trigger is reached:
+  // the sustainable write rate scaled down linearly with the pressure, within
+  // [kMinSmoothWriteRate, max_delayed_write_rate()].
+  uint64_t GetSmoothDelayedWriteRate(double pressure) const;
+
+  // In smooth throttling mode, an actor (column family) that needs writes to
+  // be paced requests a delay token for its write pressure. Writes are paced
+  // at GetSmoothDelayedWriteRate() of the highest pressure of all such tokens,
+  // regardless of which actor requested a token last.
+  std::unique_ptr<WriteControllerToken> GetSmoothDelayToken(double pressure);
+
+  static constexpr uint64_t kSustainableRateWindowMicros = 1000000;
+  static constexpr uint64_t kMinSmoothWriteRate = 16 * 1024;
+
   RateLimiter* low_pri_rate_limiter() { return low_pri_rate_limiter_.get(); }
 
  private:
   uint64_t NowMicrosMonotonic(Env* env);
 
+  // Sets the delayed write rate for the highest pressure of the smooth delay
+  // tokens, if there are any.
+  void UpdateSmoothDelayedWriteRate();
+
   friend class WriteControllerToken;
   friend class StopWriteToken;
   friend class DelayWriteToken;
+  friend class SmoothDelayWriteToken;
   friend class CompactionPressureToken;
 
   std::atomic<int> total_stopped_;
@@ -102,6 +149,16 @@ class WriteController {
   // current write rate
   uint64_t delayed_write_rate_;
 
+  bool smooth_throttling_;
+  // Background work sampled since sample_start_time_.
+  uint64_t sample_start_time_;
+  uint64_t sample_flushed_bytes_;
+  uint64_t sample_compaction_bytes_;
+  int64_t sample_debt_growth_;
+  uint64_t sustainable_write_rate_;
+  // Write pressures of the smooth delay tokens.
+  std::multiset<double> smooth_delay_pressures_;
+
   std::unique_ptr<RateLimiter> low_pri_rate_limiter_;
 };
 
@@ -134,6 +191,16 @@ class DelayWriteToken : public WriteControllerToken {
   virtual ~DelayWriteToken();
 };
 
+class SmoothDelayWriteToken : public DelayWriteToken {
+ public:
+  SmoothDelayWriteToken(WriteController* controller, double pressure)
+      : DelayWriteToken(controller), pressure_(pressure) {}
+  virtual ~SmoothDelayWriteToken();
+
+ private:
+  const double pressure_;
+};
+
 class CompactionPressureToken : public WriteControllerToken {
  public:
   explicit CompactionPressureToken(WriteController* controller)
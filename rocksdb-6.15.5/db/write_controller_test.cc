@@ -127,6 +127,47 @@ TEST_F(WriteControllerTest, SanityTest) {
   ASSERT_FALSE(controller.IsStopped());
 }
 
+TEST_F(WriteControllerTest, SustainableWriteRateTest) {
+  TimeSetEnv env;
+  WriteController controller(40000000u);
+  controller.set_smooth_throttling(true);
+  ASSERT_EQ(0u, controller.sustainable_write_rate());
+  // Without an estimate, the maximum rate is scaled down.
+  ASSERT_EQ(20000000u, controller.GetSmoothDelayedWriteRate(0.5));
+
+  // The first sample starts the window.
+  controller.UpdateSustainableWriteRate(&env, 5000000u, 5000000u, 0);
+  env.now_micros_ += 500000u;
+  controller.UpdateSustainableWriteRate(&env, 5000000u, 10000000u, 0);
+  ASSERT_EQ(0u, controller.sustainable_write_rate());
+  env.now_micros_ += 500000u;
+  // 10MB flushed in a second and the compaction debt is steady.
+  controller.UpdateSustainableWriteRate(&env, 5000000u, 10000000u, 0);
+  ASSERT_EQ(10000000u, controller.sustainable_write_rate());
+
+  // The compaction debt grew by as much as compaction wrote: half of the
+  // 10MB/s was sustainable.
+  env.now_micros_ += 1000000u;
+  controller.UpdateSustainableWriteRate(&env, 10000000u, 20000000u, 20000000);
+  ASSERT_EQ(8750000u, controller.sustainable_write_rate());
+
+  // No flushes, no sample.
+  env.now_micros_ += 1000000u;
+  controller.UpdateSustainableWriteRate(&env, 0, 0, 0);
+  ASSERT_EQ(8750000u, controller.sustainable_write_rate());
+
+  ASSERT_EQ(8750000u, controller.GetSmoothDelayedWriteRate(0));
+  ASSERT_EQ(4375000u, controller.GetSmoothDelayedWriteRate(0.5));
+  ASSERT_EQ(WriteController::kMinSmoothWriteRate,
+            controller.GetSmoothDelayedWriteRate(1));
+  ASSERT_EQ(WriteController::kMinSmoothWriteRate,
+            controller.GetSmoothDelayedWriteRate(2));
+
+  // Never faster than the maximum rate.
+  controller.set_max_delayed_write_rate(1000000u);
+  ASSERT_EQ(1000000u, controller.GetSmoothDelayedWriteRate(0.5));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
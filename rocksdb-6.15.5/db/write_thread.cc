@@ -14,6 +14,10 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+constexpr int32_t WriteThread::kMinAwaitSpins;
+constexpr int32_t WriteThread::kMaxAwaitSpins;
+constexpr int32_t WriteThread::kInitialAwaitSpinAverage;
+
 WriteThread::WriteThread(const ImmutableDBOptions& db_options)
     : max_yield_usec_(db_options.enable_write_thread_adaptive_yield
                           ? db_options.write_thread_max_yield_usec
@@ -44,6 +48,8 @@ uint8_t WriteThread::BlockingAwaitState(Writer* w, uint8_t goal_mask) {
   if ((state & goal_mask) == 0 &&
       w->state.compare_exchange_strong(state, STATE_LOCKED_WAITING)) {
     // we have permission (and an obligation) to use StateMutex
+    PERF_TIMER_GUARD(write_thread_block_nanos);
+    PERF_COUNTER_ADD(write_thread_block_count, 1);
     std::unique_lock<std::mutex> guard(w->StateMutex());
     w->StateCV().wait(guard, [w] {
       return w->state.load(std::memory_order_relaxed) != STATE_LOCKED_WAITING;
@@ -63,7 +69,7 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
                                 AdaptationContext* ctx) {
   uint8_t state = 0;
 
-  // 1. Busy loop using "pause" for 1 micro sec
+  // 1. Busy loop using "pause" for about 1 micro sec (adaptive)
   // 2. Else SOMETIMES busy loop using "yield" for 100 micro sec (default)
   // 3. Else blocking wait
 
@@ -71,13 +77,24 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
   // is the effect of the pause instruction), so 200 iterations is a bit
   // more than a microsecond.  This is long enough that waits longer than
   // this can amortize the cost of accessing the clock and yielding.
-  for (uint32_t tries = 0; tries < 200; ++tries) {
+  //
+  // With adaptive yield the number of iterations follows how long waits in
+  // ctx recently took, so that threads don't burn CPU spinning through
+  // waits that end up yielding or blocking anyway, e.g. when the host is
+  // oversubscribed and the thread that would wake us is not running.
+  const int32_t max_spins = AwaitSpinLimit(ctx);
+  for (int32_t tries = 0; tries < max_spins; ++tries) {
     state = w->state.load(std::memory_order_acquire);
     if ((state & goal_mask) != 0) {
+      if (tries > 0) {
+        PERF_COUNTER_ADD(write_thread_spin_count, 1);
+        UpdateAwaitSpinAverage(ctx, tries);
+      }
       return state;
     }
     port::AsmVolatilePause();
   }
+  UpdateAwaitSpinAverage(ctx, -1);
 
   // This is below the fast path, so that the stat is zero when all writes are
   // from the same thread.
@@ -161,6 +178,7 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
         if ((state & goal_mask) != 0) {
           // success
           would_spin_again = true;
+          PERF_COUNTER_ADD(write_thread_yield_count, 1);
           break;
         }
 
@@ -207,6 +225,37 @@ uint8_t WriteThread::AwaitState(Writer* w, uint8_t goal_mask,
   return state;
 }
 
+int32_t WriteThread::AwaitSpinLimit(AdaptationContext* ctx) const {
+  if (max_yield_usec_ == 0) {
+    return 200;
+  }
+  int32_t limit =
+      kMinAwaitSpins + 2 * ctx->spin_average.load(std::memory_order_relaxed);
+  return limit < kMaxAwaitSpins ? limit : kMaxAwaitSpins;
+}
+
+void WriteThread::UpdateAwaitSpinAverage(AdaptationContext* ctx,
+                                         int32_t spins) const {
+  // Like the yield credit, the average is shared by all writers waiting in
+  // ctx, so it is only updated on a sample of the waits and lost updates
+  // from racing threads are fine.
+  const int sampling_base = 16;
+  if (max_yield_usec_ == 0 ||
+      !Random::GetTLSInstance()->OneIn(sampling_base)) {
+    return;
+  }
+  auto v = ctx->spin_average.load(std::memory_order_relaxed);
+  if (spins >= 0) {
+    // exponential moving average with weight 1/8 for the new sample
+    v += (spins - v) / 8;
+  } else {
+    // The spin was too short. Decay the average, since waits in ctx are
+    // mostly long enough to be better spent yielding or blocking.
+    v -= v / 8;
+  }
+  ctx->spin_average.store(v, std::memory_order_relaxed);
+}
+
 void WriteThread::SetState(Writer* w, uint8_t new_state) {
   auto state = w->state.load(std::memory_order_acquire);
   if (state == STATE_LOCKED_WAITING ||
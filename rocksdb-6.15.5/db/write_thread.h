@@ -118,6 +118,7 @@ class WriteThread {
     bool no_slowdown;
     bool disable_wal;
     bool disable_memtable;
+    bool memtable_insert_sorted;
     size_t batch_cnt;  // if non-zero, number of sub-batches in the write batch
     PreReleaseCallback* pre_release_callback;
     uint64_t log_used;  // log number that this batch was inserted into
@@ -141,6 +142,7 @@ class WriteThread {
           no_slowdown(false),
           disable_wal(false),
           disable_memtable(false),
+          memtable_insert_sorted(false),
           batch_cnt(0),
           pre_release_callback(nullptr),
           log_used(0),
@@ -162,6 +164,7 @@ class WriteThread {
           no_slowdown(write_options.no_slowdown),
           disable_wal(write_options.disableWAL),
           disable_memtable(_disable_memtable),
+          memtable_insert_sorted(write_options.memtable_insert_sorted),
           batch_cnt(_batch_cnt),
           pre_release_callback(_pre_release_callback),
           log_used(0),
@@ -247,11 +250,24 @@ class WriteThread {
     }
   };
 
+  // Bounds and initial value of the busy spin of AwaitState() when
+  // enable_write_thread_adaptive_yield is set. The spin lasts for
+  // kMinAwaitSpins plus twice the recent average number of spins that
+  // satisfied a wait, so it shrinks when waits are usually too long to spin
+  // through and grows back when short spins succeed.
+  static constexpr int32_t kMinAwaitSpins = 16;
+  static constexpr int32_t kMaxAwaitSpins = 400;
+  static constexpr int32_t kInitialAwaitSpinAverage = 92;
+
   struct AdaptationContext {
     const char* name;
     std::atomic<int32_t> value;
+    // Moving average of the number of spins after which waits in this
+    // context were satisfied.
+    std::atomic<int32_t> spin_average;
 
-    explicit AdaptationContext(const char* name0) : name(name0), value(0) {}
+    explicit AdaptationContext(const char* name0)
+        : name(name0), value(0), spin_average(kInitialAwaitSpinAverage) {}
   };
 
   explicit WriteThread(const ImmutableDBOptions& db_options);
@@ -400,6 +416,14 @@ class WriteThread {
   // a context-dependent static.
   uint8_t AwaitState(Writer* w, uint8_t goal_mask, AdaptationContext* ctx);
 
+  // Returns the number of busy spins AwaitState() does in ctx before it
+  // yields or blocks.
+  int32_t AwaitSpinLimit(AdaptationContext* ctx) const;
+
+  // Samples the outcome of a busy spin of AwaitState() in ctx: a wait that
+  // was satisfied after spins iterations, or one that was not (spins < 0).
+  void UpdateAwaitSpinAverage(AdaptationContext* ctx, int32_t spins) const;
+
   // Set writer state and wake the writer up if it is waiting.
   void SetState(Writer* w, uint8_t new_state);
 
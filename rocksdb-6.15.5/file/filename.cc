@@ -239,6 +239,10 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string BlockCacheWarmupFileName(const std::string& dbname) {
+  return dbname + "/BLOCK_CACHE_WARMUP";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
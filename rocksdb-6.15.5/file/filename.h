@@ -144,6 +144,10 @@ extern std::string MetaDatabaseName(const std::string& dbname,
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string& dbname);
 
+// Return the name of the file that lists the blocks to load into the block
+// cache when the db is opened, see DBOptions::block_cache_warmup_period_sec.
+extern std::string BlockCacheWarmupFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
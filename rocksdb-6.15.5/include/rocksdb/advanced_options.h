@@ -314,6 +314,31 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool memtable_whole_key_filtering = false;
 
+  // If not 0, each memtable keeps this many hash buckets over user keys, each
+  // recording the smallest sequence number written to a key hashing to it.
+  // A point lookup at a snapshot older than that sequence number has no
+  // visible version in the memtable and returns without searching it. This
+  // helps reads at old snapshots, for example in long-running transactions,
+  // of keys that are rewritten many times. Each bucket costs 8 bytes of
+  // memtable memory.
+  //
+  // Default: 0 (disable)
+  //
+  // Dynamically changeable through SetOptions() API
+  size_t memtable_seqno_filter_bucket_count = 0;
+
+  // The share of the memory of a WriteBufferManager created with
+  // flush_by_weighted_size that this column family is expected to use,
+  // relative to the other column families of the DB. When the write buffer
+  // manager asks for a flush, the column family whose active memtable uses
+  // the most memory per unit of weight, i.e. the one most over its quota,
+  // is flushed. Must be greater than 0.
+  //
+  // Default: 1.0
+  //
+  // Dynamically changeable through SetOptions() API
+  double write_buffer_weight = 1.0;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
@@ -660,6 +685,25 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool paranoid_file_checks = false;
 
+  // If greater than 1, a flush splits the key range of the memtables it
+  // writes into up to this many partitions of about the same number of
+  // entries, and builds one L0 file per partition in parallel threads. This
+  // shortens flushes of large memtables, which otherwise run on a single
+  // thread, at the cost of more (smaller) L0 files; consider scaling
+  // level0_file_num_compaction_trigger and the L0 write stall triggers
+  // accordingly.
+  //
+  // The partition boundaries are picked from a sample of the keys on the upper
+  // levels of the memtable's skip list. Only used with kCompactionStyleLevel.
+  // Memtables that contain range deletions or are not skip list based, and
+  // column families with user-defined timestamps, are always flushed to a
+  // single file.
+  //
+  // Default: 1 (disable)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_flush_partitions = 1;
+
   // In debug mode, RocksDB runs consistency checks on the LSM every time the
   // LSM changes (Flush, Compaction, AddFile). When this option is true, these
   // checks are also enabled in release mode. These checks were historically
@@ -0,0 +1,64 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// ArenaBlockPool keeps the arena blocks of freed memtables for reuse by new
+// memtables of one or more DBs.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ArenaBlockPool {
+ public:
+  // Blocks released by memtables are kept until the pool holds `capacity`
+  // bytes of free blocks; further blocks are freed. The free blocks are
+  // sharded by the core of the thread that released them, and a block is
+  // preferably reused on the same core.
+  explicit ArenaBlockPool(size_t capacity);
+  // No copying allowed
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  ArenaBlockPool& operator=(const ArenaBlockPool&) = delete;
+
+  ~ArenaBlockPool();
+
+  size_t capacity() const { return capacity_; }
+
+  // Returns the total size of the free blocks in the pool.
+  size_t GetPooledBytes() const {
+    return pooled_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of block allocations served from the pool.
+  size_t GetReusedBlocks() const {
+    return reused_blocks_.load(std::memory_order_relaxed);
+  }
+
+  // Returns a block of `bytes` bytes, reusing a free block of that size if
+  // the pool has one. If `huge_page` is true, the block is taken from huge
+  // pages, and nullptr is returned if none could be mapped. Otherwise,
+  // *huge_page is set to false.
+  // The block must be given back with Release().
+  char* Allocate(size_t bytes, bool* huge_page);
+
+  // Gives back a block returned by Allocate() with the same size and the
+  // *huge_page it reported.
+  void Release(char* block, size_t bytes, bool huge_page);
+
+ private:
+  struct Rep;
+
+  const size_t capacity_;
+  std::atomic<size_t> pooled_bytes_;
+  std::atomic<size_t> reused_blocks_;
+  std::unique_ptr<Rep> rep_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -23,8 +23,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
@@ -33,6 +35,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class Cache;
+class SecondaryCache;
 struct ConfigOptions;
 
 extern const bool kDefaultToAdaptiveMutex;
@@ -87,6 +90,58 @@ struct LRUCacheOptions {
   CacheMetadataChargePolicy metadata_charge_policy =
       kDefaultCacheMetadataChargePolicy;
 
+  // If true, each shard keeps a small frequency sketch of the keys looked up
+  // recently, and an insert that would evict entries is admitted only if the
+  // new key was looked up more often than the entry that would be evicted
+  // first. Otherwise the insert behaves as if the entry were evicted right
+  // away. This keeps a frequently used working set from being flushed out by
+  // blocks read only once, e.g. by a long scan with fill_cache=true.
+  bool use_admission_filter = false;
+
+  // If true, a cache hit doesn't take the shard mutex to move the entry in
+  // the LRU list. Lookups then only share a reader lock of the shard's hash
+  // table, and mark the entries they find as touched. An insert that needs
+  // to evict entries moves the touched ones at the tail of the LRU list to
+  // its head instead of evicting them, so that entries are evicted in about,
+  // but not exactly, LRU order. Releasing a handle doesn't take the mutex
+  // either, unless it frees the entry.
+  // With use_admission_filter, lookups still take the mutex to update the
+  // frequency sketch.
+  bool use_deferred_promotion = false;
+
+  // If non-nullptr, entries evicted from the cache for lack of space are
+  // moved to this secondary cache, and moved back on a lookup that misses
+  // the cache, if they were inserted with Cache::InsertWithHelper() and are
+  // looked up with Cache::LookupWithHelper(). The block based table reader
+  // does so for data, index and range deletion blocks.
+  // See also NewCompressedSecondaryCache() and NewTieredCache().
+  std::shared_ptr<SecondaryCache> secondary_cache;
+
+  // If true and the machine has more than one NUMA node, the cache has a set
+  // of 2^num_shard_bits shards per node, allocated on that node, with the
+  // capacity split evenly among all the shards. An entry is inserted in and
+  // looked up in the set of the node the calling thread runs on, so that
+  // threads only touch memory and mutexes of their own node. Only a
+  // Cache::LookupWithHelper() of a high priority entry (see
+  // Cache::Priority::HIGH) also looks in the sets of the other nodes on a
+  // miss. An insert doesn't replace the copies of the key cached by other
+  // nodes, so only use this for caches of immutable values, like the block
+  // cache. Requires RocksDB to be built with NUMA support; ignored otherwise.
+  bool numa_aware = false;
+
+  // With numa_aware, a high priority entry found in the set of another node
+  // is copied to the set of its own node, if the helper it is looked up with
+  // can save it. Index blocks hot on all nodes are then cached once per node
+  // instead of being read across nodes.
+  bool numa_replicate_high_pri_entries = false;
+
+  // If true, each shard counts its lookups, hits, inserts and evictions, and
+  // the time spent waiting for its mutex, see Cache::GetShardStats() and the
+  // "rocksdb.block-cache-stats" DB property. The counters are kept per CPU
+  // core, so that they don't add contention, and the mutex wait time is only
+  // measured when the mutex is already locked.
+  bool collect_shard_stats = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -122,10 +177,10 @@ extern std::shared_ptr<Cache> NewLRUCache(
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
+// better concurrent performance in some cases. See cache/clock_cache.cc for
 // more detail.
 //
-// Return nullptr if it is not supported.
+// Return nullptr if it is not supported (in ROCKSDB_LITE).
 extern std::shared_ptr<Cache> NewClockCache(
     size_t capacity, int num_shard_bits = -1,
     bool strict_capacity_limit = false,
@@ -167,6 +222,29 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // The function that deletes the value of an entry, see Insert().
+  using DeleterFn = void (*)(const Slice& key, void* value);
+
+  // Describes how to save a copy of a cached object, so that the cache can
+  // move it to a secondary cache when evicting it. See InsertWithHelper().
+  struct CacheItemHelper {
+    // Returns the number of bytes saveto_cb writes for obj. nullptr if the
+    // object can't be saved.
+    size_t (*size_cb)(void* obj);
+    // Writes the `size` bytes returned by size_cb to `out`.
+    Status (*saveto_cb)(void* obj, size_t size, char* out);
+    // Deletes the object, like the deleter passed to Insert().
+    void (*del_cb)(const Slice& key, void* obj);
+    // Not used by the cache. Lets the user that inserted an entry tell what
+    // kind of object it is, see ApplyToAllCacheKeys().
+    uint32_t tag;
+  };
+
+  // Creates an object from the bytes its saveto_cb wrote, and returns it in
+  // *out_obj and its charge in *charge.
+  using CreateCallback = std::function<Status(const char* buf, size_t size,
+                                              void** out_obj, size_t* charge)>;
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -199,6 +277,28 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Like Insert(), but with the deleter in helper->del_cb. A cache with a
+  // secondary cache can use helper to save a copy of the value in the
+  // secondary cache when evicting it.
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+
+  // Like Lookup(), but a cache with a secondary cache looks up a missing
+  // key there too. If found, the value is rebuilt with create_cb and
+  // inserted with helper and priority, and the key is erased from the
+  // secondary cache.
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* /*helper*/,
+                                   const CreateCallback& /*create_cb*/,
+                                   Priority /*priority*/ = Priority::LOW,
+                                   Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
@@ -279,10 +379,41 @@ class Cache {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
 
+  // Apply callback to the key, charge, priority and helper of all entries in
+  // the cache. The helper is nullptr for an entry inserted with Insert()
+  // rather than InsertWithHelper(). The callback runs with the lock of the
+  // entry's shard held, so it must be cheap and must not call back into the
+  // cache. A cache that can't enumerate its keys doesn't call the callback.
+  virtual void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Priority priority,
+                               const CacheItemHelper* helper)>& /*callback*/) {
+  }
+
   // Remove all entries.
   // Prerequisite: no entry is referenced.
   virtual void EraseUnRefEntries() = 0;
 
+  // Counters and usage of a shard of the cache, see
+  // LRUCacheOptions::collect_shard_stats.
+  struct ShardStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    // Time spent by lookups, inserts, releases and erases waiting for the
+    // shard's mutex.
+    uint64_t mutex_wait_nanos = 0;
+    size_t usage = 0;
+    size_t pinned_usage = 0;
+  };
+
+  // Appends the stats of each shard of the cache to *stats, and returns true,
+  // if the cache collects them. Otherwise returns false.
+  virtual bool GetShardStats(std::vector<ShardStats>* /*stats*/) const {
+    return false;
+  }
+
   virtual std::string GetPrintableOptions() const { return ""; }
 
   MemoryAllocator* memory_allocator() const { return memory_allocator_.get(); }
@@ -203,6 +203,20 @@ struct ConfigOptions {
 //     [Example]:
 //     * {"memtable", "vector:1024"} is equivalent to setting memtable
 //       to VectorRepFactory(1024).
+//   - VersionChainRepFactory:
+//     Pass "version_chain:<version_list_height>" to config memtable to use
+//     VersionChainRepFactory, or simply "version_chain" to use the default
+//     VersionChain memtable.
+//     [Example]:
+//     * {"memtable", "version_chain:12"} is equivalent to setting memtable
+//       to NewVersionChainRepFactory(12).
+//   - HashIndexedSkipListRepFactory:
+//     Pass "hash_index:<hash_bucket_count>" to config memtable to use
+//     HashIndexedSkipList, or simply "hash_index" to use the default
+//     HashIndexedSkipList.
+//     [Example]:
+//     * {"memtable", "hash_index:100000"} is equivalent to setting memtable
+//       to NewHashIndexedSkipListRepFactory(100000).
 //
 //  * compression_opts:
 //    Use "compression_opts" to config compression_opts.  The value format
@@ -907,6 +907,12 @@ class DB {
     //  "rocksdb.is-write-stopped" - Return 1 if write has been stopped.
     static const std::string kIsWriteStopped;
 
+    //  "rocksdb.sustainable-write-rate" - returns the ingest rate, in bytes
+    //      per second, that DBOptions::smooth_write_throttling estimates
+    //      flushes and compactions can keep up with. Delayed writes are paced
+    //      at up to this rate. 0 if there is no estimate.
+    static const std::string kSustainableWriteRate;
+
     //  "rocksdb.estimate-oldest-key-time" - returns an estimation of
     //      oldest key timestamp in the DB. Currently only available for
     //      FIFO compaction with
@@ -927,6 +933,18 @@ class DB {
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    //  "rocksdb.block-cache-stats" - returns a map with the block cache's
+    //      "capacity", "usage" and "pinned-usage"; per shard
+    //      "shard.<i>.{lookups,hits,inserts,evictions,mutex-wait-nanos,usage,
+    //      pinned-usage}" if the cache collects shard stats (see
+    //      LRUCacheOptions::collect_shard_stats); and the "count" and "usage"
+    //      of the cached blocks of each block type, as
+    //      "cf.<column family>.<block type>.{count,usage}" for the blocks of
+    //      open tables of this DB and "other.<block type>.{count,usage}" for
+    //      the rest. As a string, one "<name>=<value>" line per entry. Walks
+    //      the whole block cache, so it isn't cheap.
+    static const std::string kBlockCacheStats;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -979,6 +997,7 @@ class DB {
   //  "rocksdb.num-running-flushes"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
+  //  "rocksdb.sustainable-write-rate"
   //  "rocksdb.estimate-oldest-key-time"
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
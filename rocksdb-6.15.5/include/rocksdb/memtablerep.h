@@ -40,11 +40,13 @@
 #include <stdlib.h>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace ROCKSDB_NAMESPACE {
 
 class Arena;
 class Allocator;
+class Comparator;
 class LookupKey;
 class SliceTransform;
 class Logger;
@@ -75,6 +77,11 @@ class MemTableRep {
     virtual int operator()(const char* prefix_len_key,
                            const Slice& key) const = 0;
 
+    // Returns the comparator that orders the user keys, or nullptr if it is
+    // not known. Representations that index user keys by hash use it to
+    // decide whether such an index is safe for the key format.
+    virtual const Comparator* user_comparator() const { return nullptr; }
+
     virtual ~KeyComparator() {}
   };
 
@@ -194,6 +201,14 @@ class MemTableRep {
     return 0;
   }
 
+  // Appends to *entries, in key order, about `target` entries spread evenly
+  // over the memtable, without visiting every entry. Returns false if the
+  // representation can't do that.
+  virtual bool SampleEntries(size_t /*target*/,
+                             std::vector<const char*>* /*entries*/) {
+    return false;
+  }
+
   // Report an approximation of how much memory has been used other than memory
   // that was allocated through the allocator.  Safe to call from any thread.
   virtual size_t ApproximateMemoryUsage() = 0;
@@ -381,5 +396,31 @@ extern MemTableRepFactory* NewHashLinkListRepFactory(
     bool if_log_bucket_dist_when_flash = true,
     uint32_t threshold_use_skiplist = 256);
 
+// This factory creates memtables that group all versions of a user key
+// together: a skip list of user keys, each pointing to a skip list of that
+// key's versions in descending sequence number order. A lookup at any
+// snapshot costs O(log keys + log versions), which helps workloads where a
+// small set of hot keys is overwritten many times while older snapshots are
+// still being read. No prefix extractor is required.
+// @version_list_height: the max height of each per-key version skip list
+// @version_list_branching_factor: probabilistic size ratio between adjacent
+//                                 link lists in the version skip lists
+extern MemTableRepFactory* NewVersionChainRepFactory(
+    int32_t version_list_height = 8, int32_t version_list_branching_factor = 4);
+
+// This factory creates memtables backed by a skip list that supports
+// concurrent inserts, plus a lock-free open-addressing hash index from each
+// user key to its newest entry. Point lookups of keys absent from the
+// memtable, and lookups that can see the newest version of a key, are O(1)
+// and don't search the skip list. No prefix extractor is required, and
+// allow_concurrent_memtable_write can be used.
+// The index is keyed by the raw bytes of the user key, so it is only used
+// when the user comparator treats equal keys as bytewise identical and
+// user-defined timestamps are not enabled.
+// @bucket_count: number of slots in the hash index. It should be larger than
+//                the number of distinct keys expected in a memtable.
+extern MemTableRepFactory* NewHashIndexedSkipListRepFactory(
+    size_t bucket_count = 1000000);
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
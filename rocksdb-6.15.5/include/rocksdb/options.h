@@ -35,6 +35,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class ArenaBlockPool;
 class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
@@ -760,6 +761,15 @@ struct DBOptions {
   // Default: null
   std::shared_ptr<WriteBufferManager> write_buffer_manager = nullptr;
 
+  // If not null, memtables take their arena blocks from this pool and give
+  // them back when they are freed after a flush, so new memtables reuse
+  // memory that is already mapped instead of faulting in fresh pages. With
+  // ColumnFamilyOptions::memtable_huge_page_size, the pooled blocks are
+  // huge pages. The same pool can be shared by multiple DBs.
+  //
+  // Default: null
+  std::shared_ptr<ArenaBlockPool> arena_block_pool = nullptr;
+
   // Specify the file access pattern once a compaction is started.
   // It will be applied to all input files of a compaction.
   // Default: NORMAL
@@ -908,6 +918,21 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   uint64_t delayed_write_rate = 0;
 
+  // If true, writes are paced smoothly instead of being slowed down and sped
+  // up in steps. RocksDB then measures the ingest rate that flushes and
+  // compactions keep up with and, once a slowdown trigger is reached, delays
+  // writes to that rate scaled down linearly with how far the column family
+  // has moved from its slowdown triggers towards its stop triggers
+  // (level0_stop_writes_trigger, hard_pending_compaction_bytes_limit).
+  // Reaching those stop triggers slows writes down to 16KB/s instead of
+  // stopping them. Writes still stop at max_write_buffer_number memtables.
+  // The estimated rate is reported by the "rocksdb.sustainable-write-rate"
+  // DB property. delayed_write_rate bounds the paced rate, and is used
+  // until there is an estimate.
+  //
+  // Default: false
+  bool smooth_write_throttling = false;
+
   // By default, a single write thread queue is maintained. The thread gets
   // to the head of the queue becomes write batch group leader and responsible
   // for writing to WAL and memtable for the batch group.
@@ -963,6 +988,8 @@ struct DBOptions {
   // wait for up to write_thread_max_yield_usec before blocking on a mutex.
   // This can substantially improve throughput for concurrent workloads,
   // regardless of whether allow_concurrent_memtable_write is enabled.
+  // The busy spin that precedes the yielding is also sized by how long
+  // recent waits took, instead of a fixed number of iterations.
   //
   // Default: true
   bool enable_write_thread_adaptive_yield = true;
@@ -1024,6 +1051,49 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // If true, row cache entries remember the range of sequence numbers
+  // [version_seq, next_version_seq) for which the cached result is visible,
+  // so reads at an older snapshot (e.g. inside a long-running transaction)
+  // can be served from row_cache as long as the snapshot falls inside that
+  // range. If false, snapshot reads older than the newest entry of a file use
+  // a row cache key that includes the snapshot, which rarely hits.
+  // Has no effect if row_cache is not set.
+  // Default: false
+  // Not supported in ROCKSDB_LITE mode!
+  bool row_cache_snapshot_aware = false;
+
+  // If non-zero, the DB saves the handles of the data blocks of its SST files
+  // that are in the block cache to a file in the DB directory every
+  // block_cache_warmup_period_sec seconds and when it is closed. DB::Open
+  // then loads those blocks back into the block cache with background reads
+  // in the LOW priority thread pool, so that the cache doesn't have to refill
+  // one miss at a time after a restart. Only column families with a block
+  // based table and a block cache are saved.
+  // Default: 0 (disabled)
+  // Not supported in ROCKSDB_LITE mode!
+  unsigned int block_cache_warmup_period_sec = 0;
+
+  // If not null, the block cache warm-up of block_cache_warmup_period_sec
+  // requests the bytes of the blocks it reads from this rate limiter, with
+  // Env::IO_LOW and RateLimiter::OpType::kRead, so it must be created in
+  // RateLimiter::Mode::kReadsOnly or kAllIo to have an effect.
+  // Default: nullptr (warm-up reads are not rate limited)
+  std::shared_ptr<RateLimiter> block_cache_warmup_rate_limiter = nullptr;
+
+  // If non-zero, each column family keeps the values of about this many of
+  // its most read keys in memory, and Get() returns them without searching
+  // the memtables and SST files. A key is cached when, according to a
+  // frequency sketch of the reads that miss the cache, it is read more often
+  // than the least hit cached key. Writes drop the keys they write, and
+  // range deletions and file ingestion drop all keys. Meant for workloads
+  // where a few keys get most of the reads.
+  // Only used by Get() without a timestamp, read callback or blob index, and
+  // with read_tier kReadAllTier and without ignore_range_deletions. Column
+  // families with a compaction filter or FIFO compaction, and DBs with
+  // unordered_write, don't use it.
+  // Default: 0 (disabled)
+  size_t hot_key_cache_size = 0;
+
 #ifndef ROCKSDB_LITE
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
@@ -1099,6 +1169,45 @@ struct DBOptions {
   // file.
   bool manual_wal_flush = false;
 
+  // If true, a write with WriteOptions::sync does not sync the WAL while it
+  // leads its write group. The group is written to the WAL and memtables like
+  // a non-sync group and released, and each sync writer then waits for a WAL
+  // sync outside of the write thread. Writers waiting at the same time share
+  // a single sync, and the next write group forms and appends to the WAL
+  // while the sync is in flight, which raises the throughput of concurrent
+  // sync writes. A sync write still only returns once its data is durable,
+  // but it may become visible to readers shortly before.
+  //
+  // Not compatible with two_write_queues, manual_wal_flush and
+  // allow_mmap_writes.
+  //
+  // DEFAULT: false
+  bool pipelined_wal_sync = false;
+
+  // Number of WAL files written side by side. With more than one, every new
+  // WAL is created as that many files with consecutive numbers, and each
+  // write group appends its record to the next of them in turn. Sync writes
+  // are made durable like with pipelined_wal_sync, except that each WAL file
+  // is synced on its own, so that concurrent sync writers sync different
+  // files at the same time. Recovery replays the records of all WAL files in
+  // sequence number order, and stops at the first record missing from a WAL
+  // file that lost its tail, so that it still recovers a prefix of the
+  // writes (with WALRecoveryMode::kAbsoluteConsistency, it fails instead).
+  //
+  // Not compatible with two_write_queues, unordered_write,
+  // enable_pipelined_write, manual_wal_flush, allow_mmap_writes, allow_2pc
+  // (and so TransactionDB), recycle_log_file_num and secondary instances,
+  // which fail to open a DB whose WALs are written with wal_streams > 1.
+  // DB::GetUpdatesSince() returns NotSupported. The count is recorded in the
+  // MANIFEST, so that recovery replays the WALs with the count they were
+  // written with, and flushes them when it changes.
+  //
+  // Appends still run one write group at a time, as the records go to the
+  // WAL in sequence number order; only the syncs of different files overlap.
+  //
+  // DEFAULT: 1
+  size_t wal_streams = 1;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1291,6 +1400,16 @@ struct ReadOptions {
   // Default: 0
   size_t readahead_size;
 
+  // If non-zero, iterators over block based tables read ahead this many data
+  // blocks at a time into the block cache, as low priority entries, instead
+  // of into a buffer private to the iterator. The blocks read ahead then
+  // serve other iterators and point lookups too. Like auto-readahead, it
+  // starts after two reads of data blocks from a table file. When set,
+  // readahead_size is ignored. Has no effect if fill_cache is false, if the
+  // table has no block cache, or with mmap reads.
+  // Default: 0
+  size_t block_cache_readahead_blocks;
+
   // A threshold for the number of keys that can be skipped before failing an
   // iterator seek as incomplete. The default value of 0 should be used to
   // never fail a request as incomplete, even on skipping too many keys.
@@ -1487,6 +1606,25 @@ struct WriteOptions {
   // Default: false
   bool memtable_insert_hint_per_batch;
 
+  // If true, the puts and deletes of this writebatch are inserted into each
+  // memtable in key order, every insert continuing from the position of the
+  // previous one. It makes inserting large writebatches of unordered keys
+  // cheaper, at the cost of sorting the writebatch. Writebatches with other
+  // kinds of entries, or when seq_per_batch or inplace_update_support are
+  // used, are inserted in order.
+  //
+  // Default: false
+  bool memtable_insert_sorted;
+
+  // If non-zero, DB::Put() adds values of at least this many bytes to its
+  // write batch with WriteBatch::PutPinnedValue(), so that they are copied
+  // straight from the caller's memory into the WAL and the memtable. Saves a
+  // copy of large values, at the cost of writing the WAL record in several
+  // pieces.
+  //
+  // Default: 0 (values are copied into the write batch)
+  size_t put_pinned_value_min_size;
+
   // Timestamp of write operation, e.g. Put. All timestamps of the same
   // database must share the same length and format. The user is also
   // responsible for providing a customized compare function via Comparator to
@@ -1505,6 +1643,8 @@ struct WriteOptions {
         no_slowdown(false),
         low_pri(false),
         memtable_insert_hint_per_batch(false),
+        memtable_insert_sorted(false),
+        put_pinned_value_min_size(0),
         timestamp(nullptr) {}
 };
 
@@ -159,6 +159,13 @@ struct PerfContext {
 
   // time spent waiting for other threads of the batch group
   uint64_t write_thread_wait_nanos;
+  // part of write_thread_wait_nanos spent blocked on a condition variable
+  uint64_t write_thread_block_nanos;
+  // number of waits for other threads of the batch group that ended while
+  // busy spinning, while yielding the CPU, or after blocking, respectively
+  uint64_t write_thread_spin_count;
+  uint64_t write_thread_yield_count;
+  uint64_t write_thread_block_count;
 
   // time spent on acquiring DB mutex.
   uint64_t db_mutex_lock_nanos;
@@ -183,6 +190,9 @@ struct PerfContext {
   uint64_t bloom_memtable_hit_count;
   // total number of mem table bloom misses
   uint64_t bloom_memtable_miss_count;
+  // total number of mem table lookups skipped because the key's seqno filter
+  // bucket shows no version old enough for the read snapshot
+  uint64_t seqno_filter_memtable_miss_count;
   // total number of SST table bloom hits
   uint64_t bloom_sst_hit_count;
   // total number of SST table bloom misses
@@ -44,6 +44,23 @@ class PersistentCache {
   virtual Status Lookup(const Slice& key, std::unique_ptr<char[]>* data,
                         size_t* size) = 0;
 
+  // Lookup a batch of pages by page identifiers. Same as calling Lookup() for
+  // each page, but lets the implementation batch the IO for the pages it
+  // has to read from the device.
+  //
+  // num_keys   Number of pages
+  // keys       Page identifiers
+  // data       Buffers where the data of each page should be copied
+  // sizes      Sizes of the pages
+  // statuses   Status of the lookup of each page
+  virtual void MultiLookup(const size_t num_keys, const Slice* keys,
+                           std::unique_ptr<char[]>* data, size_t* sizes,
+                           Status* statuses) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      statuses[i] = Lookup(keys[i], &data[i], &sizes[i]);
+    }
+  }
+
   // Is cache storing uncompressed data ?
   //
   // True if the cache is configured to store uncompressed data else false
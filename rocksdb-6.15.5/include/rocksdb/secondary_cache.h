@@ -0,0 +1,83 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A SecondaryCache holds copies of entries evicted from a Cache, see
+// LRUCacheOptions::secondary_cache. Unlike Cache, it stores the bytes of an
+// entry rather than a pointer to it, so that it may keep them in a cheaper
+// form, e.g. compressed.
+//
+// All methods must be thread-safe.
+class SecondaryCache {
+ public:
+  virtual ~SecondaryCache() {}
+
+  virtual const char* Name() const = 0;
+
+  // Stores a copy of `value` under `key`, replacing any previous value. The
+  // secondary cache may drop entries at any time.
+  virtual Status Insert(const Slice& key, const Slice& value) = 0;
+
+  // Returns true and stores the value of `key` in *value if found, false
+  // otherwise.
+  virtual bool Lookup(const Slice& key, std::string* value) = 0;
+
+  virtual void Erase(const Slice& key) = 0;
+
+  virtual std::string GetPrintableOptions() const { return ""; }
+};
+
+struct CompressedSecondaryCacheOptions {
+  // Capacity of the cache, in bytes of compressed values.
+  size_t capacity = 0;
+
+  // Cache is sharded into 2^num_shard_bits shards, by hash of key. See
+  // LRUCacheOptions::num_shard_bits.
+  int num_shard_bits = -1;
+
+  // Compression used for the values. Values that don't compress are stored
+  // as they are.
+  CompressionType compression_type = kLZ4Compression;
+
+  CompressedSecondaryCacheOptions() {}
+  CompressedSecondaryCacheOptions(size_t _capacity, int _num_shard_bits,
+                                  CompressionType _compression_type)
+      : capacity(_capacity),
+        num_shard_bits(_num_shard_bits),
+        compression_type(_compression_type) {}
+};
+
+// Creates an in-memory secondary cache, which keeps values compressed in an
+// LRU cache.
+//
+// Return nullptr if the options are invalid or the compression type is not
+// supported by this build.
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+// Creates an LRU cache with a compressed secondary cache, which share
+// cache_opts.capacity between them: the secondary cache gets
+// compressed_secondary_ratio of it, and the LRU cache the rest.
+// cache_opts.secondary_cache is ignored.
+//
+// Return nullptr if either cache can't be created, see NewLRUCache() and
+// NewCompressedSecondaryCache().
+extern std::shared_ptr<Cache> NewTieredCache(
+    const LRUCacheOptions& cache_opts, double compressed_secondary_ratio,
+    CompressionType compression_type = kLZ4Compression);
+
+}  // namespace ROCKSDB_NAMESPACE
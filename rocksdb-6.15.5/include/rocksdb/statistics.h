@@ -374,6 +374,21 @@ enum Tickers : uint32_t {
   // # of files deleted immediately by sst file manger through delete scheduler.
   FILES_DELETED_IMMEDIATELY,
 
+  // # of sync writes with DBOptions::pipelined_wal_sync whose data was made
+  // durable by a WAL sync of another writer.
+  WAL_FILE_SYNC_SHARED,
+
+  // # of lookups that missed the block cache and were found, or not found,
+  // in its secondary cache (see LRUCacheOptions::secondary_cache). Lookups
+  // found there also count as block cache hits.
+  SECONDARY_CACHE_HITS,
+  SECONDARY_CACHE_MISSES,
+
+  // # of Get() calls served, or not, by the hot key cache (see
+  // DBOptions::hot_key_cache_size).
+  HOT_KEY_CACHE_HIT,
+  HOT_KEY_CACHE_MISS,
+
   TICKER_ENUM_MAX
 };
 
@@ -81,6 +81,25 @@ class WriteBatch : public WriteBatchBase {
     return Put(nullptr, key, value);
   }
 
+  // Like Put(), but the batch only references the bytes of "value" instead
+  // of copying them. The value is copied straight into the WAL and the
+  // memtable when the batch is written, saving a copy of it.
+  //
+  // REQUIRES: the memory referenced by "value" stays valid and unmodified
+  // until the batch is cleared or destroyed, or, if the batch is passed to
+  // DB::Write(), at least until DB::Write() returns. Operations that need the
+  // serialized batch, e.g. Data(), copying the batch or rolling back to a
+  // save point, copy the referenced values into the batch, after which the
+  // requirement no longer applies to them. Data() does so even on a const
+  // batch, so it must not be called concurrently with other accesses to a
+  // batch with pinned values. The other const accessors never modify the
+  // batch.
+  Status PutPinnedValue(ColumnFamilyHandle* column_family, const Slice& key,
+                        const Slice& value);
+  Status PutPinnedValue(const Slice& key, const Slice& value) {
+    return PutPinnedValue(nullptr, key, value);
+  }
+
   using WriteBatchBase::Delete;
   // If the database contains a mapping for "key", erase it.  Else do nothing.
   Status Delete(ColumnFamilyHandle* column_family, const Slice& key) override;
@@ -277,11 +296,17 @@ class WriteBatch : public WriteBatchBase {
   };
   Status Iterate(Handler* handler) const;
 
-  // Retrieve the serialized version of this batch.
-  const std::string& Data() const { return rep_; }
+  // Retrieve the serialized version of this batch. Copies the values added
+  // with PutPinnedValue() into the batch first.
+  const std::string& Data() const {
+    // The pinned values are part of the logical content of the batch, which
+    // only a batch constructed non-const can hold.
+    const_cast<WriteBatch*>(this)->MaterializePinnedValues();
+    return rep_;
+  }
 
   // Retrieve data size of the batch.
-  size_t GetDataSize() const { return rep_.size(); }
+  size_t GetDataSize() const { return rep_.size() + pinned_bytes_; }
 
   // Returns the number of updates in the batch
   uint32_t Count() const;
@@ -358,7 +383,24 @@ class WriteBatch : public WriteBatchBase {
   // Performs deferred computation of content_flags if necessary
   uint32_t ComputeContentFlags() const;
 
-  // Maximum size of rep_.
+  // A value added with PutPinnedValue() that is referenced rather than
+  // stored in rep_. Its Put record is in rep_ at record_offset, up to and
+  // including the value length; the value belongs at value_offset.
+  struct PinnedValue {
+    size_t record_offset;
+    size_t value_offset;
+    Slice value;
+  };
+
+  // Pinned values in the order of their records.
+  std::vector<PinnedValue> pinned_values_;
+  // Total size of pinned_values_.
+  size_t pinned_bytes_ = 0;
+
+  // Copies the pinned values into rep_, if there are any.
+  void MaterializePinnedValues();
+
+  // Maximum size of the batch.
   size_t max_bytes_;
 
   // Is the content of the batch the application's latest state that meant only
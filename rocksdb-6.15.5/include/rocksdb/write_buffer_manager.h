@@ -24,8 +24,21 @@ class WriteBufferManager {
   // memory_usage() won't be valid and ShouldFlush() will always return true.
   // if `cache` is provided, we'll put dummy entries in the cache and cost
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
+  //
+  // If `flush_by_weighted_size` is true, a DB that ShouldFlush() asks to
+  // flush picks the column family whose active memtable uses the most memory
+  // relative to its ColumnFamilyOptions::write_buffer_weight, instead of the
+  // one with the oldest active memtable. Large, frequently written column
+  // families are then flushed before small ones that are rarely written.
+  //
+  // ShouldFlush() asks for flushes once the active memtables use more than
+  // `flush_start_ratio` of _buffer_size, 7/8 if it is 0. With a lower ratio,
+  // memtables are flushed one at a time well before the memory limit is
+  // reached, which leaves more headroom to absorb bursts of writes.
   explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {});
+                              std::shared_ptr<Cache> cache = {},
+                              bool flush_by_weighted_size = false,
+                              double flush_start_ratio = 0);
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
   WriteBufferManager& operator=(const WriteBufferManager&) = delete;
@@ -45,6 +58,8 @@ class WriteBufferManager {
   }
   size_t buffer_size() const { return buffer_size_; }
 
+  bool flush_by_weighted_size() const { return flush_by_weighted_size_; }
+
   // Should only be called from write thread
   bool ShouldFlush() const {
     if (enabled()) {
@@ -90,6 +105,7 @@ class WriteBufferManager {
  private:
   const size_t buffer_size_;
   const size_t mutable_limit_;
+  const bool flush_by_weighted_size_;
   std::atomic<size_t> memory_used_;
   // Memory that hasn't been scheduled to free.
   std::atomic<size_t> memory_active_;
@@ -15,6 +15,7 @@
 #include "logging/logging.h"
 #include "port/malloc.h"
 #include "port/port.h"
+#include "rocksdb/arena_block_pool.h"
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
 
@@ -42,8 +43,11 @@ size_t OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             ArenaBlockPool* block_pool)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      block_pool_(block_pool),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -72,6 +76,11 @@ Arena::~Arena() {
   for (const auto& block : blocks_) {
     delete[] block;
   }
+  for (const auto& block : pool_blocks_) {
+    if (block.addr_ != nullptr) {
+      block_pool_->Release(block.addr_, block.length_, block.huge_page_);
+    }
+  }
 
 #ifdef MAP_HUGETLB
   for (const auto& mmap_info : huge_blocks_) {
@@ -97,8 +106,24 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   // We waste the remaining space in the current block.
   size_t size = 0;
   char* block_head = nullptr;
+  if (block_pool_ != nullptr) {
+    size = kBlockSize;
+    bool huge_page = false;
 #ifdef MAP_HUGETLB
-  if (hugetlb_size_) {
+    if (hugetlb_size_) {
+      size = hugetlb_size_;
+      huge_page = true;
+    }
+#endif
+    block_head = AllocateFromBlockPool(size, huge_page);
+    if (!block_head) {
+      // No huge page could be mapped.
+      size = kBlockSize;
+      block_head = AllocateFromBlockPool(size, false /* huge_page */);
+    }
+  }
+#ifdef MAP_HUGETLB
+  if (!block_head && hugetlb_size_) {
     size = hugetlb_size_;
     block_head = AllocateFromHugePage(size);
   }
@@ -153,6 +178,25 @@ char* Arena::AllocateFromHugePage(size_t bytes) {
 #endif
 }
 
+char* Arena::AllocateFromBlockPool(size_t bytes, bool huge_page) {
+  // Reserve space in `pool_blocks_` before taking the block, like
+  // `AllocateFromHugePage()` does.
+  pool_blocks_.emplace_back(nullptr /* addr */, 0 /* length */,
+                            false /* huge_page */);
+
+  char* block = block_pool_->Allocate(bytes, &huge_page);
+  if (block == nullptr) {
+    pool_blocks_.pop_back();
+    return nullptr;
+  }
+  pool_blocks_.back() = PoolBlockInfo(block, bytes, huge_page);
+  blocks_memory_ += bytes;
+  if (tracker_ != nullptr) {
+    tracker_->Allocate(bytes);
+  }
+  return block;
+}
+
 char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
                              Logger* logger) {
   assert((kAlignUnit & (kAlignUnit - 1)) ==
@@ -25,6 +25,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class ArenaBlockPool;
+
 class Arena : public Allocator {
  public:
   // No copying allowed
@@ -38,8 +40,11 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // block_pool: if not nullptr, regular blocks are taken from the pool and
+  // given back to it when the arena is destroyed.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 ArenaBlockPool* block_pool = nullptr);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -98,6 +103,18 @@ class Arena : public Allocator {
   std::vector<MmapInfo> huge_blocks_;
   size_t irregular_block_num = 0;
 
+  ArenaBlockPool* const block_pool_;
+  struct PoolBlockInfo {
+    char* addr_;
+    size_t length_;
+    bool huge_page_;
+
+    PoolBlockInfo(char* addr, size_t length, bool huge_page)
+        : addr_(addr), length_(length), huge_page_(huge_page) {}
+  };
+  // Blocks to give back to block_pool_
+  std::vector<PoolBlockInfo> pool_blocks_;
+
   // Stats for current active block.
   // For each block, we allocate aligned memory chucks from one end and
   // allocate unaligned memory chucks from the other end. Otherwise the
@@ -112,6 +129,7 @@ class Arena : public Allocator {
   size_t hugetlb_size_ = 0;
 #endif  // MAP_HUGETLB
   char* AllocateFromHugePage(size_t bytes);
+  char* AllocateFromBlockPool(size_t bytes, bool huge_page);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
 
@@ -0,0 +1,115 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/arena_block_pool.h"
+
+#ifndef OS_WIN
+#include <sys/mman.h>
+#endif
+#include <vector>
+
+#include "port/port.h"
+#include "util/core_local.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+struct PooledBlock {
+  char* addr;
+  size_t length;
+  bool huge_page;
+};
+
+void FreeBlock(const PooledBlock& block) {
+#ifdef MAP_HUGETLB
+  if (block.huge_page) {
+    munmap(block.addr, block.length);
+    return;
+  }
+#endif
+  delete[] block.addr;
+}
+}  // namespace
+
+struct ArenaBlockPool::Rep {
+  struct Shard {
+    port::Mutex mutex;
+    std::vector<PooledBlock> blocks;
+  };
+
+  CoreLocalArray<Shard> shards;
+};
+
+ArenaBlockPool::ArenaBlockPool(size_t capacity)
+    : capacity_(capacity),
+      pooled_bytes_(0),
+      reused_blocks_(0),
+      rep_(new Rep()) {}
+
+ArenaBlockPool::~ArenaBlockPool() {
+  for (size_t i = 0; i < rep_->shards.Size(); ++i) {
+    for (const auto& block : rep_->shards.AccessAtCore(i)->blocks) {
+      FreeBlock(block);
+    }
+  }
+}
+
+char* ArenaBlockPool::Allocate(size_t bytes, bool* huge_page) {
+  // Look at the shard of the current core first, so that a block is reused
+  // where its memory is most likely local. Memtables are usually freed by
+  // flush threads, so fall back to the other shards before allocating.
+  const size_t num_shards = rep_->shards.Size();
+  const size_t start = rep_->shards.AccessElementAndIndex().second;
+  for (size_t i = 0;
+       i < num_shards && pooled_bytes_.load(std::memory_order_relaxed) > 0;
+       ++i) {
+    auto* shard = rep_->shards.AccessAtCore((start + i) % num_shards);
+    MutexLock l(&shard->mutex);
+    auto& blocks = shard->blocks;
+    for (size_t j = blocks.size(); j > 0; --j) {
+      if (blocks[j - 1].length != bytes) {
+        continue;
+      }
+      PooledBlock block = blocks[j - 1];
+      blocks[j - 1] = blocks.back();
+      blocks.pop_back();
+      pooled_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+      reused_blocks_.fetch_add(1, std::memory_order_relaxed);
+      *huge_page = block.huge_page;
+      return block.addr;
+    }
+  }
+
+#ifdef MAP_HUGETLB
+  if (*huge_page) {
+    void* addr = mmap(nullptr, bytes, (PROT_READ | PROT_WRITE),
+                      (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+    if (addr == MAP_FAILED) {
+      // A regular block of that size would have to be reused by arenas that
+      // asked for a huge page, so the caller falls back to its regular size.
+      return nullptr;
+    }
+    return reinterpret_cast<char*>(addr);
+  }
+#endif
+  *huge_page = false;
+  return new char[bytes];
+}
+
+void ArenaBlockPool::Release(char* block, size_t bytes, bool huge_page) {
+  PooledBlock pooled{block, bytes, huge_page};
+  if (pooled_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes >
+      capacity_) {
+    pooled_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    FreeBlock(pooled);
+    return;
+  }
+  auto* shard = rep_->shards.Access();
+  MutexLock l(&shard->mutex);
+  shard->blocks.push_back(pooled);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "memory/arena.h"
+#include "rocksdb/arena_block_pool.h"
 #include "test_util/testharness.h"
 #include "util/random.h"
 
@@ -196,6 +197,69 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+namespace {
+void BlockPoolTest(size_t huge_page_size) {
+  const size_t bsz = 32 * 1024;
+  const size_t pooled_block_size = huge_page_size ? huge_page_size : bsz;
+  ArenaBlockPool pool(2 * pooled_block_size);
+
+  if (huge_page_size) {
+    ArenaBlockPool probe(0 /* capacity */);
+    bool huge_page = true;
+    char* block = probe.Allocate(huge_page_size, &huge_page);
+    if (block == nullptr) {
+      // No huge pages here. The arena falls back to pooled regular blocks.
+      {
+        Arena arena(bsz, nullptr, huge_page_size, &pool);
+        char* p = arena.Allocate(bsz / 8);
+        memset(p, 'a', bsz / 8);
+      }
+      ASSERT_EQ(bsz, pool.GetPooledBytes());
+      return;
+    }
+    probe.Release(block, huge_page_size, huge_page);
+  }
+
+  // Allocations of up to a quarter of the block size are served from
+  // regular blocks.
+  const size_t req_sz = bsz / 4;
+  {
+    Arena arena(bsz, nullptr, huge_page_size, &pool);
+    // Three regular blocks and one irregular block
+    for (size_t i = 0; i < 3 * (pooled_block_size / req_sz); i++) {
+      char* p = arena.Allocate(req_sz);
+      memset(p, 'a', req_sz);
+    }
+    arena.Allocate(pooled_block_size);
+    ASSERT_EQ(0U, pool.GetPooledBytes());
+  }
+  // The pool keeps as many regular blocks as fit in its capacity.
+  ASSERT_EQ(2 * pooled_block_size, pool.GetPooledBytes());
+  ASSERT_EQ(0U, pool.GetReusedBlocks());
+
+  {
+    Arena arena(bsz, nullptr, huge_page_size, &pool);
+    char* p = arena.Allocate(req_sz);
+    memset(p, 'b', req_sz);
+    ASSERT_EQ(pooled_block_size, pool.GetPooledBytes());
+    ASSERT_EQ(1U, pool.GetReusedBlocks());
+    ASSERT_PRED2(CheckMemoryAllocated, arena.MemoryAllocatedBytes(),
+                 pooled_block_size + Arena::kInlineSize);
+
+    // Blocks of another size are not reused
+    Arena other_arena(2 * pooled_block_size, nullptr, 0, &pool);
+    other_arena.Allocate(req_sz);
+    ASSERT_EQ(1U, pool.GetReusedBlocks());
+  }
+  ASSERT_EQ(2 * pooled_block_size, pool.GetPooledBytes());
+}
+}  // namespace
+
+TEST_F(ArenaTest, BlockPool) {
+  BlockPoolTest(0);
+  BlockPoolTest(kHugePageSize);
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,332 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#ifndef ROCKSDB_LITE
+#include "memtable/hash_indexed_skiplist_rep.h"
+
+#include <atomic>
+
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/inlineskiplist.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/slice.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// A memtable representation that stores all entries in an InlineSkipList,
+// which provides the iteration order and supports concurrent inserts, plus a
+// lock-free open-addressing hash index from user key to the newest entry of
+// that key.
+//
+// Point lookups consult the index first:
+//  - if the user key is not in the index, it is not in the memtable and Get()
+//    returns without touching the skip list;
+//  - if the newest version is visible to the lookup, Get() starts from it
+//    directly;
+//  - otherwise (an older snapshot) Get() falls back to a skip list seek.
+//
+// Slots are only ever changed from nullptr to an entry, or from an entry to a
+// newer entry of the same user key, with compare-and-swap. A writer publishes
+// its entry in the index before its sequence number becomes visible to
+// readers, so a reader never misses a version it is allowed to see.
+//
+// The index hashes and matches the raw bytes of the user key, so it assumes
+// that user keys comparing equal are bytewise identical. It is disabled when
+// the user comparator is unknown or user-defined timestamps are in use; the
+// rep then behaves like the plain skip list rep.
+class HashIndexedSkipListRep : public MemTableRep {
+ public:
+  HashIndexedSkipListRep(const MemTableRep::KeyComparator& compare,
+                         Allocator* allocator, size_t bucket_count);
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = skip_list_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  bool InsertKey(KeyHandle handle) override {
+    auto* key = static_cast<char*>(handle);
+    if (!skip_list_.Insert(key)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKey(handle);
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    auto* key = static_cast<char*>(handle);
+    if (!skip_list_.InsertConcurrently(key)) {
+      return false;
+    }
+    UpdateIndex(key);
+    return true;
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return InsertKeyConcurrently(handle);
+  }
+
+  // Returns true iff an entry that compares equal to key is in the list.
+  bool Contains(const char* key) const override {
+    return skip_list_.Contains(key);
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                 const Slice& end_ikey) override {
+    std::string tmp;
+    uint64_t start_count =
+        skip_list_.EstimateCount(EncodeKey(&tmp, start_ikey));
+    uint64_t end_count = skip_list_.EstimateCount(EncodeKey(&tmp, end_ikey));
+    return (end_count >= start_count) ? (end_count - start_count) : 0;
+  }
+
+  bool SampleEntries(size_t target,
+                     std::vector<const char*>* entries) override {
+    skip_list_.SampleKeys(target, entries);
+    return true;
+  }
+
+  ~HashIndexedSkipListRep() override {}
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                      : operator new(sizeof(Iterator));
+    return new (mem) Iterator(&skip_list_);
+  }
+
+ private:
+  typedef InlineSkipList<const MemTableRep::KeyComparator&> List;
+
+  // Number of consecutive slots probed before giving up on indexing a key.
+  static const size_t kMaxProbes = 32;
+
+  // Record key as the newest entry of its user key if it is newer than the
+  // current one.
+  void UpdateIndex(const char* key);
+
+  // Returns the newest entry of user_key in the index. Returns nullptr and
+  // sets *maybe_present if user_key may still be in the skip list.
+  const char* FindNewest(const Slice& user_key, bool* maybe_present) const;
+
+  inline size_t GetBucket(const Slice& user_key) const {
+    return GetSliceHash(user_key) % bucket_count_;
+  }
+
+  List skip_list_;
+  const MemTableRep::KeyComparator& compare_;
+  const size_t bucket_count_;
+
+  // nullptr if the index is disabled.
+  std::atomic<const char*>* index_;
+  // Set once a key could not be indexed within kMaxProbes slots.
+  std::atomic<bool> index_overflow_;
+
+  // Iteration over the contents of a skip list
+  class Iterator : public MemTableRep::Iterator {
+    List::Iterator iter_;
+
+   public:
+    // Initialize an iterator over the specified list.
+    // The returned iterator is not valid.
+    explicit Iterator(const List* list) : iter_(list) {}
+
+    ~Iterator() override {}
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const override { return iter_.Valid(); }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const override { return iter_.key(); }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next() override { iter_.Next(); }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev() override { iter_.Prev(); }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Position at the first entry in list.
+    // Final state of iterator is Valid() iff list is not empty.
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    // Position at the last entry in list.
+    // Final state of iterator is Valid() iff list is not empty.
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   private:
+    std::string tmp_;  // For passing to EncodeKey
+  };
+};
+
+HashIndexedSkipListRep::HashIndexedSkipListRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    size_t bucket_count)
+    : MemTableRep(allocator),
+      skip_list_(compare, allocator),
+      compare_(compare),
+      bucket_count_(bucket_count),
+      index_(nullptr),
+      index_overflow_(false) {
+  const Comparator* ucmp = compare.user_comparator();
+  // The index finds keys by their bytes, so it can only be used when keys
+  // that compare equal have the same bytes.
+  if (bucket_count_ > 0 && ucmp != nullptr && ucmp->timestamp_size() == 0 &&
+      !ucmp->CanKeysWithDifferentByteContentsBeEqual()) {
+    auto mem = allocator->AllocateAligned(sizeof(std::atomic<const char*>) *
+                                          bucket_count_);
+    index_ = new (mem) std::atomic<const char*>[bucket_count_];
+    for (size_t i = 0; i < bucket_count_; ++i) {
+      index_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+}
+
+void HashIndexedSkipListRep::UpdateIndex(const char* key) {
+  if (index_ == nullptr) {
+    return;
+  }
+  const Slice user_key = UserKey(key);
+  const size_t bucket = GetBucket(user_key);
+  for (size_t probe = 0; probe < kMaxProbes && probe < bucket_count_;
+       ++probe) {
+    std::atomic<const char*>& slot = index_[(bucket + probe) % bucket_count_];
+    const char* cur = slot.load(std::memory_order_acquire);
+    while (true) {
+      if (cur == nullptr) {
+        if (slot.compare_exchange_weak(cur, key, std::memory_order_release,
+                                       std::memory_order_acquire)) {
+          return;
+        }
+        // cur now holds the entry another writer installed; re-examine it.
+        continue;
+      }
+      if (UserKey(cur) != user_key) {
+        // Slot belongs to another user key, try the next one.
+        break;
+      }
+      if (compare_(key, cur) >= 0) {
+        // The slot already points to a newer version.
+        return;
+      }
+      if (slot.compare_exchange_weak(cur, key, std::memory_order_release,
+                                     std::memory_order_acquire)) {
+        return;
+      }
+    }
+  }
+  index_overflow_.store(true, std::memory_order_release);
+}
+
+const char* HashIndexedSkipListRep::FindNewest(const Slice& user_key,
+                                               bool* maybe_present) const {
+  *maybe_present = false;
+  const size_t bucket = GetBucket(user_key);
+  for (size_t probe = 0; probe < kMaxProbes && probe < bucket_count_;
+       ++probe) {
+    const char* cur =
+        index_[(bucket + probe) % bucket_count_].load(std::memory_order_acquire);
+    if (cur == nullptr) {
+      return nullptr;
+    }
+    if (UserKey(cur) == user_key) {
+      return cur;
+    }
+  }
+  // Every probed slot is taken by other keys; the key may have been dropped
+  // from the index.
+  *maybe_present = index_overflow_.load(std::memory_order_acquire);
+  return nullptr;
+}
+
+void HashIndexedSkipListRep::Get(const LookupKey& k, void* callback_args,
+                                 bool (*callback_func)(void* arg,
+                                                       const char* entry)) {
+  const char* memtable_key = k.memtable_key().data();
+  Iterator iter(&skip_list_);
+  if (index_ != nullptr) {
+    bool maybe_present;
+    const char* newest = FindNewest(k.user_key(), &maybe_present);
+    if (newest == nullptr && !maybe_present) {
+      return;
+    }
+    if (newest != nullptr && compare_(newest, memtable_key) >= 0) {
+      // The newest version is visible to the lookup, so it is exactly where
+      // a skip list seek would land. Only pay for the seek if the callback
+      // asks for older versions, e.g. to collect merge operands.
+      if (!callback_func(callback_args, newest)) {
+        return;
+      }
+      iter.Seek(Slice(), newest);
+      assert(iter.Valid());
+      iter.Next();
+      for (; iter.Valid() && callback_func(callback_args, iter.key());
+           iter.Next()) {
+      }
+      return;
+    }
+  }
+  for (iter.Seek(Slice(), memtable_key);
+       iter.Valid() && callback_func(callback_args, iter.key()); iter.Next()) {
+  }
+}
+
+}  // anon namespace
+
+MemTableRep* HashIndexedSkipListRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new HashIndexedSkipListRep(compare, allocator, bucket_count_);
+}
+
+MemTableRepFactory* NewHashIndexedSkipListRepFactory(size_t bucket_count) {
+  return new HashIndexedSkipListRepFactory(bucket_count);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -46,6 +46,7 @@
 #include <algorithm>
 #include <atomic>
 #include <type_traits>
+#include <vector>
 #include "memory/allocator.h"
 #include "port/likely.h"
 #include "port/port.h"
@@ -141,6 +142,13 @@ class InlineSkipList {
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
+  // Appends to *keys, in order, the keys of the highest level of the list
+  // that has at least `target` nodes, or of every node if there is no such
+  // level. As a node reaches each level with probability 1/branching, the
+  // keys are spread evenly over the list, and only about target * branching
+  // nodes are visited.
+  void SampleKeys(size_t target, std::vector<const char*>* keys) const;
+
   // Validate correctness of the skip-list.
   void TEST_Validate() const;
 
@@ -473,6 +481,11 @@ InlineSkipList<Comparator>::FindGreaterOrEqual(const char* key) const {
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
+      // If the search moves to next and then drops a level, this is the node
+      // it compares against.
+      if (level > 0) {
+        PREFETCH(next->Next(level - 1), 0, 1);
+      }
     }
     // Make sure the lists are sorted
     assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
@@ -516,6 +529,9 @@ InlineSkipList<Comparator>::FindLessThan(const char* key, Node** prev,
     Node* next = x->Next(level);
     if (next != nullptr) {
       PREFETCH(next->Next(level), 0, 1);
+      if (level > bottom_level) {
+        PREFETCH(next->Next(level - 1), 0, 1);
+      }
     }
     assert(x == head_ || next == nullptr || KeyIsAfterNode(next->Key(), x));
     assert(x == head_ || KeyIsAfterNode(key_decoded, x));
@@ -586,6 +602,21 @@ uint64_t InlineSkipList<Comparator>::EstimateCount(const char* key) const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::SampleKeys(
+    size_t target, std::vector<const char*>* keys) const {
+  const size_t start = keys->size();
+  for (int level = GetMaxHeight() - 1; level >= 0; level--) {
+    keys->resize(start);
+    for (Node* x = head_->Next(level); x != nullptr; x = x->Next(level)) {
+      keys->push_back(x->Key());
+    }
+    if (keys->size() - start >= target) {
+      break;
+    }
+  }
+}
+
 template <class Comparator>
 InlineSkipList<Comparator>::InlineSkipList(const Comparator cmp,
                                            Allocator* allocator,
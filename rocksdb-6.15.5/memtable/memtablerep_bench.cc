@@ -51,7 +51,11 @@ DEFINE_string(benchmarks, "fillrandom",
               "do random\n"
               "\t                          reads\n"
               "\tseqreadwrite           -- 1 thread writes while N - 1 threads "
-              "do scans\n");
+              "do scans\n"
+              "\tfillhot                -- write N values to num_hot_keys "
+              "keys\n"
+              "\treadhot                -- read N values from num_hot_keys "
+              "keys in random order\n");
 
 DEFINE_string(memtablerep, "skiplist",
               "Which implementation of memtablerep to use. See "
@@ -61,11 +65,14 @@ DEFINE_string(memtablerep, "skiplist",
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
+              "\tversionchain        -- backed by per-key version skip lists\n"
+              "\thashindex           -- backed by a skip list with a hash "
+              "index\n"
               "\tcuckoo              -- backed by a cuckoo hash table");
 
 DEFINE_int64(bucket_count, 1000000,
-             "bucket_count parameter to pass into NewHashSkiplistRepFactory or "
-             "NewHashLinkListRepFactory");
+             "bucket_count parameter to pass into NewHashSkiplistRepFactory, "
+             "NewHashLinkListRepFactory or NewHashIndexedSkipListRepFactory");
 
 DEFINE_int32(
     hashskiplist_height, 4,
@@ -75,6 +82,14 @@ DEFINE_int32(
     hashskiplist_branching_factor, 4,
     "branching_factor parameter to pass into NewHashSkiplistRepFactory");
 
+DEFINE_int32(
+    versionchain_height, 8,
+    "version_list_height parameter to pass into NewVersionChainRepFactory");
+
+DEFINE_int32(versionchain_branching_factor, 4,
+             "version_list_branching_factor parameter to pass into "
+             "NewVersionChainRepFactory");
+
 DEFINE_int32(
     huge_page_tlb_size, 0,
     "huge_page_tlb_size parameter to pass into NewHashLinkListRepFactory");
@@ -109,6 +124,13 @@ DEFINE_int32(num_scans, 10,
 
 DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 
+DEFINE_int64(num_hot_keys, 27,
+             "Number of distinct keys for the fillhot and readhot benchmarks");
+
+DEFINE_uint64(read_snapshot_lag, 0,
+              "Random reads look up keys at a snapshot this many sequence "
+              "numbers older than the latest write");
+
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
@@ -243,7 +265,7 @@ class FillBenchmarkThread : public BenchmarkThread {
     auto key = key_gen_->Next();
     EncodeFixed64(p, key);
     p += 8;
-    EncodeFixed64(p, ++(*sequence_));
+    EncodeFixed64(p, PackSequenceAndType(++(*sequence_), kTypeValue));
     p += 8;
     Slice bytes = generator_.Generate(FLAGS_item_size);
     memcpy(p, bytes.data(), FLAGS_item_size);
@@ -310,7 +332,10 @@ class ReadBenchmarkThread : public BenchmarkThread {
     std::string user_key;
     auto key = key_gen_->Next();
     PutFixed64(&user_key, key);
-    LookupKey lookup_key(user_key, *sequence_);
+    SequenceNumber snapshot = *sequence_ > FLAGS_read_snapshot_lag
+                                  ? *sequence_ - FLAGS_read_snapshot_lag
+                                  : 0;
+    LookupKey lookup_key(user_key, snapshot);
     InternalKeyComparator internal_key_comp(BytewiseComparator());
     CallbackVerifyArgs verify_args;
     verify_args.found = false;
@@ -593,6 +618,12 @@ int main(int argc, char** argv) {
         FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist));
     options.prefix_extractor.reset(
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
+  } else if (FLAGS_memtablerep == "hashindex") {
+    factory.reset(
+        ROCKSDB_NAMESPACE::NewHashIndexedSkipListRepFactory(FLAGS_bucket_count));
+  } else if (FLAGS_memtablerep == "versionchain") {
+    factory.reset(ROCKSDB_NAMESPACE::NewVersionChainRepFactory(
+        FLAGS_versionchain_height, FLAGS_versionchain_branching_factor));
 #endif  // ROCKSDB_LITE
   } else {
     fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
@@ -638,6 +669,17 @@ int main(int argc, char** argv) {
           &rng, ROCKSDB_NAMESPACE::UNIQUE_RANDOM, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
           memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("fillhot")) {
+      memtablerep.reset(createMemtableRep());
+      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
+          &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_hot_keys));
+      benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
+          memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("readhot")) {
+      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
+          &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_hot_keys));
+      benchmark.reset(new ROCKSDB_NAMESPACE::ReadBenchmark(
+          memtablerep.get(), key_gen.get(), &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("readrandom")) {
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
@@ -95,6 +95,12 @@ public:
     return (end_count >= start_count) ? (end_count - start_count) : 0;
   }
 
+  bool SampleEntries(size_t target,
+                     std::vector<const char*>* entries) override {
+    skip_list_.SampleKeys(target, entries);
+    return true;
+  }
+
   ~SkipListRep() override {}
 
   // Iteration over the contents of a skip list
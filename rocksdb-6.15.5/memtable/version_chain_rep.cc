@@ -0,0 +1,306 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#ifndef ROCKSDB_LITE
+#include "memtable/version_chain_rep.h"
+
+#include <string.h>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/skiplist.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// A memtable representation that keeps every version of a user key in its
+// own skiplist, ordered by descending sequence number, and indexes those
+// chains with a skiplist of user keys. A point lookup at snapshot S costs
+// O(log keys + log versions of the key) no matter how many newer versions
+// of the same key exist, which is much cheaper than stepping through all of
+// them in a single flat skiplist when a few keys are overwritten very often.
+//
+// Each key node is allocated as [VersionList*][memtable key], where the
+// memtable key is the user key tagged with (kMaxSequenceNumber,
+// kValueTypeForSeek) so that it sorts before every real entry of the same
+// user key. The outer skiplist stores pointers to the memtable key part, so
+// both lists can share the memtable's KeyComparator.
+class VersionChainRep : public MemTableRep {
+ public:
+  VersionChainRep(const MemTableRep::KeyComparator& compare,
+                  Allocator* allocator, int32_t version_list_height,
+                  int32_t version_list_branching_factor);
+
+  void Insert(KeyHandle handle) override;
+
+  bool Contains(const char* key) const override;
+
+  size_t ApproximateMemoryUsage() override;
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  ~VersionChainRep() override {}
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override;
+
+ private:
+  typedef SkipList<const char*, const MemTableRep::KeyComparator&> KeyList;
+  typedef SkipList<const char*, const MemTableRep::KeyComparator&> VersionList;
+
+  static VersionList* GetVersions(const char* node_key) {
+    VersionList* versions;
+    memcpy(&versions, node_key - sizeof(VersionList*), sizeof(versions));
+    return versions;
+  }
+
+  // Encode the key node representation of user_key into *scratch.
+  static const char* EncodeKeyNode(std::string* scratch,
+                                   const Slice& user_key) {
+    scratch->clear();
+    PutVarint32(scratch, static_cast<uint32_t>(user_key.size() + 8));
+    scratch->append(user_key.data(), user_key.size());
+    PutFixed64(scratch,
+               PackSequenceAndType(kMaxSequenceNumber, kValueTypeForSeek));
+    return scratch->data();
+  }
+
+  // Returns the version list of the user key encoded in node_key, or nullptr
+  // if the key has no version in the memtable.
+  VersionList* FindVersions(const char* node_key) const;
+
+  const MemTableRep::KeyComparator& compare_;
+  // immutable after construction
+  Allocator* const allocator_;
+
+  const int32_t version_list_height_;
+  const int32_t version_list_branching_factor_;
+
+  KeyList keys_;
+
+  // Only accessed by the (single) writer in Insert().
+  std::string insert_scratch_;
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const KeyList* keys)
+        : keys_iter_(keys), versions_iter_(nullptr) {}
+
+    ~Iterator() override {}
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const override { return versions_iter_.Valid(); }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const override {
+      assert(Valid());
+      return versions_iter_.key();
+    }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next() override {
+      assert(Valid());
+      versions_iter_.Next();
+      if (!versions_iter_.Valid()) {
+        keys_iter_.Next();
+        SeekToFirstVersion();
+      }
+    }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev() override {
+      assert(Valid());
+      versions_iter_.Prev();
+      if (!versions_iter_.Valid()) {
+        keys_iter_.Prev();
+        SeekToLastVersion();
+      }
+    }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      const char* encoded_key = (memtable_key != nullptr)
+                                    ? memtable_key
+                                    : EncodeKey(&tmp_, internal_key);
+      SeekEncoded(encoded_key);
+    }
+
+    void SeekEncoded(const char* target) {
+      // The last key node <= target owns the versions of target's user key,
+      // if there are any.
+      keys_iter_.SeekForPrev(target);
+      if (!keys_iter_.Valid()) {
+        keys_iter_.SeekToFirst();
+        SeekToFirstVersion();
+        return;
+      }
+      versions_iter_.SetList(GetVersions(keys_iter_.key()));
+      versions_iter_.Seek(target);
+      if (!versions_iter_.Valid()) {
+        keys_iter_.Next();
+        SeekToFirstVersion();
+      }
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      const char* encoded_key = (memtable_key != nullptr)
+                                    ? memtable_key
+                                    : EncodeKey(&tmp_, internal_key);
+      keys_iter_.SeekForPrev(encoded_key);
+      if (!keys_iter_.Valid()) {
+        versions_iter_.SetList(nullptr);
+        return;
+      }
+      versions_iter_.SetList(GetVersions(keys_iter_.key()));
+      versions_iter_.SeekForPrev(encoded_key);
+      if (!versions_iter_.Valid()) {
+        keys_iter_.Prev();
+        SeekToLastVersion();
+      }
+    }
+
+    // Position at the first entry in collection.
+    // Final state of iterator is Valid() iff collection is not empty.
+    void SeekToFirst() override {
+      keys_iter_.SeekToFirst();
+      SeekToFirstVersion();
+    }
+
+    // Position at the last entry in collection.
+    // Final state of iterator is Valid() iff collection is not empty.
+    void SeekToLast() override {
+      keys_iter_.SeekToLast();
+      SeekToLastVersion();
+    }
+
+   private:
+    // Every key node holds at least one version, so positioning inside the
+    // current key node always yields a valid entry.
+    void SeekToFirstVersion() {
+      if (keys_iter_.Valid()) {
+        versions_iter_.SetList(GetVersions(keys_iter_.key()));
+        versions_iter_.SeekToFirst();
+      } else {
+        versions_iter_.SetList(nullptr);
+      }
+    }
+
+    void SeekToLastVersion() {
+      if (keys_iter_.Valid()) {
+        versions_iter_.SetList(GetVersions(keys_iter_.key()));
+        versions_iter_.SeekToLast();
+      } else {
+        versions_iter_.SetList(nullptr);
+      }
+    }
+
+    KeyList::Iterator keys_iter_;
+    VersionList::Iterator versions_iter_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+};
+
+VersionChainRep::VersionChainRep(const MemTableRep::KeyComparator& compare,
+                                 Allocator* allocator,
+                                 int32_t version_list_height,
+                                 int32_t version_list_branching_factor)
+    : MemTableRep(allocator),
+      compare_(compare),
+      allocator_(allocator),
+      version_list_height_(version_list_height),
+      version_list_branching_factor_(version_list_branching_factor),
+      keys_(compare, allocator) {}
+
+VersionChainRep::VersionList* VersionChainRep::FindVersions(
+    const char* node_key) const {
+  KeyList::Iterator iter(&keys_);
+  iter.Seek(node_key);
+  if (iter.Valid() && compare_(iter.key(), node_key) == 0) {
+    return GetVersions(iter.key());
+  }
+  return nullptr;
+}
+
+void VersionChainRep::Insert(KeyHandle handle) {
+  auto* key = static_cast<char*>(handle);
+  const char* node_key = EncodeKeyNode(&insert_scratch_, UserKey(key));
+  VersionList* versions = FindVersions(node_key);
+  if (versions != nullptr) {
+    assert(!versions->Contains(key));
+    versions->Insert(key);
+    return;
+  }
+
+  // First version of this user key. The key node is only published after it
+  // holds the version, so readers never observe an empty chain.
+  auto addr = allocator_->AllocateAligned(sizeof(VersionList));
+  versions = new (addr) VersionList(compare_, allocator_, version_list_height_,
+                                    version_list_branching_factor_);
+  versions->Insert(key);
+
+  const size_t node_key_size = insert_scratch_.size();
+  char* mem =
+      allocator_->AllocateAligned(sizeof(VersionList*) + node_key_size);
+  memcpy(mem, &versions, sizeof(VersionList*));
+  memcpy(mem + sizeof(VersionList*), node_key, node_key_size);
+  keys_.Insert(mem + sizeof(VersionList*));
+}
+
+bool VersionChainRep::Contains(const char* key) const {
+  std::string scratch;
+  VersionList* versions = FindVersions(EncodeKeyNode(&scratch, UserKey(key)));
+  return versions != nullptr && versions->Contains(key);
+}
+
+size_t VersionChainRep::ApproximateMemoryUsage() {
+  // All memory is allocated through allocator; nothing to report here.
+  return 0;
+}
+
+void VersionChainRep::Get(const LookupKey& k, void* callback_args,
+                          bool (*callback_func)(void* arg, const char* entry)) {
+  Iterator iter(&keys_);
+  for (iter.SeekEncoded(k.memtable_key().data());
+       iter.Valid() && callback_func(callback_args, iter.key());
+       iter.Next()) {
+  }
+}
+
+MemTableRep::Iterator* VersionChainRep::GetIterator(Arena* arena) {
+  if (arena == nullptr) {
+    return new Iterator(&keys_);
+  } else {
+    auto mem = arena->AllocateAligned(sizeof(Iterator));
+    return new (mem) Iterator(&keys_);
+  }
+}
+
+}  // anon namespace
+
+MemTableRep* VersionChainRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new VersionChainRep(compare, allocator, version_list_height_,
+                             version_list_branching_factor_);
+}
+
+MemTableRepFactory* NewVersionChainRepFactory(
+    int32_t version_list_height, int32_t version_list_branching_factor) {
+  return new VersionChainRepFactory(version_list_height,
+                                    version_list_branching_factor);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,37 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#pragma once
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class VersionChainRepFactory : public MemTableRepFactory {
+ public:
+  explicit VersionChainRepFactory(int32_t version_list_height,
+                                  int32_t version_list_branching_factor)
+      : version_list_height_(version_list_height),
+        version_list_branching_factor_(version_list_branching_factor) {}
+
+  virtual ~VersionChainRepFactory() {}
+
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, Allocator* allocator,
+      const SliceTransform* transform, Logger* logger) override;
+
+  virtual const char* Name() const override {
+    return "VersionChainRepFactory";
+  }
+
+ private:
+  const int32_t version_list_height_;
+  const int32_t version_list_branching_factor_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -48,10 +48,23 @@ struct WriteBufferManager::CacheRep {
 struct WriteBufferManager::CacheRep {};
 #endif  // ROCKSDB_LITE
 
+namespace {
+size_t GetMutableLimit(size_t buffer_size, double flush_start_ratio) {
+  if (flush_start_ratio <= 0 || flush_start_ratio >= 1) {
+    return buffer_size * 7 / 8;
+  }
+  return static_cast<size_t>(static_cast<double>(buffer_size) *
+                             flush_start_ratio);
+}
+}  // namespace
+
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
-                                       std::shared_ptr<Cache> cache)
+                                       std::shared_ptr<Cache> cache,
+                                       bool flush_by_weighted_size,
+                                       double flush_start_ratio)
     : buffer_size_(_buffer_size),
-      mutable_limit_(buffer_size_ * 7 / 8),
+      mutable_limit_(GetMutableLimit(buffer_size_, flush_start_ratio)),
+      flush_by_weighted_size_(flush_by_weighted_size),
       memory_used_(0),
       memory_active_(0),
       cache_rep_(nullptr) {
@@ -50,6 +50,30 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, FlushStartRatio) {
+  // A write buffer manager of size 10MB that starts flushing at 50%
+  std::unique_ptr<WriteBufferManager> wbf(new WriteBufferManager(
+      10 * 1024 * 1024, {}, true /* flush_by_weighted_size */, 0.5));
+  ASSERT_TRUE(wbf->flush_by_weighted_size());
+
+  wbf->ReserveMem(5 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  wbf->ReserveMem(1 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldFlush());
+  // Scheduling for freeing will release the condition
+  wbf->ScheduleFreeMem(2 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  wbf->FreeMem(2 * 1024 * 1024);
+
+  // Out of range ratios fall back to 7/8.
+  wbf.reset(new WriteBufferManager(10 * 1024 * 1024, {}, false, 1.5));
+  ASSERT_FALSE(wbf->flush_by_weighted_size());
+  wbf->ReserveMem(8 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  wbf->ReserveMem(1 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldFlush());
+}
+
 TEST_F(WriteBufferManagerTest, CacheCost) {
   LRUCacheOptions co;
   // 1GB cache
@@ -79,6 +79,10 @@ PerfContext::PerfContext(const PerfContext& other) {
   write_memtable_time = other.write_memtable_time;
   write_delay_time = other.write_delay_time;
   write_thread_wait_nanos = other.write_thread_wait_nanos;
+  write_thread_block_nanos = other.write_thread_block_nanos;
+  write_thread_spin_count = other.write_thread_spin_count;
+  write_thread_yield_count = other.write_thread_yield_count;
+  write_thread_block_count = other.write_thread_block_count;
   write_scheduling_flushes_compactions_time =
       other.write_scheduling_flushes_compactions_time;
   db_mutex_lock_nanos = other.db_mutex_lock_nanos;
@@ -92,6 +96,7 @@ PerfContext::PerfContext(const PerfContext& other) {
   find_table_nanos = other.find_table_nanos;
   bloom_memtable_hit_count = other.bloom_memtable_hit_count;
   bloom_memtable_miss_count = other.bloom_memtable_miss_count;
+  seqno_filter_memtable_miss_count = other.seqno_filter_memtable_miss_count;
   bloom_sst_hit_count = other.bloom_sst_hit_count;
   bloom_sst_miss_count = other.bloom_sst_miss_count;
   key_lock_wait_time = other.key_lock_wait_time;
@@ -176,6 +181,10 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   write_memtable_time = other.write_memtable_time;
   write_delay_time = other.write_delay_time;
   write_thread_wait_nanos = other.write_thread_wait_nanos;
+  write_thread_block_nanos = other.write_thread_block_nanos;
+  write_thread_spin_count = other.write_thread_spin_count;
+  write_thread_yield_count = other.write_thread_yield_count;
+  write_thread_block_count = other.write_thread_block_count;
   write_scheduling_flushes_compactions_time =
       other.write_scheduling_flushes_compactions_time;
   db_mutex_lock_nanos = other.db_mutex_lock_nanos;
@@ -189,6 +198,7 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   find_table_nanos = other.find_table_nanos;
   bloom_memtable_hit_count = other.bloom_memtable_hit_count;
   bloom_memtable_miss_count = other.bloom_memtable_miss_count;
+  seqno_filter_memtable_miss_count = other.seqno_filter_memtable_miss_count;
   bloom_sst_hit_count = other.bloom_sst_hit_count;
   bloom_sst_miss_count = other.bloom_sst_miss_count;
   key_lock_wait_time = other.key_lock_wait_time;
@@ -275,6 +285,10 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   write_memtable_time = other.write_memtable_time;
   write_delay_time = other.write_delay_time;
   write_thread_wait_nanos = other.write_thread_wait_nanos;
+  write_thread_block_nanos = other.write_thread_block_nanos;
+  write_thread_spin_count = other.write_thread_spin_count;
+  write_thread_yield_count = other.write_thread_yield_count;
+  write_thread_block_count = other.write_thread_block_count;
   write_scheduling_flushes_compactions_time =
       other.write_scheduling_flushes_compactions_time;
   db_mutex_lock_nanos = other.db_mutex_lock_nanos;
@@ -288,6 +302,7 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   find_table_nanos = other.find_table_nanos;
   bloom_memtable_hit_count = other.bloom_memtable_hit_count;
   bloom_memtable_miss_count = other.bloom_memtable_miss_count;
+  seqno_filter_memtable_miss_count = other.seqno_filter_memtable_miss_count;
   bloom_sst_hit_count = other.bloom_sst_hit_count;
   bloom_sst_miss_count = other.bloom_sst_miss_count;
   key_lock_wait_time = other.key_lock_wait_time;
@@ -372,6 +387,10 @@ void PerfContext::Reset() {
   write_memtable_time = 0;
   write_delay_time = 0;
   write_thread_wait_nanos = 0;
+  write_thread_block_nanos = 0;
+  write_thread_spin_count = 0;
+  write_thread_yield_count = 0;
+  write_thread_block_count = 0;
   write_scheduling_flushes_compactions_time = 0;
   db_mutex_lock_nanos = 0;
   db_condition_wait_nanos = 0;
@@ -384,6 +403,7 @@ void PerfContext::Reset() {
   find_table_nanos = 0;
   bloom_memtable_hit_count = 0;
   bloom_memtable_miss_count = 0;
+  seqno_filter_memtable_miss_count = 0;
   bloom_sst_hit_count = 0;
   bloom_sst_miss_count = 0;
   key_lock_wait_time = 0;
@@ -490,6 +510,10 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(write_pre_and_post_process_time);
   PERF_CONTEXT_OUTPUT(write_memtable_time);
   PERF_CONTEXT_OUTPUT(write_thread_wait_nanos);
+  PERF_CONTEXT_OUTPUT(write_thread_block_nanos);
+  PERF_CONTEXT_OUTPUT(write_thread_spin_count);
+  PERF_CONTEXT_OUTPUT(write_thread_yield_count);
+  PERF_CONTEXT_OUTPUT(write_thread_block_count);
   PERF_CONTEXT_OUTPUT(write_scheduling_flushes_compactions_time);
   PERF_CONTEXT_OUTPUT(db_mutex_lock_nanos);
   PERF_CONTEXT_OUTPUT(db_condition_wait_nanos);
@@ -503,6 +527,7 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(find_table_nanos);
   PERF_CONTEXT_OUTPUT(bloom_memtable_hit_count);
   PERF_CONTEXT_OUTPUT(bloom_memtable_miss_count);
+  PERF_CONTEXT_OUTPUT(seqno_filter_memtable_miss_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_hit_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_miss_count);
   PERF_CONTEXT_OUTPUT(key_lock_wait_time);
@@ -113,6 +113,10 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<Cache> row_cache;
 
+  bool row_cache_snapshot_aware;
+
+  ArenaBlockPool* arena_block_pool;
+
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
   std::vector<DbPath> cf_paths;
@@ -137,6 +141,9 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+        memtable_seqno_filter_bucket_count(
+            options.memtable_seqno_filter_bucket_count),
+        write_buffer_weight(options.write_buffer_weight),
         memtable_huge_page_size(options.memtable_huge_page_size),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
@@ -173,6 +180,7 @@ struct MutableCFOptions {
         check_flush_compaction_key_order(
             options.check_flush_compaction_key_order),
         paranoid_file_checks(options.paranoid_file_checks),
+        max_flush_partitions(options.max_flush_partitions),
         report_bg_io_stats(options.report_bg_io_stats),
         compression(options.compression),
         bottommost_compression(options.bottommost_compression),
@@ -189,6 +197,8 @@ struct MutableCFOptions {
         arena_block_size(0),
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
+        memtable_seqno_filter_bucket_count(0),
+        write_buffer_weight(1.0),
         memtable_huge_page_size(0),
         max_successive_merges(0),
         inplace_update_num_locks(0),
@@ -216,6 +226,7 @@ struct MutableCFOptions {
         max_sequential_skip_in_iterations(0),
         check_flush_compaction_key_order(true),
         paranoid_file_checks(false),
+        max_flush_partitions(1),
         report_bg_io_stats(false),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
         bottommost_compression(kDisableCompressionOption),
@@ -246,6 +257,8 @@ struct MutableCFOptions {
   size_t arena_block_size;
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
+  size_t memtable_seqno_filter_bucket_count;
+  double write_buffer_weight;
   size_t memtable_huge_page_size;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
@@ -281,6 +294,7 @@ struct MutableCFOptions {
   uint64_t max_sequential_skip_in_iterations;
   bool check_flush_compaction_key_order;
   bool paranoid_file_checks;
+  uint32_t max_flush_partitions;
   bool report_bg_io_stats;
   CompressionType compression;
   CompressionType bottommost_compression;
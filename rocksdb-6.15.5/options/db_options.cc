@@ -358,6 +358,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, manual_wal_flush),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"smooth_write_throttling",
+         {offsetof(struct ImmutableDBOptions, smooth_write_throttling),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"pipelined_wal_sync",
+         {offsetof(struct ImmutableDBOptions, pipelined_wal_sync),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"wal_streams",
+         {offsetof(struct ImmutableDBOptions, wal_streams),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kNone}},
@@ -369,6 +381,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, avoid_unnecessary_blocking_io),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"row_cache_snapshot_aware",
+         {offsetof(struct ImmutableDBOptions, row_cache_snapshot_aware),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_warmup_period_sec",
+         {offsetof(struct ImmutableDBOptions, block_cache_warmup_period_sec),
+          OptionType::kUInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"hot_key_cache_size",
+         {offsetof(struct ImmutableDBOptions, hot_key_cache_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"write_dbid_to_manifest",
          {offsetof(struct ImmutableDBOptions, write_dbid_to_manifest),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -540,6 +564,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       advise_random_on_open(options.advise_random_on_open),
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
+      arena_block_pool(options.arena_block_pool),
       access_hint_on_compaction_start(options.access_hint_on_compaction_start),
       new_table_reader_for_compaction_inputs(
           options.new_table_reader_for_compaction_inputs),
@@ -560,6 +585,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       wal_recovery_mode(options.wal_recovery_mode),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      row_cache_snapshot_aware(options.row_cache_snapshot_aware),
+      block_cache_warmup_period_sec(options.block_cache_warmup_period_sec),
+      block_cache_warmup_rate_limiter(options.block_cache_warmup_rate_limiter),
+      hot_key_cache_size(options.hot_key_cache_size),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -570,6 +599,9 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
+      smooth_write_throttling(options.smooth_write_throttling),
+      pipelined_wal_sync(options.pipelined_wal_sync),
+      wal_streams(options.wal_streams),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
       persist_stats_to_disk(options.persist_stats_to_disk),
@@ -663,6 +695,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       db_write_buffer_size);
   ROCKS_LOG_HEADER(log, "                   Options.write_buffer_manager: %p",
                    write_buffer_manager.get());
+  ROCKS_LOG_HEADER(log, "                       Options.arena_block_pool: %p",
+                   arena_block_pool.get());
   ROCKS_LOG_HEADER(log, "        Options.access_hint_on_compaction_start: %d",
                    static_cast<int>(access_hint_on_compaction_start));
   ROCKS_LOG_HEADER(log, " Options.new_table_reader_for_compaction_inputs: %d",
@@ -704,6 +738,15 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  ROCKS_LOG_HEADER(log, "               Options.row_cache_snapshot_aware: %d",
+                   row_cache_snapshot_aware);
+  ROCKS_LOG_HEADER(log, "          Options.block_cache_warmup_period_sec: %u",
+                   block_cache_warmup_period_sec);
+  ROCKS_LOG_HEADER(log, "        Options.block_cache_warmup_rate_limiter: %p",
+                   block_cache_warmup_rate_limiter.get());
+  ROCKS_LOG_HEADER(
+      log, "                     Options.hot_key_cache_size: %" ROCKSDB_PRIszt,
+      hot_key_cache_size);
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
@@ -719,6 +762,13 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "     Options.smooth_write_throttling: %d",
+                   smooth_write_throttling);
+  ROCKS_LOG_HEADER(log, "          Options.pipelined_wal_sync: %d",
+                   pipelined_wal_sync);
+  ROCKS_LOG_HEADER(log,
+                   "                 Options.wal_streams: %" ROCKSDB_PRIszt,
+                   wal_streams);
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
@@ -55,6 +55,7 @@ struct ImmutableDBOptions {
   bool advise_random_on_open;
   size_t db_write_buffer_size;
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
+  std::shared_ptr<ArenaBlockPool> arena_block_pool;
   DBOptions::AccessHint access_hint_on_compaction_start;
   bool new_table_reader_for_compaction_inputs;
   size_t random_access_max_buffer_size;
@@ -72,6 +73,10 @@ struct ImmutableDBOptions {
   WALRecoveryMode wal_recovery_mode;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  bool row_cache_snapshot_aware;
+  unsigned int block_cache_warmup_period_sec;
+  std::shared_ptr<RateLimiter> block_cache_warmup_rate_limiter;
+  size_t hot_key_cache_size;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
@@ -82,6 +87,9 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  bool smooth_write_throttling;
+  bool pipelined_wal_sync;
+  size_t wal_streams;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
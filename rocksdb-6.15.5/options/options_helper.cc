@@ -106,6 +106,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
   options.db_write_buffer_size = immutable_db_options.db_write_buffer_size;
   options.write_buffer_manager = immutable_db_options.write_buffer_manager;
+  options.arena_block_pool = immutable_db_options.arena_block_pool;
   options.access_hint_on_compaction_start =
       immutable_db_options.access_hint_on_compaction_start;
   options.new_table_reader_for_compaction_inputs =
@@ -139,6 +140,13 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.row_cache_snapshot_aware =
+      immutable_db_options.row_cache_snapshot_aware;
+  options.block_cache_warmup_period_sec =
+      immutable_db_options.block_cache_warmup_period_sec;
+  options.block_cache_warmup_rate_limiter =
+      immutable_db_options.block_cache_warmup_rate_limiter;
+  options.hot_key_cache_size = immutable_db_options.hot_key_cache_size;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -155,6 +163,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.smooth_write_throttling =
+      immutable_db_options.smooth_write_throttling;
+  options.pipelined_wal_sync = immutable_db_options.pipelined_wal_sync;
+  options.wal_streams = immutable_db_options.wal_streams;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
@@ -184,6 +196,9 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.memtable_prefix_bloom_size_ratio;
   cf_opts.memtable_whole_key_filtering =
       mutable_cf_options.memtable_whole_key_filtering;
+  cf_opts.memtable_seqno_filter_bucket_count =
+      mutable_cf_options.memtable_seqno_filter_bucket_count;
+  cf_opts.write_buffer_weight = mutable_cf_options.write_buffer_weight;
   cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
   cf_opts.max_successive_merges = mutable_cf_options.max_successive_merges;
   cf_opts.inplace_update_num_locks =
@@ -241,6 +256,7 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.check_flush_compaction_key_order =
       mutable_cf_options.check_flush_compaction_key_order;
   cf_opts.paranoid_file_checks = mutable_cf_options.paranoid_file_checks;
+  cf_opts.max_flush_partitions = mutable_cf_options.max_flush_partitions;
   cf_opts.report_bg_io_stats = mutable_cf_options.report_bg_io_stats;
   cf_opts.compression = mutable_cf_options.compression;
   cf_opts.compression_opts = mutable_cf_options.compression_opts;
@@ -1115,6 +1115,21 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("version_chain", &new_mem_factory));
+  ASSERT_OK(
+      GetMemTableRepFactoryFromString("version_chain:12", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "VersionChainRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("version_chain:12:invalid_opt",
+                                             &new_mem_factory));
+
+  ASSERT_OK(GetMemTableRepFactoryFromString("hash_index", &new_mem_factory));
+  ASSERT_OK(
+      GetMemTableRepFactoryFromString("hash_index:1000", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()),
+            "HashIndexedSkipListRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("hash_index:1000:invalid_opt",
+                                             &new_mem_factory));
+
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo", &new_mem_factory));
   // CuckooHash memtable is already removed.
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo:1024", &new_mem_factory));
@@ -80,6 +80,18 @@ void Mutex::Lock() {
 #endif
 }
 
+bool Mutex::TryLock() {
+  int ret = pthread_mutex_trylock(&mu_);
+  if (ret == EBUSY) {
+    return false;
+  }
+  PthreadCall("trylock", ret);
+#ifndef NDEBUG
+  locked_ = true;
+#endif
+  return true;
+}
+
 void Mutex::Unlock() {
 #ifndef NDEBUG
   locked_ = false;
@@ -232,9 +232,17 @@ void BlockBasedTableIterator::InitDataBlock() {
     //   Enabled after 2 sequential IOs when ReadOptions.readahead_size == 0.
     // Explicit user requested readahead:
     //   Enabled from the very first IO when ReadOptions.readahead_size is set.
-    block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
-                                       read_options_.readahead_size,
-                                       is_for_compaction);
+    // Readahead into the block cache:
+    //   Enabled after 2 sequential IOs when
+    //   ReadOptions.block_cache_readahead_blocks is set.
+    if (read_options_.block_cache_readahead_blocks > 0 && !is_for_compaction) {
+      block_prefetcher_.PrefetchIntoBlockCacheIfNeeded(
+          table_, read_options_, data_block_handle, index_iter_->key());
+    } else {
+      block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
+                                         read_options_.readahead_size,
+                                         is_for_compaction);
+    }
 
     Status s;
     table_->NewDataBlockIterator<DataBlockIter>(
@@ -32,6 +32,7 @@
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
 #include "rocksdb/table_properties.h"
@@ -75,6 +76,20 @@ BlockBasedTable::~BlockBasedTable() { delete rep_; }
 
 std::atomic<uint64_t> BlockBasedTable::next_cache_key_id_(0);
 
+namespace {
+// Delete the entry resided in the cache.
+template <class Entry>
+void DeleteCachedEntry(const Slice& /*key*/, void* value) {
+  auto entry = reinterpret_cast<Entry*>(value);
+  delete entry;
+}
+
+const size_t kNumBlockTypes = static_cast<size_t>(BlockType::kInvalid) + 1;
+}  // namespace
+
+// GetCacheItemHelper() returns how the cache can save the block to a
+// secondary cache. Only Block can be saved; the helpers of the other types
+// only hold their deleter.
 template <typename TBlocklike>
 class BlocklikeTraits;
 
@@ -92,6 +107,12 @@ class BlocklikeTraits<BlockContents> {
   static uint32_t GetNumRestarts(const BlockContents& /* contents */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper() {
+    static const Cache::CacheItemHelper kHelper{
+        nullptr, nullptr, &DeleteCachedEntry<BlockContents>, 0 /* tag */};
+    return &kHelper;
+  }
 };
 
 template <>
@@ -108,6 +129,13 @@ class BlocklikeTraits<ParsedFullFilterBlock> {
   static uint32_t GetNumRestarts(const ParsedFullFilterBlock& /* block */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper() {
+    static const Cache::CacheItemHelper kHelper{
+        nullptr, nullptr, &DeleteCachedEntry<ParsedFullFilterBlock>,
+        0 /* tag */};
+    return &kHelper;
+  }
 };
 
 template <>
@@ -122,6 +150,26 @@ class BlocklikeTraits<Block> {
   static uint32_t GetNumRestarts(const Block& block) {
     return block.NumRestarts();
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper() {
+    static const Cache::CacheItemHelper kHelper{
+        &SizeCallback, &SaveToCallback, &DeleteCachedEntry<Block>,
+        0 /* tag */};
+    return &kHelper;
+  }
+
+ private:
+  // A block is saved as its contents, which Create() parses back.
+  static size_t SizeCallback(void* obj) {
+    return reinterpret_cast<Block*>(obj)->size();
+  }
+
+  static Status SaveToCallback(void* obj, size_t size, char* out) {
+    const Block* block = reinterpret_cast<Block*>(obj);
+    assert(size == block->size());
+    memcpy(out, block->data(), size);
+    return Status::OK();
+  }
 };
 
 template <>
@@ -139,8 +187,72 @@ class BlocklikeTraits<UncompressionDict> {
   static uint32_t GetNumRestarts(const UncompressionDict& /* dict */) {
     return 0;
   }
+
+  static const Cache::CacheItemHelper* GetCacheItemHelper() {
+    static const Cache::CacheItemHelper kHelper{
+        nullptr, nullptr, &DeleteCachedEntry<UncompressionDict>, 0 /* tag */};
+    return &kHelper;
+  }
 };
 
+namespace {
+// Returns the helper of TBlocklike, tagged with block_type, so that the type
+// of a cached block can be told from the helper of its entry, see
+// BlockBasedTable::GetCachedBlockType().
+template <typename TBlocklike>
+const Cache::CacheItemHelper* GetCacheItemHelper(BlockType block_type) {
+  static const Cache::CacheItemHelper* const kBase =
+      BlocklikeTraits<TBlocklike>::GetCacheItemHelper();
+  static const Cache::CacheItemHelper kHelpers[kNumBlockTypes] = {
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kData)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kFilter)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kProperties)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kCompressionDictionary)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kRangeDeletion)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kHashIndexPrefixes)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kHashIndexMetadata)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kMetaIndex)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kIndex)},
+      {kBase->size_cb, kBase->saveto_cb, kBase->del_cb,
+       static_cast<uint32_t>(BlockType::kInvalid)},
+  };
+  static_assert(sizeof(kHelpers) / sizeof(kHelpers[0]) == kNumBlockTypes,
+                "A helper per block type");
+  assert(kHelpers[static_cast<size_t>(block_type)].tag ==
+         static_cast<uint32_t>(block_type));
+  return &kHelpers[static_cast<size_t>(block_type)];
+}
+}  // namespace
+
+BlockType BlockBasedTable::GetCachedBlockType(
+    const Cache::CacheItemHelper* helper) {
+  if (helper == nullptr || helper->tag >= kNumBlockTypes) {
+    return BlockType::kInvalid;
+  }
+  // The type is in the tag. Other cache users may use the same tags, so
+  // also check that the helper is one of ours.
+  const BlockType block_type = static_cast<BlockType>(helper->tag);
+  for (const Cache::CacheItemHelper* own :
+       {GetCacheItemHelper<BlockContents>(block_type),
+        GetCacheItemHelper<ParsedFullFilterBlock>(block_type),
+        GetCacheItemHelper<Block>(block_type),
+        GetCacheItemHelper<UncompressionDict>(block_type)}) {
+    if (helper == own) {
+      return block_type;
+    }
+  }
+  return BlockType::kInvalid;
+}
+
 namespace {
 // Read the block identified by "handle" from "file".
 // The only relevant option is options.verify_checksums for now.
@@ -175,13 +287,6 @@ Status ReadBlockFromFile(
   return s;
 }
 
-// Delete the entry resided in the cache.
-template <class Entry>
-void DeleteCachedEntry(const Slice& /*key*/, void* value) {
-  auto entry = reinterpret_cast<Entry*>(value);
-  delete entry;
-}
-
 // Release the cached entry and decrement its ref count.
 // Do not force erase
 void ReleaseCachedEntry(void* arg, void* h) {
@@ -426,8 +531,10 @@ void BlockBasedTable::UpdateCacheInsertionMetrics(BlockType block_type,
 
 Cache::Handle* BlockBasedTable::GetEntryFromCache(
     Cache* block_cache, const Slice& key, BlockType block_type,
-    GetContext* get_context) const {
-  auto cache_handle = block_cache->Lookup(key, rep_->ioptions.statistics);
+    GetContext* get_context, const Cache::CacheItemHelper* helper,
+    const Cache::CreateCallback& create_cb, Cache::Priority priority) const {
+  auto cache_handle = block_cache->LookupWithHelper(
+      key, helper, create_cb, priority, rep_->ioptions.statistics);
 
   if (cache_handle != nullptr) {
     UpdateCacheHitMetrics(block_type, get_context,
@@ -439,6 +546,15 @@ Cache::Handle* BlockBasedTable::GetEntryFromCache(
   return cache_handle;
 }
 
+Cache::Priority BlockBasedTable::GetCachePriority(BlockType block_type) const {
+  return rep_->table_options.cache_index_and_filter_blocks_with_high_priority &&
+                 (block_type == BlockType::kFilter ||
+                  block_type == BlockType::kCompressionDictionary ||
+                  block_type == BlockType::kIndex)
+             ? Cache::Priority::HIGH
+             : Cache::Priority::LOW;
+}
+
 // Helper function to setup the cache key's prefix for the Table.
 void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep) {
   assert(kMaxCacheKeyPrefixSize >= 10);
@@ -1186,11 +1302,31 @@ Status BlockBasedTable::GetDataBlockFromCache(
   Status s;
   BlockContents* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
+  Statistics* statistics = rep_->ioptions.statistics;
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
-    auto cache_handle = GetEntryFromCache(block_cache, block_cache_key,
-                                          block_type, get_context);
+    // Rebuilds a block saved to the secondary cache of block_cache. Captures
+    // few enough bytes for std::function not to allocate.
+    Cache::CreateCallback create_cb = [this, read_amp_bytes_per_bit](
+                                          const char* buf, size_t size,
+                                          void** out_obj,
+                                          size_t* charge) -> Status {
+      CacheAllocationPtr allocation =
+          AllocateBlock(size, GetMemoryAllocator(rep_->table_options));
+      memcpy(allocation.get(), buf, size);
+      TBlocklike* obj = BlocklikeTraits<TBlocklike>::Create(
+          BlockContents(std::move(allocation), size), read_amp_bytes_per_bit,
+          rep_->ioptions.statistics, rep_->blocks_definitely_zstd_compressed,
+          rep_->table_options.filter_policy.get());
+      *out_obj = obj;
+      *charge = obj->ApproximateMemoryUsage();
+      return Status::OK();
+    };
+    auto cache_handle = GetEntryFromCache(
+        block_cache, block_cache_key, block_type, get_context,
+        GetCacheItemHelper<TBlocklike>(block_type), create_cb,
+        GetCachePriority(block_type));
     if (cache_handle != nullptr) {
       block->SetCachedValue(
           reinterpret_cast<TBlocklike*>(block_cache->Value(cache_handle)),
@@ -1210,8 +1346,6 @@ Status BlockBasedTable::GetDataBlockFromCache(
   block_cache_compressed_handle =
       block_cache_compressed->Lookup(compressed_block_cache_key);
 
-  Statistics* statistics = rep_->ioptions.statistics;
-
   // if we found in the compressed cache, then uncompress and insert into
   // uncompressed cache
   if (block_cache_compressed_handle == nullptr) {
@@ -1247,8 +1381,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
         read_options.fill_cache) {
       size_t charge = block_holder->ApproximateMemoryUsage();
       Cache::Handle* cache_handle = nullptr;
-      s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                              &DeleteCachedEntry<TBlocklike>, &cache_handle);
+      s = block_cache->InsertWithHelper(
+          block_cache_key, block_holder.get(),
+          GetCacheItemHelper<TBlocklike>(block_type), charge,
+          &cache_handle);
       if (s.ok()) {
         assert(cache_handle != nullptr);
         block->SetCachedValue(block_holder.release(), block_cache,
@@ -1277,20 +1413,13 @@ Status BlockBasedTable::PutDataBlockToCache(
     CompressionType raw_block_comp_type,
     const UncompressionDict& uncompression_dict,
     MemoryAllocator* memory_allocator, BlockType block_type,
-    GetContext* get_context) const {
+    GetContext* get_context, Cache::Priority priority) const {
   const ImmutableCFOptions& ioptions = rep_->ioptions;
   const uint32_t format_version = rep_->table_options.format_version;
   const size_t read_amp_bytes_per_bit =
       block_type == BlockType::kData
           ? rep_->table_options.read_amp_bytes_per_bit
           : 0;
-  const Cache::Priority priority =
-      rep_->table_options.cache_index_and_filter_blocks_with_high_priority &&
-              (block_type == BlockType::kFilter ||
-               block_type == BlockType::kCompressionDictionary ||
-               block_type == BlockType::kIndex)
-          ? Cache::Priority::HIGH
-          : Cache::Priority::LOW;
   assert(cached_block);
   assert(cached_block->IsEmpty());
 
@@ -1352,9 +1481,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   if (block_cache != nullptr && block_holder->own_bytes()) {
     size_t charge = block_holder->ApproximateMemoryUsage();
     Cache::Handle* cache_handle = nullptr;
-    s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                            &DeleteCachedEntry<TBlocklike>, &cache_handle,
-                            priority);
+    s = block_cache->InsertWithHelper(
+        block_cache_key, block_holder.get(),
+        GetCacheItemHelper<TBlocklike>(block_type), charge,
+        &cache_handle, priority);
     if (s.ok()) {
       assert(cache_handle != nullptr);
       cached_block->SetCachedValue(block_holder.release(), block_cache,
@@ -1453,7 +1583,7 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
     const BlockHandle& handle, const UncompressionDict& uncompression_dict,
     CachableEntry<TBlocklike>* block_entry, BlockType block_type,
     GetContext* get_context, BlockCacheLookupContext* lookup_context,
-    BlockContents* contents) const {
+    BlockContents* contents, Cache::Priority priority) const {
   assert(block_entry != nullptr);
   const bool no_io = (ro.read_tier == kBlockCacheTier);
   Cache* block_cache = rep_->table_options.block_cache.get();
@@ -1541,7 +1671,8 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
         s = PutDataBlockToCache(
             key, ckey, block_cache, block_cache_compressed, block_entry,
             contents, raw_block_comp_type, uncompression_dict,
-            GetMemoryAllocator(rep_->table_options), block_type, get_context);
+            GetMemoryAllocator(rep_->table_options), block_type, get_context,
+            priority);
       }
     }
   }
@@ -1642,6 +1773,10 @@ void BlockBasedTable::RetrieveMultipleBlocks(
   const ImmutableCFOptions& ioptions = rep_->ioptions;
   size_t read_amp_bytes_per_bit = rep_->table_options.read_amp_bytes_per_bit;
   MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
+  // The blocks read fill the persistent cache, as in BlockFetcher
+  const PersistentCacheOptions& cache_options = rep_->persistent_cache_options;
+  PersistentCache* persistent_cache =
+      options.fill_cache ? cache_options.persistent_cache.get() : nullptr;
 
   if (ioptions.allow_mmap_reads) {
     size_t idx_in_batch = 0;
@@ -1811,6 +1946,13 @@ void BlockBasedTable::RetrieveMultipleBlocks(
             rep_->file->file_name(), handle.offset());
         TEST_SYNC_POINT_CALLBACK("RetrieveMultipleBlocks:VerifyChecksum", &s);
       }
+      if (s.ok() && persistent_cache != nullptr &&
+          persistent_cache->IsCompressed()) {
+        // insert to raw cache
+        PersistentCacheHelper::InsertRawPage(
+            cache_options, handle, req.result.data() + req_offset,
+            block_size(handle));
+      }
     } else if (!use_shared_buffer) {
       // Free the allocated scratch buffer.
       delete[] req.scratch;
@@ -1854,7 +1996,8 @@ void BlockBasedTable::RetrieveMultipleBlocks(
         s = MaybeReadBlockAndLoadToCache(
             nullptr, options, handle, uncompression_dict, block_entry,
             BlockType::kData, mget_iter->get_context,
-            &lookup_data_block_context, &raw_block_contents);
+            &lookup_data_block_context, &raw_block_contents,
+            GetCachePriority(BlockType::kData));
 
         // block_entry value could be null if no block cache is present, i.e
         // BlockBasedTableOptions::no_block_cache is true and no compressed
@@ -1862,6 +2005,13 @@ void BlockBasedTable::RetrieveMultipleBlocks(
         // through and set up the block explicitly
         if (block_entry->GetValue() != nullptr) {
           s.PermitUncheckedError();
+          if (persistent_cache != nullptr &&
+              !persistent_cache->IsCompressed()) {
+            const Block* block = block_entry->GetValue();
+            PersistentCacheHelper::InsertUncompressedPage(
+                cache_options, handle,
+                BlockContents(Slice(block->data(), block->size())));
+          }
           continue;
         }
       }
@@ -1885,6 +2035,11 @@ void BlockBasedTable::RetrieveMultipleBlocks(
         // block can be used directly.
         contents = std::move(raw_block_contents);
       }
+      if (s.ok() && persistent_cache != nullptr &&
+          !persistent_cache->IsCompressed()) {
+        PersistentCacheHelper::InsertUncompressedPage(cache_options, handle,
+                                                      contents);
+      }
       if (s.ok()) {
         (*results)[idx_in_batch].SetOwnedValue(new Block(
             std::move(contents), read_amp_bytes_per_bit, ioptions.statistics));
@@ -1894,6 +2049,114 @@ void BlockBasedTable::RetrieveMultipleBlocks(
   }
 }
 
+size_t BlockBasedTable::RetrieveMultipleBlocksFromPersistentCache(
+    const ReadOptions& options, const MultiGetRange* batch,
+    autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+    autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+    autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>* results,
+    const UncompressionDict& uncompression_dict) const {
+  const PersistentCacheOptions& cache_options = rep_->persistent_cache_options;
+  assert(cache_options.persistent_cache);
+  const bool raw_pages = cache_options.persistent_cache->IsCompressed();
+
+  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> idx_for_page;
+  autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> page_handles;
+  for (size_t i = 0; i < handles->size(); ++i) {
+    if (!(*handles)[i].IsNull()) {
+      idx_for_page.push_back(i);
+      page_handles.push_back((*handles)[i]);
+    }
+  }
+  if (page_handles.empty()) {
+    return 0;
+  }
+
+  const size_t num_pages = page_handles.size();
+  std::unique_ptr<char[]> pages[MultiGetContext::MAX_BATCH_SIZE];
+  size_t page_sizes[MultiGetContext::MAX_BATCH_SIZE];
+  Status page_statuses[MultiGetContext::MAX_BATCH_SIZE];
+  PersistentCacheHelper::MultiLookupPages(cache_options, num_pages,
+                                          &page_handles[0], pages, page_sizes,
+                                          page_statuses);
+
+  Cache* block_cache =
+      options.fill_cache ? rep_->table_options.block_cache.get() : nullptr;
+  Cache* block_cache_compressed =
+      options.fill_cache ? rep_->table_options.block_cache_compressed.get()
+                         : nullptr;
+  size_t bytes_found = 0;
+  auto mget_iter = batch->begin();
+  size_t idx_in_batch = 0;
+  for (size_t i = 0; i < num_pages; ++i) {
+    if (!page_statuses[i].ok()) {
+      continue;
+    }
+    const BlockHandle& handle = page_handles[i];
+    for (; idx_in_batch < idx_for_page[i]; ++idx_in_batch) {
+      ++mget_iter;
+    }
+
+    // Build the block as BlockFetcher does for a persistent cache hit
+    Status s;
+    BlockContents contents;
+    CompressionType compression_type = kNoCompression;
+    if (raw_pages) {
+      if (page_sizes[i] != block_size(handle)) {
+        continue;
+      }
+      if (options.verify_checksums) {
+        PERF_TIMER_GUARD(block_checksum_time);
+        s = ROCKSDB_NAMESPACE::VerifyBlockChecksum(
+            rep_->footer.checksum(), pages[i].get(), handle.size(),
+            rep_->file->file_name(), handle.offset());
+        if (!s.ok()) {
+          // read it from the file instead
+          continue;
+        }
+      }
+      contents = BlockContents(std::move(pages[i]), handle.size());
+#ifndef NDEBUG
+      contents.is_raw_block = true;
+#endif
+      compression_type = contents.get_compression_type();
+    } else {
+      contents = BlockContents(std::move(pages[i]), page_sizes[i]);
+    }
+
+    char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    char compressed_cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    Slice key;
+    Slice ckey;
+    if (block_cache != nullptr) {
+      key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                        handle, cache_key);
+    }
+    if (block_cache_compressed != nullptr) {
+      ckey = GetCacheKey(rep_->compressed_cache_key_prefix,
+                         rep_->compressed_cache_key_prefix_size, handle,
+                         compressed_cache_key);
+    }
+
+    // Without block caches the block is owned by the result
+    CachableEntry<Block>* block_entry = &(*results)[idx_for_page[i]];
+    s = PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
+                            block_entry, &contents, compression_type,
+                            uncompression_dict,
+                            GetMemoryAllocator(rep_->table_options),
+                            BlockType::kData, mget_iter->get_context,
+                            GetCachePriority(BlockType::kData));
+    if (!s.ok() || block_entry->GetValue() == nullptr) {
+      block_entry->Reset();
+      continue;
+    }
+
+    (*statuses)[idx_for_page[i]] = s;
+    (*handles)[idx_for_page[i]] = BlockHandle::NullBlockHandle();
+    bytes_found += block_size(handle);
+  }
+  return bytes_found;
+}
+
 template <typename TBlocklike>
 Status BlockBasedTable::RetrieveBlock(
     FilePrefetchBuffer* prefetch_buffer, const ReadOptions& ro,
@@ -1909,7 +2172,8 @@ Status BlockBasedTable::RetrieveBlock(
     s = MaybeReadBlockAndLoadToCache(prefetch_buffer, ro, handle,
                                      uncompression_dict, block_entry,
                                      block_type, get_context, lookup_context,
-                                     /*contents=*/nullptr);
+                                     /*contents=*/nullptr,
+                                     GetCachePriority(block_type));
 
     if (!s.ok()) {
       return s;
@@ -2197,6 +2461,10 @@ FragmentedRangeTombstoneIterator* BlockBasedTable::NewRangeTombstoneIterator(
   if (read_options.snapshot != nullptr) {
     snapshot = read_options.snapshot->GetSequenceNumber();
   }
+  if (snapshot < rep_->fragmented_range_dels->min_seqno()) {
+    // All of the file's tombstones were written after the snapshot.
+    return nullptr;
+  }
   return new FragmentedRangeTombstoneIterator(
       rep_->fragmented_range_dels, rep_->internal_comparator, snapshot);
 }
@@ -2615,11 +2883,20 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
         }
       }
 
+      const UncompressionDict& dict = uncompression_dict.GetValue()
+                                          ? *uncompression_dict.GetValue()
+                                          : UncompressionDict::GetEmptyDict();
+      if (total_len && rep_->persistent_cache_options.persistent_cache &&
+          !rep_->ioptions.allow_mmap_reads) {
+        // Look the blocks up in the persistent cache with one batched lookup,
+        // so that only its misses are read from the file
+        total_len -= RetrieveMultipleBlocksFromPersistentCache(
+            read_options, &data_block_range, &block_handles, &statuses,
+            &results, dict);
+      }
+
       if (total_len) {
         char* scratch = nullptr;
-        const UncompressionDict& dict = uncompression_dict.GetValue()
-                                            ? *uncompression_dict.GetValue()
-                                            : UncompressionDict::GetEmptyDict();
         assert(uncompression_dict_inited || !rep_->uncompression_dict_reader);
         assert(uncompression_dict_status.ok());
         // If using direct IO, then scratch is not used, so keep it nullptr.
@@ -2883,6 +3160,149 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+std::string BlockBasedTable::GetBlockCacheKeyPrefix() const {
+  if (rep_->table_options.block_cache == nullptr) {
+    return std::string();
+  }
+  return std::string(rep_->cache_key_prefix, rep_->cache_key_prefix_size);
+}
+
+Status BlockBasedTable::GetDataBlockHandles(
+    const ReadOptions& read_options, const std::vector<uint64_t>& offsets,
+    std::vector<BlockHandle>* handles) {
+  assert(std::is_sorted(offsets.begin(), offsets.end()));
+  if (offsets.empty()) {
+    return Status::OK();
+  }
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, /*need_upper_bound_check=*/false,
+                                &iiter_on_stack, /*get_context=*/nullptr,
+                                &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr = std::unique_ptr<InternalIteratorBase<IndexValue>>(iiter);
+  }
+  if (!iiter->status().ok()) {
+    // error opening index iterator
+    return iiter->status();
+  }
+
+  // Data blocks are written in index order, so the offsets of the index
+  // entries are increasing and can be merged with the sorted offsets.
+  auto offset = offsets.begin();
+  for (iiter->SeekToFirst(); iiter->Valid() && offset != offsets.end();
+       iiter->Next()) {
+    const BlockHandle& handle = iiter->value().handle;
+    while (offset != offsets.end() && *offset < handle.offset()) {
+      ++offset;
+    }
+    if (offset != offsets.end() && *offset == handle.offset()) {
+      handles->push_back(handle);
+      ++offset;
+    }
+  }
+  return iiter->status();
+}
+
+Status BlockBasedTable::WarmUpBlockCache(
+    const std::vector<BlockHandle>& handles, Cache::Priority priority,
+    RateLimiter* rate_limiter) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr) {
+    return Status::OK();
+  }
+  Statistics* statistics = rep_->ioptions.statistics;
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  const ReadOptions ro;
+  CachableEntry<UncompressionDict> uncompression_dict;
+  if (rep_->uncompression_dict_reader) {
+    Status s =
+        rep_->uncompression_dict_reader->GetOrReadUncompressionDictionary(
+            /*prefetch_buffer=*/nullptr, /*no_io=*/false,
+            /*get_context=*/nullptr, &lookup_context, &uncompression_dict);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const UncompressionDict& dict = uncompression_dict.GetValue()
+                                      ? *uncompression_dict.GetValue()
+                                      : UncompressionDict::GetEmptyDict();
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  for (const BlockHandle& handle : handles) {
+    Slice key = GetCacheKey(rep_->cache_key_prefix,
+                            rep_->cache_key_prefix_size, handle, cache_key);
+    Cache::Handle* cache_handle = block_cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+      continue;
+    }
+    if (rate_limiter != nullptr) {
+      size_t left = static_cast<size_t>(block_size(handle));
+      while (left > 0) {
+        left -= rate_limiter->RequestToken(left, 0 /* alignment */,
+                                           Env::IO_LOW, statistics,
+                                           RateLimiter::OpType::kRead);
+      }
+    }
+
+    // Load the block into the block cache, with the priority it had there
+    // rather than the one of data blocks.
+    CachableEntry<Block> block;
+    Status s = MaybeReadBlockAndLoadToCache(
+        /*prefetch_buffer=*/nullptr, ro, handle, dict, &block,
+        BlockType::kData, /*get_context=*/nullptr, &lookup_context,
+        /*contents=*/nullptr, priority);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status BlockBasedTable::ReadDataBlocksIntoCache(
+    const ReadOptions& ro, const std::vector<BlockHandle>& handles,
+    BlockCacheLookupContext* lookup_context) const {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  assert(block_cache != nullptr);
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  std::vector<BlockHandle> to_read;
+  for (const BlockHandle& handle : handles) {
+    Slice key = GetCacheKey(rep_->cache_key_prefix,
+                            rep_->cache_key_prefix_size, handle, cache_key);
+    Cache::Handle* cache_handle = block_cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+    } else {
+      to_read.push_back(handle);
+    }
+  }
+  if (to_read.empty()) {
+    return Status::OK();
+  }
+
+  // The buffer only lives until the blocks are in the cache.
+  FilePrefetchBuffer prefetch_buffer(rep_->file.get(), 0 /* readahead_size */,
+                                     0 /* max_readahead_size */);
+  IOOptions opts;
+  Status s = PrepareIOFromReadOptions(ro, rep_->file->env(), opts);
+  if (s.ok()) {
+    const uint64_t offset = to_read.front().offset();
+    s = prefetch_buffer.Prefetch(
+        opts, rep_->file.get(), offset,
+        static_cast<size_t>(to_read.back().offset() +
+                            block_size(to_read.back()) - offset));
+  }
+  for (size_t i = 0; s.ok() && i < to_read.size(); ++i) {
+    DataBlockIter biter;
+    NewDataBlockIterator<DataBlockIter>(
+        ro, to_read[i], &biter, BlockType::kData, /*get_context=*/nullptr,
+        lookup_context, Status(), &prefetch_buffer);
+    s = biter.status();
+  }
+  return s;
+}
+
 Status BlockBasedTable::VerifyChecksum(const ReadOptions& read_options,
                                        TableReaderCaller caller) {
   Status s;
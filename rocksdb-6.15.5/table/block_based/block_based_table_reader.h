@@ -175,6 +175,16 @@ class BlockBasedTable : public TableReader {
 
   size_t ApproximateMemoryUsage() const override;
 
+  std::string GetBlockCacheKeyPrefix() const override;
+
+  Status GetDataBlockHandles(const ReadOptions& read_options,
+                             const std::vector<uint64_t>& offsets,
+                             std::vector<BlockHandle>* handles) override;
+
+  Status WarmUpBlockCache(const std::vector<BlockHandle>& handles,
+                          Cache::Priority priority,
+                          RateLimiter* rate_limiter) override;
+
   // convert SST file to a human readable form
   Status DumpTable(WritableFile* out_file) override;
 
@@ -221,6 +231,11 @@ class BlockBasedTable : public TableReader {
                            size_t cache_key_prefix_size,
                            const BlockHandle& handle, char* cache_key);
 
+  // Returns the type of a block cached by a block based table from the
+  // helper of its cache entry, or BlockType::kInvalid if the entry is not
+  // such a block.
+  static BlockType GetCachedBlockType(const Cache::CacheItemHelper* helper);
+
   // Retrieve all key value pairs from data blocks in the table.
   // The key retrieved are internal keys.
   Status GetKVPairsFromDataBlocks(std::vector<KVPairBlock>* kv_pair_blocks);
@@ -253,6 +268,8 @@ class BlockBasedTable : public TableReader {
 
   friend class UncompressionDictReader;
 
+  friend class BlockPrefetcher;
+
  protected:
   Rep* rep_;
   explicit BlockBasedTable(Rep* rep, BlockCacheTracer* const block_cache_tracer)
@@ -281,9 +298,14 @@ class BlockBasedTable : public TableReader {
   void UpdateCacheInsertionMetrics(BlockType block_type,
                                    GetContext* get_context, size_t usage,
                                    bool redundant) const;
+  // Looks up key with helper and create_cb, see Cache::LookupWithHelper().
   Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
                                    BlockType block_type,
-                                   GetContext* get_context) const;
+                                   GetContext* get_context,
+                                   const Cache::CacheItemHelper* helper,
+                                   const Cache::CreateCallback& create_cb,
+                                   Cache::Priority priority) const;
+  Cache::Priority GetCachePriority(BlockType block_type) const;
 
   // Either Block::NewDataIterator() or Block::NewIndexIterator().
   template <typename TBlockIter>
@@ -301,13 +323,15 @@ class BlockBasedTable : public TableReader {
   // @param block_entry value is set to the uncompressed block if found. If
   //    in uncompressed block cache, also sets cache_handle to reference that
   //    block.
+  // @param priority The block cache priority of a block read from the file,
+  //    normally GetCachePriority(block_type).
   template <typename TBlocklike>
   Status MaybeReadBlockAndLoadToCache(
       FilePrefetchBuffer* prefetch_buffer, const ReadOptions& ro,
       const BlockHandle& handle, const UncompressionDict& uncompression_dict,
       CachableEntry<TBlocklike>* block_entry, BlockType block_type,
       GetContext* get_context, BlockCacheLookupContext* lookup_context,
-      BlockContents* contents) const;
+      BlockContents* contents, Cache::Priority priority) const;
 
   // Similar to the above, with one crucial difference: it will retrieve the
   // block from the file even if there are no caches configured (assuming the
@@ -329,6 +353,25 @@ class BlockBasedTable : public TableReader {
           results,
       char* scratch, const UncompressionDict& uncompression_dict) const;
 
+  // Looks up the data blocks of a MultiGet batch in the persistent cache with
+  // a single batched lookup. The blocks found are stored in results, and
+  // their handles replaced by null handles so that RetrieveMultipleBlocks()
+  // reads only the others. Returns the number of bytes found.
+  size_t RetrieveMultipleBlocksFromPersistentCache(
+      const ReadOptions& options, const MultiGetRange* batch,
+      autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+      autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+      autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>*
+          results,
+      const UncompressionDict& uncompression_dict) const;
+
+  // Reads the data blocks of `handles`, which are in file order, into the
+  // block cache with one read of the range they span. Blocks that are
+  // already cached are not read again.
+  Status ReadDataBlocksIntoCache(const ReadOptions& ro,
+                                 const std::vector<BlockHandle>& handles,
+                                 BlockCacheLookupContext* lookup_context) const;
+
   // Get the iterator from the index reader.
   //
   // If input_iter is not set, return a new Iterator.
@@ -371,6 +414,7 @@ class BlockBasedTable : public TableReader {
   // PutDataBlockToCache(). After the call, the object will be invalid.
   // @param uncompression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param priority The block cache priority of the block.
   template <typename TBlocklike>
   Status PutDataBlockToCache(const Slice& block_cache_key,
                              const Slice& compressed_block_cache_key,
@@ -380,8 +424,8 @@ class BlockBasedTable : public TableReader {
                              CompressionType raw_block_comp_type,
                              const UncompressionDict& uncompression_dict,
                              MemoryAllocator* memory_allocator,
-                             BlockType block_type,
-                             GetContext* get_context) const;
+                             BlockType block_type, GetContext* get_context,
+                             Cache::Priority priority) const;
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -63,4 +63,66 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
   readahead_size_ =
       std::min(BlockBasedTable::kMaxAutoReadaheadSize, readahead_size_ * 2);
 }
+
+void BlockPrefetcher::PrefetchIntoBlockCacheIfNeeded(
+    const BlockBasedTable* table, const ReadOptions& read_options,
+    const BlockHandle& handle, const Slice& index_key) {
+  const BlockBasedTable::Rep* rep = table->get_rep();
+  assert(read_options.block_cache_readahead_blocks > 0);
+  if (!read_options.fill_cache ||
+      read_options.read_tier == kBlockCacheTier ||
+      rep->table_options.block_cache == nullptr ||
+      rep->ioptions.allow_mmap_reads) {
+    return;
+  }
+  num_file_reads_++;
+  if (num_file_reads_ <=
+      BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
+    return;
+  }
+  if (handle.offset() >= block_cache_readahead_offset_ &&
+      handle.offset() + block_size(handle) <= block_cache_readahead_limit_) {
+    return;
+  }
+
+  if (readahead_index_iter_ == nullptr) {
+    readahead_index_iter_.reset(table->NewIndexIterator(
+        read_options, /*need_upper_bound_check=*/false,
+        /*input_iter=*/nullptr, /*get_context=*/nullptr,
+        &readahead_lookup_context_));
+  }
+  // After a sequential read of the blocks read ahead, the index iterator is
+  // already on the block.
+  if (!readahead_index_iter_->Valid() ||
+      readahead_index_iter_->value().handle.offset() != handle.offset()) {
+    if (rep->index_key_includes_seq) {
+      readahead_index_iter_->Seek(index_key);
+    } else {
+      IterKey seek_key;
+      seek_key.SetInternalKey(index_key, kMaxSequenceNumber,
+                              kValueTypeForSeek);
+      readahead_index_iter_->Seek(seek_key.GetInternalKey());
+    }
+    if (!readahead_index_iter_->Valid() ||
+        readahead_index_iter_->value().handle.offset() != handle.offset()) {
+      return;
+    }
+  }
+
+  std::vector<BlockHandle> handles;
+  for (; readahead_index_iter_->Valid() &&
+         handles.size() < read_options.block_cache_readahead_blocks;
+       readahead_index_iter_->Next()) {
+    handles.push_back(readahead_index_iter_->value().handle);
+  }
+  block_cache_readahead_offset_ = handle.offset();
+  block_cache_readahead_limit_ =
+      handles.back().offset() + block_size(handles.back());
+  // Discarding the status intentionally, as the blocks are read again from
+  // the file if they are not in the cache.
+  table
+      ->ReadDataBlocksIntoCache(read_options, handles,
+                                &readahead_lookup_context_)
+      .PermitUncheckedError();
+}
 }  // namespace ROCKSDB_NAMESPACE
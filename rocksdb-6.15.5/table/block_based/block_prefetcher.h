@@ -17,6 +17,13 @@ class BlockPrefetcher {
   void PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                         const BlockHandle& handle, size_t readahead_size,
                         bool is_for_compaction);
+  // Reads ahead ReadOptions::block_cache_readahead_blocks data blocks
+  // starting at `handle`, whose index entry has key `index_key`, into the
+  // block cache of `table`.
+  void PrefetchIntoBlockCacheIfNeeded(const BlockBasedTable* table,
+                                      const ReadOptions& read_options,
+                                      const BlockHandle& handle,
+                                      const Slice& index_key);
   FilePrefetchBuffer* prefetch_buffer() { return prefetch_buffer_.get(); }
 
  private:
@@ -28,5 +35,13 @@ class BlockPrefetcher {
   size_t readahead_limit_ = 0;
   int64_t num_file_reads_ = 0;
   std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
+
+  // For readahead into the block cache: the file range of the blocks last
+  // read ahead, and an index iterator positioned on the block after them.
+  uint64_t block_cache_readahead_offset_ = 0;
+  uint64_t block_cache_readahead_limit_ = 0;
+  BlockCacheLookupContext readahead_lookup_context_{
+      TableReaderCaller::kPrefetch};
+  std::unique_ptr<InternalIteratorBase<IndexValue>> readahead_index_iter_;
 };
 }  // namespace ROCKSDB_NAMESPACE
@@ -167,7 +167,7 @@ Status PartitionIndexReader::CacheDependencies(const ReadOptions& ro,
     s = table()->MaybeReadBlockAndLoadToCache(
         prefetch_buffer.get(), ro, handle, UncompressionDict::GetEmptyDict(),
         &block, BlockType::kIndex, /*get_context=*/nullptr, &lookup_context,
-        /*contents=*/nullptr);
+        /*contents=*/nullptr, table()->GetCachePriority(BlockType::kIndex));
 
     if (!s.ok()) {
       return s;
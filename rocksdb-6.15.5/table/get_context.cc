@@ -60,6 +60,9 @@ GetContext::GetContext(
       env_(env),
       seq_(seq),
       replay_log_(nullptr),
+      replay_log_seq_(kMaxSequenceNumber),
+      min_skipped_seq_(kMaxSequenceNumber),
+      max_visible_seq_(kMaxSequenceNumber),
       pinned_iters_mgr_(_pinned_iters_mgr),
       callback_(callback),
       do_merge_(do_merge),
@@ -219,11 +222,16 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
   if (ucmp_->CompareWithoutTimestamp(parsed_key.user_key, user_key_) == 0) {
     *matched = true;
     // If the value is not in the snapshot, skip it
-    if (!CheckCallback(parsed_key.sequence)) {
+    if (parsed_key.sequence > max_visible_seq_ ||
+        !CheckCallback(parsed_key.sequence)) {
+      min_skipped_seq_ = std::min(min_skipped_seq_, parsed_key.sequence);
       return true;  // to continue to the next seq
     }
 
     appendToReplayLog(replay_log_, parsed_key.type, value);
+    if (replay_log_ != nullptr && replay_log_seq_ == kMaxSequenceNumber) {
+      replay_log_seq_ = parsed_key.sequence;
+    }
 
     if (seq_ != nullptr) {
       // Set the sequence number if it is uninitialized
@@ -378,7 +386,8 @@ void GetContext::push_operand(const Slice& value, Cleanable* value_pinner) {
 }
 
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
-                         GetContext* get_context, Cleanable* value_pinner) {
+                         GetContext* get_context, Cleanable* value_pinner,
+                         SequenceNumber seq) {
 #ifndef ROCKSDB_LITE
   Slice s = replay_log;
   while (s.size()) {
@@ -390,17 +399,17 @@ void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
     (void)ret;
 
     bool dont_care __attribute__((__unused__));
-    // Since SequenceNumber is not stored and unknown, we will use
-    // kMaxSequenceNumber.
-    get_context->SaveValue(
-        ParsedInternalKey(user_key, kMaxSequenceNumber, type), value,
-        &dont_care, value_pinner);
+    // Unless the caller knows it, SequenceNumber is not stored and unknown,
+    // so we will use kMaxSequenceNumber.
+    get_context->SaveValue(ParsedInternalKey(user_key, seq, type), value,
+                           &dont_care, value_pinner);
   }
 #else   // ROCKSDB_LITE
   (void)replay_log;
   (void)user_key;
   (void)get_context;
   (void)value_pinner;
+  (void)seq;
   assert(false);
 #endif  // ROCKSDB_LITE
 }
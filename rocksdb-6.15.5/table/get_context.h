@@ -146,8 +146,27 @@ class GetContext {
 
   // If a non-null string is passed, all the SaveValue calls will be
   // logged into the string. The operations can then be replayed on
-  // another GetContext with replayGetContextLog.
-  void SetReplayLog(std::string* replay_log) { replay_log_ = replay_log; }
+  // another GetContext with replayGetContextLog. Setting a new log also
+  // resets the sequence numbers tracked by replay_log_seq() and
+  // min_skipped_seq().
+  void SetReplayLog(std::string* replay_log) {
+    replay_log_ = replay_log;
+    replay_log_seq_ = kMaxSequenceNumber;
+    min_skipped_seq_ = kMaxSequenceNumber;
+  }
+
+  // Entries with a sequence number larger than `seq` are skipped as if they
+  // were rejected by the read callback. Used to look at the versions of a
+  // key that are newer than the snapshot without returning them.
+  void SetMaxVisibleSeq(SequenceNumber seq) { max_visible_seq_ = seq; }
+
+  // Sequence number of the first entry appended to the replay log, or
+  // kMaxSequenceNumber if the log is empty.
+  SequenceNumber replay_log_seq() const { return replay_log_seq_; }
+
+  // Smallest sequence number of an entry for the user key that was skipped
+  // because it is not visible to this lookup, or kMaxSequenceNumber if none.
+  SequenceNumber min_skipped_seq() const { return min_skipped_seq_; }
 
   // Do we need to fetch the SequenceNumber for this key?
   bool NeedToReadSequence() const { return (seq_ != nullptr); }
@@ -188,6 +207,9 @@ class GetContext {
   // write to the key or kMaxSequenceNumber if unknown
   SequenceNumber* seq_;
   std::string* replay_log_;
+  SequenceNumber replay_log_seq_;
+  SequenceNumber min_skipped_seq_;
+  SequenceNumber max_visible_seq_;
   // Used to temporarily pin blocks when state_ == GetContext::kMerge
   PinnedIteratorsManager* pinned_iters_mgr_;
   ReadCallback* callback_;
@@ -204,9 +226,12 @@ class GetContext {
 
 // Call this to replay a log and bring the get_context up to date. The replay
 // log must have been created by another GetContext object, whose replay log
-// must have been set by calling GetContext::SetReplayLog().
+// must have been set by calling GetContext::SetReplayLog(). If the sequence
+// number of the logged entries is known it can be passed as `seq`, otherwise
+// kMaxSequenceNumber is reported.
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
                          GetContext* get_context,
-                         Cleanable* value_pinner = nullptr);
+                         Cleanable* value_pinner = nullptr,
+                         SequenceNumber seq = kMaxSequenceNumber);
 
 }  // namespace ROCKSDB_NAMESPACE
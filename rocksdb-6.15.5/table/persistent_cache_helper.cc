@@ -4,6 +4,9 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "table/persistent_cache_helper.h"
+
+#include <vector>
+
 #include "table/block_based/block_based_table_reader.h"
 #include "table/format.h"
 
@@ -113,4 +116,31 @@ Status PersistentCacheHelper::LookupUncompressedPage(
   return Status::OK();
 }
 
+void PersistentCacheHelper::MultiLookupPages(
+    const PersistentCacheOptions& cache_options, const size_t num_handles,
+    const BlockHandle* handles, std::unique_ptr<char[]>* data, size_t* sizes,
+    Status* statuses) {
+  assert(cache_options.persistent_cache);
+
+  // construct the page keys
+  const size_t kKeySize =
+      BlockBasedTable::kMaxCacheKeyPrefixSize + kMaxVarint64Length;
+  std::unique_ptr<char[]> cache_keys(new char[num_handles * kKeySize]);
+  std::vector<Slice> keys;
+  keys.reserve(num_handles);
+  for (size_t i = 0; i < num_handles; ++i) {
+    keys.push_back(BlockBasedTable::GetCacheKey(
+        cache_options.key_prefix.c_str(), cache_options.key_prefix.size(),
+        handles[i], cache_keys.get() + i * kKeySize));
+  }
+
+  // Lookup pages
+  cache_options.persistent_cache->MultiLookup(num_handles, keys.data(), data,
+                                              sizes, statuses);
+  for (size_t i = 0; i < num_handles; ++i) {
+    RecordTick(cache_options.statistics,
+               statuses[i].ok() ? PERSISTENT_CACHE_HIT : PERSISTENT_CACHE_MISS);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
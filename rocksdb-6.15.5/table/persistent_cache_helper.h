@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "monitoring/statistics.h"
@@ -39,6 +40,14 @@ class PersistentCacheHelper {
   static Status LookupUncompressedPage(
       const PersistentCacheOptions& cache_options, const BlockHandle& handle,
       BlockContents* contents);
+
+  // lookup a batch of blocks, from the raw page cache if the cache is
+  // compressed else from the uncompressed cache, with a single cache lookup
+  static void MultiLookupPages(const PersistentCacheOptions& cache_options,
+                               const size_t num_handles,
+                               const BlockHandle* handles,
+                               std::unique_ptr<char[]>* data, size_t* sizes,
+                               Status* statuses);
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -203,6 +203,26 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = new VectorRepFactory();
     }
+  } else if (opts_list[0] == "hash_index" ||
+             opts_list[0] == "HashIndexedSkipListRepFactory") {
+    // Expecting format
+    // hash_index:<hash_bucket_count>
+    if (2 == len) {
+      size_t hash_bucket_count = ParseSizeT(opts_list[1]);
+      mem_factory = NewHashIndexedSkipListRepFactory(hash_bucket_count);
+    } else if (1 == len) {
+      mem_factory = NewHashIndexedSkipListRepFactory();
+    }
+  } else if (opts_list[0] == "version_chain" ||
+             opts_list[0] == "VersionChainRepFactory") {
+    // Expecting format
+    // version_chain:<version_list_height>
+    if (2 == len) {
+      int32_t height = ParseInt(opts_list[1]);
+      mem_factory = NewVersionChainRepFactory(height);
+    } else if (1 == len) {
+      mem_factory = NewVersionChainRepFactory();
+    }
   } else if (opts_list[0] == "cuckoo") {
     return Status::NotSupported(
         "cuckoo hash memtable is not supported anymore.");
@@ -9,9 +9,13 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "db/range_tombstone_fragmenter.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/slice_transform.h"
+#include "table/format.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/multiget_context.h"
@@ -27,6 +31,7 @@ struct ReadOptions;
 struct TableProperties;
 class GetContext;
 class MultiGetContext;
+class RateLimiter;
 
 // A Table (also referred to as SST) is a sorted map from strings to strings.
 // Tables are immutable and persistent.  A Table may be safely accessed from
@@ -133,6 +138,30 @@ class TableReader {
     return Status::OK();
   }
 
+  // Returns the prefix of the block cache keys of this table's blocks, which
+  // the varint64-encoded block offset follows, or an empty string if the
+  // table doesn't keep its blocks in a block cache.
+  virtual std::string GetBlockCacheKeyPrefix() const { return std::string(); }
+
+  // Appends to *handles the handles of the data blocks that start at the
+  // given offsets, which must be sorted, in offset order. Offsets that don't
+  // start a data block are skipped.
+  virtual Status GetDataBlockHandles(const ReadOptions& /*read_options*/,
+                                     const std::vector<uint64_t>& /*offsets*/,
+                                     std::vector<BlockHandle>* /*handles*/) {
+    return Status::NotSupported("GetDataBlockHandles() not supported");
+  }
+
+  // Loads the data blocks of `handles`, as returned by GetDataBlockHandles(),
+  // into the block cache with the given priority, skipping the ones that are
+  // already there. If rate_limiter is not null, the bytes of each block read
+  // are requested from it first.
+  virtual Status WarmUpBlockCache(const std::vector<BlockHandle>& /*handles*/,
+                                  Cache::Priority /*priority*/,
+                                  RateLimiter* /*rate_limiter*/) {
+    return Status::NotSupported("WarmUpBlockCache() not supported");
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* /*out_file*/) {
     return Status::NotSupported("DumpTable() not supported");
@@ -546,6 +546,25 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_bool(row_cache_snapshot_aware,
+            ROCKSDB_NAMESPACE::Options().row_cache_snapshot_aware,
+            "If true, row cache entries record the snapshots they are "
+            "visible to, so snapshot reads can be served from the row cache.");
+
+DEFINE_uint64(hot_key_cache_size,
+              ROCKSDB_NAMESPACE::Options().hot_key_cache_size,
+              "If non-zero, serve Get() of about this many of the most read "
+              "keys of each column family from an in-memory cache.");
+
+DEFINE_uint64(block_cache_warmup_period_sec,
+              ROCKSDB_NAMESPACE::Options().block_cache_warmup_period_sec,
+              "If non-zero, save the data blocks in the block cache every this "
+              "many seconds and on close, and load them back on open.");
+
+DEFINE_int64(block_cache_warmup_rate_limit, 0,
+             "If non-zero, limit the block cache warm-up reads to this many "
+             "bytes per second.");
+
 DEFINE_int32(open_files, ROCKSDB_NAMESPACE::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -1029,6 +1048,10 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_uint64(wal_streams, ROCKSDB_NAMESPACE::Options().wal_streams,
+              "Number of WAL files written side by side. Values above 1 "
+              "need --enable_pipelined_write=false");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
@@ -1299,6 +1322,8 @@ enum RepFactory {
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
+  kVersionChain,
+  kHashIndex,
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1312,6 +1337,10 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kVectorRep;
   else if (!strcasecmp(ctype, "hash_linkedlist"))
     return kHashLinkedList;
+  else if (!strcasecmp(ctype, "version_chain"))
+    return kVersionChain;
+  else if (!strcasecmp(ctype, "hash_index"))
+    return kHashIndex;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1340,6 +1369,9 @@ DEFINE_int32(skip_list_lookahead, 0, "Used with skip_list memtablerep; try "
 DEFINE_bool(report_file_operations, false, "if report number of file "
             "operations");
 DEFINE_int32(readahead_size, 0, "Iterator readahead size");
+DEFINE_int32(block_cache_readahead_blocks, 0,
+             "Number of data blocks iterators read ahead into the block "
+             "cache");
 
 DEFINE_bool(read_with_latest_user_timestamp, true,
             "If true, always use the current latest timestamp for read. If "
@@ -2512,6 +2544,12 @@ class Benchmark {
       case kHashLinkedList:
         fprintf(stdout, "Memtablerep: hash_linkedlist\n");
         break;
+      case kVersionChain:
+        fprintf(stdout, "Memtablerep: version_chain\n");
+        break;
+      case kHashIndex:
+        fprintf(stdout, "Memtablerep: hash_index\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -3716,6 +3754,13 @@ class Benchmark {
           new VectorRepFactory
         );
         break;
+      case kVersionChain:
+        options.memtable_factory.reset(NewVersionChainRepFactory());
+        break;
+      case kHashIndex:
+        options.memtable_factory.reset(
+            NewHashIndexedSkipListRepFactory(FLAGS_hash_bucket_count));
+        break;
 #else
       default:
         fprintf(stderr, "Only skip list is supported in lite mode\n");
@@ -3944,6 +3989,7 @@ class Benchmark {
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
     options.unordered_write = FLAGS_unordered_write;
+    options.wal_streams = static_cast<size_t>(FLAGS_wal_streams);
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.rate_limit_delay_max_milliseconds =
@@ -4062,6 +4108,7 @@ class Benchmark {
       } else {
         options.row_cache = NewLRUCache(FLAGS_row_cache_size);
       }
+      options.row_cache_snapshot_aware = FLAGS_row_cache_snapshot_aware;
     }
     if (FLAGS_enable_io_prio) {
       FLAGS_env->LowerThreadPoolIOPriority(Env::LOW);
@@ -4092,6 +4139,16 @@ class Benchmark {
           FLAGS_rate_limiter_auto_tuned));
     }
 
+    options.hot_key_cache_size = static_cast<size_t>(FLAGS_hot_key_cache_size);
+    options.block_cache_warmup_period_sec =
+        static_cast<unsigned int>(FLAGS_block_cache_warmup_period_sec);
+    if (FLAGS_block_cache_warmup_rate_limit > 0) {
+      options.block_cache_warmup_rate_limiter.reset(NewGenericRateLimiter(
+          FLAGS_block_cache_warmup_rate_limit,
+          100 * 1000 /* refill_period_us */, 10 /* fairness */,
+          RateLimiter::Mode::kReadsOnly));
+    }
+
     options.listeners.emplace_back(listener_);
     if (FLAGS_num_multi_db <= 1) {
       OpenDb(options, FLAGS_db, &db_);
@@ -5779,6 +5836,7 @@ class Benchmark {
     options.prefix_same_as_start = FLAGS_prefix_same_as_start;
     options.tailing = FLAGS_use_tailing_iterator;
     options.readahead_size = FLAGS_readahead_size;
+    options.block_cache_readahead_blocks = FLAGS_block_cache_readahead_blocks;
     std::unique_ptr<char[]> ts_guard;
     Slice ts;
     if (user_timestamp_size_ > 0) {
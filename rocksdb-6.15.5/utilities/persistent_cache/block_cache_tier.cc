@@ -6,6 +6,7 @@
 
 #include "utilities/persistent_cache/block_cache_tier.h"
 
+#include <algorithm>
 #include <regex>
 #include <utility>
 #include <vector>
@@ -14,6 +15,7 @@
 #include "port/port.h"
 #include "test_util/sync_point.h"
 #include "util/stop_watch.h"
+#include "util/string_util.h"
 #include "utilities/persistent_cache/block_cache_tier_file.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -47,7 +49,20 @@ Status BlockCacheTier::Open() {
   // Create base/<cache dir> directory
   status = opt_.env->CreateDir(GetCachePath());
   if (!status.ok()) {
-    // directory already exists, clean it up
+    // directory already exists, rebuild the index from the manifest if we
+    // restart warm
+    if (opt_.enable_warm_restart) {
+      status = LoadManifest();
+      if (!status.ok()) {
+        Info(opt_.log, "Unable to load manifest, starting cold. %s",
+             status.ToString().c_str());
+        metadata_.Clear();
+        size_ = 0;
+        writer_cache_id_ = 0;
+      }
+    }
+
+    // clean up the files that are not in the index
     status = CleanupCacheFolder(GetCachePath());
     assert(status.ok());
     if (!status.ok()) {
@@ -98,10 +113,25 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
     return status;
   }
 
-  // cleanup files with the patter :digi:.rc
+  // cleanup files with the patter :digi:.rc, and the manifest which is only
+  // valid for the restart that loaded it
   for (auto file : files) {
     if (IsCacheFile(file)) {
-      // cache file
+      // cache file, keep it if it was restored from the manifest
+      Slice id_str(file);
+      uint64_t cache_id = 0;
+      if (ConsumeDecimalNumber(&id_str, &cache_id) && id_str == ".rc" &&
+          cache_id <= port::kMaxUint32) {
+        BlockCacheFile* const f =
+            metadata_.Lookup(static_cast<uint32_t>(cache_id));
+        if (f) {
+          --f->refs_;
+          continue;
+        }
+      }
+    }
+
+    if (IsCacheFile(file) || file == "MANIFEST") {
       Info(opt_.log, "Removing file %s.", file.c_str());
       status = opt_.env->DeleteFile(folder + "/" + file);
       if (!status.ok()) {
@@ -124,12 +154,185 @@ Status BlockCacheTier::Close() {
     insert_th_.join();
   }
 
+  // let the writer finish the files that are full so that they can be
+  // restored, unless it is stuck (e.g. unable to reserve space)
+  if (opt_.enable_warm_restart) {
+    for (size_t i = 0; i < kMaxFlushWaits && HasUnflushedFullFiles(); ++i) {
+      /* sleep override */
+      Env::Default()->SleepForMicroseconds(10 * 1000);
+    }
+  }
+
   // stop the writer before
   writer_.Stop();
 
-  // clear all metadata
   WriteLock _(&lock_);
+  if (opt_.enable_warm_restart && cache_file_) {
+    Status status = WriteManifest();
+    if (!status.ok()) {
+      Error(opt_.log, "Error writing manifest. %s", status.ToString().c_str());
+    }
+  }
+
+  // clear all metadata
   metadata_.Clear();
+  cache_file_ = nullptr;
+  return Status::OK();
+}
+
+bool BlockCacheTier::HasUnflushedFullFiles() {
+  WriteLock _(&lock_);
+  bool found = false;
+  for (uint32_t cache_id = 0; cache_id < writer_cache_id_; ++cache_id) {
+    BlockCacheFile* const f = metadata_.Lookup(cache_id);
+    if (!f) {
+      continue;
+    }
+    // all the files but the current one are full
+    if (!f->IsFlushed() && (f != cache_file_ || cache_file_->Eof())) {
+      found = true;
+    }
+    --f->refs_;
+  }
+  return found;
+}
+
+//
+// Manifest
+//
+// The manifest lists the records of the cache files that are fully written
+//
+// +---------+-----------+----------------+-----+----------------+-----+
+// | next id | num files | file 0         | ... | file n - 1     | crc |
+// +---------+-----------+----------------+-----+----------------+-----+
+//
+// file = cache id, num records, (key hash, offset, size) of each record
+//
+// The keys of the records may embed ids from NewId(), e.g. the cache key
+// prefixes of tables whose files have no unique id. The next id is saved so
+// that ids handed out after a restart never match the restored keys.
+//
+Status BlockCacheTier::WriteManifest() {
+  lock_.AssertHeld();
+
+  // cache files are numbered sequentially, so we can find the live ones
+  // without walking the cache file index
+  std::vector<BlockCacheFile*> files;
+  for (uint32_t cache_id = 0; cache_id < writer_cache_id_; ++cache_id) {
+    BlockCacheFile* const f = metadata_.Lookup(cache_id);
+    if (!f) {
+      // evicted
+      continue;
+    }
+    if (f->IsFlushed()) {
+      files.push_back(f);
+    } else {
+      // the buffered data is not saved
+      --f->refs_;
+    }
+  }
+
+  std::string data;
+  PutVarint64(&data, next_id());
+  PutVarint32(&data, static_cast<uint32_t>(files.size()));
+  for (BlockCacheFile* f : files) {
+    PutVarint32(&data, f->cacheid());
+    PutVarint32(&data, static_cast<uint32_t>(f->block_infos().size()));
+    for (BlockInfo* binfo : f->block_infos()) {
+      PutFixed64(&data, binfo->key_hash_);
+      PutVarint32(&data, binfo->lba_.off_);
+      PutVarint32(&data, binfo->lba_.size_);
+    }
+    --f->refs_;
+  }
+  PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+
+  Info(opt_.log, "Writing manifest with %" ROCKSDB_PRIszt " files",
+       files.size());
+  return WriteStringToFile(opt_.env, data, GetManifestPath(),
+                           /*should_sync=*/true);
+}
+
+Status BlockCacheTier::LoadManifest() {
+  lock_.AssertHeld();
+
+  std::string data;
+  Status status = ReadFileToString(opt_.env, GetManifestPath(), &data);
+  if (!status.ok()) {
+    return status;
+  }
+
+  if (data.size() < sizeof(uint32_t)) {
+    return Status::Corruption("blockcache: truncated manifest");
+  }
+  Slice input(data.data(), data.size() - sizeof(uint32_t));
+  const uint32_t crc = DecodeFixed32(data.data() + input.size());
+  if (crc32c::Unmask(crc) != crc32c::Value(input.data(), input.size())) {
+    return Status::Corruption("blockcache: manifest checksum mismatch");
+  }
+
+  // parse the whole manifest before changing the index
+  std::vector<std::pair<uint32_t, std::vector<BlockInfo>>> files;
+  uint64_t saved_next_id = 0;
+  uint32_t num_files = 0;
+  if (!GetVarint64(&input, &saved_next_id) ||
+      !GetVarint32(&input, &num_files)) {
+    return Status::Corruption("blockcache: bad manifest");
+  }
+  for (uint32_t i = 0; i < num_files; ++i) {
+    uint32_t cache_id = 0;
+    uint32_t num_blocks = 0;
+    if (!GetVarint32(&input, &cache_id) || !GetVarint32(&input, &num_blocks)) {
+      return Status::Corruption("blockcache: bad manifest");
+    }
+    files.emplace_back(cache_id, std::vector<BlockInfo>());
+    for (uint32_t j = 0; j < num_blocks; ++j) {
+      uint64_t key_hash = 0;
+      uint32_t off = 0;
+      uint32_t size = 0;
+      if (!GetFixed64(&input, &key_hash) || !GetVarint32(&input, &off) ||
+          !GetVarint32(&input, &size)) {
+        return Status::Corruption("blockcache: bad manifest");
+      }
+      files.back().second.emplace_back(key_hash, LBA(cache_id, off, size));
+    }
+  }
+
+  SkipIdsBelow(saved_next_id);
+  size_t num_restored = 0;
+  for (auto& entry : files) {
+    const uint32_t cache_id = entry.first;
+    std::unique_ptr<RandomAccessCacheFile> f(new RandomAccessCacheFile(
+        opt_.env, GetCachePath(), cache_id, opt_.log));
+    uint64_t file_size = 0;
+    if (!opt_.env->GetFileSize(f->Path(), &file_size).ok() ||
+        size_ + file_size > opt_.cache_size ||
+        !f->Open(opt_.enable_direct_reads)) {
+      // the file will be cleaned up
+      continue;
+    }
+
+    RandomAccessCacheFile* const file = f.release();
+    status = metadata_.Insert(file) ? Status::OK()
+                                    : Status::IOError("Duplicate cache file");
+    if (!status.ok()) {
+      delete file;
+      return status;
+    }
+    for (const BlockInfo& binfo : entry.second) {
+      BlockInfo* const info = metadata_.Insert(binfo.key_hash_, binfo.lba_);
+      if (info) {
+        file->Add(info);
+      }
+    }
+
+    size_ += file_size;
+    writer_cache_id_ = std::max(writer_cache_id_, cache_id + 1);
+    num_restored++;
+  }
+
+  Info(opt_.log, "Restored %" ROCKSDB_PRIszt " cache files from manifest",
+       num_restored);
   return Status::OK();
 }
 
@@ -163,6 +366,10 @@ PersistentCache::StatsType BlockCacheTier::Stats() {
       stats_.read_hit_latency_.Average());
   Add(&stats, "persistentcache.blockcachetier.read_miss_latency",
       stats_.read_miss_latency_.Average());
+  Add(&stats, "persistentcache.blockcachetier.multi_read_latency",
+      stats_.multi_read_latency_.Average());
+  Add(&stats, "persistentcache.blockcachetier.multi_read_batch_size",
+      stats_.multi_read_batch_size_.Average());
   Add(&stats, "persistentcache.blockcachetier.write_latency",
       stats_.write_latency_.Average());
 
@@ -300,7 +507,12 @@ Status BlockCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* val,
     return Status::NotFound("blockcache: error reading data");
   }
 
-  assert(blk_key == key);
+  if (blk_key != key) {
+    // the index only keeps key hashes, and the record belongs to another key
+    stats_.cache_misses_++;
+    stats_.read_miss_latency_.Add(timer.ElapsedNanos() / 1000);
+    return Status::NotFound("blockcache: key not found");
+  }
 
   val->reset(new char[blk_val.size()]);
   memcpy(val->get(), blk_val.data(), blk_val.size());
@@ -313,12 +525,134 @@ Status BlockCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* val,
   return Status::OK();
 }
 
+void BlockCacheTier::MultiLookup(const size_t num_keys, const Slice* keys,
+                                 std::unique_ptr<char[]>* data, size_t* sizes,
+                                 Status* statuses) {
+  StopWatchNano timer(opt_.env, /*auto_start=*/ true);
+
+  // Locate the records, pinning the files that hold them
+  struct RecordRead {
+    size_t key_idx;
+    LBA lba;
+    BlockCacheFile* file;
+  };
+  std::vector<RecordRead> reads;
+  reads.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    LBA lba;
+    BlockCacheFile* file = nullptr;
+    if (metadata_.Lookup(keys[i], &lba)) {
+      file = metadata_.Lookup(lba.cache_id_);
+    }
+    if (!file) {
+      stats_.cache_misses_++;
+      statuses[i] = Status::NotFound("blockcache: key not found");
+      continue;
+    }
+    assert(file->refs_);
+    reads.push_back({i, lba, file});
+  }
+
+  // Read the records of each file with one request, in offset order
+  std::sort(reads.begin(), reads.end(),
+            [](const RecordRead& lhs, const RecordRead& rhs) {
+              return lhs.lba.cache_id_ != rhs.lba.cache_id_
+                         ? lhs.lba.cache_id_ < rhs.lba.cache_id_
+                         : lhs.lba.off_ < rhs.lba.off_;
+            });
+  size_t start = 0;
+  while (start < reads.size()) {
+    BlockCacheFile* const file = reads[start].file;
+    size_t end = start;
+    while (end < reads.size() && reads[end].file == file) {
+      ++end;
+    }
+
+    // the same record can be read for more than one key
+    std::vector<LBA> lbas;
+    std::vector<size_t> record_idx;
+    size_t total_size = 0;
+    for (size_t i = start; i < end; ++i) {
+      if (lbas.empty() || lbas.back().off_ != reads[i].lba.off_) {
+        lbas.push_back(reads[i].lba);
+        total_size += reads[i].lba.size_;
+      }
+      record_idx.push_back(lbas.size() - 1);
+    }
+
+    std::unique_ptr<char[]> scratch(new char[total_size]);
+    std::vector<char*> scratches;
+    char* p = scratch.get();
+    for (const LBA& lba : lbas) {
+      scratches.push_back(p);
+      p += lba.size_;
+    }
+    std::vector<Slice> blk_keys(lbas.size());
+    std::vector<Slice> blk_vals(lbas.size());
+    std::unique_ptr<bool[]> oks(new bool[lbas.size()]);
+    file->MultiRead(lbas.data(), lbas.size(), blk_keys.data(), blk_vals.data(),
+                    scratches.data(), oks.get());
+    stats_.multi_read_batch_size_.Add(lbas.size());
+
+    for (size_t i = start; i < end; ++i) {
+      const size_t key_idx = reads[i].key_idx;
+      const size_t rec = record_idx[i - start];
+      --file->refs_;
+      if (!oks[rec]) {
+        stats_.cache_misses_++;
+        stats_.cache_errors_++;
+        statuses[key_idx] = Status::NotFound("blockcache: error reading data");
+        continue;
+      }
+      if (blk_keys[rec] != keys[key_idx]) {
+        stats_.cache_misses_++;
+        statuses[key_idx] = Status::NotFound("blockcache: key not found");
+        continue;
+      }
+      const Slice& blk_val = blk_vals[rec];
+      data[key_idx].reset(new char[blk_val.size()]);
+      memcpy(data[key_idx].get(), blk_val.data(), blk_val.size());
+      sizes[key_idx] = blk_val.size();
+      statuses[key_idx] = Status::OK();
+      stats_.bytes_read_.Add(blk_val.size());
+      stats_.cache_hits_++;
+    }
+    start = end;
+  }
+
+  stats_.multi_read_latency_.Add(timer.ElapsedNanos() / 1000);
+}
+
 bool BlockCacheTier::Erase(const Slice& key) {
   WriteLock _(&lock_);
-  BlockInfo* info = metadata_.Remove(key);
-  assert(info);
+  LBA lba;
+  if (!metadata_.Lookup(key, &lba)) {
+    return false;
+  }
+  BlockCacheFile* const file = metadata_.Lookup(lba.cache_id_);
+  if (!file) {
+    return false;
+  }
+
+  // the index only keeps key hashes, so make sure the record belongs to the
+  // key before removing it
+  std::unique_ptr<char[]> scratch(new char[lba.size_]);
+  Slice blk_key;
+  Slice blk_val;
+  if (!file->Read(lba, &blk_key, &blk_val, scratch.get()) || blk_key != key) {
+    --file->refs_;
+    return false;
+  }
+
+  BlockInfo* const info = metadata_.Remove(key);
+  const bool erased = info != nullptr;
+  if (erased) {
+    // unlink from the file so that eviction and the manifest don't see it
+    file->Remove(info);
+  }
+  --file->refs_;
   delete info;
-  return true;
+  return erased;
 }
 
 Status BlockCacheTier::NewCacheFile() {
@@ -60,6 +60,9 @@ class BlockCacheTier : public PersistentCacheTier {
   Status Insert(const Slice& key, const char* data, const size_t size) override;
   Status Lookup(const Slice& key, std::unique_ptr<char[]>* data,
                 size_t* size) override;
+  void MultiLookup(const size_t num_keys, const Slice* keys,
+                   std::unique_ptr<char[]>* data, size_t* sizes,
+                   Status* statuses) override;
   Status Open() override;
   Status Close() override;
   bool Erase(const Slice& key) override;
@@ -83,6 +86,8 @@ class BlockCacheTier : public PersistentCacheTier {
   static const size_t kEvictPct = 10;
   // Max attempts to insert key, value to cache in pipelined mode
   static const size_t kMaxRetry = 3;
+  // Max number of 10ms waits for the full files to be flushed on close
+  static const size_t kMaxFlushWaits = 1000;
 
   // Pipelined operation
   struct InsertOp {
@@ -111,8 +116,16 @@ class BlockCacheTier : public PersistentCacheTier {
   Status NewCacheFile();
   // Get cache directory path
   std::string GetCachePath() const { return opt_.path + "/cache"; }
-  // Cleanup folder
+  // Get manifest path
+  std::string GetManifestPath() const { return GetCachePath() + "/MANIFEST"; }
+  // Cleanup folder, keeping the cache files in the index
   Status CleanupCacheFolder(const std::string& folder);
+  // Check for full cache files that are not completely written yet
+  bool HasUnflushedFullFiles();
+  // Save the index of the flushed cache files to the manifest
+  Status WriteManifest();
+  // Rebuild the index from the manifest
+  Status LoadManifest();
 
   // Statistics
   struct Statistics {
@@ -121,6 +134,8 @@ class BlockCacheTier : public PersistentCacheTier {
     HistogramImpl bytes_read_;
     HistogramImpl read_hit_latency_;
     HistogramImpl read_miss_latency_;
+    HistogramImpl multi_read_latency_;
+    HistogramImpl multi_read_batch_size_;
     HistogramImpl write_latency_;
     std::atomic<uint64_t> cache_hits_{0};
     std::atomic<uint64_t> cache_misses_{0};
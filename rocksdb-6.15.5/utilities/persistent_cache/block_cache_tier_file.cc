@@ -9,6 +9,7 @@
 #ifndef OS_WIN
 #include <unistd.h>
 #endif
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -248,6 +249,48 @@ bool RandomAccessCacheFile::Read(const LBA& lba, Slice* key, Slice* val,
   return ParseRec(lba, key, val, scratch);
 }
 
+void RandomAccessCacheFile::MultiRead(const LBA* lbas, const size_t num,
+                                      Slice* keys, Slice* vals,
+                                      char* const* scratches, bool* oks) {
+  ReadLock _(&rwlock_);
+
+  if (!freader_) {
+    std::fill(oks, oks + num, false);
+    return;
+  }
+
+  std::vector<FSReadRequest> reqs(num);
+  for (size_t i = 0; i < num; ++i) {
+    assert(lbas[i].cache_id_ == cache_id_);
+    assert(i == 0 || lbas[i - 1].off_ + lbas[i - 1].size_ <= lbas[i].off_);
+    reqs[i].offset = lbas[i].off_;
+    reqs[i].len = lbas[i].size_;
+    reqs[i].scratch = scratches[i];
+  }
+
+  // In direct IO mode the results point into aligned_buf
+  AlignedBuf aligned_buf;
+  Status s = freader_->MultiRead(IOOptions(), reqs.data(), num,
+                                 freader_->use_direct_io() ? &aligned_buf
+                                                           : nullptr);
+  if (!s.ok()) {
+    Error(log_, "Error reading from file %s. %s", Path().c_str(),
+          s.ToString().c_str());
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    const FSReadRequest& req = reqs[i];
+    oks[i] = s.ok() && req.status.ok() && req.result.size() == lbas[i].size_;
+    if (!oks[i]) {
+      continue;
+    }
+    if (req.result.data() != scratches[i]) {
+      memcpy(scratches[i], req.result.data(), req.result.size());
+    }
+    oks[i] = ParseRec(lbas[i], &keys[i], &vals[i], scratches[i]);
+  }
+}
+
 bool RandomAccessCacheFile::ParseRec(const LBA& lba, Slice* key, Slice* val,
                                      char* scratch) {
   Slice data(scratch, lba.size_);
@@ -117,6 +117,18 @@ class BlockCacheFile : public LRUElement<BlockCacheFile> {
     return false;
   }
 
+  // read a batch of records, sorted by offset, and return the key, value and
+  // status of each. scratches[i] must hold lbas[i].size_ bytes
+  virtual void MultiRead(const LBA* lbas, const size_t num, Slice* keys,
+                         Slice* vals, char* const* scratches, bool* oks) {
+    for (size_t i = 0; i < num; ++i) {
+      oks[i] = Read(lbas[i], &keys[i], &vals[i], scratches[i]);
+    }
+  }
+
+  // true if all the records of the file are on disk
+  virtual bool IsFlushed() { return true; }
+
   // get file path
   std::string Path() const {
     return dir_ + "/" + std::to_string(cache_id_) + ".rc";
@@ -129,6 +141,11 @@ class BlockCacheFile : public LRUElement<BlockCacheFile> {
     WriteLock _(&rwlock_);
     block_infos_.push_back(binfo);
   }
+  // Remove block information from file data
+  virtual void Remove(BlockInfo* binfo) {
+    WriteLock _(&rwlock_);
+    block_infos_.remove(binfo);
+  }
   // get block information
   std::list<BlockInfo*>& block_infos() { return block_infos_; }
   // delete file and return the size of the file
@@ -159,6 +176,9 @@ class RandomAccessCacheFile : public BlockCacheFile {
   bool Open(const bool enable_direct_reads);
   // read data from the disk
   bool Read(const LBA& lba, Slice* key, Slice* block, char* scratch) override;
+  // read a batch of records from the disk with a single request
+  void MultiRead(const LBA* lbas, const size_t num, Slice* keys, Slice* vals,
+                 char* const* scratches, bool* oks) override;
 
  private:
   std::unique_ptr<RandomAccessFileReader> freader_;
@@ -203,6 +223,25 @@ class WriteableCacheFile : public RandomAccessCacheFile {
     return ReadBuffer(lba, key, block, scratch);
   }
 
+  // read a batch of records from logical file
+  void MultiRead(const LBA* lbas, const size_t num, Slice* keys, Slice* vals,
+                 char* const* scratches, bool* oks) override {
+    ReadLock _(&rwlock_);
+    const bool closed = eof_ && bufs_.empty();
+    if (closed) {
+      RandomAccessCacheFile::MultiRead(lbas, num, keys, vals, scratches, oks);
+      return;
+    }
+    for (size_t i = 0; i < num; ++i) {
+      oks[i] = ReadBuffer(lbas[i], &keys[i], &vals[i], scratches[i]);
+    }
+  }
+
+  bool IsFlushed() override {
+    ReadLock _(&rwlock_);
+    return eof_ && bufs_.empty();
+  }
+
   // append data to end of file
   bool Append(const Slice&, const Slice&, LBA* const) override;
   // End-of-file
@@ -37,7 +37,12 @@ void BlockCacheTierMetadata::Clear() {
 }
 
 BlockInfo* BlockCacheTierMetadata::Insert(const Slice& key, const LBA& lba) {
-  std::unique_ptr<BlockInfo> binfo(new BlockInfo(key, lba));
+  return Insert(GetSliceHash64(key), lba);
+}
+
+BlockInfo* BlockCacheTierMetadata::Insert(const uint64_t key_hash,
+                                          const LBA& lba) {
+  std::unique_ptr<BlockInfo> binfo(new BlockInfo(key_hash, lba));
   if (!block_index_.Insert(binfo.get())) {
     return nullptr;
   }
@@ -53,7 +58,7 @@ bool BlockCacheTierMetadata::Lookup(const Slice& key, LBA* lba) {
   }
 
   ReadUnlock _(rlock);
-  assert(block->key_ == key.ToString());
+  assert(block->key_hash_ == lookup_key.key_hash_);
   if (lba) {
     *lba = block->lba_;
   }
@@ -63,9 +68,9 @@ bool BlockCacheTierMetadata::Lookup(const Slice& key, LBA* lba) {
 BlockInfo* BlockCacheTierMetadata::Remove(const Slice& key) {
   BlockInfo lookup_key(key);
   BlockInfo* binfo = nullptr;
-  bool ok __attribute__((__unused__));
-  ok = block_index_.Erase(&lookup_key, &binfo);
-  assert(ok);
+  if (!block_index_.Erase(&lookup_key, &binfo)) {
+    return nullptr;
+  }
   return binfo;
 }
 
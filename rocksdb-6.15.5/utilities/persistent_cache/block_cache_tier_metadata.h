@@ -12,6 +12,7 @@
 
 #include "rocksdb/slice.h"
 
+#include "util/hash.h"
 #include "utilities/persistent_cache/block_cache_tier_file.h"
 #include "utilities/persistent_cache/hash_table.h"
 #include "utilities/persistent_cache/hash_table_evictable.h"
@@ -33,15 +34,21 @@ namespace ROCKSDB_NAMESPACE {
 //
 // LBA = { cache-id, offset, size }
 //
+// To keep the index compact, it stores a 64-bit hash of the key instead of
+// the key. The record on disk holds the key, so readers detect the (rare)
+// hash collisions by comparing it with the key they look up.
+//
 // Cache File Index
 //
 // This is a forward index that maps a given cache-id to a cache file object.
 // Typically you would lookup using LBA and use the object to read or write
 struct BlockInfo {
   explicit BlockInfo(const Slice& key, const LBA& lba = LBA())
-      : key_(key.ToString()), lba_(lba) {}
+      : key_hash_(GetSliceHash64(key)), lba_(lba) {}
+  explicit BlockInfo(const uint64_t key_hash, const LBA& lba)
+      : key_hash_(key_hash), lba_(lba) {}
 
-  std::string key_;
+  uint64_t key_hash_;
   LBA lba_;
 };
 
@@ -61,12 +68,14 @@ class BlockCacheTierMetadata {
 
   // Insert block information to block index
   BlockInfo* Insert(const Slice& key, const LBA& lba);
+  // Insert block information, by key hash, to block index
+  BlockInfo* Insert(const uint64_t key_hash, const LBA& lba);
   // bool Insert(BlockInfo* binfo);
 
   // Lookup block information from block index
   bool Lookup(const Slice& key, LBA* lba);
 
-  // Remove a given from the block index
+  // Remove a given from the block index, or return nullptr if not found
   BlockInfo* Remove(const Slice& key);
 
   // Find and evict a cache file using LRU policy
@@ -104,13 +113,13 @@ class BlockCacheTierMetadata {
   // key => LBA
   struct Hash {
     size_t operator()(BlockInfo* node) const {
-      return std::hash<std::string>()(node->key_);
+      return static_cast<size_t>(node->key_hash_);
     }
   };
 
   struct Equal {
     size_t operator()(BlockInfo* lhs, BlockInfo* rhs) const {
-      return lhs->key_ == rhs->key_;
+      return lhs->key_hash_ == rhs->key_hash_;
     }
   };
 
@@ -10,10 +10,12 @@
 int main() { fprintf(stderr, "Please install gflags to run tools\n"); }
 #else
 #include <atomic>
+#include <cinttypes>
 #include <functional>
 #include <memory>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/env.h"
 
@@ -42,6 +44,11 @@ DEFINE_string(cache_type, "block_cache",
               "Cache type. (block_cache, volatile, tiered)");
 DEFINE_bool(benchmark, false, "Benchmark mode");
 DEFINE_int32(volatile_cache_pct, 10, "Percentage of cache in memory tier.");
+DEFINE_int32(read_batch_size, 1,
+             "Number of blocks looked up together with MultiLookup");
+DEFINE_bool(warm_restart, false,
+            "Restart the block cache after pre-population, and read from the "
+            "index restored from its manifest");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -64,6 +71,7 @@ std::unique_ptr<PersistentCacheTier> NewBlockCache() {
   opt.writer_qdepth = FLAGS_writer_qdepth;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
+  opt.enable_warm_restart = FLAGS_warm_restart;
   std::unique_ptr<PersistentCacheTier> cache(new BlockCacheTier(opt));
   Status status = cache->Open();
   return cache;
@@ -118,6 +126,10 @@ class CacheTierBenchmark {
       fprintf(stdout, "Pre-population completed\n");
     }
 
+    if (FLAGS_warm_restart) {
+      Restart();
+    }
+
     stats_.Clear();
 
     // Start IO threads
@@ -158,6 +170,7 @@ class CacheTierBenchmark {
         << stats_.bytes_written_.ToString() << std::endl
         << "* Bytes read:" << std::endl
         << stats_.bytes_read_.ToString() << std::endl
+        << "* Read misses: " << stats_.read_misses_ << std::endl
         << "Cache stats:" << std::endl
         << cache_->PrintStats() << std::endl;
     fprintf(stderr, "%s\n", msg.str().c_str());
@@ -212,12 +225,28 @@ class CacheTierBenchmark {
     stats_.bytes_written_.Add(FLAGS_iosize);
   }
 
+  // Close the cache and open it again from its manifest
+  void Restart() {
+    cache_->TEST_Flush();
+    cache_->Close();
+    cache_.reset();
+
+    StopWatchNano timer(Env::Default(), /*auto_start=*/true);
+    cache_ = NewBlockCache();
+    fprintf(stdout, "Warm restart completed in %" PRIu64 " ms\n",
+            timer.ElapsedNanos() / 1000000);
+  }
+
   //
   // Read implementation
   //
   void Read() {
     while (!quit_) {
-      ReadKey(random() % read_key_limit_);
+      if (FLAGS_read_batch_size > 1) {
+        ReadKeys();
+      } else {
+        ReadKey(random() % read_key_limit_);
+      }
     }
   }
 
@@ -231,6 +260,11 @@ class CacheTierBenchmark {
     std::unique_ptr<char[]> block;
     size_t size;
     Status status = cache_->Lookup(key, &block, &size);
+    if (!status.ok() && FLAGS_warm_restart) {
+      // the blocks that were not flushed are lost on restart
+      stats_.read_misses_++;
+      return;
+    }
     if (!status.ok()) {
       fprintf(stderr, "%s\n", status.ToString().c_str());
     }
@@ -249,6 +283,48 @@ class CacheTierBenchmark {
     }
   }
 
+  void ReadKeys() {
+    const size_t n = static_cast<size_t>(FLAGS_read_batch_size);
+    struct KeyBuf {
+      uint64_t k[3];
+    };
+    std::vector<uint64_t> vals(n);
+    std::vector<KeyBuf> key_bufs(n);
+    std::vector<Slice> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+      vals[i] = random() % read_key_limit_;
+      keys[i] = FillKey(key_bufs[i].k, vals[i]);
+    }
+
+    // Lookup in cache
+    StopWatchNano timer(Env::Default(), /*auto_start=*/true);
+    std::vector<std::unique_ptr<char[]>> blocks(n);
+    std::vector<size_t> sizes(n);
+    std::vector<Status> statuses(n);
+    cache_->MultiLookup(n, keys.data(), blocks.data(), sizes.data(),
+                        statuses.data());
+
+    // adjust stats, latency is per block
+    const size_t elapsed_micro = timer.ElapsedNanos() / 1000;
+    for (size_t i = 0; i < n; ++i) {
+      if (!statuses[i].ok()) {
+        assert(FLAGS_warm_restart);
+        stats_.read_misses_++;
+        continue;
+      }
+      assert(sizes[i] == (size_t)FLAGS_iosize);
+      stats_.read_latency_.Add(elapsed_micro / n);
+      stats_.bytes_read_.Add(FLAGS_iosize);
+
+      // verify content
+      if (!FLAGS_benchmark) {
+        auto expected_block = NewBlock(vals[i]);
+        assert(memcmp(blocks[i].get(), expected_block.get(), FLAGS_iosize) ==
+               0);
+      }
+    }
+  }
+
   // create data for a key by filling with a certain pattern
   std::unique_ptr<char[]> NewBlock(const uint64_t val) {
     std::unique_ptr<char[]> data(new char[FLAGS_iosize]);
@@ -286,12 +362,14 @@ class CacheTierBenchmark {
       bytes_read_.Clear();
       read_latency_.Clear();
       write_latency_.Clear();
+      read_misses_ = 0;
     }
 
     HistogramImpl bytes_written_;
     HistogramImpl bytes_read_;
     HistogramImpl read_latency_;
     HistogramImpl write_latency_;
+    std::atomic<uint64_t> read_misses_{0};
   };
 
   std::shared_ptr<PersistentCacheTier> cache_;  // cache implementation
@@ -325,7 +403,9 @@ int main(int argc, char** argv) {
       << std::endl
       << "* cache_type=" << FLAGS_cache_type << std::endl
       << "* benchmark=" << FLAGS_benchmark << std::endl
-      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl;
+      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl
+      << "* read_batch_size=" << FLAGS_read_batch_size << std::endl
+      << "* warm_restart=" << FLAGS_warm_restart << std::endl;
 
   fprintf(stderr, "%s\n", msg.str().c_str());
 
@@ -343,6 +423,11 @@ int main(int argc, char** argv) {
     fprintf(stderr, "Unknown option for cache\n");
   }
 
+  if (FLAGS_warm_restart && FLAGS_cache_type != "block_cache") {
+    fprintf(stderr, "Warm restart is only supported by the block cache\n");
+    abort();
+  }
+
   assert(cache);
   if (!cache) {
     fprintf(stderr, "Error creating cache\n");
@@ -103,13 +103,15 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache(
 std::unique_ptr<PersistentCacheTier> NewBlockCache(
     Env* env, const std::string& path,
     const uint64_t max_size = std::numeric_limits<uint64_t>::max(),
-    const bool enable_direct_writes = false) {
+    const bool enable_direct_writes = false,
+    const bool enable_warm_restart = false) {
   const uint32_t max_file_size = static_cast<uint32_t>(12 * 1024 * 1024 * kStressFactor);
   auto log = std::make_shared<ConsoleLogger>();
   PersistentCacheConfig opt(env, path, max_size, log);
   opt.cache_file_size = max_file_size;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   opt.enable_direct_writes = enable_direct_writes;
+  opt.enable_warm_restart = enable_warm_restart;
   std::unique_ptr<PersistentCacheTier> scache(new BlockCacheTier(opt));
   Status s = scache->Open();
   assert(s.ok());
@@ -174,6 +176,140 @@ TEST_F(PersistentCacheTierTest, BasicTest) {
   RunInsertTest(/*nthreads=*/1, /*max_keys=*/1024);
 }
 
+TEST_F(PersistentCacheTierTest, BlockCacheMultiLookup) {
+  cache_ = NewBlockCache(Env::Default(), path_);
+  // spans a few cache files, the last one still in the write buffers
+  Insert(/*nthreads=*/1, /*max_keys=*/1024);
+
+  const std::string prefix = "key_prefix_";
+  const size_t kBatchSize = 16;
+  for (size_t start = 0; start < max_keys_; start += kBatchSize) {
+    std::vector<std::string> key_strs;
+    for (size_t i = start; i < start + kBatchSize; ++i) {
+      key_strs.push_back(prefix + PaddedNumber(i, /*count=*/8));
+    }
+    // a key that is not in the cache, and a key looked up twice
+    key_strs.push_back("missing_key");
+    key_strs.push_back(key_strs[0]);
+
+    std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+    std::vector<std::unique_ptr<char[]>> data(keys.size());
+    std::vector<size_t> sizes(keys.size());
+    std::vector<Status> statuses(keys.size());
+    cache_->MultiLookup(keys.size(), keys.data(), data.data(), sizes.data(),
+                        statuses.data());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (i == kBatchSize) {
+        ASSERT_TRUE(statuses[i].IsNotFound());
+        continue;
+      }
+      const size_t key_num = i < kBatchSize ? start + i : start;
+      char edata[4 * 1024];
+      memset(edata, '0' + (key_num % 10), sizeof(edata));
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(sizes[i], sizeof(edata));
+      ASSERT_EQ(memcmp(edata, data[i].get(), sizeof(edata)), 0);
+    }
+  }
+
+  ASSERT_OK(cache_->Close());
+  cache_.reset();
+}
+
+TEST_F(PersistentCacheTierTest, BlockCacheErase) {
+  cache_ = NewBlockCache(Env::Default(), path_);
+  Insert(/*nthreads=*/1, /*max_keys=*/16);
+
+  const std::string key = "key_prefix_" + PaddedNumber(0, /*count=*/8);
+  std::unique_ptr<char[]> data;
+  size_t size;
+  ASSERT_OK(cache_->Lookup(key, &data, &size));
+  ASSERT_TRUE(cache_->Erase(key));
+  ASSERT_TRUE(cache_->Lookup(key, &data, &size).IsNotFound());
+  // keys that are not in the cache are left alone
+  ASSERT_FALSE(cache_->Erase(key));
+  ASSERT_FALSE(cache_->Erase("missing_key"));
+  const std::string other_key = "key_prefix_" + PaddedNumber(1, /*count=*/8);
+  ASSERT_OK(cache_->Lookup(other_key, &data, &size));
+
+  ASSERT_OK(cache_->Close());
+  cache_.reset();
+}
+
+TEST_F(PersistentCacheTierTest, BlockCacheWarmRestart) {
+  cache_ = NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*warm_restart=*/true);
+  Insert(/*nthreads=*/1, /*max_keys=*/1024);
+  ASSERT_OK(cache_->Close());
+
+  // the full cache files are restored, the data of the last one is lost
+  cache_ = NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*warm_restart=*/true);
+  Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+  ASSERT_GT(stats_verify_hits_, 0);
+  ASSERT_GT(stats_verify_missed_, 0);
+  ASSERT_OK(cache_->Close());
+
+  // without warm restart the cached data is discarded
+  cache_ = NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*warm_restart=*/false);
+  Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+  ASSERT_EQ(stats_verify_hits_, 0);
+
+  ASSERT_OK(cache_->Close());
+  cache_.reset();
+}
+
+TEST_F(PersistentCacheTierTest, BlockCacheWarmRestartNewId) {
+  cache_ = NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*warm_restart=*/true);
+  // keys prefixed with ids from the cache, like the keys of tables whose
+  // files have no unique id
+  const char edata[4 * 1024] = {'x'};
+  std::vector<std::string> keys;
+  uint64_t max_id = 0;
+  for (int i = 0; i < 16; ++i) {
+    const uint64_t id = cache_->NewId();
+    max_id = std::max(max_id, id);
+    std::string key;
+    PutVarint64(&key, id);
+    key.append("block");
+    ASSERT_OK(cache_->Insert(key, edata, sizeof(edata)));
+    keys.push_back(key);
+  }
+  // push the keys above into fully written cache files
+  Insert(/*nthreads=*/1, /*max_keys=*/1024);
+  ASSERT_OK(cache_->Close());
+
+  cache_ = NewBlockCache(Env::Default(), path_,
+                         /*size=*/std::numeric_limits<uint64_t>::max(),
+                         /*direct_writes=*/false, /*warm_restart=*/true);
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  ASSERT_OK(cache_->Lookup(keys[0], &data, &size));
+  ASSERT_EQ(sizeof(edata), size);
+  // new ids never match the restored keys
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_GT(cache_->NewId(), max_id);
+  }
+  ASSERT_OK(cache_->Close());
+
+  // the same holds for a block cache below a volatile tier
+  PersistentCacheConfig opt(Env::Default(), path_,
+                            std::numeric_limits<uint64_t>::max(),
+                            std::make_shared<ConsoleLogger>());
+  opt.enable_warm_restart = true;
+  auto tcache = NewTieredCache(/*mem_size=*/1024 * 1024, opt);
+  ASSERT_GT(tcache->NewId(), max_id);
+  ASSERT_OK(tcache->Close());
+  cache_.reset();
+}
+
 // Volatile cache tests
 // DISABLED for now (somewhat expensive)
 TEST_F(PersistentCacheTierTest, DISABLED_VolatileCacheInsert) {
@@ -447,6 +583,60 @@ TEST_F(PersistentCacheDBTest, BasicTest) {
           /*max_usecase=*/1);
 }
 
+TEST_F(PersistentCacheDBTest, MultiGetTest) {
+  for (bool is_compressed : {true, false}) {
+    Options options;
+    options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+    options = CurrentOptions(options);
+    auto pcache = std::make_shared<VolatileCacheTier>(is_compressed);
+    BlockBasedTableOptions table_options;
+    table_options.persistent_cache = pcache;
+    // every data block is read from the file or the persistent cache
+    table_options.no_block_cache = true;
+    table_options.block_size = 1024;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    const int kNumKeys = 256;
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      keys.push_back(Key(i));
+      values.push_back(rnd.RandomString(100));
+      ASSERT_OK(Put(keys.back(), values.back()));
+    }
+    ASSERT_OK(Flush());
+
+    // the first MultiGet reads the blocks from the file and fills the
+    // persistent cache, the second one is served by the persistent cache
+    for (int iter = 0; iter < 2; iter++) {
+      uint64_t page_hit = TestGetTickerCount(options, PERSISTENT_CACHE_HIT);
+      uint64_t page_miss = TestGetTickerCount(options, PERSISTENT_CACHE_MISS);
+      std::vector<Slice> key_slices(keys.begin(), keys.end());
+      std::vector<PinnableSlice> results(kNumKeys);
+      std::vector<Status> statuses(kNumKeys);
+      db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), kNumKeys,
+                    key_slices.data(), results.data(), statuses.data());
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_OK(statuses[i]);
+        ASSERT_EQ(results[i], values[i]);
+      }
+      if (iter == 0) {
+        ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_MISS),
+                  page_miss);
+      } else {
+        ASSERT_EQ(TestGetTickerCount(options, PERSISTENT_CACHE_MISS),
+                  page_miss);
+        ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_HIT), page_hit);
+      }
+    }
+
+    Close();
+    ASSERT_OK(pcache->Close());
+  }
+}
+
 // test table with block page cache
 // DISABLED for now (very expensive, especially memory)
 TEST_F(PersistentCacheDBTest, DISABLED_BlockCacheTest) {
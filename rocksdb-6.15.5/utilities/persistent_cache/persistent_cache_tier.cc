@@ -7,6 +7,7 @@
 
 #include "utilities/persistent_cache/persistent_cache_tier.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <sstream>
 #include <string>
@@ -49,6 +50,9 @@ std::string PersistentCacheConfig::ToString() const {
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "    is_compressed: %d\n", is_compressed);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    enable_warm_restart: %d\n",
+           enable_warm_restart);
+  ret.append(buffer);
 
   return ret;
 }
@@ -100,7 +104,19 @@ PersistentCache::StatsType PersistentCacheTier::Stats() {
 }
 
 uint64_t PersistentCacheTier::NewId() {
-  return last_id_.fetch_add(1, std::memory_order_relaxed);
+  uint64_t id = last_id_.fetch_add(1, std::memory_order_relaxed);
+  if (next_tier_) {
+    // the keys of the next tier may use ids this tier never handed out
+    id = std::max(id, next_tier_->NewId());
+  }
+  return id;
+}
+
+void PersistentCacheTier::SkipIdsBelow(const uint64_t id) {
+  uint64_t cur = last_id_.load(std::memory_order_relaxed);
+  while (cur < id && !last_id_.compare_exchange_weak(
+                         cur, id, std::memory_order_relaxed)) {
+  }
 }
 
 //
@@ -157,6 +173,11 @@ void PersistentTieredCache::AddTier(const Tier& tier) {
   tiers_.push_back(tier);
 }
 
+uint64_t PersistentTieredCache::NewId() {
+  assert(!tiers_.empty());
+  return tiers_.front()->NewId();
+}
+
 bool PersistentTieredCache::IsCompressed() {
   assert(tiers_.size());
   return tiers_.front()->IsCompressed();
@@ -217,6 +217,16 @@ struct PersistentCacheConfig {
   // uncompressed mode
   bool is_compressed = true;
 
+  // enable-warm-restart
+  //
+  // When enabled, Close() saves the index of the cache files that are fully
+  // written to a manifest in the cache directory, and Open() rebuilds the
+  // index from it instead of discarding the cached data. Data that was not
+  // flushed to disk before Close() is lost.
+  //
+  // default: false
+  bool enable_warm_restart = false;
+
   PersistentCacheConfig MakePersistentCacheConfig(
       const std::string& path, const uint64_t size,
       const std::shared_ptr<Logger>& log);
@@ -266,6 +276,8 @@ class PersistentCacheTier : public PersistentCache {
 
   virtual std::string GetPrintableOptions() const override = 0;
 
+  // Returns an id that neither this tier nor the tiers below it handed out
+  // before, including the ids restored by a warm restart
   virtual uint64_t NewId() override;
 
   // Return a reference to next tier
@@ -283,6 +295,13 @@ class PersistentCacheTier : public PersistentCache {
     }
   }
 
+ protected:
+  // The id NewId() hands out next, unless a tier below has used it
+  uint64_t next_id() const { return last_id_.load(std::memory_order_relaxed); }
+
+  // Makes NewId() return ids of at least id from now on
+  void SkipIdsBelow(const uint64_t id);
+
  private:
   Tier next_tier_;  // next tier
   std::atomic<uint64_t> last_id_{1};
@@ -307,6 +326,7 @@ class PersistentTieredCache : public PersistentCacheTier {
   Status Lookup(const Slice& page_key, std::unique_ptr<char[]>* data,
                 size_t* size) override;
   bool IsCompressed() override;
+  uint64_t NewId() override;
 
   std::string GetPrintableOptions() const override {
     return "PersistentTieredCache";
@@ -256,6 +256,14 @@ class SimCacheImpl : public SimCache {
     cache_->ApplyToAllCacheEntries(callback, thread_safe);
   }
 
+  void ApplyToAllCacheKeys(
+      const std::function<void(const Slice& key, size_t charge,
+                               Priority priority,
+                               const CacheItemHelper* helper)>&
+          callback) override {
+    cache_->ApplyToAllCacheKeys(callback);
+  }
+
   void EraseUnRefEntries() override {
     cache_->EraseUnRefEntries();
     key_only_cache_->EraseUnRefEntries();